@@ -0,0 +1,134 @@
+#include "BenchmarkSupport.h"
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace BenchmarkSupport {
+
+namespace {
+
+// Fixed seed so inputs are identical across runs and machines
+const uint64 INPUT_SEED = 0x1D1A6E;
+
+std::mutex& inputMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+int allCores() {
+    return std::max(1, cv::getNumberOfCPUs());
+}
+
+void registerArgs(benchmark::internal::Benchmark* b, int maxSide, bool grayToo) {
+    const int threadCounts[] = {1, allCores()};
+    for (int side = MIN_SIDE; side <= std::min(maxSide, MAX_SIDE); side *= 2) {
+        for (int channels = grayToo ? 1 : 3; channels <= 3; channels += 2) {
+            for (int t = 0; t < 2; ++t) {
+                if (t == 1 && threadCounts[1] == 1) {
+                    continue;
+                }
+                b->Args({side, channels, threadCounts[t]});
+            }
+        }
+    }
+    b->ArgNames({"side", "channels", "threads"});
+}
+
+cv::Mat buildImage(int side, int channels) {
+    cv::Mat image(side, side, CV_8UC3);
+
+    // Smooth gradients (one direction per channel)
+    for (int y = 0; y < side; ++y) {
+        cv::Vec3b* row = image.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < side; ++x) {
+            row[x] = cv::Vec3b(static_cast<uchar>(x * 255 / side),
+                               static_cast<uchar>(y * 255 / side),
+                               static_cast<uchar>((x + y) * 127 / side));
+        }
+    }
+
+    // Filled shapes give edges, regions and contours
+    cv::RNG rng(INPUT_SEED);
+    const int shapes = 24;
+    for (int i = 0; i < shapes; ++i) {
+        const cv::Point center(rng.uniform(0, side), rng.uniform(0, side));
+        const int radius = rng.uniform(side / 40, side / 10);
+        const cv::Scalar color(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+        if (i % 2 == 0) {
+            cv::circle(image, center, radius, color, cv::FILLED);
+        } else {
+            cv::rectangle(image, cv::Rect(center.x - radius, center.y - radius / 2,
+                                          radius * 2, radius), color, cv::FILLED);
+        }
+    }
+
+    // Mild noise so filters and estimators see texture
+    cv::Mat noise(image.size(), CV_16SC3);
+    rng.fill(noise, cv::RNG::NORMAL, 0, 6);
+    cv::Mat noisy;
+    image.convertTo(noisy, CV_16SC3);
+    noisy += noise;
+    noisy.convertTo(image, CV_8UC3);
+
+    if (channels == 1) {
+        cv::Mat gray;
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+        return gray;
+    }
+    return image;
+}
+
+} // namespace
+
+void imageArgs(benchmark::internal::Benchmark* b, int maxSide) {
+    registerArgs(b, maxSide, true);
+}
+
+void colorArgs(benchmark::internal::Benchmark* b, int maxSide) {
+    registerArgs(b, maxSide, false);
+}
+
+const cv::Mat& syntheticImage(int side, int channels) {
+    static std::map<std::pair<int, int>, cv::Mat> images;
+    std::lock_guard<std::mutex> lock(inputMutex());
+    cv::Mat& image = images[std::make_pair(side, channels)];
+    if (image.empty()) {
+        image = buildImage(side, channels);
+    }
+    return image;
+}
+
+const cv::Mat& syntheticMask(int side) {
+    static std::map<int, cv::Mat> masks;
+    const cv::Mat& gray = syntheticImage(side, 1);
+    std::lock_guard<std::mutex> lock(inputMutex());
+    cv::Mat& mask = masks[side];
+    if (mask.empty()) {
+        cv::threshold(gray, mask, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+    }
+    return mask;
+}
+
+// =============================================================================
+// FIXTURE
+// =============================================================================
+
+void ImageFixture::SetUp(const benchmark::State& state) {
+    cv::setNumThreads(static_cast<int>(state.range(2)));
+    input = syntheticImage(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    output.release();
+}
+
+void ImageFixture::TearDown(const benchmark::State&) {
+    input.release();
+    output.release();
+    cv::setNumThreads(-1);
+}
+
+void ImageFixture::reportThroughput(benchmark::State& state) const {
+    const int64_t pixels = static_cast<int64_t>(input.total());
+    state.SetItemsProcessed(state.iterations() * pixels);
+    state.SetBytesProcessed(state.iterations() * pixels * static_cast<int64_t>(input.elemSize()));
+}
+
+} // namespace BenchmarkSupport
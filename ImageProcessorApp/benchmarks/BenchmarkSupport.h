@@ -0,0 +1,113 @@
+#ifndef BENCHMARKSUPPORT_H
+#define BENCHMARKSUPPORT_H
+
+#include <benchmark/benchmark.h>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Shared fixtures and inputs for the imgproc_bench suite
+ *
+ * Every benchmark runs on a synthetic, deterministic image (same pixels on
+ * every machine and run) parameterized over:
+ *   range(0) - side of the square image (512 .. 8192)
+ *   range(1) - channel count (1 or 3)
+ *   range(2) - OpenCV worker threads (1 or all cores)
+ */
+namespace BenchmarkSupport {
+
+// =============================================================================
+// PARAMETERS
+// =============================================================================
+
+const int MIN_SIDE = 512;
+const int MAX_SIDE = 8192;
+
+// Size caps for operations whose cost makes the largest inputs impractical
+const int SIDE_CAP_SLOW = 2048;      // bilateral, watershed, ...
+const int SIDE_CAP_VERY_SLOW = 1024; // non-local means, GrabCut
+
+/**
+ * @brief Register sizes MIN_SIDE..maxSide (powers of two), 1 and 3 channels,
+ *        single-threaded and all cores
+ */
+void imageArgs(benchmark::internal::Benchmark* b, int maxSide = MAX_SIDE);
+
+/**
+ * @brief Same as imageArgs() with 3-channel inputs only
+ */
+void colorArgs(benchmark::internal::Benchmark* b, int maxSide = MAX_SIDE);
+
+// =============================================================================
+// INPUTS
+// =============================================================================
+
+/**
+ * @brief Synthetic test image: smooth gradients, filled shapes and fixed-seed
+ *        noise (cached, shared between benchmarks)
+ */
+const cv::Mat& syntheticImage(int side, int channels);
+
+/**
+ * @brief Binary (0/255) version of syntheticImage() with separate blobs
+ */
+const cv::Mat& syntheticMask(int side);
+
+// =============================================================================
+// FIXTURE
+// =============================================================================
+
+/**
+ * @brief Sets the thread count and provides the input image of the run
+ */
+class ImageFixture : public benchmark::Fixture {
+public:
+    void SetUp(const benchmark::State& state) override;
+    void TearDown(const benchmark::State& state) override;
+
+protected:
+    /**
+     * @brief Report pixel and byte throughput of the input
+     */
+    void reportThroughput(benchmark::State& state) const;
+
+    cv::Mat input;
+    cv::Mat output;
+};
+
+} // namespace BenchmarkSupport
+
+// The benchmark macros paste the fixture name into class names, so it has
+// to be usable unqualified
+using BenchmarkSupport::ImageFixture;
+
+/**
+ * @brief Register a fixture benchmark defined with BENCHMARK_DEFINE_F
+ *        (for benchmarks that prepare inputs before the timed loop)
+ * @param Name Benchmark name
+ * @param Args Argument generator (imageArgs or colorArgs, optionally capped)
+ */
+#define IMGPROC_REGISTER(Name, Args)                                           \
+    BENCHMARK_REGISTER_F(ImageFixture, Name)                                   \
+        ->Apply([](benchmark::internal::Benchmark* b) { Args; })               \
+        ->Unit(benchmark::kMillisecond)                                        \
+        ->UseRealTime()
+
+/**
+ * @brief Define and register a fixture benchmark
+ * @param Name Benchmark name
+ * @param Args Argument generator (imageArgs or colorArgs, optionally capped)
+ * @param ... Statement timed on every iteration (input -> output)
+ */
+#define IMGPROC_BENCHMARK(Name, Args, ...)                                     \
+    BENCHMARK_DEFINE_F(ImageFixture, Name)                                     \
+    (benchmark::State & state) {                                               \
+        for (auto _ : state) {                                                 \
+            __VA_ARGS__;                                                       \
+            benchmark::DoNotOptimize(output.data);                             \
+            benchmark::ClobberMemory();                                        \
+        }                                                                      \
+        reportThroughput(state);                                               \
+    }                                                                          \
+    IMGPROC_REGISTER(Name, Args)
+
+#endif // BENCHMARKSUPPORT_H
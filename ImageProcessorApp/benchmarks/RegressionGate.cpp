@@ -0,0 +1,419 @@
+#include "RegressionGate.h"
+#include <opencv2/core.hpp>
+#include <opencv2/core/utils/filesystem.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <regex>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace {
+
+double toMilliseconds(double value, const std::string& unit) {
+    if (unit == "ns") return value * 1e-6;
+    if (unit == "us") return value * 1e-3;
+    if (unit == "s") return value * 1e3;
+    return value;   // "ms"
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    const size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : 0.5 * (values[mid - 1] + values[mid]);
+}
+
+double stddev(const std::vector<double>& values) {
+    if (values.size() < 2) {
+        return 0.0;
+    }
+    double mean = 0.0;
+    for (double v : values) mean += v;
+    mean /= values.size();
+    double sum = 0.0;
+    for (double v : values) sum += (v - mean) * (v - mean);
+    return std::sqrt(sum / (values.size() - 1));
+}
+
+double relativeSpread(const RegressionGate::Measurement& m) {
+    return m.medianMs > 0.0 ? m.stddevMs / m.medianMs : 0.0;
+}
+
+std::string trim(const std::string& text) {
+    const size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    const size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+// First line printed by a shell command (empty on failure)
+std::string commandOutput(const std::string& command) {
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) {
+        return std::string();
+    }
+    char buffer[256];
+    std::string line;
+    if (fgets(buffer, sizeof(buffer), pipe)) {
+        line = buffer;
+    }
+    const int status = pclose(pipe);
+    return status == 0 ? trim(line) : std::string();
+}
+
+std::string currentDate() {
+    const std::time_t now = std::time(nullptr);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    return buffer;
+}
+
+const char* verdictLabel(RegressionGate::Verdict verdict) {
+    switch (verdict) {
+        case RegressionGate::VERDICT_IMPROVED:  return "faster";
+        case RegressionGate::VERDICT_REGRESSED: return "REGRESSED";
+        case RegressionGate::VERDICT_NEW:       return "new";
+        case RegressionGate::VERDICT_MISSING:   return "missing";
+        default:                                return "ok";
+    }
+}
+
+} // namespace
+
+// =============================================================================
+// RESULT FILES
+// =============================================================================
+
+bool RegressionGate::loadBenchmarkOutput(const std::string& path, ResultSet& results) {
+    cv::FileStorage fs;
+    try {
+        if (!fs.open(path, cv::FileStorage::READ | cv::FileStorage::FORMAT_JSON)) {
+            return false;
+        }
+    } catch (const cv::Exception&) {
+        return false;
+    }
+
+    const cv::FileNode benchmarks = fs["benchmarks"];
+    if (benchmarks.empty() || !benchmarks.isSeq()) {
+        return false;
+    }
+
+    // Repetitions are reported either as aggregates or as individual runs
+    std::map<std::string, std::vector<double>> samples;
+    std::map<std::string, Measurement> aggregates;
+
+    for (cv::FileNodeIterator it = benchmarks.begin(); it != benchmarks.end(); ++it) {
+        const cv::FileNode entry = *it;
+        if (!entry["error_occurred"].empty() && static_cast<int>(entry["error_occurred"]) != 0) {
+            continue;
+        }
+
+        std::string name = static_cast<std::string>(entry["run_name"]);
+        if (name.empty()) {
+            name = static_cast<std::string>(entry["name"]);
+        }
+        const double timeMs = toMilliseconds(static_cast<double>(entry["real_time"]),
+                                             static_cast<std::string>(entry["time_unit"]));
+
+        if (static_cast<std::string>(entry["run_type"]) == "aggregate") {
+            const std::string aggregate = static_cast<std::string>(entry["aggregate_name"]);
+            Measurement& m = aggregates[name];
+            m.name = name;
+            if (aggregate == "median") {
+                m.medianMs = timeMs;
+            } else if (aggregate == "stddev") {
+                m.stddevMs = timeMs;
+            }
+        } else {
+            samples[name].push_back(timeMs);
+        }
+    }
+
+    std::map<std::string, Measurement> measurements;
+    for (const auto& sample : samples) {
+        Measurement m;
+        m.name = sample.first;
+        m.medianMs = median(sample.second);
+        m.stddevMs = stddev(sample.second);
+        measurements[m.name] = m;
+    }
+    for (const auto& aggregate : aggregates) {
+        if (aggregate.second.medianMs > 0.0) {
+            measurements[aggregate.first] = aggregate.second;
+        }
+    }
+
+    results.date = static_cast<std::string>(fs["context"]["date"]);
+    if (results.date.empty()) {
+        results.date = currentDate();
+    }
+    results.measurements.clear();
+    for (const auto& m : measurements) {
+        results.measurements.push_back(m.second);
+    }
+    return !results.measurements.empty();
+}
+
+bool RegressionGate::loadResults(const std::string& path, ResultSet& results) {
+    cv::FileStorage fs;
+    try {
+        if (!fs.open(path, cv::FileStorage::READ | cv::FileStorage::FORMAT_JSON)) {
+            return false;
+        }
+    } catch (const cv::Exception&) {
+        return false;
+    }
+
+    results.commit = static_cast<std::string>(fs["commit"]);
+    results.cpu = static_cast<std::string>(fs["cpu"]);
+    results.date = static_cast<std::string>(fs["date"]);
+    results.measurements.clear();
+
+    const cv::FileNode benchmarks = fs["benchmarks"];
+    for (cv::FileNodeIterator it = benchmarks.begin(); it != benchmarks.end(); ++it) {
+        Measurement m;
+        m.name = static_cast<std::string>((*it)["name"]);
+        m.medianMs = static_cast<double>((*it)["median_ms"]);
+        m.stddevMs = static_cast<double>((*it)["stddev_ms"]);
+        if (!m.name.empty()) {
+            results.measurements.push_back(m);
+        }
+    }
+
+    std::sort(results.measurements.begin(), results.measurements.end(),
+              [](const Measurement& a, const Measurement& b) { return a.name < b.name; });
+    return true;
+}
+
+bool RegressionGate::saveResults(const std::string& path, const ResultSet& results) {
+    const size_t slash = path.find_last_of("/\\");
+    if (slash != std::string::npos && slash > 0) {
+        cv::utils::fs::createDirectories(path.substr(0, slash));
+    }
+
+    cv::FileStorage fs;
+    try {
+        if (!fs.open(path, cv::FileStorage::WRITE | cv::FileStorage::FORMAT_JSON)) {
+            return false;
+        }
+    } catch (const cv::Exception&) {
+        return false;
+    }
+
+    fs << "commit" << results.commit;
+    fs << "cpu" << results.cpu;
+    fs << "date" << results.date;
+    fs << "benchmarks" << "[";
+    for (const Measurement& m : results.measurements) {
+        fs << "{" << "name" << m.name
+           << "median_ms" << m.medianMs
+           << "stddev_ms" << m.stddevMs << "}";
+    }
+    fs << "]";
+    return true;
+}
+
+// =============================================================================
+// COMPARISON
+// =============================================================================
+
+std::vector<RegressionGate::Comparison> RegressionGate::compare(const ResultSet& baseline,
+                                                                const ResultSet& current,
+                                                                const Thresholds& thresholds) {
+    std::vector<std::pair<std::regex, double>> overrides;
+    for (const auto& entry : thresholds.overrides) {
+        overrides.emplace_back(std::regex(entry.first), entry.second);
+    }
+
+    std::map<std::string, const Measurement*> before;
+    std::map<std::string, const Measurement*> after;
+    for (const Measurement& m : baseline.measurements) before[m.name] = &m;
+    for (const Measurement& m : current.measurements) after[m.name] = &m;
+
+    std::map<std::string, Comparison> byName;
+
+    for (const auto& entry : before) {
+        Comparison c;
+        c.name = entry.first;
+        c.baselineMs = entry.second->medianMs;
+
+        const auto found = after.find(entry.first);
+        if (found == after.end()) {
+            c.verdict = VERDICT_MISSING;
+            byName[c.name] = c;
+            continue;
+        }
+        c.currentMs = found->second->medianMs;
+
+        double percent = thresholds.defaultPercent;
+        for (const auto& rule : overrides) {
+            if (std::regex_search(c.name, rule.first)) {
+                percent = rule.second;
+            }
+        }
+        const double spread = std::sqrt(std::pow(relativeSpread(*entry.second), 2) +
+                                        std::pow(relativeSpread(*found->second), 2));
+        c.allowedPercent = std::max(percent, thresholds.noiseFactor * spread * 100.0);
+
+        c.deltaPercent = c.baselineMs > 0.0
+            ? (c.currentMs - c.baselineMs) / c.baselineMs * 100.0
+            : 0.0;
+
+        const bool measurable = c.baselineMs >= thresholds.minTimeMs;
+        if (measurable && c.deltaPercent > c.allowedPercent) {
+            c.verdict = VERDICT_REGRESSED;
+        } else if (measurable && c.deltaPercent < -c.allowedPercent) {
+            c.verdict = VERDICT_IMPROVED;
+        }
+        byName[c.name] = c;
+    }
+
+    for (const auto& entry : after) {
+        if (before.count(entry.first) == 0) {
+            Comparison c;
+            c.name = entry.first;
+            c.currentMs = entry.second->medianMs;
+            c.verdict = VERDICT_NEW;
+            byName[c.name] = c;
+        }
+    }
+
+    std::vector<Comparison> comparisons;
+    comparisons.reserve(byName.size());
+    for (const auto& entry : byName) {
+        comparisons.push_back(entry.second);
+    }
+    return comparisons;
+}
+
+bool RegressionGate::hasRegression(const std::vector<Comparison>& comparisons) {
+    for (const Comparison& c : comparisons) {
+        if (c.verdict == VERDICT_REGRESSED) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RegressionGate::hasMissing(const std::vector<Comparison>& comparisons) {
+    for (const Comparison& c : comparisons) {
+        if (c.verdict == VERDICT_MISSING) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RegressionGate::printReport(std::ostream& out, const ResultSet& baseline,
+                                 const ResultSet& current,
+                                 const std::vector<Comparison>& comparisons,
+                                 bool verbose) {
+    out << "Baseline: " << baseline.commit << " (" << baseline.date << ")\n"
+        << "Current:  " << current.commit << " (" << current.date << ")\n"
+        << "CPU:      " << current.cpu << "\n\n";
+
+    size_t width = 9;
+    for (const Comparison& c : comparisons) {
+        width = std::max(width, c.name.size());
+    }
+
+    out << std::left << std::setw(static_cast<int>(width)) << "Benchmark"
+        << std::right << std::setw(14) << "Baseline ms" << std::setw(14) << "Current ms"
+        << std::setw(10) << "Delta" << std::setw(10) << "Allowed" << "  Status\n";
+
+    int counts[5] = {0, 0, 0, 0, 0};
+    const std::ios::fmtflags flags = out.flags();
+    for (const Comparison& c : comparisons) {
+        ++counts[c.verdict];
+        if (!verbose && c.verdict == VERDICT_UNCHANGED) {
+            continue;
+        }
+
+        out << std::left << std::setw(static_cast<int>(width)) << c.name << std::right
+            << std::fixed << std::setprecision(3);
+        if (c.verdict == VERDICT_NEW) {
+            out << std::setw(14) << "-";
+        } else {
+            out << std::setw(14) << c.baselineMs;
+        }
+        if (c.verdict == VERDICT_MISSING) {
+            out << std::setw(14) << "-" << std::setw(10) << "-" << std::setw(10) << "-";
+        } else {
+            out << std::setw(14) << c.currentMs;
+            if (c.verdict == VERDICT_NEW) {
+                out << std::setw(10) << "-" << std::setw(10) << "-";
+            } else {
+                out << std::setprecision(1) << std::showpos << std::setw(9) << c.deltaPercent << "%"
+                    << std::noshowpos << std::setw(9) << c.allowedPercent << "%";
+            }
+        }
+        out << "  " << verdictLabel(c.verdict) << "\n";
+    }
+    out.flags(flags);
+
+    out << "\n" << comparisons.size() << " benchmarks: "
+        << counts[VERDICT_REGRESSED] << " regressed, "
+        << counts[VERDICT_IMPROVED] << " faster, "
+        << counts[VERDICT_UNCHANGED] << " unchanged, "
+        << counts[VERDICT_NEW] << " new, "
+        << counts[VERDICT_MISSING] << " missing\n";
+}
+
+// =============================================================================
+// RUN IDENTIFICATION
+// =============================================================================
+
+std::string RegressionGate::cpuModel() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        // x86 reports "model name", some ARM kernels only "Processor"/"Hardware"
+        if (line.compare(0, 10, "model name") == 0 || line.compare(0, 9, "Processor") == 0 ||
+            line.compare(0, 8, "Hardware") == 0) {
+            const size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                const std::string model = trim(line.substr(colon + 1));
+                if (!model.empty()) {
+                    return model;
+                }
+            }
+        }
+    }
+
+    const char* identifier = std::getenv("PROCESSOR_IDENTIFIER");   // Windows
+    return identifier ? trim(identifier) : std::string("unknown-cpu");
+}
+
+std::string RegressionGate::currentCommit(const std::string& sourceDir) {
+    const std::string commit = commandOutput("git -C \"" + sourceDir +
+                                             "\" describe --always --dirty --abbrev=12");
+    return commit.empty() ? std::string("unknown") : commit;
+}
+
+std::string RegressionGate::slug(const std::string& text) {
+    std::string result;
+    for (char ch : text) {
+        const unsigned char c = static_cast<unsigned char>(ch);
+        if (std::isalnum(c)) {
+            result += static_cast<char>(std::tolower(c));
+        } else if (!result.empty() && result.back() != '-') {
+            result += '-';
+        }
+    }
+    while (!result.empty() && result.back() == '-') {
+        result.pop_back();
+    }
+    return result.empty() ? std::string("unknown") : result;
+}
@@ -0,0 +1,156 @@
+#ifndef REGRESSIONGATE_H
+#define REGRESSIONGATE_H
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Compares imgproc_bench runs against a stored baseline
+ *
+ * A result set is the median (and spread) of every benchmark of one run,
+ * tagged with the commit it was built from and the CPU model it ran on.
+ * Result sets are stored as small JSON files (cv::FileStorage), so baselines
+ * can be checked in next to the code and compared without network access.
+ */
+class RegressionGate {
+public:
+    /**
+     * @brief Timing of one benchmark (milliseconds)
+     */
+    struct Measurement {
+        std::string name;
+        double medianMs;
+        double stddevMs;
+
+        Measurement() : medianMs(0.0), stddevMs(0.0) {}
+    };
+
+    /**
+     * @brief All measurements of one run
+     */
+    struct ResultSet {
+        std::string commit;
+        std::string cpu;
+        std::string date;
+        std::vector<Measurement> measurements;   // sorted by name
+    };
+
+    /**
+     * @brief When a slowdown counts as a regression
+     *
+     * A benchmark regresses when its median grows by more than the allowed
+     * percentage, which is the threshold of the benchmark (the last matching
+     * override, else defaultPercent) or noiseFactor times the combined
+     * relative spread of both runs, whichever is larger. Benchmarks faster
+     * than minTimeMs in the baseline are reported but never fail the gate.
+     */
+    struct Thresholds {
+        double defaultPercent;
+        double noiseFactor;
+        double minTimeMs;
+        std::vector<std::pair<std::string, double>> overrides;   // regex -> percent
+
+        Thresholds() : defaultPercent(5.0), noiseFactor(2.0), minTimeMs(0.05) {}
+    };
+
+    enum Verdict {
+        VERDICT_UNCHANGED,
+        VERDICT_IMPROVED,
+        VERDICT_REGRESSED,
+        VERDICT_NEW,        // only in the current run
+        VERDICT_MISSING     // only in the baseline
+    };
+
+    /**
+     * @brief Outcome for one benchmark
+     */
+    struct Comparison {
+        std::string name;
+        double baselineMs;
+        double currentMs;
+        double deltaPercent;
+        double allowedPercent;
+        Verdict verdict;
+
+        Comparison()
+            : baselineMs(0.0), currentMs(0.0), deltaPercent(0.0),
+              allowedPercent(0.0), verdict(VERDICT_UNCHANGED) {}
+    };
+
+    // ==========================================================================
+    // RESULT FILES
+    // ==========================================================================
+
+    /**
+     * @brief Read Google Benchmark JSON output (--benchmark_out_format=json)
+     * @param path Output file of imgproc_bench
+     * @param results Measurements (median of repetitions when available)
+     * @return false if the file cannot be read or has no benchmarks
+     */
+    static bool loadBenchmarkOutput(const std::string& path, ResultSet& results);
+
+    /**
+     * @brief Read a result set written by saveResults()
+     */
+    static bool loadResults(const std::string& path, ResultSet& results);
+
+    /**
+     * @brief Write a result set (creates missing directories)
+     */
+    static bool saveResults(const std::string& path, const ResultSet& results);
+
+    // ==========================================================================
+    // COMPARISON
+    // ==========================================================================
+
+    /**
+     * @brief Compare every benchmark of two runs
+     * @return One entry per benchmark name in either run, sorted by name
+     */
+    static std::vector<Comparison> compare(const ResultSet& baseline,
+                                           const ResultSet& current,
+                                           const Thresholds& thresholds);
+
+    /**
+     * @brief Whether any benchmark regressed
+     */
+    static bool hasRegression(const std::vector<Comparison>& comparisons);
+
+    /**
+     * @brief Whether any baseline benchmark is absent from the current run
+     */
+    static bool hasMissing(const std::vector<Comparison>& comparisons);
+
+    /**
+     * @brief Print the per-benchmark diff table and a summary line
+     * @param verbose Also list unchanged benchmarks
+     */
+    static void printReport(std::ostream& out, const ResultSet& baseline,
+                            const ResultSet& current,
+                            const std::vector<Comparison>& comparisons,
+                            bool verbose = false);
+
+    // ==========================================================================
+    // RUN IDENTIFICATION
+    // ==========================================================================
+
+    /**
+     * @brief CPU model name of this machine ("unknown-cpu" if unavailable)
+     */
+    static std::string cpuModel();
+
+    /**
+     * @brief Commit of a source tree (git describe --always --dirty)
+     * @return "unknown" if git or the repository is unavailable
+     */
+    static std::string currentCommit(const std::string& sourceDir);
+
+    /**
+     * @brief File-name friendly form of a CPU model or commit
+     */
+    static std::string slug(const std::string& text);
+};
+
+#endif // REGRESSIONGATE_H
@@ -0,0 +1,172 @@
+#include "BenchmarkSupport.h"
+#include "processing/ColorProcessingLib.h"
+
+using namespace BenchmarkSupport;
+using ColorProcessingLib::ColorSpace;
+using ColorProcessingLib::WhiteBalanceMode;
+
+// =============================================================================
+// COLOR SPACE CONVERSIONS
+// =============================================================================
+
+IMGPROC_BENCHMARK(Color_ConvertColorSpaceLAB, colorArgs(b),
+                  ColorProcessingLib::convertColorSpace(input, output, ColorSpace::LAB));
+IMGPROC_BENCHMARK(Color_RgbToHSV, colorArgs(b),
+                  ColorProcessingLib::rgbToHSV(input, output));
+IMGPROC_BENCHMARK(Color_RgbToLAB, colorArgs(b),
+                  ColorProcessingLib::rgbToLAB(input, output));
+IMGPROC_BENCHMARK(Color_RgbToYCrCb, colorArgs(b),
+                  ColorProcessingLib::rgbToYCrCb(input, output));
+IMGPROC_BENCHMARK(Color_RgbToHSL, colorArgs(b),
+                  ColorProcessingLib::rgbToHSL(input, output));
+IMGPROC_BENCHMARK(Color_RgbToXYZ, colorArgs(b),
+                  ColorProcessingLib::rgbToXYZ(input, output));
+
+// =============================================================================
+// CHANNEL OPERATIONS
+// =============================================================================
+
+BENCHMARK_DEFINE_F(ImageFixture, Color_SplitChannels)(benchmark::State& state) {
+    std::vector<cv::Mat> channels;
+    for (auto _ : state) {
+        ColorProcessingLib::splitChannels(input, channels);
+        benchmark::DoNotOptimize(channels.data());
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Color_SplitChannels, colorArgs(b));
+
+BENCHMARK_DEFINE_F(ImageFixture, Color_MergeChannels)(benchmark::State& state) {
+    std::vector<cv::Mat> channels;
+    ColorProcessingLib::splitChannels(input, channels);
+    for (auto _ : state) {
+        ColorProcessingLib::mergeChannels(channels, output);
+        benchmark::DoNotOptimize(output.data);
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Color_MergeChannels, colorArgs(b));
+
+IMGPROC_BENCHMARK(Color_ExtractChannel, colorArgs(b),
+                  ColorProcessingLib::extractChannel(input, output, 1));
+IMGPROC_BENCHMARK(Color_VisualizeChannel, colorArgs(b),
+                  ColorProcessingLib::visualizeChannel(input, output, 2));
+IMGPROC_BENCHMARK(Color_SwapChannels, colorArgs(b),
+                  ColorProcessingLib::swapChannels(input, output, 0, 2));
+
+// =============================================================================
+// COLOR ADJUSTMENTS
+// =============================================================================
+
+IMGPROC_BENCHMARK(Color_AdjustBrightness, imageArgs(b),
+                  ColorProcessingLib::adjustBrightness(input, output, 30));
+IMGPROC_BENCHMARK(Color_AdjustContrast, imageArgs(b),
+                  ColorProcessingLib::adjustContrast(input, output, 1.3));
+IMGPROC_BENCHMARK(Color_AdjustSaturation, colorArgs(b),
+                  ColorProcessingLib::adjustSaturation(input, output, 40));
+IMGPROC_BENCHMARK(Color_AdjustHue, colorArgs(b),
+                  ColorProcessingLib::adjustHue(input, output, 30));
+IMGPROC_BENCHMARK(Color_AdjustTemperature, colorArgs(b),
+                  ColorProcessingLib::adjustTemperature(input, output, 40));
+IMGPROC_BENCHMARK(Color_AdjustColors, colorArgs(b),
+                  ColorProcessingLib::adjustColors(input, output, 20, 1.2, 30, 15));
+
+// =============================================================================
+// WHITE BALANCE ENGINE
+// =============================================================================
+
+IMGPROC_BENCHMARK(Color_WhiteBalance, colorArgs(b),
+                  ColorProcessingLib::whiteBalance(input, output));
+IMGPROC_BENCHMARK(Color_WhiteBalancePercentile, colorArgs(b),
+                  ColorProcessingLib::whiteBalance(input, output,
+                                                   WhiteBalanceMode::PERCENTILE, 99.0, 1));
+
+BENCHMARK_DEFINE_F(ImageFixture, Color_WhiteBalanceStats)(benchmark::State& state) {
+    ColorProcessingLib::WhiteBalanceStats stats;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ColorProcessingLib::computeWhiteBalanceStats(input, stats, 1));
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Color_WhiteBalanceStats, colorArgs(b));
+
+BENCHMARK_DEFINE_F(ImageFixture, Color_WhiteBalanceGains)(benchmark::State& state) {
+    ColorProcessingLib::WhiteBalanceStats stats;
+    ColorProcessingLib::computeWhiteBalanceStats(input, stats, 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ColorProcessingLib::computeWhiteBalanceGains(
+            stats, WhiteBalanceMode::PERCENTILE, 99.0));
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Color_WhiteBalanceGains, colorArgs(b, MIN_SIDE));
+
+IMGPROC_BENCHMARK(Color_ApplyWhiteBalanceGains, colorArgs(b),
+                  ColorProcessingLib::applyWhiteBalanceGains(input, output, cv::Vec3d(1.1, 1.0, 0.9)));
+
+BENCHMARK_DEFINE_F(ImageFixture, Color_WhiteBalanceFromStats)(benchmark::State& state) {
+    ColorProcessingLib::WhiteBalanceStats stats;
+    ColorProcessingLib::computeWhiteBalanceStats(input, stats, 1);
+    for (auto _ : state) {
+        ColorProcessingLib::whiteBalance(input, output, stats, WhiteBalanceMode::GRAY_WORLD);
+        benchmark::DoNotOptimize(output.data);
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Color_WhiteBalanceFromStats, colorArgs(b));
+
+// =============================================================================
+// COLOR GRADING & EFFECTS
+// =============================================================================
+
+IMGPROC_BENCHMARK(Color_Sepia, colorArgs(b),
+                  ColorProcessingLib::applySepiaEffect(input, output, 1.0));
+IMGPROC_BENCHMARK(Color_CoolFilter, colorArgs(b),
+                  ColorProcessingLib::applyCoolFilter(input, output, 0.5));
+IMGPROC_BENCHMARK(Color_WarmFilter, colorArgs(b),
+                  ColorProcessingLib::applyWarmFilter(input, output, 0.5));
+IMGPROC_BENCHMARK(Color_Vintage, colorArgs(b),
+                  ColorProcessingLib::applyVintageEffect(input, output));
+
+BENCHMARK_DEFINE_F(ImageFixture, Color_ApplyLUT)(benchmark::State& state) {
+    cv::Mat lut;
+    ColorProcessingLib::createColorGradingLUT(lut, "warm");
+    for (auto _ : state) {
+        ColorProcessingLib::applyLUT(input, output, lut);
+        benchmark::DoNotOptimize(output.data);
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Color_ApplyLUT, colorArgs(b));
+
+BENCHMARK_DEFINE_F(ImageFixture, Color_CreateColorGradingLUT)(benchmark::State& state) {
+    for (auto _ : state) {
+        ColorProcessingLib::createColorGradingLUT(output, "cool");
+        benchmark::DoNotOptimize(output.data);
+    }
+}
+IMGPROC_REGISTER(Color_CreateColorGradingLUT, colorArgs(b, MIN_SIDE));
+
+// =============================================================================
+// UTILITY FUNCTIONS
+// =============================================================================
+
+IMGPROC_BENCHMARK(Color_GetColorSpaceName, colorArgs(b, MIN_SIDE),
+                  benchmark::DoNotOptimize(ColorProcessingLib::getColorSpaceName(ColorSpace::YCrCb)));
+IMGPROC_BENCHMARK(Color_IsValidImage, imageArgs(b, MIN_SIDE),
+                  benchmark::DoNotOptimize(ColorProcessingLib::isValidImage(input)));
+IMGPROC_BENCHMARK(Color_ClampToByte, imageArgs(b, MIN_SIDE),
+                  benchmark::DoNotOptimize(ColorProcessingLib::clampToByte(300)));
+
+BENCHMARK_DEFINE_F(ImageFixture, Color_NormalizeChannel)(benchmark::State& state) {
+    // One channel stretched outside 0..255
+    cv::Mat channel, wide;
+    cv::extractChannel(input, channel, 0);
+    channel.convertTo(wide, CV_32F, 3.0, -100.0);
+    for (auto _ : state) {
+        ColorProcessingLib::normalizeChannelForVisualization(wide, output);
+        benchmark::DoNotOptimize(output.data);
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Color_NormalizeChannel, imageArgs(b));
@@ -0,0 +1,85 @@
+#include "BenchmarkSupport.h"
+#include "filters/ImageFilters.h"
+
+using namespace BenchmarkSupport;
+
+// =============================================================================
+// SMOOTHING FILTERS
+// =============================================================================
+
+IMGPROC_BENCHMARK(Filters_Traditional, imageArgs(b),
+                  ImageFilters::applyTraditionalFilter(input, output, 5));
+IMGPROC_BENCHMARK(Filters_Pyramidal, imageArgs(b),
+                  ImageFilters::applyPyramidalFilter(input, output));
+IMGPROC_BENCHMARK(Filters_Circular, imageArgs(b),
+                  ImageFilters::applyCircularFilter(input, output, 2.0f));
+IMGPROC_BENCHMARK(Filters_Cone, imageArgs(b),
+                  ImageFilters::applyConeFilter(input, output));
+
+// =============================================================================
+// EDGE DETECTION
+// =============================================================================
+
+IMGPROC_BENCHMARK(Filters_Laplacian, imageArgs(b),
+                  ImageFilters::applyLaplacianFilter(input, output));
+IMGPROC_BENCHMARK(Filters_Sobel, imageArgs(b),
+                  ImageFilters::applySobelFilter(input, output));
+
+// =============================================================================
+// NOISE
+// =============================================================================
+
+IMGPROC_BENCHMARK(Filters_GaussianNoise, imageArgs(b),
+                  ImageFilters::addGaussianNoise(input, output, 0.0, 25.0));
+IMGPROC_BENCHMARK(Filters_SaltPepperNoise, imageArgs(b),
+                  ImageFilters::addSaltPepperNoise(input, output, 0.05));
+IMGPROC_BENCHMARK(Filters_PoissonNoise, imageArgs(b),
+                  ImageFilters::addPoissonNoise(input, output));
+IMGPROC_BENCHMARK(Filters_SpeckleNoise, imageArgs(b),
+                  ImageFilters::addSpeckleNoise(input, output, 0.1));
+
+// =============================================================================
+// DENOISING
+// =============================================================================
+
+IMGPROC_BENCHMARK(Filters_Median, imageArgs(b),
+                  ImageFilters::applyMedianFilter(input, output, 5));
+IMGPROC_BENCHMARK(Filters_Bilateral, imageArgs(b, SIDE_CAP_SLOW),
+                  ImageFilters::applyBilateralFilter(input, output, 9, 75.0, 75.0));
+IMGPROC_BENCHMARK(Filters_NonLocalMeans, imageArgs(b, SIDE_CAP_VERY_SLOW),
+                  ImageFilters::applyNonLocalMeansDenoising(input, output, 10.0f, 7, 21));
+
+// =============================================================================
+// MORPHOLOGY
+// =============================================================================
+
+IMGPROC_BENCHMARK(Filters_Opening, imageArgs(b),
+                  ImageFilters::applyMorphologicalOpening(input, output, 5, 1));
+IMGPROC_BENCHMARK(Filters_Closing, imageArgs(b),
+                  ImageFilters::applyMorphologicalClosing(input, output, 5, 1));
+IMGPROC_BENCHMARK(Filters_Gradient, imageArgs(b),
+                  ImageFilters::applyMorphologicalGradient(input, output, 5));
+IMGPROC_BENCHMARK(Filters_TopHat, imageArgs(b),
+                  ImageFilters::applyTopHat(input, output, 9));
+IMGPROC_BENCHMARK(Filters_BlackHat, imageArgs(b),
+                  ImageFilters::applyBlackHat(input, output, 9));
+
+// =============================================================================
+// SHARPENING
+// =============================================================================
+
+IMGPROC_BENCHMARK(Filters_UnsharpMask, imageArgs(b),
+                  ImageFilters::applyUnsharpMask(input, output, 1.0, 1.5, 0));
+IMGPROC_BENCHMARK(Filters_HighPass, imageArgs(b),
+                  ImageFilters::applyHighPassFilter(input, output, 21));
+IMGPROC_BENCHMARK(Filters_CustomSharpen, imageArgs(b),
+                  ImageFilters::applyCustomSharpen(input, output, 100));
+
+// =============================================================================
+// UTILITY FUNCTIONS (size independent)
+// =============================================================================
+
+IMGPROC_BENCHMARK(Filters_IsValidImage, imageArgs(b, MIN_SIDE),
+                  benchmark::DoNotOptimize(ImageFilters::isValidImage(input)));
+IMGPROC_BENCHMARK(Filters_CreateStructuringElement, imageArgs(b, MIN_SIDE),
+                  output = ImageFilters::createStructuringElement(1, 15));
@@ -0,0 +1,59 @@
+#include "BenchmarkSupport.h"
+#include "processing/MorphologyLib.h"
+
+using namespace BenchmarkSupport;
+
+// =============================================================================
+// BASIC MORPHOLOGICAL OPERATIONS
+// =============================================================================
+
+IMGPROC_BENCHMARK(Morphology_Erosion, imageArgs(b),
+                  MorphologyLib::applyErosion(input, output, 5, MorphologyLib::ELLIPSE, 1));
+IMGPROC_BENCHMARK(Morphology_ErosionLarge, imageArgs(b),
+                  MorphologyLib::applyErosion(input, output, 31, MorphologyLib::RECT, 1));
+IMGPROC_BENCHMARK(Morphology_Dilation, imageArgs(b),
+                  MorphologyLib::applyDilation(input, output, 5, MorphologyLib::ELLIPSE, 1));
+IMGPROC_BENCHMARK(Morphology_Opening, imageArgs(b),
+                  MorphologyLib::applyOpening(input, output, 5, MorphologyLib::ELLIPSE));
+IMGPROC_BENCHMARK(Morphology_Closing, imageArgs(b),
+                  MorphologyLib::applyClosing(input, output, 5, MorphologyLib::ELLIPSE));
+IMGPROC_BENCHMARK(Morphology_Gradient, imageArgs(b),
+                  MorphologyLib::applyMorphGradient(input, output, 5));
+IMGPROC_BENCHMARK(Morphology_TopHat, imageArgs(b),
+                  MorphologyLib::applyTopHatTransform(input, output, 9));
+IMGPROC_BENCHMARK(Morphology_BlackHat, imageArgs(b),
+                  MorphologyLib::applyBlackHatTransform(input, output, 9));
+
+// =============================================================================
+// ADVANCED MORPHOLOGY
+// =============================================================================
+
+IMGPROC_BENCHMARK(Morphology_CreateStructuringElement, imageArgs(b, MIN_SIDE),
+                  output = MorphologyLib::createStructuringElement(MorphologyLib::ELLIPSE,
+                                                                   cv::Size(15, 15)));
+IMGPROC_BENCHMARK(Morphology_Iterative, imageArgs(b),
+                  MorphologyLib::applyIterativeMorphology(input, output, cv::MORPH_OPEN, 5, 3));
+
+// =============================================================================
+// EDGE DETECTION SUITE
+// =============================================================================
+
+IMGPROC_BENCHMARK(Morphology_Prewitt, imageArgs(b),
+                  MorphologyLib::applyPrewittOperator(input, output));
+IMGPROC_BENCHMARK(Morphology_RobertsCross, imageArgs(b),
+                  MorphologyLib::applyRobertsCross(input, output));
+IMGPROC_BENCHMARK(Morphology_LoG, imageArgs(b),
+                  MorphologyLib::applyLoG(input, output, 5, 1.0));
+IMGPROC_BENCHMARK(Morphology_DoG, imageArgs(b),
+                  MorphologyLib::applyDoG(input, output, 5, 1.0, 9, 2.0));
+IMGPROC_BENCHMARK(Morphology_ZeroCrossing, imageArgs(b),
+                  MorphologyLib::applyZeroCrossing(input, output, 5));
+
+// =============================================================================
+// UTILITY FUNCTIONS
+// =============================================================================
+
+IMGPROC_BENCHMARK(Morphology_IsValidImage, imageArgs(b, MIN_SIDE),
+                  benchmark::DoNotOptimize(MorphologyLib::isValidImage(input)));
+IMGPROC_BENCHMARK(Morphology_NormalizeEdgeImage, imageArgs(b),
+                  MorphologyLib::normalizeEdgeImage(input, output));
@@ -0,0 +1,82 @@
+#include "BenchmarkSupport.h"
+#include "filters/ImageFilters.h"
+#include "processing/BufferPool.h"
+#include "processing/ColorProcessingLib.h"
+#include "processing/ImageProcessingLib.h"
+
+using namespace BenchmarkSupport;
+
+BENCHMARK_DEFINE_F(ImageFixture, Processing_AutoEnhance)(benchmark::State& state) {
+    QStringList operations;
+    for (auto _ : state) {
+        operations.clear();
+        ImageProcessingLib::applyAutoEnhance(input, output, operations);
+        benchmark::DoNotOptimize(output.data);
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Processing_AutoEnhance, imageArgs(b));
+
+IMGPROC_BENCHMARK(Processing_Grayscale, imageArgs(b),
+                  ImageProcessingLib::convertToGrayscale(input, output));
+IMGPROC_BENCHMARK(Processing_BinaryThreshold, imageArgs(b),
+                  ImageProcessingLib::applyBinaryThreshold(input, output, 128));
+IMGPROC_BENCHMARK(Processing_GaussianBlur, imageArgs(b),
+                  ImageProcessingLib::applyGaussianBlur(input, output, 5));
+IMGPROC_BENCHMARK(Processing_EdgeDetection, imageArgs(b),
+                  ImageProcessingLib::applyEdgeDetection(input, output, 100, 200));
+IMGPROC_BENCHMARK(Processing_Invert, imageArgs(b),
+                  ImageProcessingLib::invertColors(input, output));
+IMGPROC_BENCHMARK(Processing_HistogramEqualization, imageArgs(b),
+                  ImageProcessingLib::applyHistogramEqualization(input, output));
+IMGPROC_BENCHMARK(Processing_OtsuThreshold, imageArgs(b),
+                  ImageProcessingLib::applyOtsuThresholding(input, output));
+
+// =============================================================================
+// PIPELINE
+// =============================================================================
+
+namespace {
+
+// A typical edit session: every step allocates its own temporaries
+void runChain(const cv::Mat& input, cv::Mat& output) {
+    cv::Mat a, b;
+    ImageFilters::addGaussianNoise(input, a, 0.0, 10.0);
+    ImageFilters::applyMedianFilter(a, b, 3);
+    ImageFilters::applyUnsharpMask(b, a);
+    ColorProcessingLib::applySepiaEffect(a, b, 0.5);
+    ImageProcessingLib::applyGaussianBlur(b, a, 3);
+    ImageProcessingLib::applyHistogramEqualization(a, b);
+    ImageProcessingLib::invertColors(b, a);
+    ImageProcessingLib::convertToGrayscale(a, b);
+    ImageProcessingLib::applyEdgeDetection(b, a, 100, 200);
+    ImageProcessingLib::applyOtsuThresholding(a, output);
+}
+
+} // namespace
+
+IMGPROC_BENCHMARK(Processing_Chain, colorArgs(b, SIDE_CAP_SLOW),
+                  runChain(input, output));
+
+// Same chain with BufferPool as the default allocator; pool_misses is the
+// number of buffers still allocated per iteration once the pool is warm
+BENCHMARK_DEFINE_F(ImageFixture, Processing_ChainPooled)(benchmark::State& state) {
+    BufferPool& pool = BufferPool::instance();
+    cv::MatAllocator* previous = cv::Mat::getDefaultAllocator();
+    cv::Mat::setDefaultAllocator(&pool);
+
+    runChain(input, output);
+    pool.resetStats();
+    for (auto _ : state) {
+        runChain(input, output);
+        benchmark::DoNotOptimize(output.data);
+        benchmark::ClobberMemory();
+    }
+    state.counters["pool_misses"] = benchmark::Counter(
+        static_cast<double>(pool.stats().misses), benchmark::Counter::kAvgIterations);
+
+    cv::Mat::setDefaultAllocator(previous);
+    pool.trim();
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Processing_ChainPooled, colorArgs(b, SIDE_CAP_SLOW));
@@ -0,0 +1,208 @@
+#include "BenchmarkSupport.h"
+#include "processing/SegmentationLib.h"
+
+using namespace BenchmarkSupport;
+
+namespace {
+
+// Contours of the synthetic mask, found once per run outside the timed loop
+std::vector<std::vector<cv::Point>> maskContours(int side) {
+    std::vector<std::vector<cv::Point>> contours;
+    std::vector<cv::Vec4i> hierarchy;
+    SegmentationLib::findAllContours(syntheticMask(side), contours, hierarchy);
+    return contours;
+}
+
+} // namespace
+
+// =============================================================================
+// THRESHOLDING VARIANTS
+// =============================================================================
+
+IMGPROC_BENCHMARK(Segmentation_AdaptiveThreshold, imageArgs(b),
+                  SegmentationLib::applyAdaptiveThreshold(input, output));
+IMGPROC_BENCHMARK(Segmentation_MultiLevelThreshold, imageArgs(b),
+                  SegmentationLib::applyMultiLevelThreshold(input, output, 4));
+IMGPROC_BENCHMARK(Segmentation_MultiOtsuThresholds, imageArgs(b),
+                  benchmark::DoNotOptimize(SegmentationLib::computeMultiOtsuThresholds(input, 4)));
+IMGPROC_BENCHMARK(Segmentation_LocalThresholdSauvola, imageArgs(b),
+                  SegmentationLib::applyLocalThreshold(input, output,
+                                                       SegmentationLib::LOCAL_THRESH_SAUVOLA, 25));
+IMGPROC_BENCHMARK(Segmentation_LocalThresholdBradley, imageArgs(b),
+                  SegmentationLib::applyLocalThreshold(input, output,
+                                                       SegmentationLib::LOCAL_THRESH_BRADLEY, 25, 0.15));
+
+// =============================================================================
+// WATERSHED SEGMENTATION
+// =============================================================================
+
+IMGPROC_BENCHMARK(Segmentation_WatershedAuto, colorArgs(b, SIDE_CAP_SLOW),
+                  SegmentationLib::applyWatershedAuto(input, output, 0.5));
+
+IMGPROC_BENCHMARK(Segmentation_WatershedMarkers, imageArgs(b, SIDE_CAP_SLOW),
+                  SegmentationLib::createWatershedMarkers(input, output, 0.5));
+
+BENCHMARK_DEFINE_F(ImageFixture, Segmentation_WatershedManual)(benchmark::State& state) {
+    cv::Mat markers;
+    SegmentationLib::createWatershedMarkers(input, markers, 0.5);
+
+    for (auto _ : state) {
+        // watershed writes into the markers, so each run gets a fresh copy
+        cv::Mat runMarkers = markers.clone();
+        SegmentationLib::applyWatershedManual(input, runMarkers, output);
+        benchmark::DoNotOptimize(output.data);
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Segmentation_WatershedManual, colorArgs(b, SIDE_CAP_SLOW));
+
+// =============================================================================
+// GRABCUT SEGMENTATION
+// =============================================================================
+
+IMGPROC_BENCHMARK(Segmentation_GrabCut, colorArgs(b, SIDE_CAP_VERY_SLOW),
+                  SegmentationLib::applyGrabCut(input, output,
+                                                cv::Rect(input.cols / 8, input.rows / 8,
+                                                         input.cols * 3 / 4, input.rows * 3 / 4), 3));
+
+BENCHMARK_DEFINE_F(ImageFixture, Segmentation_GrabCutWithMask)(benchmark::State& state) {
+    // Probable foreground inside a centered rectangle, probable background outside
+    cv::Mat mask(input.size(), CV_8UC1, cv::Scalar(cv::GC_PR_BGD));
+    mask(cv::Rect(input.cols / 8, input.rows / 8, input.cols * 3 / 4, input.rows * 3 / 4))
+        .setTo(cv::GC_PR_FGD);
+
+    for (auto _ : state) {
+        output = mask.clone();
+        SegmentationLib::applyGrabCutWithMask(input, output, 3);
+        benchmark::DoNotOptimize(output.data);
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Segmentation_GrabCutWithMask, colorArgs(b, SIDE_CAP_VERY_SLOW));
+
+// =============================================================================
+// CONNECTED COMPONENTS
+// =============================================================================
+
+BENCHMARK_DEFINE_F(ImageFixture, Segmentation_ConnectedComponents)(benchmark::State& state) {
+    const cv::Mat& mask = syntheticMask(input.cols);
+    std::vector<ConnectedComponents::ComponentStats> stats;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(SegmentationLib::labelConnectedComponents(mask, output, stats, 8));
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Segmentation_ConnectedComponents, imageArgs(b));
+
+// =============================================================================
+// CONTOUR DETECTION & ANALYSIS
+// =============================================================================
+
+BENCHMARK_DEFINE_F(ImageFixture, Segmentation_FindAllContours)(benchmark::State& state) {
+    const cv::Mat& mask = syntheticMask(input.cols);
+    std::vector<std::vector<cv::Point>> contours;
+    std::vector<cv::Vec4i> hierarchy;
+
+    for (auto _ : state) {
+        SegmentationLib::findAllContours(mask, contours, hierarchy, cv::RETR_TREE);
+        benchmark::DoNotOptimize(contours.data());
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Segmentation_FindAllContours, imageArgs(b));
+
+BENCHMARK_DEFINE_F(ImageFixture, Segmentation_ContourProperties)(benchmark::State& state) {
+    const std::vector<std::vector<cv::Point>> contours = maskContours(input.cols);
+
+    for (auto _ : state) {
+        for (const std::vector<cv::Point>& contour : contours) {
+            benchmark::DoNotOptimize(SegmentationLib::calculateContourProperties(contour));
+        }
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Segmentation_ContourProperties, imageArgs(b));
+
+BENCHMARK_DEFINE_F(ImageFixture, Segmentation_AllContourProperties)(benchmark::State& state) {
+    const std::vector<std::vector<cv::Point>> contours = maskContours(input.cols);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(SegmentationLib::calculateAllContourProperties(contours));
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Segmentation_AllContourProperties, imageArgs(b));
+
+BENCHMARK_DEFINE_F(ImageFixture, Segmentation_DrawContours)(benchmark::State& state) {
+    const std::vector<std::vector<cv::Point>> contours = maskContours(input.cols);
+
+    for (auto _ : state) {
+        output = input.clone();
+        SegmentationLib::drawContoursWithInfo(output, contours);
+        benchmark::DoNotOptimize(output.data);
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Segmentation_DrawContours, colorArgs(b));
+
+BENCHMARK_DEFINE_F(ImageFixture, Segmentation_DrawContourTable)(benchmark::State& state) {
+    const std::vector<std::vector<cv::Point>> contours = maskContours(input.cols);
+    ContourTable table;
+    table.build(contours);
+
+    for (auto _ : state) {
+        output = input.clone();
+        SegmentationLib::drawContoursWithInfo(output, table);
+        benchmark::DoNotOptimize(output.data);
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Segmentation_DrawContourTable, colorArgs(b));
+
+BENCHMARK_DEFINE_F(ImageFixture, Segmentation_FilterByArea)(benchmark::State& state) {
+    const std::vector<std::vector<cv::Point>> contours = maskContours(input.cols);
+    std::vector<std::vector<cv::Point>> filtered;
+
+    for (auto _ : state) {
+        SegmentationLib::filterContoursByArea(contours, filtered, 100.0);
+        benchmark::DoNotOptimize(filtered.data());
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Segmentation_FilterByArea, imageArgs(b));
+
+BENCHMARK_DEFINE_F(ImageFixture, Segmentation_FilterByCircularity)(benchmark::State& state) {
+    const std::vector<std::vector<cv::Point>> contours = maskContours(input.cols);
+    std::vector<std::vector<cv::Point>> filtered;
+
+    for (auto _ : state) {
+        SegmentationLib::filterContoursByCircularity(contours, filtered, 0.5);
+        benchmark::DoNotOptimize(filtered.data());
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Segmentation_FilterByCircularity, imageArgs(b));
+
+// =============================================================================
+// UTILITY FUNCTIONS
+// =============================================================================
+
+IMGPROC_BENCHMARK(Segmentation_ConvertToGrayscale, imageArgs(b),
+                  SegmentationLib::convertToGrayscale(input, output));
+IMGPROC_BENCHMARK(Segmentation_IsValidImage, imageArgs(b, MIN_SIDE),
+                  benchmark::DoNotOptimize(SegmentationLib::isValidImage(input)));
+
+BENCHMARK_DEFINE_F(ImageFixture, Segmentation_ColorizeLabels)(benchmark::State& state) {
+    cv::Mat labels;
+    std::vector<ConnectedComponents::ComponentStats> stats;
+    const int numLabels =
+        SegmentationLib::labelConnectedComponents(syntheticMask(input.cols), labels, stats, 8);
+
+    for (auto _ : state) {
+        SegmentationLib::colorizeLabels(labels, output, cv::Vec3b(0, 0, 0), numLabels);
+        benchmark::DoNotOptimize(output.data);
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Segmentation_ColorizeLabels, imageArgs(b));
@@ -0,0 +1,68 @@
+#include "BenchmarkSupport.h"
+#include "processing/TransformationsLib.h"
+
+using namespace BenchmarkSupport;
+
+// =============================================================================
+// GEOMETRIC TRANSFORMS
+// =============================================================================
+
+IMGPROC_BENCHMARK(Transform_Translation, imageArgs(b),
+                  TransformationsLib::applyTranslation(input, output, 37, -21));
+IMGPROC_BENCHMARK(Transform_Rotation, imageArgs(b),
+                  TransformationsLib::applyRotation(input, output, 17.5));
+IMGPROC_BENCHMARK(Transform_RotationRightAngle, imageArgs(b),
+                  TransformationsLib::applyRotation(input, output, 90.0));
+IMGPROC_BENCHMARK(Transform_RotateRightAngle, imageArgs(b),
+                  TransformationsLib::rotateRightAngle(input, output, 3));
+IMGPROC_BENCHMARK(Transform_ZoomIn, imageArgs(b),
+                  TransformationsLib::applyZoom(input, output, 2.5));
+IMGPROC_BENCHMARK(Transform_ZoomOut, imageArgs(b),
+                  TransformationsLib::applyZoom(input, output, 0.4));
+IMGPROC_BENCHMARK(Transform_FlipX, imageArgs(b),
+                  TransformationsLib::applyFlipX(input, output));
+IMGPROC_BENCHMARK(Transform_FlipY, imageArgs(b),
+                  TransformationsLib::applyFlipY(input, output));
+IMGPROC_BENCHMARK(Transform_FlipXY, imageArgs(b),
+                  TransformationsLib::applyFlipXY(input, output));
+IMGPROC_BENCHMARK(Transform_Skew, imageArgs(b),
+                  TransformationsLib::applySkew(input, output, 100.0f));
+
+// =============================================================================
+// TRANSFORM MATRICES
+// =============================================================================
+
+IMGPROC_BENCHMARK(Transform_BuildMatrices, imageArgs(b, MIN_SIDE),
+                  benchmark::DoNotOptimize(
+                      TransformationsLib::rotationMatrix(input.size(), 30.0) *
+                      TransformationsLib::zoomMatrix(input.size(), 1.5) *
+                      TransformationsLib::skewMatrix(input.size(), 40.0) *
+                      TransformationsLib::flipMatrix(input.size(), 1) *
+                      TransformationsLib::translationMatrix(5.0, 7.0)));
+IMGPROC_BENCHMARK(Transform_QuarterTurns, imageArgs(b, MIN_SIDE),
+                  benchmark::DoNotOptimize(TransformationsLib::quarterTurns(
+                      TransformationsLib::rotationMatrix(input.size(), 270.0), input.size())));
+
+BENCHMARK_DEFINE_F(ImageFixture, Transform_ApplyMatrix)(benchmark::State& state) {
+    const cv::Matx33d chain = TransformationsLib::zoomMatrix(input.size(), 1.2) *
+                              TransformationsLib::rotationMatrix(input.size(), 12.0);
+    for (auto _ : state) {
+        TransformationsLib::applyTransformMatrix(input, output, chain);
+        benchmark::DoNotOptimize(output.data);
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Transform_ApplyMatrix, imageArgs(b));
+
+BENCHMARK_DEFINE_F(ImageFixture, Transform_ApplyCachedMatrix)(benchmark::State& state) {
+    // Remap tables are built on the first call and reused afterwards
+    const cv::Matx33d chain = TransformationsLib::zoomMatrix(input.size(), 1.2) *
+                              TransformationsLib::rotationMatrix(input.size(), 12.0);
+    TransformationsLib::applyCachedTransform(input, output, chain);
+    for (auto _ : state) {
+        TransformationsLib::applyCachedTransform(input, output, chain);
+        benchmark::DoNotOptimize(output.data);
+    }
+    reportThroughput(state);
+}
+IMGPROC_REGISTER(Transform_ApplyCachedMatrix, imageArgs(b));
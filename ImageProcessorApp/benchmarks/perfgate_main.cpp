@@ -0,0 +1,273 @@
+// imgproc_perfgate - runs imgproc_bench and fails on performance regressions
+//
+// Every run is stored as <results-dir>/<cpu>/<commit>.json and compared with
+// the baseline of the same CPU model (benchmarks/baselines/<cpu>.json).
+// Exit status: 0 = no regression, 1 = regression (or missing benchmarks with
+// --fail-on-missing), 2 = run, setup or usage error.
+
+#include "RegressionGate.h"
+#include <opencv2/core/utils/filesystem.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <string>
+
+#ifndef IMGPROC_BENCH_PATH
+#define IMGPROC_BENCH_PATH "imgproc_bench"
+#endif
+
+#ifndef IMGPROC_SOURCE_DIR
+#define IMGPROC_SOURCE_DIR "."
+#endif
+
+namespace {
+
+struct Options {
+    std::string benchPath = IMGPROC_BENCH_PATH;
+    std::string input;
+    std::string baseline;
+    std::string baselineDir = std::string(IMGPROC_SOURCE_DIR) + "/benchmarks/baselines";
+    std::string resultsDir = "perf-results";
+    std::string filter;
+    std::string commit;
+    int repetitions = 5;
+    bool updateBaseline = false;
+    bool failOnMissing = false;
+    bool verbose = false;
+    RegressionGate::Thresholds thresholds;
+};
+
+void printUsage() {
+    std::cout <<
+        "Usage: imgproc_perfgate [options]\n"
+        "\n"
+        "Runs imgproc_bench, stores the results and compares them with the\n"
+        "baseline recorded on the same CPU model.\n"
+        "\n"
+        "  --bench PATH              imgproc_bench executable\n"
+        "  --input FILE              compare existing Google Benchmark JSON output\n"
+        "                            instead of running the suite\n"
+        "  --filter REGEX            only run/compare matching benchmarks\n"
+        "  --repetitions N           runs per benchmark, median is compared (default 5)\n"
+        "  --threshold PCT           allowed slowdown in percent (default 5)\n"
+        "  --threshold-for REGEX=PCT allowed slowdown for matching benchmarks\n"
+        "                            (repeatable, the last match wins)\n"
+        "  --noise-factor F          also allow F times the measured spread (default 2)\n"
+        "  --min-time MS             never fail benchmarks faster than this (default 0.05)\n"
+        "  --baseline FILE           baseline to compare with\n"
+        "                            (default <baseline-dir>/<cpu>.json)\n"
+        "  --baseline-dir DIR        directory of per-CPU baselines\n"
+        "  --results-dir DIR         where runs are stored (default perf-results)\n"
+        "  --commit ID               commit label (default: git describe)\n"
+        "  --update-baseline         merge this run into the baseline and exit\n"
+        "  --fail-on-missing         also fail when baseline benchmarks did not run\n"
+        "  --verbose                 also list unchanged benchmarks\n";
+}
+
+// Report a malformed regex as a usage error instead of an exception later
+bool isValidRegex(const std::string& pattern, const std::string& option) {
+    try {
+        std::regex check(pattern);
+    } catch (const std::regex_error& e) {
+        std::cerr << "Invalid regex for " << option << ": " << pattern
+                  << " (" << e.what() << ")\n";
+        return false;
+    }
+    return true;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        } else if (arg == "--update-baseline") {
+            options.updateBaseline = true;
+        } else if (arg == "--fail-on-missing") {
+            options.failOnMissing = true;
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else if (!hasValue) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        } else if (arg == "--bench") {
+            options.benchPath = argv[++i];
+        } else if (arg == "--input") {
+            options.input = argv[++i];
+        } else if (arg == "--filter") {
+            options.filter = argv[++i];
+            const bool exclude = !options.filter.empty() && options.filter[0] == '-';
+            if (!isValidRegex(exclude ? options.filter.substr(1) : options.filter, arg)) {
+                return false;
+            }
+        } else if (arg == "--repetitions") {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--threshold") {
+            options.thresholds.defaultPercent = std::atof(argv[++i]);
+        } else if (arg == "--threshold-for") {
+            const std::string rule = argv[++i];
+            const size_t equals = rule.rfind('=');
+            if (equals == std::string::npos || equals == 0) {
+                std::cerr << "Expected REGEX=PCT, got " << rule << "\n";
+                return false;
+            }
+            if (!isValidRegex(rule.substr(0, equals), arg)) {
+                return false;
+            }
+            options.thresholds.overrides.emplace_back(rule.substr(0, equals),
+                                                      std::atof(rule.c_str() + equals + 1));
+        } else if (arg == "--noise-factor") {
+            options.thresholds.noiseFactor = std::atof(argv[++i]);
+        } else if (arg == "--min-time") {
+            options.thresholds.minTimeMs = std::atof(argv[++i]);
+        } else if (arg == "--baseline") {
+            options.baseline = argv[++i];
+        } else if (arg == "--baseline-dir") {
+            options.baselineDir = argv[++i];
+        } else if (arg == "--results-dir") {
+            options.resultsDir = argv[++i];
+        } else if (arg == "--commit") {
+            options.commit = argv[++i];
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool runBenchmarks(const Options& options, const std::string& outputPath) {
+    std::string command = "\"" + options.benchPath + "\"" +
+        " --benchmark_repetitions=" + std::to_string(options.repetitions) +
+        " --benchmark_report_aggregates_only=true" +
+        " --benchmark_out_format=json" +
+        " --benchmark_out=\"" + outputPath + "\"";
+    if (!options.filter.empty()) {
+        command += " --benchmark_filter=\"" + options.filter + "\"";
+    }
+
+    std::cout << "Running " << command << "\n" << std::flush;
+    return std::system(command.c_str()) == 0;
+}
+
+// Keep only benchmarks selected by the --filter regex (Google Benchmark
+// semantics: a leading '-' excludes matches)
+void applyFilter(const std::string& filter, RegressionGate::ResultSet& results) {
+    if (filter.empty()) {
+        return;
+    }
+    const bool exclude = filter[0] == '-';
+    const std::regex pattern(exclude ? filter.substr(1) : filter);
+
+    std::vector<RegressionGate::Measurement> kept;
+    for (const RegressionGate::Measurement& m : results.measurements) {
+        if (std::regex_search(m.name, pattern) != exclude) {
+            kept.push_back(m);
+        }
+    }
+    results.measurements.swap(kept);
+}
+
+// Replace the measurements of the baseline that were measured again
+void mergeInto(RegressionGate::ResultSet& baseline, const RegressionGate::ResultSet& current) {
+    std::map<std::string, RegressionGate::Measurement> merged;
+    for (const RegressionGate::Measurement& m : baseline.measurements) merged[m.name] = m;
+    for (const RegressionGate::Measurement& m : current.measurements) merged[m.name] = m;
+
+    baseline.commit = current.commit;
+    baseline.cpu = current.cpu;
+    baseline.date = current.date;
+    baseline.measurements.clear();
+    for (const auto& entry : merged) {
+        baseline.measurements.push_back(entry.second);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    const std::string cpu = RegressionGate::cpuModel();
+    const std::string commit = options.commit.empty()
+        ? RegressionGate::currentCommit(IMGPROC_SOURCE_DIR)
+        : options.commit;
+    const std::string runDir = options.resultsDir + "/" + RegressionGate::slug(cpu);
+    const std::string baselinePath = options.baseline.empty()
+        ? options.baselineDir + "/" + RegressionGate::slug(cpu) + ".json"
+        : options.baseline;
+
+    // Run the suite (or take a finished run)
+    std::string benchOutput = options.input;
+    if (benchOutput.empty()) {
+        benchOutput = runDir + "/" + RegressionGate::slug(commit) + ".bench.json";
+        cv::utils::fs::createDirectories(runDir);
+        if (!runBenchmarks(options, benchOutput)) {
+            std::cerr << "imgproc_bench failed\n";
+            return 2;
+        }
+    }
+
+    RegressionGate::ResultSet current;
+    if (!RegressionGate::loadBenchmarkOutput(benchOutput, current)) {
+        std::cerr << "No benchmark results in " << benchOutput << "\n";
+        return 2;
+    }
+    current.commit = commit;
+    current.cpu = cpu;
+
+    const std::string resultPath = runDir + "/" + RegressionGate::slug(commit) + ".json";
+    if (RegressionGate::saveResults(resultPath, current)) {
+        std::cout << "Results: " << resultPath << "\n";
+    }
+
+    RegressionGate::ResultSet baseline;
+    const bool haveBaseline = RegressionGate::loadResults(baselinePath, baseline);
+
+    if (options.updateBaseline) {
+        mergeInto(baseline, current);
+        if (!RegressionGate::saveResults(baselinePath, baseline)) {
+            std::cerr << "Cannot write baseline " << baselinePath << "\n";
+            return 2;
+        }
+        std::cout << "Baseline updated: " << baselinePath << " ("
+                  << baseline.measurements.size() << " benchmarks)\n";
+        return 0;
+    }
+
+    if (!haveBaseline) {
+        std::cerr << "No baseline for \"" << cpu << "\" at " << baselinePath << "\n"
+                  << "Record one with --update-baseline on a known-good commit.\n";
+        return 2;
+    }
+    if (baseline.cpu != cpu) {
+        std::cerr << "Warning: baseline was recorded on \"" << baseline.cpu << "\"\n";
+    }
+
+    applyFilter(options.filter, baseline);
+    applyFilter(options.filter, current);
+
+    const std::vector<RegressionGate::Comparison> comparisons =
+        RegressionGate::compare(baseline, current, options.thresholds);
+    RegressionGate::printReport(std::cout, baseline, current, comparisons, options.verbose);
+
+    if (RegressionGate::hasRegression(comparisons)) {
+        std::cout << "FAILED: performance regression against " << baseline.commit << "\n";
+        return 1;
+    }
+    if (options.failOnMissing && RegressionGate::hasMissing(comparisons)) {
+        std::cout << "FAILED: baseline benchmarks missing from this run\n";
+        return 1;
+    }
+    std::cout << "PASSED\n";
+    return 0;
+}
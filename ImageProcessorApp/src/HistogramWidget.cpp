@@ -1,4 +1,5 @@
 #include "HistogramWidget.h"
+#include "processing/Trace.h"
 #include <QPainter>
 #include <QPainterPath>
 
@@ -11,14 +12,15 @@ HistogramWidget::HistogramWidget(QWidget *parent)
                  "border-radius: 8px;");
 }
 
-void HistogramWidget::setImage(const cv::Mat& image) {
-    sourceImage = image.clone();
+void HistogramWidget::setImage(const ImageHandle& image) {
+    sourceImage = image;
     calculateHistogram();
     update();
 }
 
 void HistogramWidget::calculateHistogram() {
     if (sourceImage.empty()) return;
+    TRACE_SCOPE("ui", "histogram");
     
     // Clear previous data
     for (int i = 0; i < 3; i++) {
@@ -27,13 +29,13 @@ void HistogramWidget::calculateHistogram() {
     }
     
     maxFrequency = 0;
-    isGrayscale = (sourceImage.channels() == 1);
+    isGrayscale = (sourceImage->channels() == 1);
     
     if (isGrayscale) {
         // Grayscale histogram
-        for (int i = 0; i < sourceImage.rows; i++) {
-            for (int j = 0; j < sourceImage.cols; j++) {
-                uchar pixel = sourceImage.at<uchar>(i, j);
+        for (int i = 0; i < sourceImage->rows; i++) {
+            for (int j = 0; j < sourceImage->cols; j++) {
+                uchar pixel = sourceImage->at<uchar>(i, j);
                 histogramData[0][pixel]++;
                 if (histogramData[0][pixel] > maxFrequency) {
                     maxFrequency = histogramData[0][pixel];
@@ -42,9 +44,9 @@ void HistogramWidget::calculateHistogram() {
         }
     } else {
         // Color histogram (BGR)
-        for (int i = 0; i < sourceImage.rows; i++) {
-            for (int j = 0; j < sourceImage.cols; j++) {
-                cv::Vec3b pixel = sourceImage.at<cv::Vec3b>(i, j);
+        for (int i = 0; i < sourceImage->rows; i++) {
+            for (int j = 0; j < sourceImage->cols; j++) {
+                cv::Vec3b pixel = sourceImage->at<cv::Vec3b>(i, j);
                 for (int c = 0; c < 3; c++) {
                     histogramData[c][pixel[c]]++;
                     if (histogramData[c][pixel[c]] > maxFrequency) {
@@ -57,6 +59,7 @@ void HistogramWidget::calculateHistogram() {
 }
 
 void HistogramWidget::paintEvent(QPaintEvent *event) {
+    TRACE_SCOPE("ui", "paint");
     QWidget::paintEvent(event);
     
     if (sourceImage.empty() || maxFrequency == 0) {
@@ -160,7 +163,7 @@ void HistogramWidget::drawHistogram(QPainter& painter) {
 }
 
 void HistogramWidget::clear() {
-    sourceImage = cv::Mat();
+    sourceImage.reset();
     maxFrequency = 0;
     update();
 }
\ No newline at end of file
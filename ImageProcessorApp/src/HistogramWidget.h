@@ -7,6 +7,7 @@
 #include <QLinearGradient>
 #include <opencv2/opencv.hpp>
 #include <vector>
+#include "processing/ImageHandle.h"
 
 class HistogramWidget : public QWidget {
     Q_OBJECT
@@ -14,7 +15,7 @@ class HistogramWidget : public QWidget {
 public:
     explicit HistogramWidget(QWidget *parent = nullptr);
     
-    void setImage(const cv::Mat& image);
+    void setImage(const ImageHandle& image);
     void clear();
     
 protected:
@@ -24,7 +25,7 @@ private:
     void calculateHistogram();
     void drawHistogram(QPainter& painter);
     
-    cv::Mat sourceImage;
+    ImageHandle sourceImage;
     std::vector<int> histogramData[3]; // RGB channels
     int maxFrequency;
     bool isGrayscale;
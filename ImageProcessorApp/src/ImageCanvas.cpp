@@ -1,6 +1,16 @@
 #include "ImageCanvas.h"
+#include "processing/Resampler.h"
+#include "processing/Trace.h"
 #include <QPainter>
 #include <QResizeEvent>
+#include <QTimer>
+
+namespace {
+
+// Quiet time after the last resize event before the full-quality rescale
+const int RESAMPLE_DELAY_MS = 150;
+
+}
 
 ImageCanvas::ImageCanvas(QWidget *parent, const QString& borderColor)
     : QWidget(parent), borderColor(borderColor) {
@@ -15,6 +25,17 @@ ImageCanvas::ImageCanvas(QWidget *parent, const QString& borderColor)
     imageLabel->setStyleSheet("border: none; background: transparent;");
     imageLabel->setText("No Image Loaded");
     imageLabel->setWordWrap(true);
+    imageLabel->setAttribute(Qt::WA_TransparentForMouseEvents);
+    
+    // Report the cursor position even when no button is pressed
+    setMouseTracking(true);
+    
+    // While the window is being resized the image is scaled fast; the
+    // antialiased rescale runs once the size settles
+    resampleTimer = new QTimer(this);
+    resampleTimer->setSingleShot(true);
+    resampleTimer->setInterval(RESAMPLE_DELAY_MS);
+    connect(resampleTimer, &QTimer::timeout, this, &ImageCanvas::updateScaledPixmap);
     
     // Center the label initially
     imageLabel->move(10, 10);
@@ -22,6 +43,8 @@ ImageCanvas::ImageCanvas(QWidget *parent, const QString& borderColor)
 }
 
 void ImageCanvas::setImage(const QPixmap& pixmap) {
+    displayImage.release();
+    resampledSize = cv::Size();
     currentPixmap = pixmap;
     updateScaledPixmap();
 }
@@ -33,6 +56,7 @@ void ImageCanvas::setImage(const cv::Mat& mat) {
     }
     
     // Convert cv::Mat to QPixmap
+    TRACE_SCOPE("ui", "convert");
     cv::Mat rgb;
     if (mat.channels() == 1) {
         cv::cvtColor(mat, rgb, cv::COLOR_GRAY2RGB);
@@ -47,11 +71,17 @@ void ImageCanvas::setImage(const cv::Mat& mat) {
     QImage qImg(rgb.data, rgb.cols, rgb.rows, rgb.step, 
                 QImage::Format_RGB888);
     currentPixmap = QPixmap::fromImage(qImg.copy());
+    displayImage = rgb;
+    resampledSize = cv::Size();
     updateScaledPixmap();
 }
 
 void ImageCanvas::clear() {
     currentPixmap = QPixmap();
+    displayImage.release();
+    resampledSize = cv::Size();
+    resampleTimer->stop();
+    highlight.clear();
     imageLabel->clear();
     imageLabel->setText("No Image Loaded");
     imageLabel->setAlignment(Qt::AlignCenter);
@@ -61,13 +91,60 @@ void ImageCanvas::clear() {
 
 void ImageCanvas::updateScaledPixmap() {
     if (currentPixmap.isNull()) return;
+    TRACE_SCOPE("ui", "scale");
+    resampleTimer->stop();
     
     QSize canvasSize = size() - QSize(20, 20); // Padding
-    scaledPixmap = currentPixmap.scaled(canvasSize, 
-                                       Qt::KeepAspectRatio, 
-                                       Qt::SmoothTransformation);
     
-    imageLabel->setPixmap(scaledPixmap);
+    // Images set from cv::Mat are scaled with the antialiased resampler,
+    // once per image and displayed size
+    if (!displayImage.empty() && displayImage.channels() == 3 &&
+        canvasSize.width() > 0 && canvasSize.height() > 0) {
+        cv::Size fitted = Resampler::fitSize(displayImage.size(),
+                                             cv::Size(canvasSize.width(), canvasSize.height()));
+        if (fitted == resampledSize) {
+            updateLabelPixmap();
+            return;
+        }
+        resampledSize = fitted;
+        cv::Mat scaled;
+        Resampler::resize(displayImage, scaled, fitted, Resampler::FILTER_LANCZOS3);
+        
+        QImage qImg(scaled.data, scaled.cols, scaled.rows, scaled.step, 
+                    QImage::Format_RGB888);
+        scaledPixmap = QPixmap::fromImage(qImg.copy());
+    } else {
+        scaledPixmap = currentPixmap.scaled(canvasSize, 
+                                           Qt::KeepAspectRatio, 
+                                           Qt::SmoothTransformation);
+    }
+    
+    updateLabelPixmap();
+}
+
+void ImageCanvas::updateLabelPixmap() {
+    if (highlight.empty()) {
+        imageLabel->setPixmap(scaledPixmap);
+    } else {
+        // Draw the outline on a copy so the scaled image stays reusable
+        QPixmap overlay = scaledPixmap;
+        const double sx = static_cast<double>(scaledPixmap.width()) / currentPixmap.width();
+        const double sy = static_cast<double>(scaledPixmap.height()) / currentPixmap.height();
+        
+        QPolygonF polygon;
+        for (const cv::Point& p : highlight) {
+            polygon << QPointF((p.x + 0.5) * sx, (p.y + 0.5) * sy);
+        }
+        
+        QPainter painter(&overlay);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(QPen(QColor("#ffd400"), 2));
+        painter.setBrush(QColor(255, 212, 0, 60));
+        painter.drawPolygon(polygon);
+        painter.end();
+        
+        imageLabel->setPixmap(overlay);
+    }
     imageLabel->adjustSize();
     
     // Center the label
@@ -76,10 +153,74 @@ void ImageCanvas::updateScaledPixmap() {
     imageLabel->move(x, y);
 }
 
+void ImageCanvas::setHighlight(const std::vector<cv::Point>& polygon) {
+    highlight = polygon;
+    if (!currentPixmap.isNull()) {
+        updateLabelPixmap();
+    }
+}
+
+void ImageCanvas::clearHighlight() {
+    if (highlight.empty()) return;
+    
+    highlight.clear();
+    if (!currentPixmap.isNull()) {
+        updateLabelPixmap();
+    }
+}
+
+void ImageCanvas::mouseMoveEvent(QMouseEvent *event) {
+    QWidget::mouseMoveEvent(event);
+    if (currentPixmap.isNull() || scaledPixmap.isNull()) return;
+    
+    // Map from label (scaled pixmap) coordinates to image coordinates
+    QPoint local = event->pos() - imageLabel->pos();
+    if (local.x() < 0 || local.y() < 0 ||
+        local.x() >= scaledPixmap.width() || local.y() >= scaledPixmap.height()) {
+        emit imageHovered(QPoint(-1, -1));
+        return;
+    }
+    
+    int imageX = local.x() * currentPixmap.width() / scaledPixmap.width();
+    int imageY = local.y() * currentPixmap.height() / scaledPixmap.height();
+    emit imageHovered(QPoint(imageX, imageY));
+}
+
+void ImageCanvas::leaveEvent(QEvent *event) {
+    QWidget::leaveEvent(event);
+    emit imageHovered(QPoint(-1, -1));
+}
+
+void ImageCanvas::updateScaledPixmapFast() {
+    TRACE_SCOPE("ui", "scale");
+    QSize canvasSize = size() - QSize(20, 20); // Padding
+    
+    // Only the position changed: keep the full-quality pixmap
+    if (!resampledSize.empty() && canvasSize.width() > 0 && canvasSize.height() > 0 &&
+        Resampler::fitSize(displayImage.size(),
+                           cv::Size(canvasSize.width(), canvasSize.height())) == resampledSize) {
+        updateLabelPixmap();
+        return;
+    }
+    
+    scaledPixmap = currentPixmap.scaled(canvasSize, 
+                                       Qt::KeepAspectRatio, 
+                                       Qt::FastTransformation);
+    resampledSize = cv::Size();
+    updateLabelPixmap();
+}
+
 void ImageCanvas::resizeEvent(QResizeEvent *event) {
     QWidget::resizeEvent(event);
     if (!currentPixmap.isNull()) {
-        updateScaledPixmap();
+        if (displayImage.empty()) {
+            updateScaledPixmap();
+        } else {
+            updateScaledPixmapFast();
+            if (resampledSize.empty()) {
+                resampleTimer->start();
+            }
+        }
     } else {
         // Update text label position
         imageLabel->resize(size() - QSize(20, 20));
@@ -88,5 +229,6 @@ void ImageCanvas::resizeEvent(QResizeEvent *event) {
 }
 
 void ImageCanvas::paintEvent(QPaintEvent *event) {
+    TRACE_SCOPE("ui", "paint");
     QWidget::paintEvent(event);
 }
\ No newline at end of file
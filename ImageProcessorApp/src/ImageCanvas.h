@@ -6,7 +6,11 @@
 #include <QLabel>
 #include <QPainter>
 #include <QResizeEvent>
+#include <QMouseEvent>
 #include <opencv2/opencv.hpp>
+#include <vector>
+
+class QTimer;
 
 class ImageCanvas : public QWidget {
     Q_OBJECT
@@ -20,17 +24,33 @@ public:
     void clear();
     QPixmap getPixmap() const { return currentPixmap; }
     
+    // Outline drawn over the image (polygon in image coordinates)
+    void setHighlight(const std::vector<cv::Point>& polygon);
+    void clearHighlight();
+    
+signals:
+    // Cursor position in image coordinates, (-1, -1) when off the image
+    void imageHovered(const QPoint& imagePos);
+    
 protected:
     void paintEvent(QPaintEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
     
 private:
-    void updateScaledPixmap();
+    void updateScaledPixmap();      // Full quality, reused while the size is unchanged
+    void updateScaledPixmapFast();  // Nearest-neighbour, during window resizes
+    void updateLabelPixmap();
     
     QLabel *imageLabel;
     QPixmap currentPixmap;
     QPixmap scaledPixmap;
+    cv::Mat displayImage; // RGB pixels of currentPixmap when set from cv::Mat
+    cv::Size resampledSize; // Size scaledPixmap was resampled to (empty if not)
+    QTimer *resampleTimer;
     QString borderColor;
+    std::vector<cv::Point> highlight;
 };
 
 #endif // IMAGECANVAS_H
\ No newline at end of file
@@ -10,11 +10,18 @@
 #include "processing/ColorProcessingLib.h"
 #include "processing/MorphologyLib.h"
 #include "processing/SegmentationLib.h"
+#include "processing/DerivedImageCache.h"
+#include "processing/ResultCache.h"
+#include "processing/Resampler.h"
+#include "processing/BufferPool.h"
+#include "processing/Trace.h"
 #include "utils/ImageUtils.h"
 #include <QApplication>
 #include <QSplitter>
 #include <QScrollArea>
 #include <QInputDialog>
+#include <QStandardPaths>
+#include <QDir>
 #include <cmath>
 
 MainWindow::MainWindow(QWidget *parent)
@@ -25,10 +32,29 @@ MainWindow::MainWindow(QWidget *parent)
     setMinimumSize(1200, 800);
     resize(1600, 1000);
     
+    Trace::setThreadName("UI");
+    BufferPool::install();
+    Trace::installAllocationTracking();
     setupUI();
+
+    Trace::setOperationListener([this](const Trace::OperationSummary& summary) {
+        updatePerformanceHud(summary);
+    });
 }
 
 MainWindow::~MainWindow() {
+    Trace::setOperationListener(nullptr);
+    setResultSpilling(false);
+    
+    // Hand the image buffers back and free what the pool kept
+    processingStack.clear();
+    processedImage.reset();
+    currentImage.reset();
+    originalImage.reset();
+    transformStack.clear();
+    DerivedImageCache::clearCache();
+    ResultCache::clearCache();
+    BufferPool::instance().trim();
 }
 
 void MainWindow::setupUI() {
@@ -69,6 +95,17 @@ void MainWindow::createMenuBar() {
     connect(undoAction, &QAction::triggered, this, &MainWindow::undoLastOperation);
     std::cout << "[DEBUG] Undo action created and connected" << std::endl;
     
+    QAction *exportTraceAction = new QAction("Export Performance Trace...", this);
+    exportTraceAction->setToolTip("Save recent operation timings as a Chrome/Perfetto trace");
+    exportTraceAction->setEnabled(Trace::isCompiledIn());
+    connect(exportTraceAction, &QAction::triggered, this, &MainWindow::exportPerformanceTrace);
+    
+    QAction *spillResultsAction = new QAction("Keep Evicted Previews on Disk", this);
+    spillResultsAction->setToolTip("Write cached dialog previews that no longer fit in memory to "
+                                   "the cache directory (removed on exit)");
+    spillResultsAction->setCheckable(true);
+    connect(spillResultsAction, &QAction::toggled, this, &MainWindow::setResultSpilling);
+    
     exitAction = new QAction("Exit", this);
     exitAction->setShortcut(QKeySequence::Quit);
     connect(exitAction, &QAction::triggered, this, &QWidget::close);
@@ -79,6 +116,9 @@ void MainWindow::createMenuBar() {
     fileMenu->addAction(resetAction);
     fileMenu->addAction(undoAction);
     fileMenu->addSeparator();
+    fileMenu->addAction(exportTraceAction);
+    fileMenu->addAction(spillResultsAction);
+    fileMenu->addSeparator();
     fileMenu->addAction(exitAction);
     
     // Enhancement Menu
@@ -162,6 +202,7 @@ void MainWindow::createCentralWidget() {
     
     processedCanvas = new ImageCanvas(this, "#1fa65a");
     processedCanvas->setMinimumSize(500, 400);
+    connect(processedCanvas, &ImageCanvas::imageHovered, this, &MainWindow::onProcessedCanvasHover);
     
     processedInfoLabel = new QLabel("No processing applied");
     processedInfoLabel->setStyleSheet("color: #9ca3b3; font-size: 9pt; padding: 5px;");
@@ -569,27 +610,31 @@ void MainWindow::createCentralWidget() {
     
     QPushButton *adaptiveThreshBtn = new QPushButton("Adaptive Threshold");
     QPushButton *multiLevelBtn = new QPushButton("Multi-Level");
+    QPushButton *localThreshBtn = new QPushButton("Local Threshold");
     QPushButton *watershedBtn = new QPushButton("Watershed");
     QPushButton *grabCutBtn = new QPushButton("GrabCut");
     QPushButton *contoursBtn = new QPushButton("Contours");
     
     addTooltip(adaptiveThreshBtn, "Adaptive thresholding - local threshold calculation");
     addTooltip(multiLevelBtn, "Multi-level thresholding");
+    addTooltip(localThreshBtn, "Sauvola, Niblack, Bradley or box-mean local thresholding");
     addTooltip(watershedBtn, "Watershed segmentation");
     addTooltip(grabCutBtn, "GrabCut segmentation - foreground extraction");
     addTooltip(contoursBtn, "Detect and analyze contours");
     
     connect(adaptiveThreshBtn, &QPushButton::clicked, this, &MainWindow::applyAdaptiveThreshold);
     connect(multiLevelBtn, &QPushButton::clicked, this, &MainWindow::applyMultiLevelThreshold);
+    connect(localThreshBtn, &QPushButton::clicked, this, &MainWindow::applyLocalThreshold);
     connect(watershedBtn, &QPushButton::clicked, this, &MainWindow::applyWatershedSegmentation);
     connect(grabCutBtn, &QPushButton::clicked, this, &MainWindow::applyGrabCutSegmentation);
     connect(contoursBtn, &QPushButton::clicked, this, &MainWindow::detectAndAnalyzeContours);
     
     segmentLayout->addWidget(adaptiveThreshBtn, 0, 0);
     segmentLayout->addWidget(multiLevelBtn, 0, 1);
-    segmentLayout->addWidget(watershedBtn, 1, 0);
-    segmentLayout->addWidget(grabCutBtn, 1, 1);
-    segmentLayout->addWidget(contoursBtn, 2, 0, 1, 2);
+    segmentLayout->addWidget(localThreshBtn, 1, 0);
+    segmentLayout->addWidget(watershedBtn, 1, 1);
+    segmentLayout->addWidget(grabCutBtn, 2, 0);
+    segmentLayout->addWidget(contoursBtn, 2, 1);
     
     morphMainLayout->addWidget(segmentGroup);
     
@@ -614,7 +659,12 @@ void MainWindow::createStatusBar() {
     progressBar->setVisible(false);
     progressBar->setMaximumWidth(200);
     
+    perfLabel = new QLabel();
+    perfLabel->setStyleSheet("color: #9aa5c4; padding-right: 6px;");
+    perfLabel->setVisible(Trace::isCompiledIn());
+
     statusBar()->addWidget(statusLabel);
+    statusBar()->addPermanentWidget(perfLabel);
     statusBar()->addPermanentWidget(progressBar);
     statusBar()->setStyleSheet("QStatusBar { border-top: 1px solid #3a4a6f; }");
 }
@@ -626,6 +676,7 @@ void MainWindow::addTooltip(QWidget *widget, const QString& text) {
 
 QPixmap MainWindow::cvMatToQPixmap(const cv::Mat& mat) {
     if (mat.empty()) return QPixmap();
+    TRACE_SCOPE("ui", "convert");
     
     cv::Mat rgb;
     if (mat.channels() == 1) {
@@ -651,35 +702,45 @@ cv::Mat MainWindow::qPixmapToCvMat(const QPixmap& pixmap) {
 }
 
 void MainWindow::updateDisplay() {
-    if (!imageLoaded) return;
+    refreshDisplay();
     
-    originalCanvas->setImage(currentImage);
-    
-    QString originalInfo = QString("Size: %1x%2 | Channels: %3 | Type: %4")
-                          .arg(currentImage.cols)
-                          .arg(currentImage.rows)
-                          .arg(currentImage.channels())
-                          .arg(QString::fromStdString(cv::typeToString(currentImage.type())));
-    originalInfoLabel->setText(originalInfo);
+    // The result is on screen; dialogs shown after this are not timed
+    Trace::finishOperation();
+}
+
+void MainWindow::refreshDisplay() {
+    if (!imageLoaded) return;
     
-    if (!processedImage.empty()) {
-        processedCanvas->setImage(processedImage);
-        
-        // Calculate quality metrics
-        QString metricsText = getQualityMetrics();
+    {
+        TRACE_FUNCTION("ui");
+        originalCanvas->setImage(currentImage);
         
-        QString processedInfo = QString("Size: %1x%2 | Channels: %3\n%4")
-                               .arg(processedImage.cols)
-                               .arg(processedImage.rows)
-                               .arg(processedImage.channels())
-                               .arg(metricsText);
-        processedInfoLabel->setText(processedInfo);
+        QString originalInfo = QString("Size: %1x%2 | Channels: %3 | Type: %4")
+                              .arg(currentImage->cols)
+                              .arg(currentImage->rows)
+                              .arg(currentImage->channels())
+                              .arg(QString::fromStdString(cv::typeToString(currentImage->type())));
+        originalInfoLabel->setText(originalInfo);
         
-        saveAction->setEnabled(true);
-    } else {
-        processedCanvas->clear();
-        processedInfoLabel->setText("No processing applied");
-        saveAction->setEnabled(false);
+        if (!processedImage.empty()) {
+            processedCanvas->setImage(processedImage);
+            
+            // Calculate quality metrics
+            QString metricsText = getQualityMetrics();
+            
+            QString processedInfo = QString("Size: %1x%2 | Channels: %3\n%4")
+                                   .arg(processedImage->cols)
+                                   .arg(processedImage->rows)
+                                   .arg(processedImage->channels())
+                                   .arg(metricsText);
+            processedInfoLabel->setText(processedInfo);
+            
+            saveAction->setEnabled(true);
+        } else {
+            processedCanvas->clear();
+            processedInfoLabel->setText("No processing applied");
+            saveAction->setEnabled(false);
+        }
     }
 }
 
@@ -696,9 +757,55 @@ void MainWindow::updateStatus(const QString& message, const QString& type, int p
     QApplication::processEvents();
 }
 
+void MainWindow::updatePerformanceHud(const Trace::OperationSummary& summary) {
+    // Throughput counts library stages only; UI work (display, dialogs)
+    // would otherwise dominate fast operations
+    double processingMs = 0.0;
+    for (const Trace::StageTiming& stage : summary.stages) {
+        if (stage.category != "ui") {
+            processingMs += stage.milliseconds;
+        }
+    }
+    if (processingMs <= 0.0) {
+        processingMs = summary.wallMs;
+    }
+    
+    const cv::Mat& image = processedImage.empty() ? currentImage.mat() : processedImage.mat();
+    const double megapixels = image.total() / 1e6;
+    
+    QString text = QString("%1  %2 ms")
+                   .arg(QString::fromStdString(summary.name))
+                   .arg(summary.wallMs, 0, 'f', 1);
+    if (megapixels > 0.0 && processingMs > 0.0) {
+        text += QString(" | %1 MP/s").arg(megapixels / (processingMs / 1000.0), 0, 'f', 1);
+    }
+    text += QString(" | peak +%1 MB | %2 threads")
+            .arg(summary.peakTemporaryBytes / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(summary.threads);
+    perfLabel->setText(text);
+    
+    QString details = QString("Last operation: %1\nWall time: %2 ms\n\nStages:")
+                      .arg(QString::fromStdString(summary.name))
+                      .arg(summary.wallMs, 0, 'f', 2);
+    for (const Trace::StageTiming& stage : summary.stages) {
+        details += QString("\n  %1 / %2: %3 ms")
+                   .arg(QString::fromStdString(stage.category))
+                   .arg(QString::fromStdString(stage.name))
+                   .arg(stage.milliseconds, 0, 'f', 2);
+        if (stage.calls > 1) {
+            details += QString(" (%1 calls)").arg(stage.calls);
+        }
+    }
+    if (summary.stages.empty()) {
+        details += "\n  (none recorded)";
+    }
+    perfLabel->setToolTip(details);
+}
+
 // File operations implementation continues in next part...
 
 void MainWindow::loadImage() {
+    TRACE_OPERATION("ui");
     QString fileName = QFileDialog::getOpenFileName(this,
         "Load Image File",
         QString(),
@@ -706,21 +813,35 @@ void MainWindow::loadImage() {
     
     if (fileName.isEmpty()) return;
     
+    if (!openImage(fileName)) {
+        QMessageBox::critical(this, "Error", 
+                             "Failed to load image file!\n\nPlease check the file format and try again.");
+    }
+}
+
+bool MainWindow::openImage(const QString& fileName) {
     updateStatus("Loading image...", "info", 25);
     
-    originalImage = cv::imread(fileName.toStdString());
+    ImageHandle loaded;
+    {
+        TRACE_SCOPE("ui", "decode");
+        loaded = ImageHandle(cv::imread(fileName.toStdString()));
+    }
     
-    if (originalImage.empty()) {
-        QMessageBox::critical(this, "Error", 
-                             "Failed to load image file!\n\nPlease check the file format and try again.");
+    if (loaded.empty()) {
         updateStatus("Failed to load image", "error");
-        return;
+        return false;
     }
     
     updateStatus("Image loaded successfully", "success", 100);
     
-    currentImage = originalImage.clone();
-    processedImage = cv::Mat(); // Clear processed image
+    originalImage = loaded;
+    currentImage = originalImage;
+    processedImage.reset(); // Clear processed image
+    clearContourIndex();
+    DerivedImageCache::clearCache();
+    transformStack.clear();
+    BufferPool::instance().trim();  // Buffers sized for the previous image
     imagePath = fileName;
     imageLoaded = true;
     recentlyProcessed = false;
@@ -737,9 +858,11 @@ void MainWindow::loadImage() {
     transformGroup->setEnabled(true);
     histogramGroup->setEnabled(true);
     processingGroup->setEnabled(true);
+    return true;
 }
 
 void MainWindow::saveImage() {
+    TRACE_OPERATION("ui");
     if (processedImage.empty()) {
         QMessageBox::warning(this, "Warning", "No processed image to save!");
         return;
@@ -765,112 +888,172 @@ void MainWindow::saveImage() {
         fileName += ext;
     }
 
+    if (saveProcessedImage(fileName)) {
+        QMessageBox::information(this, "Success",
+                                QString("Image saved successfully!\n\n%1").arg(fileName));
+    } else {
+        QMessageBox::critical(this, "Error", "Failed to save image file!\n\nEnsure OpenCV was built with TIFF support if saving as TIFF.");
+    }
+}
+
+bool MainWindow::saveProcessedImage(const QString& fileName) {
+    if (processedImage.empty()) return false;
+    
     updateStatus("Saving image...", "info", 50);
 
-    bool success = cv::imwrite(fileName.toStdString(), processedImage);
+    bool success;
+    {
+        TRACE_SCOPE("ui", "encode");
+        success = cv::imwrite(fileName.toStdString(), processedImage.mat());
+    }
+    Trace::finishOperation();
 
     if (success) {
         updateStatus("Image saved successfully", "success");
-        QMessageBox::information(this, "Success",
-                                QString("Image saved successfully!\n\n%1").arg(fileName));
     } else {
         updateStatus("Failed to save image", "error");
-        QMessageBox::critical(this, "Error", "Failed to save image file!\n\nEnsure OpenCV was built with TIFF support if saving as TIFF.");
+    }
+    return success;
+}
+
+void MainWindow::exportPerformanceTrace() {
+    QString fileName = QFileDialog::getSaveFileName(this,
+        "Export Performance Trace",
+        "imgproc_trace.json",
+        "Chrome Trace Files (*.json);;All Files (*.*)");
+    
+    if (fileName.isEmpty()) return;
+    
+    const size_t events = Trace::eventCount();
+    if (Trace::writeChromeTrace(fileName.toStdString())) {
+        updateStatus(QString("Trace exported: %1 events (open in chrome://tracing or ui.perfetto.dev)")
+                     .arg(events), "success");
+    } else {
+        QMessageBox::critical(this, "Error", "Failed to write the trace file!");
+        updateStatus("Failed to export trace", "error");
+    }
+}
+
+void MainWindow::setResultSpilling(bool enabled) {
+    // Files of this session only: anything left in the directory is removed
+    // when spilling starts and stops (and so on exit)
+    ResultCache::clearSpill();
+    ResultCache::setSpillDirectory(std::string());
+    if (!enabled) {
+        return;
+    }
+    
+    const QString resultCacheDir =
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/results";
+    if (QDir().mkpath(resultCacheDir)) {
+        ResultCache::setSpillDirectory(resultCacheDir.toStdString());
+        ResultCache::clearSpill();
+        updateStatus("Evicted previews are kept on disk until exit", "info");
+    } else {
+        updateStatus("Cannot create the result cache directory", "error");
     }
 }
 
 void MainWindow::resetImage() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) return;
     
-    currentImage = originalImage.clone();
-    processedImage = cv::Mat();
+    currentImage = originalImage;
+    processedImage.reset();
     recentlyProcessed = false;
     processingHistory.clear();
     lastOperation = "";
     processingStack.clear();
+    clearContourIndex();
+    DerivedImageCache::clearCache();
+    transformStack.clear();
+    BufferPool::instance().trim();  // Intermediate results are gone
     
     updateDisplay();
     updateStatus("Image reset to original", "info");
 }
 
 void MainWindow::undoLastOperation() {
-    std::cout << "[DEBUG] ===== UNDO FUNCTION CALLED =====" << std::endl;
-    std::cout << "[DEBUG] Image loaded: " << (imageLoaded ? "YES" : "NO") << std::endl;
-    std::cout << "[DEBUG] Processing stack size: " << processingStack.size() << std::endl;
-    std::cout << "[DEBUG] Processing history size: " << processingHistory.size() << std::endl;
+    TRACE_OPERATION("ui");
     
     if (!imageLoaded) {
-        std::cout << "[DEBUG] Undo failed: No image loaded" << std::endl;
         QMessageBox::warning(this, "Warning", "Please load an image first!");
         return;
     }
     
     if (processingStack.empty()) {
-        std::cout << "[DEBUG] Undo failed: Processing stack is empty" << std::endl;
         QMessageBox::information(this, "Undo", "No operations to undo!");
         return;
     }
     
-    std::cout << "[DEBUG] Restoring state from stack..." << std::endl;
-    
     // Restore previous state
-    processedImage = processingStack.back().clone();
+    processedImage = processingStack.back();
     processingStack.pop_back();
-    
-    std::cout << "[DEBUG] State restored. New stack size: " << processingStack.size() << std::endl;
+    clearContourIndex();
+    transformStack.clear();
+    TRACE_COUNTER("ui", "undo stack", static_cast<double>(processingStack.size()));
     
     if (!processingHistory.isEmpty()) {
-        QString undoneOperation = processingHistory.last();
         processingHistory.removeLast();
-        std::cout << "[DEBUG] Removed operation from history: " << undoneOperation.toStdString() << std::endl;
     }
     
     // Enable/disable undo action based on stack state
     if (undoAction) {
         undoAction->setEnabled(!processingStack.empty());
-        std::cout << "[DEBUG] Undo action " << (processingStack.empty() ? "disabled" : "enabled") << std::endl;
     }
     
     updateDisplay();
     updateStatus("Undo: Last operation reverted", "info");
-    std::cout << "[DEBUG] ===== UNDO COMPLETED =====" << std::endl;
 }
 
 // Helper function to save state before processing
-void MainWindow::saveProcessingState() {
-    std::cout << "[DEBUG] ===== SAVING PROCESSING STATE =====" << std::endl;
+bool MainWindow::execOperationDialog(QDialog& dialog) {
+    // Only the work of applying the accepted result is timed: previews and
+    // the time the dialog stayed open are dropped, and a cancelled dialog
+    // reports nothing
+    if (dialog.exec() == QDialog::Accepted) {
+        Trace::restartOperation();
+        return true;
+    }
+    Trace::cancelOperation();
+    return false;
+}
+
+void MainWindow::saveProcessingState(bool keepTransforms) {
+    TRACE_FUNCTION("ui");
+    
+    // The processed image is about to be replaced
+    clearContourIndex();
+    if (!keepTransforms) {
+        transformStack.clear();
+    }
     
     // For the FIRST operation: save the currentImage (original)
     // For subsequent operations: save the processedImage (previous result)
+    // Handles share the pixels; operations write their result to a new buffer
     if (processedImage.empty()) {
         // First operation - save the original currentImage
-        std::cout << "[DEBUG] First operation detected - saving original currentImage" << std::endl;
-        processingStack.push_back(currentImage.clone());
-        std::cout << "[DEBUG] Original image saved to stack. Stack size: " << processingStack.size() << std::endl;
+        processingStack.push_back(currentImage);
     } else {
         // Subsequent operations - save the current processed result
-        std::cout << "[DEBUG] Subsequent operation - saving current processedImage" << std::endl;
-        processingStack.push_back(processedImage.clone());
-        std::cout << "[DEBUG] Processed image saved to stack. Stack size: " << processingStack.size() << std::endl;
+        processingStack.push_back(processedImage);
     }
     
     // Limit stack size
     if (processingStack.size() > static_cast<size_t>(maxHistorySize)) {
         processingStack.erase(processingStack.begin());
-        std::cout << "[DEBUG] Stack size exceeded limit. Removed oldest state. New size: " << processingStack.size() << std::endl;
     }
+    TRACE_COUNTER("ui", "undo stack", static_cast<double>(processingStack.size()));
     
     // Enable undo action
     if (undoAction) {
         undoAction->setEnabled(true);
-        std::cout << "[DEBUG] Undo action enabled" << std::endl;
     }
-    
-    std::cout << "[DEBUG] ===== STATE SAVE COMPLETED =====" << std::endl;
 }
 
 // Lab 1: Image Information
 void MainWindow::showImageInfo() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -907,9 +1090,9 @@ void MainWindow::showImageInfo() {
     
     // Build information string
     QString info;
-    int rows = currentImage.rows;
-    int cols = currentImage.cols;
-    int channels = currentImage.channels();
+    int rows = currentImage->rows;
+    int cols = currentImage->cols;
+    int channels = currentImage->channels();
     
     QString imgType;
     if (channels == 1) {
@@ -923,8 +1106,8 @@ void MainWindow::showImageInfo() {
     }
     
     double minVal, maxVal, meanVal;
-    cv::minMaxLoc(currentImage, &minVal, &maxVal);
-    meanVal = cv::mean(currentImage)[0];
+    cv::minMaxLoc(currentImage.mat(), &minVal, &maxVal);
+    meanVal = cv::mean(currentImage.mat())[0];
     
     info += "======================================\n\n";
     info += QString("  File Path:               %1\n\n").arg(imagePath);
@@ -938,7 +1121,7 @@ void MainWindow::showImageInfo() {
            .arg(channels, 20);
     info += QString("  Data Type:               %1\n\n")
            .arg(QString::fromStdString(
-               cv::typeToString(currentImage.type())), 20);
+               cv::typeToString(currentImage->type())), 20);
     info += QString("  Min Value:               %1\n")
            .arg(minVal, 20, 'f', 2);
     info += QString("  Max Value:               %1\n")
@@ -961,11 +1144,13 @@ void MainWindow::showImageInfo() {
     btnLayout->addWidget(closeBtn);
     layout->addLayout(btnLayout);
     
+    Trace::finishOperation();
     infoDialog->exec();
 }
 
 // Lab 2: Pixel Information
 void MainWindow::showPixelInfo() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -988,9 +1173,9 @@ void MainWindow::showPixelInfo() {
     // X coordinate input
     QHBoxLayout *xLayout = new QHBoxLayout();
     xLayout->addWidget(new QLabel(QString("Enter X coordinate (0-%1):")
-                                 .arg(currentImage.cols - 1)));
+                                 .arg(currentImage->cols - 1)));
     QSpinBox *xSpinBox = new QSpinBox();
-    xSpinBox->setRange(0, currentImage.cols - 1);
+    xSpinBox->setRange(0, currentImage->cols - 1);
     xSpinBox->setValue(0);
     xLayout->addWidget(xSpinBox);
     layout->addLayout(xLayout);
@@ -998,9 +1183,9 @@ void MainWindow::showPixelInfo() {
     // Y coordinate input
     QHBoxLayout *yLayout = new QHBoxLayout();
     yLayout->addWidget(new QLabel(QString("Enter Y coordinate (0-%1):")
-                                 .arg(currentImage.rows - 1)));
+                                 .arg(currentImage->rows - 1)));
     QSpinBox *ySpinBox = new QSpinBox();
-    ySpinBox->setRange(0, currentImage.rows - 1);
+    ySpinBox->setRange(0, currentImage->rows - 1);
     ySpinBox->setValue(0);
     yLayout->addWidget(ySpinBox);
     layout->addLayout(yLayout);
@@ -1016,15 +1201,15 @@ void MainWindow::showPixelInfo() {
         int y = ySpinBox->value();
         
         QString valueStr;
-        if (currentImage.channels() == 1) {
-            uchar val = currentImage.at<uchar>(y, x);
+        if (currentImage->channels() == 1) {
+            uchar val = currentImage->at<uchar>(y, x);
             valueStr = QString::number(val);
-        } else if (currentImage.channels() == 3) {
-            cv::Vec3b val = currentImage.at<cv::Vec3b>(y, x);
+        } else if (currentImage->channels() == 3) {
+            cv::Vec3b val = currentImage->at<cv::Vec3b>(y, x);
             valueStr = QString("B:%1, G:%2, R:%3")
                       .arg(val[0]).arg(val[1]).arg(val[2]);
-        } else if (currentImage.channels() == 4) {
-            cv::Vec4b val = currentImage.at<cv::Vec4b>(y, x);
+        } else if (currentImage->channels() == 4) {
+            cv::Vec4b val = currentImage->at<cv::Vec4b>(y, x);
             valueStr = QString("B:%1, G:%2, R:%3, A:%4")
                       .arg(val[0]).arg(val[1]).arg(val[2]).arg(val[3]);
         }
@@ -1046,20 +1231,21 @@ void MainWindow::showPixelInfo() {
 
 // Lab 3: Image Statistics
 void MainWindow::showImageStats() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
     double minVal, maxVal;
-    cv::minMaxLoc(currentImage, &minVal, &maxVal);
+    cv::minMaxLoc(currentImage.mat(), &minVal, &maxVal);
     
-    cv::Scalar meanScalar = cv::mean(currentImage);
+    cv::Scalar meanScalar = cv::mean(currentImage.mat());
     double meanVal = meanScalar[0];
     
     // Calculate standard deviation
     cv::Mat meanMat, stdDevMat;
-    cv::meanStdDev(currentImage, meanMat, stdDevMat);
+    cv::meanStdDev(currentImage.mat(), meanMat, stdDevMat);
     double stdDev = stdDevMat.at<double>(0, 0);
     
     QString stats = QString(
@@ -1079,199 +1265,186 @@ void MainWindow::showImageStats() {
         "QMessageBox { background-color: #0f1535; } "
         "QLabel { color: #f8f9fc; font-size: 11pt; }"
     );
+    Trace::finishOperation();
     msgBox.exec();
 }
 
 // Lab 4: Geometric Transformations
 void MainWindow::applyTranslation() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle previousImage = processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     
+    // Previews compose with the pending transforms (single resample)
     TransformDialog *dialog = new TransformDialog(
         this, 
         TransformDialog::Translation, 
-        sourceImage
+        sourceImage,
+        &transformStack
     );
     
-    // Connect preview signal to update processed canvas
     connect(dialog, &TransformDialog::previewRequested,
-            [this](const cv::Mat& preview) {
-                processedImage = preview.clone();
-                updateDisplay();
+            [this](const ImageHandle& preview) {
+                processedImage = preview;
+                refreshDisplay();
             });
     
-    if (dialog->exec() == QDialog::Accepted) {
-        // Save state before applying transformation
-        saveProcessingState();
-        
-        processedImage = dialog->getResultImage();
-        recentlyProcessed = true;
-        updateDisplay();
+    const bool accepted = execOperationDialog(*dialog);
+    
+    // Previews replaced the processed image; put the previous one back
+    processedImage = previousImage;
+    
+    if (accepted) {
+        applyGeometricTransform(dialog->getTransformMatrix(), dialog->getResultImage());
         updateStatus("Image translated successfully", "success");
+    } else {
+        refreshDisplay();
     }
     
     delete dialog;
 }
 
 void MainWindow::applyRotation() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle previousImage = processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     
+    // Previews compose with the pending transforms (single resample)
     TransformDialog *dialog = new TransformDialog(
         this, 
         TransformDialog::Rotation, 
-        sourceImage
+        sourceImage,
+        &transformStack
     );
     
     connect(dialog, &TransformDialog::previewRequested,
-            [this](const cv::Mat& preview) {
-                processedImage = preview.clone();
-                updateDisplay();
+            [this](const ImageHandle& preview) {
+                processedImage = preview;
+                refreshDisplay();
             });
     
-    if (dialog->exec() == QDialog::Accepted) {
-        // Save state before applying transformation
-        saveProcessingState();
-        
-        processedImage = dialog->getResultImage();
-        recentlyProcessed = true;
-        updateDisplay();
+    const bool accepted = execOperationDialog(*dialog);
+    
+    // Previews replaced the processed image; put the previous one back
+    processedImage = previousImage;
+    
+    if (accepted) {
+        applyGeometricTransform(dialog->getTransformMatrix(), dialog->getResultImage());
         updateStatus("Image rotated successfully", "success");
+    } else {
+        refreshDisplay();
     }
     
     delete dialog;
 }
 
 void MainWindow::applySkew() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    // Save state before processing
-    saveProcessingState();
-    
     // Use processed image if available, otherwise use current
-    cv::Mat img = processedImage.empty() ? currentImage.clone() : processedImage.clone();
-    int rows = img.rows;
-    int cols = img.cols;
-    
-    cv::Point2f srcTri[3];
-    cv::Point2f dstTri[3];
-    
-    srcTri[0] = cv::Point2f(0, 0);
-    srcTri[1] = cv::Point2f(cols - 1, 0);
-    srcTri[2] = cv::Point2f(0, rows - 1);
-    
-    dstTri[0] = cv::Point2f(0, 0);
-    dstTri[1] = cv::Point2f(cols - 1, 0);
-    dstTri[2] = cv::Point2f(100, rows - 1);
-    
-    cv::Mat warpMat = cv::getAffineTransform(srcTri, dstTri);
-    cv::warpAffine(img, processedImage, warpMat, img.size());
-    
-    recentlyProcessed = true;
-    updateDisplay();
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    applyGeometricTransform(TransformationsLib::skewMatrix(sourceImage->size(), 100));
     updateStatus("Image skewed successfully", "success");
 }
 
 void MainWindow::applyZoom() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle previousImage = processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     
+    // Previews compose with the pending transforms (single resample)
     TransformDialog *dialog = new TransformDialog(
         this, 
         TransformDialog::Zoom, 
-        sourceImage
+        sourceImage,
+        &transformStack
     );
     
     connect(dialog, &TransformDialog::previewRequested,
-            [this](const cv::Mat& preview) {
-                processedImage = preview.clone();
-                updateDisplay();
+            [this](const ImageHandle& preview) {
+                processedImage = preview;
+                refreshDisplay();
             });
     
-    if (dialog->exec() == QDialog::Accepted) {
-        // Save state before applying transformation
-        saveProcessingState();
-        
-        processedImage = dialog->getResultImage();
-        recentlyProcessed = true;
-        updateDisplay();
+    const bool accepted = execOperationDialog(*dialog);
+    
+    // Previews replaced the processed image; put the previous one back
+    processedImage = previousImage;
+    
+    if (accepted) {
+        applyGeometricTransform(dialog->getTransformMatrix(), dialog->getResultImage());
         updateStatus("Image zoomed successfully", "success");
+    } else {
+        refreshDisplay();
     }
     
     delete dialog;
 }
 
 void MainWindow::applyFlipX() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    // Save state before processing
-    saveProcessingState();
-    
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    cv::flip(sourceImage, processedImage, 0); // Flip around x-axis
-    recentlyProcessed = true;
-    updateDisplay();
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    applyGeometricTransform(TransformationsLib::flipMatrix(sourceImage->size(), 0)); // Flip around x-axis
     updateStatus("Image flipped horizontally", "success");
 }
 
 void MainWindow::applyFlipY() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    // Save state before processing
-    saveProcessingState();
-    
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    cv::flip(sourceImage, processedImage, 1); // Flip around y-axis
-    recentlyProcessed = true;
-    updateDisplay();
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    applyGeometricTransform(TransformationsLib::flipMatrix(sourceImage->size(), 1)); // Flip around y-axis
     updateStatus("Image flipped vertically", "success");
 }
 
 void MainWindow::applyFlipXY() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    // Save state before processing
-    saveProcessingState();
-    
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    cv::flip(sourceImage, processedImage, -1); // Flip both axes
-    recentlyProcessed = true;
-    updateDisplay();
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    applyGeometricTransform(TransformationsLib::flipMatrix(sourceImage->size(), -1)); // Flip both axes
     updateStatus("Image flipped both ways", "success");
 }
 
 // Lab 5: Histogram Operations
 void MainWindow::showHistogram() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1296,7 +1469,7 @@ void MainWindow::showHistogram() {
     
     // Histogram widget - use processed image if available, otherwise current
     HistogramWidget *histWidget = new HistogramWidget(histDialog);
-    cv::Mat imageToAnalyze = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle imageToAnalyze = processedImage.empty() ? currentImage : processedImage;
     histWidget->setImage(imageToAnalyze);
     layout->addWidget(histWidget);
     
@@ -1311,10 +1484,12 @@ void MainWindow::showHistogram() {
     btnLayout->addWidget(closeBtn);
     layout->addLayout(btnLayout);
     
+    Trace::finishOperation();
     histDialog->exec();
 }
 
 void MainWindow::applyHistogramEqualization() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1324,8 +1499,8 @@ void MainWindow::applyHistogramEqualization() {
     saveProcessingState();
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageProcessingLib::applyHistogramEqualization(sourceImage, processedImage);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageProcessingLib::applyHistogramEqualization(sourceImage, processedImage.output());
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1333,6 +1508,7 @@ void MainWindow::applyHistogramEqualization() {
 }
 
 void MainWindow::applyOtsuThresholding() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1342,8 +1518,10 @@ void MainWindow::applyOtsuThresholding() {
     saveProcessingState();
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageProcessingLib::applyOtsuThresholding(sourceImage, processedImage);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    // Gray-only result: start from the shared gray form of the source
+    ImageProcessingLib::applyOtsuThresholding(DerivedImageCache::gray(sourceImage),
+                                              processedImage.output());
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1352,6 +1530,7 @@ void MainWindow::applyOtsuThresholding() {
 
 // Lab 6: Basic Image Processing
 void MainWindow::convertToGrayscale() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1361,9 +1540,9 @@ void MainWindow::convertToGrayscale() {
     saveProcessingState();
     
     // Continuous processing: use processed image if available
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     
-    ImageProcessingLib::convertToGrayscale(sourceImage, processedImage);
+    ImageProcessingLib::convertToGrayscale(DerivedImageCache::gray(sourceImage), processedImage.output());
     
     processingHistory << "Grayscale";
     lastOperation = "Grayscale";
@@ -1373,6 +1552,7 @@ void MainWindow::convertToGrayscale() {
 }
 
 void MainWindow::applyBinaryThreshold() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1382,8 +1562,10 @@ void MainWindow::applyBinaryThreshold() {
     saveProcessingState();
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageProcessingLib::applyBinaryThreshold(sourceImage, processedImage, 128);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    // Gray-only result: start from the shared gray form of the source
+    ImageProcessingLib::applyBinaryThreshold(DerivedImageCache::gray(sourceImage),
+                                             processedImage.output(), 128);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1391,6 +1573,7 @@ void MainWindow::applyBinaryThreshold() {
 }
 
 void MainWindow::applyGaussianBlur() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1400,8 +1583,8 @@ void MainWindow::applyGaussianBlur() {
     saveProcessingState();
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageProcessingLib::applyGaussianBlur(sourceImage, processedImage, 5);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageProcessingLib::applyGaussianBlur(sourceImage, processedImage.output(), 5);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1409,6 +1592,7 @@ void MainWindow::applyGaussianBlur() {
 }
 
 void MainWindow::applyEdgeDetection() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1418,8 +1602,10 @@ void MainWindow::applyEdgeDetection() {
     saveProcessingState();
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageProcessingLib::applyEdgeDetection(sourceImage, processedImage, 100, 200);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    // Gray-only result: start from the shared gray form of the source
+    ImageProcessingLib::applyEdgeDetection(DerivedImageCache::gray(sourceImage),
+                                           processedImage.output(), 100, 200);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1427,6 +1613,7 @@ void MainWindow::applyEdgeDetection() {
 }
 
 void MainWindow::invertColors() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1436,8 +1623,8 @@ void MainWindow::invertColors() {
     saveProcessingState();
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageProcessingLib::invertColors(sourceImage, processedImage);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageProcessingLib::invertColors(sourceImage, processedImage.output());
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1446,6 +1633,7 @@ void MainWindow::invertColors() {
 
 // Lab 7: Custom Filters Implementation
 void MainWindow::applyTraditionalFilter() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1457,8 +1645,8 @@ void MainWindow::applyTraditionalFilter() {
     updateStatus("Applying traditional filter...", "info", 50);
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageFilters::applyTraditionalFilter(sourceImage, processedImage, 5);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageFilters::applyTraditionalFilter(sourceImage, processedImage.output(), 5);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1473,6 +1661,7 @@ void MainWindow::applyTraditionalFilter() {
 }
 
 void MainWindow::applyPyramidalFilter() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1484,8 +1673,8 @@ void MainWindow::applyPyramidalFilter() {
     updateStatus("Applying pyramidal filter...", "info", 50);
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageFilters::applyPyramidalFilter(sourceImage, processedImage);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageFilters::applyPyramidalFilter(sourceImage, processedImage.output());
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1500,6 +1689,7 @@ void MainWindow::applyPyramidalFilter() {
 }
 
 void MainWindow::applyCircularFilter() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1511,8 +1701,8 @@ void MainWindow::applyCircularFilter() {
     updateStatus("Applying circular filter...", "info", 50);
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageFilters::applyCircularFilter(sourceImage, processedImage, 2.0f);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageFilters::applyCircularFilter(sourceImage, processedImage.output(), 2.0f);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1527,6 +1717,7 @@ void MainWindow::applyCircularFilter() {
 }
 
 void MainWindow::applyConeFilter() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1538,8 +1729,8 @@ void MainWindow::applyConeFilter() {
     updateStatus("Applying cone filter...", "info", 50);
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageFilters::applyConeFilter(sourceImage, processedImage);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageFilters::applyConeFilter(sourceImage, processedImage.output());
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1554,6 +1745,7 @@ void MainWindow::applyConeFilter() {
 }
 
 void MainWindow::applyLaplacianFilter() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1565,8 +1757,8 @@ void MainWindow::applyLaplacianFilter() {
     updateStatus("Applying Laplacian filter...", "info", 50);
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageFilters::applyLaplacianFilter(sourceImage, processedImage);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageFilters::applyLaplacianFilter(sourceImage, processedImage.output());
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1581,6 +1773,7 @@ void MainWindow::applyLaplacianFilter() {
 }
 
 void MainWindow::applySobelFilter() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1592,8 +1785,8 @@ void MainWindow::applySobelFilter() {
     updateStatus("Applying Sobel filter...", "info", 50);
     
     // Use processed image if available, otherwise use current
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageFilters::applySobelFilter(sourceImage, processedImage);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageFilters::applySobelFilter(sourceImage, processedImage.output());
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1608,6 +1801,7 @@ void MainWindow::applySobelFilter() {
 }
 
 void MainWindow::autoEnhance() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1619,7 +1813,7 @@ void MainWindow::autoEnhance() {
     updateStatus("Auto-enhancing image...", "info", 50);
     
     // Get source image (continuous processing support)
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     
     cv::Mat enhancedImage;
     QStringList operations;
@@ -1627,7 +1821,7 @@ void MainWindow::autoEnhance() {
     // Call auto enhance with operation tracking
     ImageProcessingLib::applyAutoEnhance(sourceImage, enhancedImage, operations);
     
-    processedImage = enhancedImage.clone();
+    processedImage = ImageHandle(enhancedImage);
     processingHistory.append(operations);
     lastOperation = "Auto Enhancement";
     recentlyProcessed = true;
@@ -1710,9 +1904,10 @@ QString MainWindow::getQualityMetrics() {
     if (processedImage.empty() || currentImage.empty()) {
         return "No metrics available";
     }
+    TRACE_SCOPE("ui", "metrics");
     
     // Ensure both images have the same size
-    if (currentImage.size() != processedImage.size()) {
+    if (currentImage->size() != processedImage->size()) {
         return "Size mismatch - cannot calculate metrics";
     }
     
@@ -1736,6 +1931,7 @@ QString MainWindow::getQualityMetrics() {
 
 // Noise Addition Functions
 void MainWindow::addGaussianNoise() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1755,8 +1951,8 @@ void MainWindow::addGaussianNoise() {
     saveProcessingState();
     updateStatus("Adding Gaussian noise...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageFilters::addGaussianNoise(sourceImage, processedImage, mean, stddev);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageFilters::addGaussianNoise(sourceImage, processedImage.output(), mean, stddev);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1764,6 +1960,7 @@ void MainWindow::addGaussianNoise() {
 }
 
 void MainWindow::addSaltPepperNoise() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1778,8 +1975,8 @@ void MainWindow::addSaltPepperNoise() {
     saveProcessingState();
     updateStatus("Adding salt & pepper noise...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageFilters::addSaltPepperNoise(sourceImage, processedImage, density);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageFilters::addSaltPepperNoise(sourceImage, processedImage.output(), density);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1787,6 +1984,7 @@ void MainWindow::addSaltPepperNoise() {
 }
 
 void MainWindow::addPoissonNoise() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1795,8 +1993,8 @@ void MainWindow::addPoissonNoise() {
     saveProcessingState();
     updateStatus("Adding Poisson noise...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageFilters::addPoissonNoise(sourceImage, processedImage);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageFilters::addPoissonNoise(sourceImage, processedImage.output());
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1811,6 +2009,7 @@ void MainWindow::addPoissonNoise() {
 }
 
 void MainWindow::addSpeckleNoise() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -1825,8 +2024,8 @@ void MainWindow::addSpeckleNoise() {
     saveProcessingState();
     updateStatus("Adding speckle noise...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    ImageFilters::addSpeckleNoise(sourceImage, processedImage, variance);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageFilters::addSpeckleNoise(sourceImage, processedImage.output(), variance);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -1835,18 +2034,18 @@ void MainWindow::addSpeckleNoise() {
 
 // Advanced Denoising Functions
 void MainWindow::applyMedianFilter() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    saveProcessingState();
-    
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     FilterDialog dialog(sourceImage, FilterDialog::MEDIAN, this);
     
-    if (dialog.exec() == QDialog::Accepted) {
-        processedImage = dialog.getFilteredImage();
+    if (execOperationDialog(dialog)) {
+        saveProcessingState();
+        processedImage = dialog.renderResult();
         recentlyProcessed = true;
         updateDisplay();
         updateStatus("Median filter applied", "success");
@@ -1854,18 +2053,18 @@ void MainWindow::applyMedianFilter() {
 }
 
 void MainWindow::applyBilateralFilter() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    saveProcessingState();
-    
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     FilterDialog dialog(sourceImage, FilterDialog::BILATERAL, this);
     
-    if (dialog.exec() == QDialog::Accepted) {
-        processedImage = dialog.getFilteredImage();
+    if (execOperationDialog(dialog)) {
+        saveProcessingState();
+        processedImage = dialog.renderResult();
         recentlyProcessed = true;
         updateDisplay();
         updateStatus("Bilateral filter applied", "success");
@@ -1873,18 +2072,18 @@ void MainWindow::applyBilateralFilter() {
 }
 
 void MainWindow::applyNonLocalMeansFilter() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    saveProcessingState();
-    
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     FilterDialog dialog(sourceImage, FilterDialog::NON_LOCAL_MEANS, this);
     
-    if (dialog.exec() == QDialog::Accepted) {
-        processedImage = dialog.getFilteredImage();
+    if (execOperationDialog(dialog)) {
+        saveProcessingState();
+        processedImage = dialog.renderResult();
         recentlyProcessed = true;
         updateDisplay();
         updateStatus("Non-Local Means denoising applied", "success");
@@ -1893,18 +2092,18 @@ void MainWindow::applyNonLocalMeansFilter() {
 
 // Morphological Operations
 void MainWindow::applyMorphologicalOpening() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    saveProcessingState();
-    
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     FilterDialog dialog(sourceImage, FilterDialog::MORPHOLOGICAL_OPENING, this);
     
-    if (dialog.exec() == QDialog::Accepted) {
-        processedImage = dialog.getFilteredImage();
+    if (execOperationDialog(dialog)) {
+        saveProcessingState();
+        processedImage = dialog.renderResult();
         recentlyProcessed = true;
         updateDisplay();
         updateStatus("Morphological opening applied", "success");
@@ -1912,18 +2111,18 @@ void MainWindow::applyMorphologicalOpening() {
 }
 
 void MainWindow::applyMorphologicalClosing() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    saveProcessingState();
-    
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     FilterDialog dialog(sourceImage, FilterDialog::MORPHOLOGICAL_CLOSING, this);
     
-    if (dialog.exec() == QDialog::Accepted) {
-        processedImage = dialog.getFilteredImage();
+    if (execOperationDialog(dialog)) {
+        saveProcessingState();
+        processedImage = dialog.renderResult();
         recentlyProcessed = true;
         updateDisplay();
         updateStatus("Morphological closing applied", "success");
@@ -1931,18 +2130,18 @@ void MainWindow::applyMorphologicalClosing() {
 }
 
 void MainWindow::applyMorphologicalGradient() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    saveProcessingState();
-    
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     FilterDialog dialog(sourceImage, FilterDialog::MORPHOLOGICAL_GRADIENT, this);
     
-    if (dialog.exec() == QDialog::Accepted) {
-        processedImage = dialog.getFilteredImage();
+    if (execOperationDialog(dialog)) {
+        saveProcessingState();
+        processedImage = dialog.renderResult();
         recentlyProcessed = true;
         updateDisplay();
         updateStatus("Morphological gradient applied", "success");
@@ -1950,18 +2149,18 @@ void MainWindow::applyMorphologicalGradient() {
 }
 
 void MainWindow::applyTopHat() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    saveProcessingState();
-    
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     FilterDialog dialog(sourceImage, FilterDialog::TOP_HAT, this);
     
-    if (dialog.exec() == QDialog::Accepted) {
-        processedImage = dialog.getFilteredImage();
+    if (execOperationDialog(dialog)) {
+        saveProcessingState();
+        processedImage = dialog.renderResult();
         recentlyProcessed = true;
         updateDisplay();
         updateStatus("Top-hat transform applied", "success");
@@ -1969,18 +2168,18 @@ void MainWindow::applyTopHat() {
 }
 
 void MainWindow::applyBlackHat() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    saveProcessingState();
-    
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     FilterDialog dialog(sourceImage, FilterDialog::BLACK_HAT, this);
     
-    if (dialog.exec() == QDialog::Accepted) {
-        processedImage = dialog.getFilteredImage();
+    if (execOperationDialog(dialog)) {
+        saveProcessingState();
+        processedImage = dialog.renderResult();
         recentlyProcessed = true;
         updateDisplay();
         updateStatus("Black-hat transform applied", "success");
@@ -1989,18 +2188,18 @@ void MainWindow::applyBlackHat() {
 
 // Sharpening Functions
 void MainWindow::applyUnsharpMask() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    saveProcessingState();
-    
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     FilterDialog dialog(sourceImage, FilterDialog::UNSHARP_MASK, this);
     
-    if (dialog.exec() == QDialog::Accepted) {
-        processedImage = dialog.getFilteredImage();
+    if (execOperationDialog(dialog)) {
+        saveProcessingState();
+        processedImage = dialog.renderResult();
         recentlyProcessed = true;
         updateDisplay();
         updateStatus("Unsharp mask applied", "success");
@@ -2008,18 +2207,18 @@ void MainWindow::applyUnsharpMask() {
 }
 
 void MainWindow::applyHighPassFilter() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    saveProcessingState();
-    
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     FilterDialog dialog(sourceImage, FilterDialog::HIGH_PASS, this);
     
-    if (dialog.exec() == QDialog::Accepted) {
-        processedImage = dialog.getFilteredImage();
+    if (execOperationDialog(dialog)) {
+        saveProcessingState();
+        processedImage = dialog.renderResult();
         recentlyProcessed = true;
         updateDisplay();
         updateStatus("High-pass filter applied", "success");
@@ -2027,18 +2226,18 @@ void MainWindow::applyHighPassFilter() {
 }
 
 void MainWindow::applyCustomSharpen() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    saveProcessingState();
-    
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     FilterDialog dialog(sourceImage, FilterDialog::CUSTOM_SHARPEN, this);
     
-    if (dialog.exec() == QDialog::Accepted) {
-        processedImage = dialog.getFilteredImage();
+    if (execOperationDialog(dialog)) {
+        saveProcessingState();
+        processedImage = dialog.renderResult();
         recentlyProcessed = true;
         updateDisplay();
         updateStatus("Custom sharpening applied", "success");
@@ -2050,12 +2249,13 @@ void MainWindow::applyCustomSharpen() {
 // =============================================================================
 
 void MainWindow::convertToColorSpace() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    if (currentImage.channels() != 3) {
+    if (currentImage->channels() != 3) {
         QMessageBox::warning(this, "Warning", "Color space conversion requires a color image!");
         return;
     }
@@ -2102,7 +2302,7 @@ void MainWindow::convertToColorSpace() {
     
     cv::Mat result;
     if (ColorProcessingLib::convertColorSpace(currentImage, result, targetSpace)) {
-        processedImage = result;
+        processedImage = ImageHandle(result);
         recentlyProcessed = true;
         lastOperation = QString("Color Space: %1").arg(spaceName);
         updateDisplay();
@@ -2120,12 +2320,13 @@ void MainWindow::convertToColorSpace() {
 }
 
 void MainWindow::splitRGBChannels() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    if (currentImage.channels() != 3) {
+    if (currentImage->channels() != 3) {
         QMessageBox::warning(this, "Warning", "Channel split requires a color image!");
         return;
     }
@@ -2158,17 +2359,17 @@ void MainWindow::splitRGBChannels() {
         ColorProcessingLib::visualizeChannel(currentImage, green, 1);
         ColorProcessingLib::visualizeChannel(currentImage, red, 2);
         
-        int newWidth = currentImage.cols / 3;
-        int newHeight = currentImage.rows;
+        int newWidth = currentImage->cols / 3;
+        int newHeight = currentImage->rows;
         
         cv::Mat blueResized, greenResized, redResized;
-        cv::resize(blue, blueResized, cv::Size(newWidth, newHeight));
-        cv::resize(green, greenResized, cv::Size(newWidth, newHeight));
-        cv::resize(red, redResized, cv::Size(newWidth, newHeight));
+        Resampler::resize(blue, blueResized, cv::Size(newWidth, newHeight), Resampler::FILTER_AREA);
+        Resampler::resize(green, greenResized, cv::Size(newWidth, newHeight), Resampler::FILTER_AREA);
+        Resampler::resize(red, redResized, cv::Size(newWidth, newHeight), Resampler::FILTER_AREA);
         
         cv::Mat composite;
         cv::hconcat(blueResized, greenResized, composite);
-        cv::hconcat(composite, redResized, processedImage);
+        cv::hconcat(composite, redResized, processedImage.output());
         
         recentlyProcessed = true;
         lastOperation = "RGB Channels Split (Composite)";
@@ -2178,7 +2379,7 @@ void MainWindow::splitRGBChannels() {
         int channelIndex = selection.startsWith("Blue") ? 0 : 
                           (selection.startsWith("Green") ? 1 : 2);
         
-        ColorProcessingLib::visualizeChannel(currentImage, processedImage, channelIndex);
+        ColorProcessingLib::visualizeChannel(currentImage, processedImage.output(), channelIndex);
         
         recentlyProcessed = true;
         lastOperation = QString("Channel: %1").arg(selection);
@@ -2188,6 +2389,7 @@ void MainWindow::splitRGBChannels() {
 }
 
 void MainWindow::adjustColors() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2198,12 +2400,12 @@ void MainWindow::adjustColors() {
     ColorAdjustDialog dialog(currentImage, this);
     
     connect(&dialog, &ColorAdjustDialog::previewRequested, 
-            [this](const cv::Mat& preview) {
-        processedImage = preview.clone();
-        updateDisplay();
+            [this](const ImageHandle& preview) {
+        processedImage = preview;
+        refreshDisplay();
     });
     
-    if (dialog.exec() == QDialog::Accepted) {
+    if (execOperationDialog(dialog)) {
         saveProcessingState();
         processedImage = dialog.getAdjustedImage();
         recentlyProcessed = true;
@@ -2222,47 +2424,71 @@ void MainWindow::adjustColors() {
         updateStatus(msg, "success");
     } else {
         if (recentlyProcessed) {
-            updateDisplay();
+            refreshDisplay();
         }
         updateStatus("Color adjustment cancelled", "info");
     }
 }
 
 void MainWindow::applyWhiteBalance() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    if (currentImage.channels() != 3) {
+    if (currentImage->channels() != 3) {
         QMessageBox::warning(this, "Warning", "White balance requires a color image!");
         return;
     }
     
+    QStringList algorithms;
+    algorithms << "Gray World (Equalize channel averages)"
+               << "White Patch (Brightest value becomes white)"
+               << "Percentile (Robust white patch, 99th percentile)";
+    
+    bool ok;
+    QString selection = QInputDialog::getItem(this, "White Balance",
+                                             "Select white balance algorithm:",
+                                             algorithms, 0, false, &ok);
+    
+    if (!ok || selection.isEmpty()) return;
+    
+    ColorProcessingLib::WhiteBalanceMode mode = ColorProcessingLib::WhiteBalanceMode::GRAY_WORLD;
+    if (selection.startsWith("White Patch")) {
+        mode = ColorProcessingLib::WhiteBalanceMode::WHITE_PATCH;
+    } else if (selection.startsWith("Percentile")) {
+        mode = ColorProcessingLib::WhiteBalanceMode::PERCENTILE;
+    }
+    
     updateStatus("Applying white balance...", "info", 50);
     
     saveProcessingState();
-    ColorProcessingLib::whiteBalance(currentImage, processedImage);
+    ColorProcessingLib::whiteBalance(currentImage, processedImage.output(), mode);
+    
+    QString algorithmName = selection.section(" (", 0, 0);
     
     recentlyProcessed = true;
-    lastOperation = "White Balance";
+    lastOperation = QString("White Balance (%1)").arg(algorithmName);
     updateDisplay();
     updateStatus("White balance applied successfully", "success");
     
     QMessageBox::information(this, "White Balance",
-        "Automatic white balance correction applied!\n\n"
-        "Algorithm: Gray World assumption\n"
-        "Effect: Corrects color cast by normalizing average RGB values\n"
-        "Use case: Fix images with color temperature issues");
+        QString("Automatic white balance correction applied!\n\n"
+                "Algorithm: %1\n"
+                "Effect: Corrects color cast by rescaling each RGB channel\n"
+                "Use case: Fix images with color temperature issues")
+        .arg(algorithmName));
 }
 
 void MainWindow::applySepiaEffect() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    if (currentImage.channels() != 3) {
+    if (currentImage->channels() != 3) {
         QMessageBox::warning(this, "Warning", "Sepia effect requires a color image!");
         return;
     }
@@ -2278,7 +2504,7 @@ void MainWindow::applySepiaEffect() {
     
     saveProcessingState();
     double intensityFactor = intensity / 100.0;
-    ColorProcessingLib::applySepiaEffect(currentImage, processedImage, intensityFactor);
+    ColorProcessingLib::applySepiaEffect(currentImage, processedImage.output(), intensityFactor);
     
     recentlyProcessed = true;
     lastOperation = QString("Sepia (%1%)").arg(intensity);
@@ -2287,12 +2513,13 @@ void MainWindow::applySepiaEffect() {
 }
 
 void MainWindow::applyCoolFilter() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    if (currentImage.channels() != 3) {
+    if (currentImage->channels() != 3) {
         QMessageBox::warning(this, "Warning", "Cool filter requires a color image!");
         return;
     }
@@ -2308,7 +2535,7 @@ void MainWindow::applyCoolFilter() {
     
     saveProcessingState();
     double intensityFactor = intensity / 100.0;
-    ColorProcessingLib::applyCoolFilter(currentImage, processedImage, intensityFactor);
+    ColorProcessingLib::applyCoolFilter(currentImage, processedImage.output(), intensityFactor);
     
     recentlyProcessed = true;
     lastOperation = QString("Cool Filter (%1%)").arg(intensity);
@@ -2317,12 +2544,13 @@ void MainWindow::applyCoolFilter() {
 }
 
 void MainWindow::applyWarmFilter() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    if (currentImage.channels() != 3) {
+    if (currentImage->channels() != 3) {
         QMessageBox::warning(this, "Warning", "Warm filter requires a color image!");
         return;
     }
@@ -2338,7 +2566,7 @@ void MainWindow::applyWarmFilter() {
     
     saveProcessingState();
     double intensityFactor = intensity / 100.0;
-    ColorProcessingLib::applyWarmFilter(currentImage, processedImage, intensityFactor);
+    ColorProcessingLib::applyWarmFilter(currentImage, processedImage.output(), intensityFactor);
     
     recentlyProcessed = true;
     lastOperation = QString("Warm Filter (%1%)").arg(intensity);
@@ -2347,12 +2575,13 @@ void MainWindow::applyWarmFilter() {
 }
 
 void MainWindow::applyVintageEffect() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    if (currentImage.channels() != 3) {
+    if (currentImage->channels() != 3) {
         QMessageBox::warning(this, "Warning", "Vintage effect requires a color image!");
         return;
     }
@@ -2360,7 +2589,7 @@ void MainWindow::applyVintageEffect() {
     updateStatus("Applying vintage effect...", "info", 50);
     
     saveProcessingState();
-    ColorProcessingLib::applyVintageEffect(currentImage, processedImage);
+    ColorProcessingLib::applyVintageEffect(currentImage, processedImage.output());
     
     recentlyProcessed = true;
     lastOperation = "Vintage Effect";
@@ -2382,6 +2611,7 @@ void MainWindow::applyVintageEffect() {
 
 // Basic Morphological Operations
 void MainWindow::applyErosion() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2390,14 +2620,14 @@ void MainWindow::applyErosion() {
     bool ok;
     int kernelSize = QInputDialog::getInt(this, "Erosion", 
                                           "Enter kernel size (odd number):",
-                                          5, 3, 21, 2, &ok);
+                                          5, 3, MorphologyLib::MAX_KERNEL_SIZE, 2, &ok);
     if (!ok) return;
     
     saveProcessingState();
     updateStatus("Applying erosion...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    MorphologyLib::applyErosion(sourceImage, processedImage, kernelSize);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    MorphologyLib::applyErosion(sourceImage, processedImage.output(), kernelSize);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2405,6 +2635,7 @@ void MainWindow::applyErosion() {
 }
 
 void MainWindow::applyDilation() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2413,14 +2644,14 @@ void MainWindow::applyDilation() {
     bool ok;
     int kernelSize = QInputDialog::getInt(this, "Dilation", 
                                           "Enter kernel size (odd number):",
-                                          5, 3, 21, 2, &ok);
+                                          5, 3, MorphologyLib::MAX_KERNEL_SIZE, 2, &ok);
     if (!ok) return;
     
     saveProcessingState();
     updateStatus("Applying dilation...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    MorphologyLib::applyDilation(sourceImage, processedImage, kernelSize);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    MorphologyLib::applyDilation(sourceImage, processedImage.output(), kernelSize);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2428,6 +2659,7 @@ void MainWindow::applyDilation() {
 }
 
 void MainWindow::applyMorphOpening() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2436,14 +2668,14 @@ void MainWindow::applyMorphOpening() {
     bool ok;
     int kernelSize = QInputDialog::getInt(this, "Opening", 
                                           "Enter kernel size (odd number):",
-                                          5, 3, 21, 2, &ok);
+                                          5, 3, MorphologyLib::MAX_KERNEL_SIZE, 2, &ok);
     if (!ok) return;
     
     saveProcessingState();
     updateStatus("Applying morphological opening...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    MorphologyLib::applyOpening(sourceImage, processedImage, kernelSize);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    MorphologyLib::applyOpening(sourceImage, processedImage.output(), kernelSize);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2451,6 +2683,7 @@ void MainWindow::applyMorphOpening() {
 }
 
 void MainWindow::applyMorphClosing() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2459,14 +2692,14 @@ void MainWindow::applyMorphClosing() {
     bool ok;
     int kernelSize = QInputDialog::getInt(this, "Closing", 
                                           "Enter kernel size (odd number):",
-                                          5, 3, 21, 2, &ok);
+                                          5, 3, MorphologyLib::MAX_KERNEL_SIZE, 2, &ok);
     if (!ok) return;
     
     saveProcessingState();
     updateStatus("Applying morphological closing...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    MorphologyLib::applyClosing(sourceImage, processedImage, kernelSize);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    MorphologyLib::applyClosing(sourceImage, processedImage.output(), kernelSize);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2474,6 +2707,7 @@ void MainWindow::applyMorphClosing() {
 }
 
 void MainWindow::applyMorphGradient() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2482,14 +2716,14 @@ void MainWindow::applyMorphGradient() {
     bool ok;
     int kernelSize = QInputDialog::getInt(this, "Morphological Gradient", 
                                           "Enter kernel size (odd number):",
-                                          5, 3, 21, 2, &ok);
+                                          5, 3, MorphologyLib::MAX_KERNEL_SIZE, 2, &ok);
     if (!ok) return;
     
     saveProcessingState();
     updateStatus("Applying morphological gradient...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    MorphologyLib::applyMorphGradient(sourceImage, processedImage, kernelSize);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    MorphologyLib::applyMorphGradient(sourceImage, processedImage.output(), kernelSize);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2497,6 +2731,7 @@ void MainWindow::applyMorphGradient() {
 }
 
 void MainWindow::applyTopHatTransform() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2505,14 +2740,14 @@ void MainWindow::applyTopHatTransform() {
     bool ok;
     int kernelSize = QInputDialog::getInt(this, "Top-Hat Transform", 
                                           "Enter kernel size (odd number):",
-                                          9, 3, 21, 2, &ok);
+                                          9, 3, MorphologyLib::MAX_KERNEL_SIZE, 2, &ok);
     if (!ok) return;
     
     saveProcessingState();
     updateStatus("Applying top-hat transform...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    MorphologyLib::applyTopHatTransform(sourceImage, processedImage, kernelSize);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    MorphologyLib::applyTopHatTransform(sourceImage, processedImage.output(), kernelSize);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2520,6 +2755,7 @@ void MainWindow::applyTopHatTransform() {
 }
 
 void MainWindow::applyBlackHatTransform() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2528,14 +2764,14 @@ void MainWindow::applyBlackHatTransform() {
     bool ok;
     int kernelSize = QInputDialog::getInt(this, "Black-Hat Transform", 
                                           "Enter kernel size (odd number):",
-                                          9, 3, 21, 2, &ok);
+                                          9, 3, MorphologyLib::MAX_KERNEL_SIZE, 2, &ok);
     if (!ok) return;
     
     saveProcessingState();
     updateStatus("Applying black-hat transform...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    MorphologyLib::applyBlackHatTransform(sourceImage, processedImage, kernelSize);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    MorphologyLib::applyBlackHatTransform(sourceImage, processedImage.output(), kernelSize);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2544,6 +2780,7 @@ void MainWindow::applyBlackHatTransform() {
 
 // Edge Detection Suite
 void MainWindow::applyPrewittEdge() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2552,8 +2789,8 @@ void MainWindow::applyPrewittEdge() {
     saveProcessingState();
     updateStatus("Applying Prewitt edge detection...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    MorphologyLib::applyPrewittOperator(sourceImage, processedImage);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    MorphologyLib::applyPrewittOperator(sourceImage, processedImage.output());
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2561,6 +2798,7 @@ void MainWindow::applyPrewittEdge() {
 }
 
 void MainWindow::applyRobertsEdge() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2569,8 +2807,8 @@ void MainWindow::applyRobertsEdge() {
     saveProcessingState();
     updateStatus("Applying Roberts Cross edge detection...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    MorphologyLib::applyRobertsCross(sourceImage, processedImage);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    MorphologyLib::applyRobertsCross(sourceImage, processedImage.output());
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2578,6 +2816,7 @@ void MainWindow::applyRobertsEdge() {
 }
 
 void MainWindow::applyLoGEdge() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2586,8 +2825,8 @@ void MainWindow::applyLoGEdge() {
     saveProcessingState();
     updateStatus("Applying Laplacian of Gaussian edge detection...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    MorphologyLib::applyLoG(sourceImage, processedImage, 5, 1.0);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    MorphologyLib::applyLoG(sourceImage, processedImage.output(), 5, 1.0);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2595,6 +2834,7 @@ void MainWindow::applyLoGEdge() {
 }
 
 void MainWindow::applyDoGEdge() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2603,8 +2843,8 @@ void MainWindow::applyDoGEdge() {
     saveProcessingState();
     updateStatus("Applying Difference of Gaussians edge detection...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    MorphologyLib::applyDoG(sourceImage, processedImage, 5, 1.0, 9, 2.0);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    MorphologyLib::applyDoG(sourceImage, processedImage.output(), 5, 1.0, 9, 2.0);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2612,6 +2852,7 @@ void MainWindow::applyDoGEdge() {
 }
 
 void MainWindow::applyZeroCrossingEdge() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2620,8 +2861,8 @@ void MainWindow::applyZeroCrossingEdge() {
     saveProcessingState();
     updateStatus("Applying zero-crossing edge detection...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    MorphologyLib::applyZeroCrossing(sourceImage, processedImage, 5);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    MorphologyLib::applyZeroCrossing(sourceImage, processedImage.output(), 5);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2630,6 +2871,7 @@ void MainWindow::applyZeroCrossingEdge() {
 
 // Segmentation Algorithms
 void MainWindow::applyAdaptiveThreshold() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2644,8 +2886,8 @@ void MainWindow::applyAdaptiveThreshold() {
     saveProcessingState();
     updateStatus("Applying adaptive thresholding...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    SegmentationLib::applyAdaptiveThreshold(sourceImage, processedImage, 255, 
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    SegmentationLib::applyAdaptiveThreshold(sourceImage, processedImage.output(), 255, 
                                            cv::ADAPTIVE_THRESH_GAUSSIAN_C, blockSize, 2);
     
     recentlyProcessed = true;
@@ -2654,6 +2896,7 @@ void MainWindow::applyAdaptiveThreshold() {
 }
 
 void MainWindow::applyMultiLevelThreshold() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2662,27 +2905,91 @@ void MainWindow::applyMultiLevelThreshold() {
     bool ok;
     int levels = QInputDialog::getInt(this, "Multi-Level Threshold", 
                                       "Enter number of levels:",
-                                      3, 2, 5, 1, &ok);
+                                      3, 2, SegmentationLib::MAX_THRESHOLD_LEVELS, 1, &ok);
     if (!ok) return;
     
     saveProcessingState();
     updateStatus("Applying multi-level thresholding...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    SegmentationLib::applyMultiLevelThreshold(sourceImage, processedImage, levels);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    SegmentationLib::applyMultiLevelThreshold(sourceImage, processedImage.output(), levels);
     
     recentlyProcessed = true;
     updateDisplay();
     updateStatus(QString("Multi-level thresholding applied (%1 levels)").arg(levels), "success");
 }
 
+void MainWindow::applyLocalThreshold() {
+    TRACE_OPERATION("ui");
+    if (!imageLoaded) {
+        QMessageBox::critical(this, "Error", "Please load an image first!");
+        return;
+    }
+    
+    QStringList methods;
+    methods << "Sauvola (documents, uneven lighting)"
+            << "Niblack (local mean + k * std dev)"
+            << "Bradley (fraction of local mean)"
+            << "Box Mean (local mean - C)";
+    
+    bool ok;
+    QString selection = QInputDialog::getItem(this, "Local Threshold",
+                                             "Select method:",
+                                             methods, 0, false, &ok);
+    if (!ok || selection.isEmpty()) return;
+    
+    int method;
+    double defaultK;
+    QString methodName;
+    if (selection.startsWith("Sauvola")) {
+        method = SegmentationLib::LOCAL_THRESH_SAUVOLA;
+        defaultK = 0.2;
+        methodName = "Sauvola";
+    } else if (selection.startsWith("Niblack")) {
+        method = SegmentationLib::LOCAL_THRESH_NIBLACK;
+        defaultK = -0.2;
+        methodName = "Niblack";
+    } else if (selection.startsWith("Bradley")) {
+        method = SegmentationLib::LOCAL_THRESH_BRADLEY;
+        defaultK = 0.15;
+        methodName = "Bradley";
+    } else {
+        method = SegmentationLib::LOCAL_THRESH_BOX_MEAN;
+        defaultK = 2.0;
+        methodName = "Box mean";
+    }
+    
+    int windowSize = QInputDialog::getInt(this, "Local Threshold",
+                                          "Enter window size (odd number):",
+                                          25, 3, 1001, 2, &ok);
+    if (!ok) return;
+    
+    double k = QInputDialog::getDouble(this, "Local Threshold",
+                                       "Enter k (C for box mean):",
+                                       defaultK, -50.0, 50.0, 2, &ok);
+    if (!ok) return;
+    
+    saveProcessingState();
+    updateStatus("Applying local thresholding...", "info", 50);
+    
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    // Tables are shared, so trying other settings on this image skips them
+    SegmentationLib::applyLocalThreshold(sourceImage, *DerivedImageCache::integral(sourceImage),
+                                         processedImage.output(), method, windowSize, k);
+    
+    recentlyProcessed = true;
+    updateDisplay();
+    updateStatus(QString("%1 local thresholding applied (window %2)").arg(methodName).arg(windowSize), "success");
+}
+
 void MainWindow::applyWatershedSegmentation() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    if (currentImage.channels() != 3) {
+    if (currentImage->channels() != 3) {
         QMessageBox::warning(this, "Warning", "Watershed requires a color image!");
         return;
     }
@@ -2696,8 +3003,8 @@ void MainWindow::applyWatershedSegmentation() {
     saveProcessingState();
     updateStatus("Applying watershed segmentation...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
-    SegmentationLib::applyWatershedAuto(sourceImage, processedImage, threshold / 100.0);
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    SegmentationLib::applyWatershedAuto(sourceImage, processedImage.output(), threshold / 100.0);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2705,12 +3012,13 @@ void MainWindow::applyWatershedSegmentation() {
 }
 
 void MainWindow::applyGrabCutSegmentation() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
     }
     
-    if (currentImage.channels() != 3) {
+    if (currentImage->channels() != 3) {
         QMessageBox::warning(this, "Warning", "GrabCut requires a color image!");
         return;
     }
@@ -2724,14 +3032,14 @@ void MainWindow::applyGrabCutSegmentation() {
     saveProcessingState();
     updateStatus("Applying GrabCut segmentation...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     
     // Create rectangle covering center 80% of image
-    int w = sourceImage.cols;
-    int h = sourceImage.rows;
+    int w = sourceImage->cols;
+    int h = sourceImage->rows;
     cv::Rect rect(w * 0.1, h * 0.1, w * 0.8, h * 0.8);
     
-    SegmentationLib::applyGrabCut(sourceImage, processedImage, rect, 5);
+    SegmentationLib::applyGrabCut(sourceImage, processedImage.output(), rect, 5);
     
     recentlyProcessed = true;
     updateDisplay();
@@ -2739,6 +3047,7 @@ void MainWindow::applyGrabCutSegmentation() {
 }
 
 void MainWindow::detectAndAnalyzeContours() {
+    TRACE_OPERATION("ui");
     if (!imageLoaded) {
         QMessageBox::critical(this, "Error", "Please load an image first!");
         return;
@@ -2747,38 +3056,38 @@ void MainWindow::detectAndAnalyzeContours() {
     saveProcessingState();
     updateStatus("Detecting and analyzing contours...", "info", 50);
     
-    cv::Mat sourceImage = processedImage.empty() ? currentImage : processedImage;
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
     
     // Convert to grayscale and threshold
     cv::Mat gray, binary;
     SegmentationLib::convertToGrayscale(sourceImage, gray);
     cv::threshold(gray, binary, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
     
-    // Find contours
-    std::vector<std::vector<cv::Point>> contours;
+    // Find contours (kept for hover hit-testing)
     std::vector<cv::Vec4i> hierarchy;
-    SegmentationLib::findAllContours(binary, contours, hierarchy);
+    SegmentationLib::findAllContours(binary, detectedContours, hierarchy);
     
-    // Filter by area (remove very small contours)
-    std::vector<std::vector<cv::Point>> filteredContours;
-    SegmentationLib::filterContoursByArea(contours, filteredContours, 100);
-    
-    // Calculate properties
-    auto properties = SegmentationLib::calculateAllContourProperties(filteredContours);
+    // Compute all features once, then filter by area (remove very small contours)
+    ContourTable table;
+    table.build(detectedContours);
+    contourTable = table.select(table.maskByArea(100));
+    contourIndex.build(contourTable);
+    const ContourTable& properties = contourTable;
     
     // Draw contours on result image
-    if (sourceImage.channels() == 1) {
-        cv::cvtColor(sourceImage, processedImage, cv::COLOR_GRAY2BGR);
+    cv::Mat& annotated = processedImage.output();
+    if (sourceImage->channels() == 1) {
+        cv::cvtColor(sourceImage.mat(), annotated, cv::COLOR_GRAY2BGR);
     } else {
-        processedImage = sourceImage.clone();
+        sourceImage->copyTo(annotated);
     }
     
-    SegmentationLib::drawContoursWithInfo(processedImage, filteredContours, 
+    SegmentationLib::drawContoursWithInfo(annotated, properties, 
                                          cv::Scalar(0, 255, 0), 2, true, true);
     
     recentlyProcessed = true;
     updateDisplay();
-    updateStatus(QString("Found %1 contours").arg(filteredContours.size()), "success");
+    updateStatus(QString("Found %1 contours").arg(properties.size()), "success");
     
     // Show contour statistics
     if (!properties.empty()) {
@@ -2788,9 +3097,9 @@ void MainWindow::detectAndAnalyzeContours() {
         int showCount = std::min(5, static_cast<int>(properties.size()));
         for (int i = 0; i < showCount; ++i) {
             stats += QString("Contour %1:\n").arg(i + 1);
-            stats += QString("  Area: %1\n").arg(properties[i].area, 0, 'f', 1);
-            stats += QString("  Perimeter: %1\n").arg(properties[i].perimeter, 0, 'f', 1);
-            stats += QString("  Circularity: %1\n\n").arg(properties[i].circularity, 0, 'f', 3);
+            stats += QString("  Area: %1\n").arg(properties.areas()[i], 0, 'f', 1);
+            stats += QString("  Perimeter: %1\n").arg(properties.perimeters()[i], 0, 'f', 1);
+            stats += QString("  Circularity: %1\n\n").arg(properties.circularities()[i], 0, 'f', 3);
         }
         
         if (properties.size() > showCount) {
@@ -2800,3 +3109,58 @@ void MainWindow::detectAndAnalyzeContours() {
         QMessageBox::information(this, "Contour Analysis", stats);
     }
 }
+
+void MainWindow::onProcessedCanvasHover(const QPoint& imagePos) {
+    if (contourIndex.empty()) return;
+    
+    int row = -1;
+    if (imagePos.x() >= 0 && imagePos.y() >= 0) {
+        row = contourIndex.query(cv::Point2f(imagePos.x(), imagePos.y()));
+    }
+    if (row == hoveredContour) return;
+    
+    hoveredContour = row;
+    if (row < 0) {
+        processedCanvas->clearHighlight();
+        statusLabel->setText(QString("Found %1 contours").arg(contourTable.size()));
+        return;
+    }
+    
+    processedCanvas->setHighlight(contourTable.contour(row));
+    statusLabel->setText(QString("Contour %1 | Area: %2 | Perimeter: %3 | Circularity: %4")
+                        .arg(row + 1)
+                        .arg(contourTable.areas()[row], 0, 'f', 1)
+                        .arg(contourTable.perimeters()[row], 0, 'f', 1)
+                        .arg(contourTable.circularities()[row], 0, 'f', 3));
+}
+
+void MainWindow::clearContourIndex() {
+    contourIndex.clear();
+    contourTable = ContourTable();
+    detectedContours.clear();
+    if (hoveredContour >= 0 && processedCanvas) {
+        processedCanvas->clearHighlight();
+    }
+    hoveredContour = -1;
+}
+
+void MainWindow::applyGeometricTransform(const cv::Matx33d& transform, const ImageHandle& rendered) {
+    TRACE_FUNCTION("ui");
+    ImageHandle sourceImage = processedImage.empty() ? currentImage : processedImage;
+    
+    // Keep chaining while only geometric transforms were applied
+    saveProcessingState(true);
+    if (transformStack.empty()) {
+        transformStack.setSource(sourceImage);
+    }
+    transformStack.append(transform);
+    
+    if (rendered.empty()) {
+        transformStack.render(processedImage.output());
+    } else {
+        processedImage = rendered;
+    }
+    
+    recentlyProcessed = true;
+    updateDisplay();
+}
@@ -20,6 +20,10 @@
 #include <QMessageBox>
 #include <opencv2/opencv.hpp>
 #include <memory>
+#include "processing/ContourIndex.h"
+#include "processing/ImageHandle.h"
+#include "processing/TransformStack.h"
+#include "processing/Trace.h"
 
 class ImageCanvas;
 class HistogramWidget;
@@ -32,6 +36,10 @@ class MainWindow : public QMainWindow {
 public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
+    
+    // File operations without dialogs (used by the slots and the tests)
+    bool openImage(const QString& fileName);
+    bool saveProcessedImage(const QString& fileName);
 
 private slots:
     // File operations
@@ -39,6 +47,8 @@ private slots:
     void saveImage();
     void resetImage();
     void undoLastOperation();
+    void exportPerformanceTrace();
+    void setResultSpilling(bool enabled);  // Opt-in disk spill of ResultCache
     
     // Auto Enhancement
     void autoEnhance();
@@ -119,9 +129,11 @@ private slots:
     void applyZeroCrossingEdge();
     void applyAdaptiveThreshold();
     void applyMultiLevelThreshold();
+    void applyLocalThreshold();
     void applyWatershedSegmentation();
     void applyGrabCutSegmentation();
     void detectAndAnalyzeContours();
+    void onProcessedCanvasHover(const QPoint& imagePos);
 
 private:
     void setupUI();
@@ -132,12 +144,18 @@ private:
     void createProcessingControls();
     void applyStyleSheet();
     
-    void updateDisplay();
+    void updateDisplay();   // Show the result and finish the timed operation
+    void refreshDisplay();  // Show the current images only (dialog previews)
     void updateStatus(const QString& message, 
                      const QString& type = "info", 
                      int progress = -1);
+    void updatePerformanceHud(const Trace::OperationSummary& summary);  // Status bar timings of the last operation
     void addTooltip(QWidget *widget, const QString& text);
-    void saveProcessingState();  // Save current state before processing
+    void saveProcessingState(bool keepTransforms = false);  // Save current state before processing
+    bool execOperationDialog(QDialog& dialog);  // Run a parameter dialog of a timed operation
+    void clearContourIndex();    // Drop hover data of the last contour analysis
+    void applyGeometricTransform(const cv::Matx33d& transform,
+                                 const ImageHandle& rendered = ImageHandle());
     
     QPixmap cvMatToQPixmap(const cv::Mat& mat);
     cv::Mat qPixmapToCvMat(const QPixmap& pixmap);
@@ -157,6 +175,7 @@ private:
     QLabel *processedInfoLabel;
     QLabel *processedTitleLabel;
     QLabel *statusLabel;
+    QLabel *perfLabel;
     QProgressBar *progressBar;
     
     // Menu and toolbar actions
@@ -175,10 +194,10 @@ private:
     QGroupBox *colorGroup;
     QGroupBox *morphologyGroup;
     
-    // Image data
-    cv::Mat originalImage;
-    cv::Mat currentImage;
-    cv::Mat processedImage;
+    // Image data (handles share pixels; see ImageHandle)
+    ImageHandle originalImage;
+    ImageHandle currentImage;
+    ImageHandle processedImage;
     QString imagePath;
     
     // Processing state
@@ -188,8 +207,18 @@ private:
     // Processing history
     QStringList processingHistory;
     QString lastOperation;
-    std::vector<cv::Mat> processingStack;  // Stack to store previous states
+    std::vector<ImageHandle> processingStack;  // Stack to store previous states
     int maxHistorySize = 10;  // Maximum undo steps
+    
+    // Contour analysis results for hover hit-testing on the processed canvas
+    std::vector<std::vector<cv::Point>> detectedContours;
+    ContourTable contourTable;
+    ContourIndex contourIndex;
+    int hoveredContour = -1;
+    
+    // Geometric transforms applied since the last other operation; chained
+    // transforms are resampled once from the image they started on
+    TransformStack transformStack;
 };
 
 #endif // MAINWINDOW_H
\ No newline at end of file
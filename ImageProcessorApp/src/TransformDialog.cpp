@@ -1,4 +1,6 @@
 #include "TransformDialog.h"
+#include "processing/TransformationsLib.h"
+#include "processing/ResultCache.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGroupBox>
@@ -7,8 +9,16 @@
 
 TransformDialog::TransformDialog(QWidget *parent, 
                                 TransformType type,
-                                const cv::Mat& inputImage)
-    : QDialog(parent), transformType(type), sourceImage(inputImage.clone()) {
+                                const ImageHandle& inputImage,
+                                const TransformStack* pending)
+    : QDialog(parent), transformType(type), sourceImage(inputImage),
+      transformMatrix(cv::Matx33d::eye()) {
+    
+    if (pending && !pending->empty()) {
+        baseStack = *pending;
+    } else {
+        baseStack.setSource(sourceImage);
+    }
     
     setWindowTitle("Image Transformation");
     setModal(true);
@@ -43,7 +53,7 @@ void TransformDialog::setupTranslationUI() {
     QGroupBox *xGroup = new QGroupBox("X Translation (Horizontal)");
     QVBoxLayout *xLayout = new QVBoxLayout(xGroup);
     
-    int maxOffset = std::max(sourceImage.cols, sourceImage.rows) / 2;
+    int maxOffset = std::max(sourceImage->cols, sourceImage->rows) / 2;
     
     sliderX = new QSlider(Qt::Horizontal);
     sliderX->setRange(-maxOffset, maxOffset);
@@ -264,45 +274,34 @@ void TransformDialog::applyTranslationPreview() {
     int tx = spinBoxX->value();
     int ty = spinBoxY->value();
     
-    cv::Mat M = (cv::Mat_<float>(2, 3) << 1, 0, tx, 0, 1, ty);
-    cv::warpAffine(sourceImage, resultImage, M, 
-                   sourceImage.size());
-    
-    emit previewRequested(resultImage);
+    renderPreview(TransformationsLib::translationMatrix(tx, ty));
 }
 
 void TransformDialog::applyRotationPreview() {
     double angle = angleSpinBox->value();
     
-    cv::Point2f center(sourceImage.cols / 2.0, sourceImage.rows / 2.0);
-    cv::Mat M = cv::getRotationMatrix2D(center, angle, 1.0);
-    cv::warpAffine(sourceImage, resultImage, M, sourceImage.size());
-    
-    emit previewRequested(resultImage);
+    renderPreview(TransformationsLib::rotationMatrix(sourceImage->size(), angle));
 }
 
 void TransformDialog::applyZoomPreview() {
     double zoom = zoomSpinBox->value();
     
-    cv::resize(sourceImage, resultImage, cv::Size(), zoom, zoom);
-    
-    // If zoomed out, pad with black
-    if (zoom < 1.0) {
-        cv::Mat padded = cv::Mat::zeros(sourceImage.size(), sourceImage.type());
-        int x_offset = (sourceImage.cols - resultImage.cols) / 2;
-        int y_offset = (sourceImage.rows - resultImage.rows) / 2;
-        
-        cv::Rect roi(x_offset, y_offset, resultImage.cols, resultImage.rows);
-        resultImage.copyTo(padded(roi));
-        resultImage = padded;
-    }
-    // If zoomed in, crop to original size
-    else if (zoom > 1.0) {
-        int x_offset = (resultImage.cols - sourceImage.cols) / 2;
-        int y_offset = (resultImage.rows - sourceImage.rows) / 2;
-        
-        cv::Rect roi(x_offset, y_offset, sourceImage.cols, sourceImage.rows);
-        resultImage = resultImage(roi);
+    renderPreview(TransformationsLib::zoomMatrix(sourceImage->size(), zoom));
+}
+
+void TransformDialog::renderPreview(const cv::Matx33d& transform) {
+    transformMatrix = transform;
+    
+    // One resample of the original pixels, including pending transforms
+    TransformStack stack = baseStack;
+    stack.append(transform);
+    
+    // Sliding back to an earlier value reuses its rendering
+    ResultCache::Key key("TransformStack::render", stack.source());
+    key.add("matrix", stack.matrix()).add("interpolation", static_cast<int>(cv::INTER_LINEAR));
+    if (!ResultCache::lookup(key, resultImage)) {
+        stack.render(resultImage.output());
+        ResultCache::store(key, resultImage);
     }
     
     emit previewRequested(resultImage);
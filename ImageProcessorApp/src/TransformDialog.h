@@ -12,6 +12,8 @@
 #include <QPushButton>
 #include <opencv2/opencv.hpp>
 #include <functional>
+#include "processing/ImageHandle.h"
+#include "processing/TransformStack.h"
 
 class TransformDialog : public QDialog {
     Q_OBJECT
@@ -23,14 +25,20 @@ public:
         Zoom
     };
     
+    /**
+     * @param pending Transforms not yet resampled; previews compose with them
+     *                and resample their source once (optional)
+     */
     explicit TransformDialog(QWidget *parent, 
                             TransformType type,
-                            const cv::Mat& inputImage);
+                            const ImageHandle& inputImage,
+                            const TransformStack* pending = nullptr);
     
-    cv::Mat getResultImage() const { return resultImage; }
+    ImageHandle getResultImage() const { return resultImage; }
+    cv::Matx33d getTransformMatrix() const { return transformMatrix; }
     
 signals:
-    void previewRequested(const cv::Mat& preview);
+    void previewRequested(const ImageHandle& preview);
 
 private slots:
     void onParameterChanged();
@@ -44,10 +52,13 @@ private:
     void applyTranslationPreview();
     void applyRotationPreview();
     void applyZoomPreview();
+    void renderPreview(const cv::Matx33d& transform);
     
     TransformType transformType;
-    cv::Mat sourceImage;
-    cv::Mat resultImage;
+    ImageHandle sourceImage;
+    ImageHandle resultImage;
+    TransformStack baseStack;
+    cv::Matx33d transformMatrix;
     
     // UI elements
     QSlider *sliderX;
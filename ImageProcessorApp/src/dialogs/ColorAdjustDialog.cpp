@@ -3,9 +3,9 @@
 #include <QGridLayout>
 #include <QMessageBox>
 
-ColorAdjustDialog::ColorAdjustDialog(const cv::Mat& originalImage, QWidget *parent)
+ColorAdjustDialog::ColorAdjustDialog(const ImageHandle& originalImage, QWidget *parent)
     : QDialog(parent),
-      originalImage(originalImage.clone()),
+      originalImage(originalImage),
       brightnessValue(0),
       contrastValue(1.0),
       saturationValue(100),
@@ -21,13 +21,13 @@ ColorAdjustDialog::ColorAdjustDialog(const cv::Mat& originalImage, QWidget *pare
     applyStyleSheet();
     
     // Initialize adjusted image
-    adjustedImage = originalImage.clone();
+    adjustedImage = originalImage;
 }
 
 ColorAdjustDialog::~ColorAdjustDialog() {
 }
 
-cv::Mat ColorAdjustDialog::getAdjustedImage() const {
+ImageHandle ColorAdjustDialog::getAdjustedImage() const {
     return adjustedImage;
 }
 
@@ -309,7 +309,7 @@ void ColorAdjustDialog::onResetClicked() {
     temperatureValue = 0;
     
     // Reset image
-    adjustedImage = originalImage.clone();
+    adjustedImage = originalImage;
     
     updatePreview();
 }
@@ -322,7 +322,7 @@ void ColorAdjustDialog::onApplyClicked() {
 
 void ColorAdjustDialog::onCancelClicked() {
     // Restore original image
-    adjustedImage = originalImage.clone();
+    adjustedImage = originalImage;
     reject();
 }
 
@@ -331,9 +331,9 @@ void ColorAdjustDialog::updatePreview() {
     emit previewRequested(adjustedImage);
 }
 
-cv::Mat ColorAdjustDialog::processImage() {
+ImageHandle ColorAdjustDialog::processImage() {
     if (originalImage.empty()) {
-        return cv::Mat();
+        return ImageHandle();
     }
     
     cv::Mat result;
@@ -341,7 +341,7 @@ cv::Mat ColorAdjustDialog::processImage() {
     try {
         // Apply all adjustments
         // For color adjustments (saturation, hue), we need 3-channel image
-        if (originalImage.channels() == 3) {
+        if (originalImage->channels() == 3) {
             // Apply brightness and contrast first
             cv::Mat temp1, temp2;
             ColorProcessingLib::adjustBrightness(originalImage, temp1, brightnessValue);
@@ -364,11 +364,11 @@ cv::Mat ColorAdjustDialog::processImage() {
             ColorProcessingLib::adjustContrast(temp, result, contrastValue);
         }
         
-        return result;
+        return ImageHandle(result);
     } catch (const cv::Exception& e) {
         QMessageBox::warning(const_cast<ColorAdjustDialog*>(this), 
                            "Processing Error", 
                            QString("Error adjusting colors: %1").arg(e.what()));
-        return originalImage.clone();
+        return originalImage;
     }
 }
@@ -12,6 +12,7 @@
 #include <QGroupBox>
 #include <QCheckBox>
 #include <opencv2/opencv.hpp>
+#include "../processing/ImageHandle.h"
 
 /**
  * @brief ColorAdjustDialog provides an interactive Qt dialog for color adjustments
@@ -38,7 +39,7 @@ public:
      * @param originalImage Input image to adjust
      * @param parent Parent widget
      */
-    explicit ColorAdjustDialog(const cv::Mat& originalImage, QWidget *parent = nullptr);
+    explicit ColorAdjustDialog(const ImageHandle& originalImage, QWidget *parent = nullptr);
     
     /**
      * @brief Destructor
@@ -49,7 +50,7 @@ public:
      * @brief Get the adjusted image result
      * @return Processed image with applied adjustments
      */
-    cv::Mat getAdjustedImage() const;
+    ImageHandle getAdjustedImage() const;
     
     /**
      * @brief Get brightness adjustment value
@@ -86,7 +87,7 @@ signals:
      * @brief Emitted when user requests preview update
      * @param adjusted Adjusted image for preview
      */
-    void previewRequested(const cv::Mat& adjusted);
+    void previewRequested(const ImageHandle& adjusted);
 
 private slots:
     /**
@@ -168,11 +169,11 @@ private:
      * @brief Process image with current adjustment values
      * @return Processed image
      */
-    cv::Mat processImage();
+    ImageHandle processImage();
     
-    // Original and result images
-    cv::Mat originalImage;
-    cv::Mat adjustedImage;
+    // Original and result images (shared with the caller, never copied)
+    ImageHandle originalImage;
+    ImageHandle adjustedImage;
     
     // Adjustment values
     int brightnessValue;
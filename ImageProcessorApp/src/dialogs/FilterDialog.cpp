@@ -1,17 +1,20 @@
 #include "FilterDialog.h"
 #include "../filters/ImageFilters.h"
+#include "../processing/NoiseEstimator.h"
 #include <QGridLayout>
 #include <QMessageBox>
+#include <algorithm>
 
-FilterDialog::FilterDialog(const cv::Mat& originalImage, FilterType filterType, QWidget *parent)
+FilterDialog::FilterDialog(const ImageHandle& originalImage, FilterType filterType, QWidget *parent)
     : QDialog(parent),
-      originalImage(originalImage.clone()),
+      originalImage(originalImage),
       filterType(filterType),
       medianKernelSize(5),
       bilateralD(9),
       bilateralSigmaColor(75.0),
       bilateralSigmaSpace(75.0),
       nlmH(10.0f),
+      nlmDefaultH(10.0f),
       nlmTemplateWindow(7),
       nlmSearchWindow(21),
       morphKernelSize(5),
@@ -34,16 +37,28 @@ FilterDialog::FilterDialog(const cv::Mat& originalImage, FilterType filterType,
     setModal(true);
     resize(500, 400);
     
+    // Start non-local means from the measured noise level
+    if (filterType == NON_LOCAL_MEANS) {
+        double h = NoiseEstimator::recommendedNlmStrength(NoiseEstimator::estimateSigma(originalImage));
+        nlmDefaultH = static_cast<float>(std::max(1, std::min(30, cvRound(h))));
+        nlmH = nlmDefaultH;
+    }
+    
     setupUI();
     applyStyleSheet();
     
-    filteredImage = originalImage.clone();
+    filteredImage = originalImage;
 }
 
 FilterDialog::~FilterDialog() {
 }
 
-cv::Mat FilterDialog::getFilteredImage() const {
+ImageHandle FilterDialog::getFilteredImage() const {
+    return filteredImage;
+}
+
+ImageHandle FilterDialog::renderResult() {
+    filteredImage = processImage();
     return filteredImage;
 }
 
@@ -194,7 +209,8 @@ void FilterDialog::setupNLMUI() {
     parametersGroup = new QGroupBox("Denoising Parameters");
     QVBoxLayout *layout = new QVBoxLayout(parametersGroup);
     
-    QGroupBox *hGroup = createSliderGroup("Filter Strength (h)", 1, 30, 10, slider1, label1);
+    QGroupBox *hGroup = createSliderGroup("Filter Strength (h)", 1, 30,
+                                              static_cast<int>(nlmDefaultH), slider1, label1);
     QGroupBox *templateGroup = createSliderGroup("Template Window", 5, 11, 7, slider2, label2);
     QGroupBox *searchGroup = createSliderGroup("Search Window", 11, 31, 21, slider3, label3);
     
@@ -526,10 +542,10 @@ void FilterDialog::onResetClicked() {
             if (slider3) slider3->setValue(75);
             break;
         case NON_LOCAL_MEANS:
-            nlmH = 10.0f;
+            nlmH = nlmDefaultH;
             nlmTemplateWindow = 7;
             nlmSearchWindow = 21;
-            if (slider1) slider1->setValue(10);
+            if (slider1) slider1->setValue(static_cast<int>(nlmDefaultH));
             if (slider2) slider2->setValue(7);
             if (slider3) slider3->setValue(21);
             break;
@@ -561,17 +577,17 @@ void FilterDialog::onResetClicked() {
             break;
     }
     
-    filteredImage = originalImage.clone();
+    filteredImage = originalImage;
     updatePreview();
 }
 
 void FilterDialog::onApplyClicked() {
-    filteredImage = processImage();
+    // The caller renders the result once the dialog is closed (see renderResult)
     accept();
 }
 
 void FilterDialog::onCancelClicked() {
-    filteredImage = originalImage.clone();
+    filteredImage = originalImage;
     reject();
 }
 
@@ -580,9 +596,16 @@ void FilterDialog::updatePreview() {
     emit previewRequested(filteredImage);
 }
 
-cv::Mat FilterDialog::processImage() {
+ImageHandle FilterDialog::processImage() {
     if (originalImage.empty()) {
-        return cv::Mat();
+        return ImageHandle();
+    }
+    
+    // Going back to an earlier setting returns the stored result
+    const ResultCache::Key key = cacheKey();
+    ImageHandle cached;
+    if (ResultCache::lookup(key, cached)) {
+        return cached;
     }
     
     cv::Mat result;
@@ -629,11 +652,56 @@ cv::Mat FilterDialog::processImage() {
                 break;
         }
         
-        return result;
+        const ImageHandle handle(result);
+        ResultCache::store(key, handle);
+        return handle;
     } catch (const cv::Exception& e) {
         QMessageBox::warning(const_cast<FilterDialog*>(this), 
                            "Processing Error", 
                            QString("Error applying filter: %1").arg(e.what()));
-        return originalImage.clone();
+        return originalImage;
+    }
+}
+
+ResultCache::Key FilterDialog::cacheKey() const {
+    ResultCache::Key key("FilterDialog/" + std::to_string(static_cast<int>(filterType)),
+                         originalImage);
+    
+    // Only the parameters the filter reads
+    switch (filterType) {
+        case MEDIAN:
+            key.add("ksize", medianKernelSize);
+            break;
+        case BILATERAL:
+            key.add("d", bilateralD)
+               .add("sigmaColor", bilateralSigmaColor)
+               .add("sigmaSpace", bilateralSigmaSpace);
+            break;
+        case NON_LOCAL_MEANS:
+            key.add("h", static_cast<double>(nlmH))
+               .add("templateWindow", nlmTemplateWindow)
+               .add("searchWindow", nlmSearchWindow);
+            break;
+        case MORPHOLOGICAL_OPENING:
+        case MORPHOLOGICAL_CLOSING:
+            key.add("ksize", morphKernelSize).add("shape", morphKernelShape);
+            break;
+        case MORPHOLOGICAL_GRADIENT:
+        case TOP_HAT:
+        case BLACK_HAT:
+            key.add("ksize", morphKernelSize);
+            break;
+        case UNSHARP_MASK:
+            key.add("sigma", unsharpSigma)
+               .add("amount", unsharpAmount)
+               .add("threshold", unsharpThreshold);
+            break;
+        case HIGH_PASS:
+            key.add("ksize", highPassKernelSize);
+            break;
+        case CUSTOM_SHARPEN:
+            key.add("strength", sharpenStrength);
+            break;
     }
+    return key;
 }
@@ -13,6 +13,8 @@
 #include <QCheckBox>
 #include <QComboBox>
 #include <opencv2/opencv.hpp>
+#include "../processing/ImageHandle.h"
+#include "../processing/ResultCache.h"
 
 /**
  * @brief FilterDialog provides an interactive Qt dialog for advanced filter adjustment
@@ -50,7 +52,7 @@ public:
      * @param filterType Type of filter to configure
      * @param parent Parent widget
      */
-    explicit FilterDialog(const cv::Mat& originalImage, FilterType filterType, 
+    explicit FilterDialog(const ImageHandle& originalImage, FilterType filterType, 
                          QWidget *parent = nullptr);
     
     /**
@@ -60,9 +62,18 @@ public:
     
     /**
      * @brief Get the filtered image result
+     * @return Processed image as last rendered (preview or renderResult)
+     */
+    ImageHandle getFilteredImage() const;
+    
+    /**
+     * @brief Filter the original image with the current parameters
      * @return Processed image with applied filter
+     *
+     * Called after the dialog is accepted, so the work is timed apart
+     * from the dialog session; a previewed setting is a cache hit.
      */
-    cv::Mat getFilteredImage() const;
+    ImageHandle renderResult();
     
     // Median Filter parameters
     int getMedianKernelSize() const { return medianKernelSize; }
@@ -97,7 +108,7 @@ signals:
      * @brief Emitted when user requests preview update
      * @param filtered Filtered image for preview
      */
-    void previewRequested(const cv::Mat& filtered);
+    void previewRequested(const ImageHandle& filtered);
 
 private slots:
     void onParameterChanged();
@@ -124,11 +135,12 @@ private:
                                       QSlider*& slider, QLabel*& valueLabel);
     
     void applyStyleSheet();
-    cv::Mat processImage();
+    ImageHandle processImage();
+    ResultCache::Key cacheKey() const;
     
-    // Original and result images
-    cv::Mat originalImage;
-    cv::Mat filteredImage;
+    // Original and result images (shared with the caller, never copied)
+    ImageHandle originalImage;
+    ImageHandle filteredImage;
     FilterType filterType;
     
     // Common parameters
@@ -137,6 +149,7 @@ private:
     double bilateralSigmaColor;
     double bilateralSigmaSpace;
     float nlmH;
+    float nlmDefaultH;       // Suggested from the estimated noise level
     int nlmTemplateWindow;
     int nlmSearchWindow;
     int morphKernelSize;
@@ -1,4 +1,6 @@
 #include "ImageFilters.h"
+#include "processing/MorphologyEngine.h"
+#include "processing/Trace.h"
 #include <opencv2/photo.hpp>
 #include <cmath>
 #include <algorithm>
@@ -7,12 +9,14 @@
 namespace ImageFilters {
 
 void applyTraditionalFilter(const cv::Mat& input, cv::Mat& output, int kernelSize) {
+    TRACE_FUNCTION("filters");
     // Traditional averaging filter with equal weights
     cv::Mat kernel = cv::Mat::ones(kernelSize, kernelSize, CV_32F) / float(kernelSize * kernelSize);
     cv::filter2D(input, output, -1, kernel);
 }
 
 void applyPyramidalFilter(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("filters");
     // Pyramidal filter with weights increasing toward center
     cv::Mat kernel = (cv::Mat_<float>(5, 5) << 
         1, 2, 3, 2, 1,
@@ -27,6 +31,7 @@ void applyPyramidalFilter(const cv::Mat& input, cv::Mat& output) {
 }
 
 void applyCircularFilter(const cv::Mat& input, cv::Mat& output, float radius) {
+    TRACE_FUNCTION("filters");
     // Circular filter - only pixels within radius get weighted
     int kernelSize = static_cast<int>(radius * 2) + 1;
     cv::Mat kernel = cv::Mat::zeros(kernelSize, kernelSize, CV_32F);
@@ -48,6 +53,7 @@ void applyCircularFilter(const cv::Mat& input, cv::Mat& output, float radius) {
 }
 
 void applyConeFilter(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("filters");
     // Cone filter - weights decrease linearly from center
     int kernelSize = 5;
     cv::Mat kernel = cv::Mat::zeros(kernelSize, kernelSize, CV_32F);
@@ -68,6 +74,7 @@ void applyConeFilter(const cv::Mat& input, cv::Mat& output) {
 }
 
 void applyLaplacianFilter(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("filters");
     // Laplacian filter kernel (3x3)
     cv::Mat kernel_L = (cv::Mat_<float>(3, 3) << 
         1, 1, 1,
@@ -82,6 +89,7 @@ void applyLaplacianFilter(const cv::Mat& input, cv::Mat& output) {
 }
 
 void applySobelFilter(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("filters");
     // Sobel filter kernels
     cv::Mat kernel_TH = (cv::Mat_<int>(3, 3) << 
         -1, -2, -1,
@@ -118,6 +126,7 @@ void applySobelFilter(const cv::Mat& input, cv::Mat& output) {
 // =============================================================================
 
 void addGaussianNoise(const cv::Mat& input, cv::Mat& output, double mean, double stddev) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     cv::Mat noise = cv::Mat(input.size(), input.type());
@@ -132,6 +141,7 @@ void addGaussianNoise(const cv::Mat& input, cv::Mat& output, double mean, double
 }
 
 void addSaltPepperNoise(const cv::Mat& input, cv::Mat& output, double density) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     output = input.clone();
@@ -165,6 +175,7 @@ void addSaltPepperNoise(const cv::Mat& input, cv::Mat& output, double density) {
 }
 
 void addPoissonNoise(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     cv::Mat temp;
@@ -197,6 +208,7 @@ void addPoissonNoise(const cv::Mat& input, cv::Mat& output) {
 }
 
 void addSpeckleNoise(const cv::Mat& input, cv::Mat& output, double variance) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     cv::Mat noise = cv::Mat(input.size(), CV_32F);
@@ -226,6 +238,7 @@ void addSpeckleNoise(const cv::Mat& input, cv::Mat& output, double variance) {
 // =============================================================================
 
 void applyMedianFilter(const cv::Mat& input, cv::Mat& output, int kernelSize) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     // Ensure kernel size is odd
@@ -239,6 +252,7 @@ void applyMedianFilter(const cv::Mat& input, cv::Mat& output, int kernelSize) {
 
 void applyBilateralFilter(const cv::Mat& input, cv::Mat& output, 
                           int d, double sigmaColor, double sigmaSpace) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     cv::bilateralFilter(input, output, d, sigmaColor, sigmaSpace);
@@ -247,6 +261,7 @@ void applyBilateralFilter(const cv::Mat& input, cv::Mat& output,
 void applyNonLocalMeansDenoising(const cv::Mat& input, cv::Mat& output,
                                  float h, int templateWindowSize, 
                                  int searchWindowSize) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     if (input.channels() == 1) {
@@ -258,42 +273,47 @@ void applyNonLocalMeansDenoising(const cv::Mat& input, cv::Mat& output,
 
 void applyMorphologicalOpening(const cv::Mat& input, cv::Mat& output, 
                                int kernelSize, int kernelShape) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     cv::Mat kernel = createStructuringElement(kernelShape, kernelSize);
-    cv::morphologyEx(input, output, cv::MORPH_OPEN, kernel);
+    MorphologyEngine::morphologyEx(input, output, cv::MORPH_OPEN, kernel);
 }
 
 void applyMorphologicalClosing(const cv::Mat& input, cv::Mat& output, 
                                int kernelSize, int kernelShape) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     cv::Mat kernel = createStructuringElement(kernelShape, kernelSize);
-    cv::morphologyEx(input, output, cv::MORPH_CLOSE, kernel);
+    MorphologyEngine::morphologyEx(input, output, cv::MORPH_CLOSE, kernel);
 }
 
 void applyMorphologicalGradient(const cv::Mat& input, cv::Mat& output, int kernelSize) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, 
                                                cv::Size(kernelSize, kernelSize));
-    cv::morphologyEx(input, output, cv::MORPH_GRADIENT, kernel);
+    MorphologyEngine::morphologyEx(input, output, cv::MORPH_GRADIENT, kernel);
 }
 
 void applyTopHat(const cv::Mat& input, cv::Mat& output, int kernelSize) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, 
                                                cv::Size(kernelSize, kernelSize));
-    cv::morphologyEx(input, output, cv::MORPH_TOPHAT, kernel);
+    MorphologyEngine::morphologyEx(input, output, cv::MORPH_TOPHAT, kernel);
 }
 
 void applyBlackHat(const cv::Mat& input, cv::Mat& output, int kernelSize) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, 
                                                cv::Size(kernelSize, kernelSize));
-    cv::morphologyEx(input, output, cv::MORPH_BLACKHAT, kernel);
+    MorphologyEngine::morphologyEx(input, output, cv::MORPH_BLACKHAT, kernel);
 }
 
 // =============================================================================
@@ -302,6 +322,7 @@ void applyBlackHat(const cv::Mat& input, cv::Mat& output, int kernelSize) {
 
 void applyUnsharpMask(const cv::Mat& input, cv::Mat& output, 
                       double sigma, double amount, int threshold) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     // Create blurred version
@@ -328,6 +349,7 @@ void applyUnsharpMask(const cv::Mat& input, cv::Mat& output,
 }
 
 void applyHighPassFilter(const cv::Mat& input, cv::Mat& output, int kernelSize) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     // Ensure kernel size is odd
@@ -350,6 +372,7 @@ void applyHighPassFilter(const cv::Mat& input, cv::Mat& output, int kernelSize)
 }
 
 void applyCustomSharpen(const cv::Mat& input, cv::Mat& output, int strength) {
+    TRACE_FUNCTION("filters");
     if (!isValidImage(input)) return;
     
     // Clamp strength to 0-200
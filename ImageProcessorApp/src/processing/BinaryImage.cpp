@@ -0,0 +1,196 @@
+#include "BinaryImage.h"
+#include "Trace.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+
+const int BinaryImage::BITS_PER_WORD;
+
+BinaryImage::BinaryImage() : rowCount(0), colCount(0), words(0) {
+}
+
+BinaryImage::BinaryImage(int rows, int cols, bool value) : rowCount(0), colCount(0), words(0) {
+    create(rows, cols);
+    fill(value);
+}
+
+// =============================================================================
+// CONVERSIONS
+// =============================================================================
+
+BinaryImage BinaryImage::fromMat(const cv::Mat& input) {
+    BinaryImage result;
+    if (input.empty()) {
+        return result;
+    }
+
+    cv::Mat gray;
+    if (input.channels() == 3) {
+        cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = input;
+    }
+    if (gray.type() != CV_8UC1) {
+        return result;
+    }
+
+    // Non-zero means foreground, i.e. "above 0"
+    return fromThreshold(gray, 0);
+}
+
+BinaryImage BinaryImage::fromThreshold(const cv::Mat& gray, double threshold, bool inverted) {
+    TRACE_FUNCTION("morphology");
+    BinaryImage result;
+    if (gray.empty() || gray.type() != CV_8UC1) {
+        return result;
+    }
+
+    result.create(gray.rows, gray.cols);
+
+    // Same integer rule as cv::threshold on 8-bit data
+    const int level = static_cast<int>(std::floor(threshold));
+    const int cols = gray.cols;
+
+    cv::parallel_for_(cv::Range(0, gray.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const uchar* src = gray.ptr<uchar>(y);
+            Word* dst = result.row(y);
+
+            for (int w = 0; w < result.words; ++w) {
+                const int x0 = w * BITS_PER_WORD;
+                const int count = std::min(BITS_PER_WORD, cols - x0);
+                Word word = 0;
+                for (int b = 0; b < count; ++b) {
+                    bool above = src[x0 + b] > level;
+                    word |= static_cast<Word>(above != inverted) << b;
+                }
+                dst[w] = word;
+            }
+        }
+    });
+
+    return result;
+}
+
+bool BinaryImage::isBinaryMask(const cv::Mat& input) {
+    if (input.empty() || input.type() != CV_8UC1) {
+        return false;
+    }
+
+    for (int y = 0; y < input.rows; ++y) {
+        const uchar* src = input.ptr<uchar>(y);
+        for (int x = 0; x < input.cols; ++x) {
+            if (src[x] != 0 && src[x] != 255) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void BinaryImage::toMat(cv::Mat& output, uchar foreground) const {
+    TRACE_FUNCTION("morphology");
+    if (empty()) {
+        output = cv::Mat();
+        return;
+    }
+
+    output.create(rowCount, colCount, CV_8UC1);
+
+    cv::parallel_for_(cv::Range(0, rowCount), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const Word* src = row(y);
+            uchar* dst = output.ptr<uchar>(y);
+
+            for (int w = 0; w < words; ++w) {
+                const int x0 = w * BITS_PER_WORD;
+                const int count = std::min(BITS_PER_WORD, colCount - x0);
+                const Word word = src[w];
+                for (int b = 0; b < count; ++b) {
+                    dst[x0 + b] = ((word >> b) & 1) ? foreground : 0;
+                }
+            }
+        }
+    });
+}
+
+// =============================================================================
+// ACCESS
+// =============================================================================
+
+void BinaryImage::create(int rows, int cols) {
+    rowCount = std::max(0, rows);
+    colCount = std::max(0, cols);
+    words = (colCount + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    bits.assign(static_cast<size_t>(rowCount) * words, 0);
+}
+
+void BinaryImage::fill(bool value) {
+    if (empty()) {
+        return;
+    }
+
+    std::fill(bits.begin(), bits.end(), value ? ~Word(0) : Word(0));
+    if (value) {
+        const Word mask = lastWordMask();
+        for (int y = 0; y < rowCount; ++y) {
+            row(y)[words - 1] &= mask;
+        }
+    }
+}
+
+BinaryImage::Word BinaryImage::lastWordMask() const {
+    const int tail = colCount % BITS_PER_WORD;
+    return tail == 0 ? ~Word(0) : ((Word(1) << tail) - 1);
+}
+
+bool BinaryImage::get(int x, int y) const {
+    if (x < 0 || y < 0 || x >= colCount || y >= rowCount) {
+        return false;
+    }
+    return (row(y)[x / BITS_PER_WORD] >> (x % BITS_PER_WORD)) & 1;
+}
+
+void BinaryImage::set(int x, int y, bool value) {
+    if (x < 0 || y < 0 || x >= colCount || y >= rowCount) {
+        return;
+    }
+
+    Word& word = row(y)[x / BITS_PER_WORD];
+    const Word bit = Word(1) << (x % BITS_PER_WORD);
+    if (value) {
+        word |= bit;
+    } else {
+        word &= ~bit;
+    }
+}
+
+int BinaryImage::countNonZero() const {
+    size_t count = 0;
+    for (Word word : bits) {
+        count += std::bitset<BITS_PER_WORD>(word).count();
+    }
+    return static_cast<int>(count);
+}
+
+BinaryImage BinaryImage::inverted() const {
+    BinaryImage result;
+    result.rowCount = rowCount;
+    result.colCount = colCount;
+    result.words = words;
+    result.bits.resize(bits.size());
+
+    if (empty()) {
+        return result;
+    }
+
+    const Word mask = lastWordMask();
+    for (size_t i = 0; i < bits.size(); ++i) {
+        result.bits[i] = ~bits[i];
+    }
+    for (int y = 0; y < rowCount; ++y) {
+        result.row(y)[words - 1] &= mask;
+    }
+
+    return result;
+}
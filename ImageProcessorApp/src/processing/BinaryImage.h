@@ -0,0 +1,101 @@
+#ifndef BINARYIMAGE_H
+#define BINARYIMAGE_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Bit-packed binary image (1 bit per pixel)
+ *
+ * Pixels are stored row by row in 64-bit words, least significant bit first,
+ * so a binary mask takes 1/8 of the memory of a CV_8U mask and morphology
+ * can process 64 pixels per instruction. Bits past the last column of each
+ * row are always kept at zero.
+ */
+class BinaryImage {
+public:
+    typedef std::uint64_t Word;
+    static const int BITS_PER_WORD = 64;
+
+    BinaryImage();
+    BinaryImage(int rows, int cols, bool value = false);
+
+    // ==========================================================================
+    // CONVERSIONS
+    // ==========================================================================
+
+    /**
+     * @brief Pack a mask, treating every non-zero pixel as foreground
+     * @param input Source mask (CV_8UC1; color images are converted to grayscale)
+     * @return Packed binary image
+     */
+    static BinaryImage fromMat(const cv::Mat& input);
+
+    /**
+     * @brief Threshold and pack in one pass (same rule as cv::THRESH_BINARY)
+     * @param gray Source grayscale image (CV_8UC1)
+     * @param threshold Pixels strictly above the threshold become foreground
+     * @param inverted Select pixels at or below the threshold instead
+     * @return Packed binary image
+     */
+    static BinaryImage fromThreshold(const cv::Mat& gray, double threshold,
+                                     bool inverted = false);
+
+    /**
+     * @brief Check whether an image is a CV_8UC1 mask holding only 0 and 255
+     * @param input Image to check
+     * @return true if packing and unpacking the image is lossless
+     */
+    static bool isBinaryMask(const cv::Mat& input);
+
+    /**
+     * @brief Unpack into a CV_8UC1 mask
+     * @param output Output mask (foreground pixels set to foreground, others to 0)
+     * @param foreground Value written for foreground pixels
+     */
+    void toMat(cv::Mat& output, uchar foreground = 255) const;
+
+    // ==========================================================================
+    // ACCESS
+    // ==========================================================================
+
+    void create(int rows, int cols);
+    void fill(bool value);
+
+    bool empty() const { return bits.empty(); }
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    cv::Size size() const { return cv::Size(colCount, rowCount); }
+    int wordsPerRow() const { return words; }
+    size_t byteSize() const { return bits.size() * sizeof(Word); }
+
+    Word* row(int y) { return &bits[static_cast<size_t>(y) * words]; }
+    const Word* row(int y) const { return &bits[static_cast<size_t>(y) * words]; }
+
+    /**
+     * @brief Mask of the valid bits in the last word of every row
+     */
+    Word lastWordMask() const;
+
+    bool get(int x, int y) const;
+    void set(int x, int y, bool value);
+
+    /**
+     * @brief Count foreground pixels
+     */
+    int countNonZero() const;
+
+    /**
+     * @brief Return the complement (foreground and background swapped)
+     */
+    BinaryImage inverted() const;
+
+private:
+    int rowCount;
+    int colCount;
+    int words;
+    std::vector<Word> bits;
+};
+
+#endif // BINARYIMAGE_H
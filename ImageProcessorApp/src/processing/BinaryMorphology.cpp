@@ -0,0 +1,395 @@
+#include "BinaryMorphology.h"
+#include "MorphologyEngine.h"
+#include "Trace.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+typedef BinaryImage::Word Word;
+
+const Word ALL_ONES = ~Word(0);
+
+/**
+ * Word i of a row as seen by a shift: words outside the row, and the unused
+ * bits of the last word, read as `fillWord` (the identity of the operation).
+ */
+inline Word sourceWord(const Word* src, int i, int words, Word lastMask, Word fillWord) {
+    if (i < 0 || i >= words) {
+        return fillWord;
+    }
+    if (i == words - 1) {
+        return (src[i] & lastMask) | (fillWord & ~lastMask);
+    }
+    return src[i];
+}
+
+inline Word tailMask(int bits) {
+    const int tail = bits % BinaryImage::BITS_PER_WORD;
+    return tail == 0 ? ~Word(0) : ((Word(1) << tail) - 1);
+}
+
+inline int wordCount(int bits) {
+    return (bits + BinaryImage::BITS_PER_WORD - 1) / BinaryImage::BITS_PER_WORD;
+}
+
+/**
+ * dst[x] = src[x + d] for every pixel x of a `dstBits` wide row; src pixels
+ * outside its `srcBits` read as `fillWord`.
+ */
+void shiftRow(const Word* src, int srcBits, Word* dst, int dstBits, int d, Word fillWord) {
+    const int bitsPerWord = BinaryImage::BITS_PER_WORD;
+    const int srcWords = wordCount(srcBits);
+    const int dstWords = wordCount(dstBits);
+    const Word srcMask = tailMask(srcBits);
+    const int q = d >= 0 ? d / bitsPerWord : -((-d + bitsPerWord - 1) / bitsPerWord);
+    const int r = d - q * bitsPerWord;
+
+    for (int w = 0; w < dstWords; ++w) {
+        Word low = sourceWord(src, w + q, srcWords, srcMask, fillWord);
+        if (r == 0) {
+            dst[w] = low;
+        } else {
+            Word high = sourceWord(src, w + q + 1, srcWords, srcMask, fillWord);
+            dst[w] = (low >> r) | (high << (bitsPerWord - r));
+        }
+    }
+    dst[dstWords - 1] &= tailMask(dstBits);
+}
+
+inline void combineWords(Word* a, const Word* b, int words, bool isErosion) {
+    if (isErosion) {
+        for (int w = 0; w < words; ++w) a[w] &= b[w];
+    } else {
+        for (int w = 0; w < words; ++w) a[w] |= b[w];
+    }
+}
+
+/**
+ * Window of k pixels starting at offset lo: dst[x] = op(src[x + lo .. x + lo + k - 1]).
+ *
+ * The row is first moved into a padded domain of cols + k - 1 pixels so that
+ * window starts left of the image still see the pixels they cover. Doubling
+ * then builds runs of p = 2^floor(log2 k) pixels, and two overlapping runs
+ * cover the window because AND/OR are idempotent.
+ */
+void runRow(const Word* src, Word* dst, int cols, int lo, int k, bool isErosion,
+            std::vector<Word>& run, std::vector<Word>& shifted) {
+    const Word fillWord = isErosion ? ALL_ONES : 0;
+    const int padded = cols + k - 1;
+    const int paddedWords = wordCount(padded);
+    run.resize(paddedWords);
+    shifted.resize(paddedWords);
+
+    shiftRow(src, cols, run.data(), padded, lo, fillWord);
+
+    int p = 1;
+    while (2 * p <= k) {
+        shiftRow(run.data(), padded, shifted.data(), padded, p, fillWord);
+        combineWords(run.data(), shifted.data(), paddedWords, isErosion);
+        p *= 2;
+    }
+
+    const int words = wordCount(cols);
+    shiftRow(run.data(), padded, dst, cols, 0, fillWord);
+    if (p < k) {
+        shiftRow(run.data(), padded, shifted.data(), cols, k - p, fillWord);
+        combineWords(dst, shifted.data(), words, isErosion);
+    }
+}
+
+void combineImages(BinaryImage& a, const BinaryImage& b, bool isErosion) {
+    const int words = a.wordsPerRow();
+    for (int y = 0; y < a.rows(); ++y) {
+        combineWords(a.row(y), b.row(y), words, isErosion);
+    }
+}
+
+// out = a AND NOT b (tail bits stay clear because they are clear in a)
+void andNot(const BinaryImage& a, const BinaryImage& b, BinaryImage& out) {
+    BinaryImage result(a.rows(), a.cols());
+    const int words = a.wordsPerRow();
+    for (int y = 0; y < a.rows(); ++y) {
+        const Word* pa = a.row(y);
+        const Word* pb = b.row(y);
+        Word* po = result.row(y);
+        for (int w = 0; w < words; ++w) {
+            po[w] = pa[w] & ~pb[w];
+        }
+    }
+    out = result;
+}
+
+bool hasCenteredAnchor(const cv::Mat& kernel) {
+    return !kernel.empty() && kernel.rows % 2 == 1 && kernel.cols % 2 == 1;
+}
+
+} // namespace
+
+// =============================================================================
+// BASIC OPERATIONS
+// =============================================================================
+
+void BinaryMorphology::erode(const BinaryImage& input, BinaryImage& output,
+                             const cv::Mat& kernel, int iterations) {
+    applyExtremum(input, output, kernel, iterations, true);
+}
+
+void BinaryMorphology::dilate(const BinaryImage& input, BinaryImage& output,
+                              const cv::Mat& kernel, int iterations) {
+    applyExtremum(input, output, kernel, iterations, false);
+}
+
+void BinaryMorphology::open(const BinaryImage& input, BinaryImage& output,
+                            const cv::Mat& kernel, int iterations) {
+    BinaryImage eroded;
+    applyExtremum(input, eroded, kernel, iterations, true);
+    applyExtremum(eroded, output, kernel, iterations, false);
+}
+
+void BinaryMorphology::close(const BinaryImage& input, BinaryImage& output,
+                             const cv::Mat& kernel, int iterations) {
+    BinaryImage dilated;
+    applyExtremum(input, dilated, kernel, iterations, false);
+    applyExtremum(dilated, output, kernel, iterations, true);
+}
+
+void BinaryMorphology::hitOrMiss(const BinaryImage& input, BinaryImage& output,
+                                 const cv::Mat& kernel) {
+    TRACE_FUNCTION("morphology");
+    if (input.empty() || !hasCenteredAnchor(kernel)) {
+        output = input;
+        return;
+    }
+
+    cv::Mat pattern;
+    kernel.convertTo(pattern, CV_32S);
+    cv::Mat hitMask = (pattern == 1);
+    cv::Mat missMask = (pattern == -1);
+
+    // An empty part of the pattern matches everywhere (same as OpenCV)
+    BinaryImage hits, misses;
+    applyOffsets(input, hits, hitMask, true);
+    applyOffsets(input.inverted(), misses, missMask, true);
+
+    combineImages(hits, misses, true);
+    output = hits;
+}
+
+// =============================================================================
+// MASK CONVENIENCE
+// =============================================================================
+
+void BinaryMorphology::morphologyEx(const cv::Mat& input, cv::Mat& output, int operation,
+                                    const cv::Mat& kernel, int iterations) {
+    BinaryImage packed = BinaryImage::fromMat(input);
+    if (packed.empty()) {
+        output = input.clone();
+        return;
+    }
+
+    BinaryImage result;
+    morphologyEx(packed, result, operation, kernel, iterations);
+    result.toMat(output);
+}
+
+void BinaryMorphology::morphologyEx(const BinaryImage& input, BinaryImage& output, int operation,
+                                    const cv::Mat& kernel, int iterations) {
+    BinaryImage first, second;
+
+    switch (operation) {
+        case cv::MORPH_ERODE:
+            erode(input, output, kernel, iterations);
+            break;
+
+        case cv::MORPH_DILATE:
+            dilate(input, output, kernel, iterations);
+            break;
+
+        case cv::MORPH_OPEN:
+            open(input, output, kernel, iterations);
+            break;
+
+        case cv::MORPH_CLOSE:
+            close(input, output, kernel, iterations);
+            break;
+
+        case cv::MORPH_GRADIENT:
+            dilate(input, first, kernel, iterations);
+            erode(input, second, kernel, iterations);
+            andNot(first, second, output);
+            break;
+
+        case cv::MORPH_TOPHAT:
+            open(input, first, kernel, iterations);
+            andNot(input, first, output);
+            break;
+
+        case cv::MORPH_BLACKHAT:
+            close(input, first, kernel, iterations);
+            andNot(first, input, output);
+            break;
+
+        case cv::MORPH_HITMISS:
+            hitOrMiss(input, output, kernel);
+            break;
+
+        default:
+            output = input;
+            break;
+    }
+}
+
+// =============================================================================
+// PRIVATE HELPERS
+// =============================================================================
+
+void BinaryMorphology::applyExtremum(const BinaryImage& input, BinaryImage& output,
+                                     const cv::Mat& kernel, int iterations, bool isErosion) {
+    TRACE_FUNCTION("morphology");
+    if (input.empty() || !hasCenteredAnchor(kernel)) {
+        output = input;
+        return;
+    }
+
+    iterations = std::max(1, iterations);
+
+    cv::Mat mask;
+    kernel.convertTo(mask, CV_8U);
+    mask = (mask != 0);
+
+    // Rectangles are exactly collapsed into one larger rectangle
+    if (iterations > 1 && cv::countNonZero(mask) == mask.rows * mask.cols) {
+        mask = MorphologyEngine::iterateStructuringElement(mask, iterations);
+        iterations = 1;
+    }
+
+    std::vector<cv::Rect> rects;
+    const bool decomposed = MorphologyEngine::decomposeStructuringElement(mask, rects);
+
+    BinaryImage current = input;
+    for (int i = 0; i < iterations; ++i) {
+        BinaryImage result;
+        if (decomposed) {
+            // Erosion by a union of rectangles is the AND of the erosions by each
+            applyRect(current, result, rects[0], isErosion);
+            for (size_t r = 1; r < rects.size(); ++r) {
+                BinaryImage partial;
+                applyRect(current, partial, rects[r], isErosion);
+                combineImages(result, partial, isErosion);
+            }
+        } else {
+            applyOffsets(current, result, mask, isErosion);
+        }
+        current = result;
+    }
+
+    output = current;
+}
+
+void BinaryMorphology::applyRect(const BinaryImage& input, BinaryImage& output,
+                                 const cv::Rect& offsets, bool isErosion) {
+    const int rows = input.rows();
+    const int cols = input.cols();
+    const int words = input.wordsPerRow();
+    const Word fillWord = isErosion ? ALL_ONES : 0;
+
+    // Horizontal runs, row-parallel
+    BinaryImage horizontal = input;
+    if (offsets.width > 1 || offsets.x != 0) {
+        horizontal = BinaryImage(rows, cols);
+        cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& range) {
+            std::vector<Word> run, shifted;
+            for (int y = range.start; y < range.end; ++y) {
+                runRow(input.row(y), horizontal.row(y), cols,
+                       offsets.x, offsets.width, isErosion, run, shifted);
+            }
+        });
+    }
+
+    if (offsets.height == 1 && offsets.y == 0) {
+        output = horizontal;
+        return;
+    }
+
+    // Vertical runs by doubling over whole rows of words, in a padded domain
+    // of rows + k - 1 rows (row j holds image row j + offsets.y)
+    const int k = offsets.height;
+    const int padded = rows + k - 1;
+    const std::vector<Word> fillRow(words, fillWord);
+
+    BinaryImage run(padded, cols);
+    BinaryImage next(padded, cols);
+    auto runRowOrFill = [&](int j) -> const Word* {
+        return j < padded ? run.row(j) : fillRow.data();
+    };
+
+    cv::parallel_for_(cv::Range(0, padded), [&](const cv::Range& range) {
+        for (int j = range.start; j < range.end; ++j) {
+            const int y = j + offsets.y;
+            const Word* src = (y >= 0 && y < rows) ? horizontal.row(y) : fillRow.data();
+            std::copy(src, src + words, run.row(j));
+        }
+    });
+
+    int p = 1;
+    while (2 * p <= k) {
+        cv::parallel_for_(cv::Range(0, padded), [&](const cv::Range& range) {
+            for (int j = range.start; j < range.end; ++j) {
+                Word* dst = next.row(j);
+                std::copy(run.row(j), run.row(j) + words, dst);
+                combineWords(dst, runRowOrFill(j + p), words, isErosion);
+            }
+        });
+        std::swap(run, next);
+        p *= 2;
+    }
+
+    BinaryImage result(rows, cols);
+    const Word lastMask = input.lastWordMask();
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            Word* dst = result.row(y);
+            std::copy(run.row(y), run.row(y) + words, dst);
+            combineWords(dst, runRowOrFill(y + k - p), words, isErosion);
+            dst[words - 1] &= lastMask;
+        }
+    });
+
+    output = result;
+}
+
+void BinaryMorphology::applyOffsets(const BinaryImage& input, BinaryImage& output,
+                                    const cv::Mat& mask, bool isErosion) {
+    const int rows = input.rows();
+    const int cols = input.cols();
+    const int words = input.wordsPerRow();
+    const Word fillWord = isErosion ? ALL_ONES : 0;
+
+    std::vector<cv::Point> elements;
+    for (int y = 0; y < mask.rows; ++y) {
+        for (int x = 0; x < mask.cols; ++x) {
+            if (mask.at<uchar>(y, x)) {
+                elements.push_back(cv::Point(x - mask.cols / 2, y - mask.rows / 2));
+            }
+        }
+    }
+
+    BinaryImage result(rows, cols, isErosion);
+    const std::vector<Word> fillRow(words, fillWord);
+
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& range) {
+        std::vector<Word> shifted(words);
+        for (int y = range.start; y < range.end; ++y) {
+            Word* dst = result.row(y);
+            for (const cv::Point& e : elements) {
+                const int sy = y + e.y;
+                const Word* src = (sy >= 0 && sy < rows) ? input.row(sy) : fillRow.data();
+                shiftRow(src, cols, shifted.data(), cols, e.x, fillWord);
+                combineWords(dst, shifted.data(), words, isErosion);
+            }
+        }
+    });
+
+    output = result;
+}
@@ -0,0 +1,110 @@
+#ifndef BINARYMORPHOLOGY_H
+#define BINARYMORPHOLOGY_H
+
+#include "BinaryImage.h"
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Morphology on bit-packed binary images
+ *
+ * Operates on BinaryImage with 64-bit word operations: erosion is a bitwise
+ * AND of shifted rows, dilation a bitwise OR. Rectangular windows use
+ * doubling (a run of 2L pixels is two overlapping runs of L), so a k-pixel
+ * window costs log2(k) word passes per direction. Ellipses and crosses are
+ * decomposed into rectangles; any other structuring element is applied
+ * element by element.
+ *
+ * Results match cv::erode/cv::dilate/cv::morphologyEx on 0/255 masks with
+ * the default border (pixels outside the image are ignored).
+ */
+class BinaryMorphology {
+public:
+    // ==========================================================================
+    // BASIC OPERATIONS
+    // ==========================================================================
+
+    /**
+     * @brief Erode a packed binary image
+     * @param input Source image
+     * @param output Eroded image
+     * @param kernel Structuring element (non-zero pixels, centered anchor)
+     * @param iterations Number of times erosion is applied
+     */
+    static void erode(const BinaryImage& input, BinaryImage& output,
+                      const cv::Mat& kernel, int iterations = 1);
+
+    /**
+     * @brief Dilate a packed binary image
+     * @param input Source image
+     * @param output Dilated image
+     * @param kernel Structuring element (non-zero pixels, centered anchor)
+     * @param iterations Number of times dilation is applied
+     */
+    static void dilate(const BinaryImage& input, BinaryImage& output,
+                       const cv::Mat& kernel, int iterations = 1);
+
+    /**
+     * @brief Opening (erosion followed by dilation)
+     * @param input Source image
+     * @param output Result image
+     * @param kernel Structuring element
+     * @param iterations Number of erosions, then of dilations
+     */
+    static void open(const BinaryImage& input, BinaryImage& output,
+                     const cv::Mat& kernel, int iterations = 1);
+
+    /**
+     * @brief Closing (dilation followed by erosion)
+     * @param input Source image
+     * @param output Result image
+     * @param kernel Structuring element
+     * @param iterations Number of dilations, then of erosions
+     */
+    static void close(const BinaryImage& input, BinaryImage& output,
+                      const cv::Mat& kernel, int iterations = 1);
+
+    /**
+     * @brief Hit-or-miss transform
+     * @param input Source image
+     * @param output Pixels where the pattern matches
+     * @param kernel Pattern (1 = must be foreground, -1 = must be background, 0 = don't care)
+     */
+    static void hitOrMiss(const BinaryImage& input, BinaryImage& output,
+                          const cv::Mat& kernel);
+
+    // ==========================================================================
+    // MASK CONVENIENCE
+    // ==========================================================================
+
+    /**
+     * @brief Run a morphological operation on a CV_8UC1 mask through the packed path
+     * @param input Source mask (non-zero = foreground)
+     * @param output Result mask (0/255)
+     * @param operation cv::MORPH_ERODE, DILATE, OPEN, CLOSE, GRADIENT, TOPHAT, BLACKHAT or HITMISS
+     * @param kernel Structuring element (or hit-or-miss pattern)
+     * @param iterations Number of iterations, as in cv::morphologyEx
+     */
+    static void morphologyEx(const cv::Mat& input, cv::Mat& output, int operation,
+                             const cv::Mat& kernel, int iterations = 1);
+
+    /**
+     * @brief Apply a morphological operation to a packed image
+     * @param input Source image
+     * @param output Result image
+     * @param operation cv::MORPH_ERODE, DILATE, OPEN, CLOSE, GRADIENT, TOPHAT, BLACKHAT or HITMISS
+     * @param kernel Structuring element (or hit-or-miss pattern)
+     * @param iterations Number of iterations, as in cv::morphologyEx
+     */
+    static void morphologyEx(const BinaryImage& input, BinaryImage& output, int operation,
+                             const cv::Mat& kernel, int iterations = 1);
+
+private:
+    static void applyExtremum(const BinaryImage& input, BinaryImage& output,
+                              const cv::Mat& kernel, int iterations, bool isErosion);
+    static void applyRect(const BinaryImage& input, BinaryImage& output,
+                          const cv::Rect& offsets, bool isErosion);
+    static void applyOffsets(const BinaryImage& input, BinaryImage& output,
+                             const cv::Mat& mask, bool isErosion);
+};
+
+#endif // BINARYMORPHOLOGY_H
@@ -0,0 +1,221 @@
+#include "BufferPool.h"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+const size_t BufferPool::POOL_MIN_BYTES;
+const size_t BufferPool::DEFAULT_CAPACITY;
+
+namespace {
+
+struct CachedBuffer {
+    void* data;
+    uint64_t releasedAt;   // release order, for evicting the oldest first
+};
+
+/**
+ * Free lists of the pool. Kept outside the class so the header does not
+ * need <map>/<mutex> and the allocator's const interface can update them.
+ */
+struct PoolState {
+    std::mutex mutex;
+    std::map<size_t, std::vector<CachedBuffer>> freeLists;   // size class -> buffers
+    size_t capacity = BufferPool::DEFAULT_CAPACITY;
+    uint64_t releaseCounter = 0;
+    BufferPool::Stats stats;
+};
+
+PoolState& poolState() {
+    static PoolState* state = new PoolState();   // outlives static destruction
+    return *state;
+}
+
+// Round up to one of eight classes per power of two
+size_t sizeClass(size_t bytes) {
+    size_t power = 1;
+    while (power <= bytes / 2) {
+        power *= 2;
+    }
+    const size_t granule = std::max<size_t>(power / 8, 64);
+    return (bytes + granule - 1) / granule * granule;
+}
+
+// Free the least recently released buffers until the cache fits (lock held)
+void evictTo(PoolState& state, size_t limit) {
+    while (state.stats.cachedBytes > limit) {
+        std::map<size_t, std::vector<CachedBuffer>>::iterator oldest = state.freeLists.end();
+        for (auto it = state.freeLists.begin(); it != state.freeLists.end(); ++it) {
+            if (!it->second.empty() &&
+                (oldest == state.freeLists.end() ||
+                 it->second.front().releasedAt < oldest->second.front().releasedAt)) {
+                oldest = it;
+            }
+        }
+        if (oldest == state.freeLists.end()) {
+            break;
+        }
+
+        cv::fastFree(oldest->second.front().data);
+        oldest->second.erase(oldest->second.begin());
+        state.stats.cachedBytes -= oldest->first;
+        state.stats.cachedBuffers--;
+    }
+}
+
+} // namespace
+
+BufferPool::BufferPool() {
+}
+
+BufferPool& BufferPool::instance() {
+    static BufferPool* pool = new BufferPool();   // buffers may outlive static destruction
+    return *pool;
+}
+
+void BufferPool::install() {
+    cv::Mat::setDefaultAllocator(&instance());
+}
+
+void BufferPool::setCapacity(size_t bytes) {
+    PoolState& state = poolState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.capacity = bytes;
+    evictTo(state, bytes);
+}
+
+size_t BufferPool::capacity() const {
+    PoolState& state = poolState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.capacity;
+}
+
+void BufferPool::trim() {
+    PoolState& state = poolState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    evictTo(state, 0);
+    state.freeLists.clear();
+}
+
+BufferPool::Stats BufferPool::stats() const {
+    PoolState& state = poolState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.stats;
+}
+
+void BufferPool::resetStats() {
+    PoolState& state = poolState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.stats.hits = 0;
+    state.stats.misses = 0;
+    state.stats.unpooled = 0;
+}
+
+// =============================================================================
+// BUFFERS
+// =============================================================================
+
+void* BufferPool::acquire(size_t bytes) const {
+    PoolState& state = poolState();
+    if (bytes < POOL_MIN_BYTES) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stats.unpooled++;
+        return nullptr;
+    }
+
+    const size_t rounded = sizeClass(bytes);
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        auto it = state.freeLists.find(rounded);
+        if (it != state.freeLists.end() && !it->second.empty()) {
+            // Most recently released first: its pages are still mapped and warm
+            void* data = it->second.back().data;
+            it->second.pop_back();
+            state.stats.cachedBytes -= rounded;
+            state.stats.cachedBuffers--;
+            state.stats.hits++;
+            return data;
+        }
+        state.stats.misses++;
+    }
+    return cv::fastMalloc(rounded);
+}
+
+void BufferPool::release(void* buffer, size_t bytes) const {
+    PoolState& state = poolState();
+    const size_t rounded = sizeClass(bytes);
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (rounded > state.capacity) {
+        cv::fastFree(buffer);
+        return;
+    }
+
+    CachedBuffer cached;
+    cached.data = buffer;
+    cached.releasedAt = state.releaseCounter++;
+    state.freeLists[rounded].push_back(cached);
+    state.stats.cachedBytes += rounded;
+    state.stats.cachedBuffers++;
+    evictTo(state, state.capacity);
+}
+
+// =============================================================================
+// cv::MatAllocator
+// =============================================================================
+
+cv::UMatData* BufferPool::allocate(int dims, const int* sizes, int type, void* data0,
+                                   size_t* step, cv::AccessFlag, cv::UMatUsageFlags) const {
+    // Same layout as OpenCV's standard allocator
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        if (step) {
+            if (data0 && step[i] != CV_AUTOSTEP) {
+                CV_Assert(total <= step[i]);
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    uchar* data = static_cast<uchar*>(data0);
+    if (!data) {
+        data = static_cast<uchar*>(acquire(total));
+        if (!data) {
+            data = static_cast<uchar*>(cv::fastMalloc(total));
+        }
+    }
+
+    cv::UMatData* u = new cv::UMatData(this);
+    u->data = u->origdata = data;
+    u->size = total;
+    if (data0) {
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+    }
+    return u;
+}
+
+bool BufferPool::allocate(cv::UMatData* u, cv::AccessFlag, cv::UMatUsageFlags) const {
+    return u != nullptr;
+}
+
+void BufferPool::deallocate(cv::UMatData* u) const {
+    if (!u) {
+        return;
+    }
+    CV_Assert(u->urefcount == 0);
+    CV_Assert(u->refcount == 0);
+
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+        if (u->size >= POOL_MIN_BYTES) {
+            release(u->origdata, u->size);
+        } else {
+            cv::fastFree(u->origdata);
+        }
+        u->origdata = 0;
+    }
+    delete u;
+}
@@ -0,0 +1,94 @@
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+
+/**
+ * @brief cv::Mat allocator that recycles large pixel buffers
+ *
+ * Released buffers of POOL_MIN_BYTES or more are kept in free lists bucketed
+ * by size class (eight classes per power of two, so at most 12.5% of a
+ * buffer is unused) and handed out again for the next request of the same
+ * class. Once installed as the default allocator, every temporary made by
+ * the libraries and by OpenCV itself (cvtColor outputs, CV_32F copies,
+ * split channels, noise fields) comes from the pool, and a chain of
+ * operations repeated on same-sized images stops calling malloc after the
+ * first pass.
+ *
+ * Smaller buffers go straight to cv::fastMalloc. Cached memory is capped;
+ * the least recently released buffers are freed first.
+ */
+class BufferPool : public cv::MatAllocator {
+public:
+    /**
+     * @brief Smallest buffer that is pooled
+     */
+    static const size_t POOL_MIN_BYTES = 64 * 1024;
+
+    /**
+     * @brief Default cap on cached (free) memory
+     */
+    static const size_t DEFAULT_CAPACITY = 512 * 1024 * 1024;
+
+    /**
+     * @brief Allocation counters since the last resetStats()
+     */
+    struct Stats {
+        size_t hits;              // pooled requests served from a free list
+        size_t misses;            // pooled requests that had to allocate
+        size_t unpooled;          // requests below POOL_MIN_BYTES
+        size_t cachedBytes;       // memory currently held in free lists
+        size_t cachedBuffers;
+
+        Stats() : hits(0), misses(0), unpooled(0), cachedBytes(0), cachedBuffers(0) {}
+    };
+
+    /**
+     * @brief The process-wide pool (never destroyed)
+     */
+    static BufferPool& instance();
+
+    /**
+     * @brief Make the pool the default allocator of new cv::Mat buffers
+     *
+     * Call once at startup, before images are loaded. Buffers allocated
+     * earlier are still released by the allocator that made them.
+     */
+    static void install();
+
+    /**
+     * @brief Limit the memory kept in free lists (trims immediately)
+     */
+    void setCapacity(size_t bytes);
+    size_t capacity() const;
+
+    /**
+     * @brief Free every cached buffer (e.g. after switching to a much
+     *        smaller image)
+     */
+    void trim();
+
+    Stats stats() const;
+    void resetStats();
+
+    // ==========================================================================
+    // cv::MatAllocator
+    // ==========================================================================
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override;
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags,
+                  cv::UMatUsageFlags usageFlags) const override;
+    void deallocate(cv::UMatData* data) const override;
+
+private:
+    BufferPool();
+    BufferPool(const BufferPool&);
+    BufferPool& operator=(const BufferPool&);
+
+    void* acquire(size_t bytes) const;
+    void release(void* buffer, size_t bytes) const;
+};
+
+#endif // BUFFERPOOL_H
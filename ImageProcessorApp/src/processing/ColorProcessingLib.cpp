@@ -1,4 +1,5 @@
 #include "ColorProcessingLib.h"
+#include "Trace.h"
 #include <opencv2/opencv.hpp>
 #include <algorithm>
 #include <cmath>
@@ -10,6 +11,7 @@ namespace ColorProcessingLib {
 // =============================================================================
 
 bool convertColorSpace(const cv::Mat& input, cv::Mat& output, ColorSpace targetSpace) {
+    TRACE_FUNCTION("color");
     if (!isValidImage(input)) {
         return false;
     }
@@ -66,6 +68,7 @@ bool convertColorSpace(const cv::Mat& input, cv::Mat& output, ColorSpace targetS
 }
 
 void rgbToHSV(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
@@ -73,6 +76,7 @@ void rgbToHSV(const cv::Mat& input, cv::Mat& output) {
 }
 
 void rgbToLAB(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
@@ -80,6 +84,7 @@ void rgbToLAB(const cv::Mat& input, cv::Mat& output) {
 }
 
 void rgbToYCrCb(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
@@ -87,6 +92,7 @@ void rgbToYCrCb(const cv::Mat& input, cv::Mat& output) {
 }
 
 void rgbToHSL(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
@@ -94,6 +100,7 @@ void rgbToHSL(const cv::Mat& input, cv::Mat& output) {
 }
 
 void rgbToXYZ(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
@@ -105,6 +112,7 @@ void rgbToXYZ(const cv::Mat& input, cv::Mat& output) {
 // =============================================================================
 
 void splitChannels(const cv::Mat& input, std::vector<cv::Mat>& channels) {
+    TRACE_FUNCTION("color");
     if (input.empty()) {
         return;
     }
@@ -112,6 +120,7 @@ void splitChannels(const cv::Mat& input, std::vector<cv::Mat>& channels) {
 }
 
 void mergeChannels(const std::vector<cv::Mat>& channels, cv::Mat& output) {
+    TRACE_FUNCTION("color");
     if (channels.empty()) {
         return;
     }
@@ -119,6 +128,7 @@ void mergeChannels(const std::vector<cv::Mat>& channels, cv::Mat& output) {
 }
 
 void extractChannel(const cv::Mat& input, cv::Mat& output, int channelIndex) {
+    TRACE_FUNCTION("color");
     if (input.empty() || channelIndex < 0 || channelIndex >= input.channels()) {
         return;
     }
@@ -129,6 +139,7 @@ void extractChannel(const cv::Mat& input, cv::Mat& output, int channelIndex) {
 }
 
 void visualizeChannel(const cv::Mat& input, cv::Mat& output, int channelIndex) {
+    TRACE_FUNCTION("color");
     if (input.empty() || channelIndex < 0 || channelIndex >= input.channels()) {
         return;
     }
@@ -152,6 +163,7 @@ void visualizeChannel(const cv::Mat& input, cv::Mat& output, int channelIndex) {
 }
 
 void swapChannels(const cv::Mat& input, cv::Mat& output, int channel1, int channel2) {
+    TRACE_FUNCTION("color");
     if (input.empty() || channel1 < 0 || channel2 < 0 || 
         channel1 >= input.channels() || channel2 >= input.channels()) {
         return;
@@ -171,6 +183,7 @@ void swapChannels(const cv::Mat& input, cv::Mat& output, int channel1, int chann
 // =============================================================================
 
 void adjustBrightness(const cv::Mat& input, cv::Mat& output, int value) {
+    TRACE_FUNCTION("color");
     if (input.empty()) {
         return;
     }
@@ -183,6 +196,7 @@ void adjustBrightness(const cv::Mat& input, cv::Mat& output, int value) {
 }
 
 void adjustContrast(const cv::Mat& input, cv::Mat& output, double value) {
+    TRACE_FUNCTION("color");
     if (input.empty()) {
         return;
     }
@@ -195,6 +209,7 @@ void adjustContrast(const cv::Mat& input, cv::Mat& output, double value) {
 }
 
 void adjustSaturation(const cv::Mat& input, cv::Mat& output, int value) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
@@ -220,6 +235,7 @@ void adjustSaturation(const cv::Mat& input, cv::Mat& output, int value) {
 }
 
 void adjustHue(const cv::Mat& input, cv::Mat& output, int degrees) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
@@ -256,36 +272,31 @@ void adjustHue(const cv::Mat& input, cv::Mat& output, int degrees) {
 }
 
 void whiteBalance(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
     
-    // Simple gray world white balance algorithm
-    std::vector<cv::Mat> channels;
-    cv::split(input, channels);
-    
-    // Calculate average for each channel
-    cv::Scalar avgB = cv::mean(channels[0]);
-    cv::Scalar avgG = cv::mean(channels[1]);
-    cv::Scalar avgR = cv::mean(channels[2]);
-    
-    // Calculate gray average
-    double avgGray = (avgB[0] + avgG[0] + avgR[0]) / 3.0;
+    if (input.depth() == CV_8U) {
+        whiteBalance(input, output, WhiteBalanceMode::GRAY_WORLD);
+        return;
+    }
     
-    // Calculate scaling factors
-    double scaleB = avgGray / avgB[0];
-    double scaleG = avgGray / avgG[0];
-    double scaleR = avgGray / avgR[0];
+    // Gray world for non 8-bit images: one mean pass over all channels,
+    // one scaling pass
+    cv::Scalar avg = cv::mean(input);
+    double avgGray = (avg[0] + avg[1] + avg[2]) / 3.0;
     
-    // Apply white balance
-    channels[0].convertTo(channels[0], -1, scaleB, 0);
-    channels[1].convertTo(channels[1], -1, scaleG, 0);
-    channels[2].convertTo(channels[2], -1, scaleR, 0);
+    cv::Scalar scale;
+    for (int c = 0; c < 3; ++c) {
+        scale[c] = avg[c] > 0 ? avgGray / avg[c] : 1.0;
+    }
     
-    cv::merge(channels, output);
+    cv::multiply(input, scale, output);
 }
 
 void adjustTemperature(const cv::Mat& input, cv::Mat& output, int temperature) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
@@ -314,6 +325,7 @@ void adjustTemperature(const cv::Mat& input, cv::Mat& output, int temperature) {
 
 void adjustColors(const cv::Mat& input, cv::Mat& output,
                  int brightness, double contrast, int saturation, int hue) {
+    TRACE_FUNCTION("color");
     if (input.empty()) {
         return;
     }
@@ -327,11 +339,175 @@ void adjustColors(const cv::Mat& input, cv::Mat& output,
     adjustHue(temp3, output, hue);
 }
 
+// =============================================================================
+// WHITE BALANCE ENGINE
+// =============================================================================
+
+WhiteBalanceStats::WhiteBalanceStats() : sampleCount(0) {
+    std::fill(&histogram[0][0], &histogram[0][0] + 3 * 256, 0);
+}
+
+double WhiteBalanceStats::channelMean(int channel) const {
+    if (sampleCount <= 0 || channel < 0 || channel > 2) {
+        return 0.0;
+    }
+    
+    double sum = 0.0;
+    for (int v = 0; v < 256; ++v) {
+        sum += static_cast<double>(v) * histogram[channel][v];
+    }
+    return sum / sampleCount;
+}
+
+int WhiteBalanceStats::channelPercentile(int channel, double percentile) const {
+    if (sampleCount <= 0 || channel < 0 || channel > 2) {
+        return 0;
+    }
+    
+    percentile = std::max(0.0, std::min(100.0, percentile));
+    long long target = static_cast<long long>(std::ceil(percentile / 100.0 * sampleCount));
+    target = std::max(1LL, target);
+    
+    long long cumSum = 0;
+    for (int v = 0; v < 256; ++v) {
+        cumSum += histogram[channel][v];
+        if (cumSum >= target) {
+            return v;
+        }
+    }
+    return 255;
+}
+
+bool computeWhiteBalanceStats(const cv::Mat& input, WhiteBalanceStats& stats,
+                              int sampleStep) {
+    TRACE_FUNCTION("color");
+    stats = WhiteBalanceStats();
+    if (input.empty() || input.type() != CV_8UC3) {
+        return false;
+    }
+    
+    sampleStep = std::max(1, sampleStep);
+    const int sampledRows = (input.rows + sampleStep - 1) / sampleStep;
+    const int numStripes = std::max(1, std::min(sampledRows, cv::getNumThreads() * 4));
+    
+    // Each stripe fills its own histograms, merged afterwards without locking
+    std::vector<WhiteBalanceStats> partial(numStripes);
+    
+    cv::parallel_for_(cv::Range(0, numStripes), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            WhiteBalanceStats& local = partial[s];
+            const int firstRow = static_cast<int>(static_cast<long long>(sampledRows) * s / numStripes);
+            const int lastRow = static_cast<int>(static_cast<long long>(sampledRows) * (s + 1) / numStripes);
+            
+            for (int r = firstRow; r < lastRow; ++r) {
+                const uchar* row = input.ptr<uchar>(r * sampleStep);
+                for (int x = 0; x < input.cols; x += sampleStep) {
+                    const uchar* px = row + 3 * x;
+                    ++local.histogram[0][px[0]];
+                    ++local.histogram[1][px[1]];
+                    ++local.histogram[2][px[2]];
+                    ++local.sampleCount;
+                }
+            }
+        }
+    });
+    
+    for (const WhiteBalanceStats& local : partial) {
+        for (int c = 0; c < 3; ++c) {
+            for (int v = 0; v < 256; ++v) {
+                stats.histogram[c][v] += local.histogram[c][v];
+            }
+        }
+        stats.sampleCount += local.sampleCount;
+    }
+    
+    return stats.isValid();
+}
+
+cv::Vec3d computeWhiteBalanceGains(const WhiteBalanceStats& stats,
+                                   WhiteBalanceMode mode,
+                                   double percentile) {
+    TRACE_FUNCTION("color");
+    cv::Vec3d gains(1.0, 1.0, 1.0);
+    if (!stats.isValid()) {
+        return gains;
+    }
+    
+    switch (mode) {
+        case WhiteBalanceMode::GRAY_WORLD: {
+            double means[3];
+            for (int c = 0; c < 3; ++c) {
+                means[c] = stats.channelMean(c);
+            }
+            double avgGray = (means[0] + means[1] + means[2]) / 3.0;
+            for (int c = 0; c < 3; ++c) {
+                gains[c] = means[c] > 0 ? avgGray / means[c] : 1.0;
+            }
+            break;
+        }
+        
+        case WhiteBalanceMode::WHITE_PATCH:
+        case WhiteBalanceMode::PERCENTILE: {
+            double p = (mode == WhiteBalanceMode::WHITE_PATCH)
+                           ? 100.0
+                           : std::max(50.0, std::min(100.0, percentile));
+            for (int c = 0; c < 3; ++c) {
+                int reference = stats.channelPercentile(c, p);
+                gains[c] = reference > 0 ? 255.0 / reference : 1.0;
+            }
+            break;
+        }
+    }
+    
+    return gains;
+}
+
+void applyWhiteBalanceGains(const cv::Mat& input, cv::Mat& output, const cv::Vec3d& gains) {
+    TRACE_FUNCTION("color");
+    if (input.empty() || input.type() != CV_8UC3) {
+        output = input.clone();
+        return;
+    }
+    
+    cv::Mat lut(1, 256, CV_8UC3);
+    for (int i = 0; i < 256; ++i) {
+        cv::Vec3b& entry = lut.at<cv::Vec3b>(0, i);
+        for (int c = 0; c < 3; ++c) {
+            entry[c] = cv::saturate_cast<uchar>(i * gains[c]);
+        }
+    }
+    
+    cv::LUT(input, lut, output);
+}
+
+void whiteBalance(const cv::Mat& input, cv::Mat& output, WhiteBalanceMode mode,
+                  double percentile, int sampleStep) {
+    TRACE_FUNCTION("color");
+    WhiteBalanceStats stats;
+    if (!computeWhiteBalanceStats(input, stats, sampleStep)) {
+        // Unsupported type: pass the image through unchanged
+        output = input.clone();
+        return;
+    }
+    whiteBalance(input, output, stats, mode, percentile);
+}
+
+void whiteBalance(const cv::Mat& input, cv::Mat& output, const WhiteBalanceStats& stats,
+                  WhiteBalanceMode mode, double percentile) {
+    TRACE_FUNCTION("color");
+    if (input.empty() || input.type() != CV_8UC3 || !stats.isValid()) {
+        output = input.clone();
+        return;
+    }
+    applyWhiteBalanceGains(input, output, computeWhiteBalanceGains(stats, mode, percentile));
+}
+
 // =============================================================================
 // COLOR GRADING & EFFECTS
 // =============================================================================
 
 void applySepiaEffect(const cv::Mat& input, cv::Mat& output, double intensity) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
@@ -358,6 +534,7 @@ void applySepiaEffect(const cv::Mat& input, cv::Mat& output, double intensity) {
 }
 
 void applyCoolFilter(const cv::Mat& input, cv::Mat& output, double intensity) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
@@ -376,6 +553,7 @@ void applyCoolFilter(const cv::Mat& input, cv::Mat& output, double intensity) {
 }
 
 void applyWarmFilter(const cv::Mat& input, cv::Mat& output, double intensity) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
@@ -395,6 +573,7 @@ void applyWarmFilter(const cv::Mat& input, cv::Mat& output, double intensity) {
 }
 
 void applyVintageEffect(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("color");
     if (input.empty() || input.channels() != 3) {
         return;
     }
@@ -429,6 +608,7 @@ void applyVintageEffect(const cv::Mat& input, cv::Mat& output) {
 }
 
 void applyLUT(const cv::Mat& input, cv::Mat& output, const cv::Mat& lut) {
+    TRACE_FUNCTION("color");
     if (input.empty() || lut.empty()) {
         return;
     }
@@ -437,6 +617,7 @@ void applyLUT(const cv::Mat& input, cv::Mat& output, const cv::Mat& lut) {
 }
 
 void createColorGradingLUT(cv::Mat& lut, const QString& style) {
+    TRACE_FUNCTION("color");
     lut = cv::Mat(1, 256, CV_8UC3);
     
     for (int i = 0; i < 256; ++i) {
@@ -496,6 +677,7 @@ bool isValidImage(const cv::Mat& image) {
 }
 
 void normalizeChannelForVisualization(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("color");
     if (input.empty()) {
         return;
     }
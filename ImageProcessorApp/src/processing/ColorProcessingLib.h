@@ -170,7 +170,7 @@ namespace ColorProcessingLib {
     void adjustHue(const cv::Mat& input, cv::Mat& output, int degrees);
 
     /**
-     * @brief Apply white balance correction
+     * @brief Apply white balance correction (gray world)
      * @param input Input BGR image
      * @param output Output white balanced image
      */
@@ -196,6 +196,88 @@ namespace ColorProcessingLib {
     void adjustColors(const cv::Mat& input, cv::Mat& output,
                      int brightness, double contrast, int saturation, int hue);
 
+    // =============================================================================
+    // WHITE BALANCE ENGINE
+    // =============================================================================
+
+    /**
+     * @brief White balance algorithms supported by the engine
+     */
+    enum class WhiteBalanceMode {
+        GRAY_WORLD,   // Equalize channel means
+        WHITE_PATCH,  // Map the brightest value of each channel to white
+        PERCENTILE    // White patch on a robust percentile instead of the maximum
+    };
+
+    /**
+     * @brief Per-channel statistics gathered once per image
+     *
+     * Holds one 256-bin histogram per BGR channel; means, maxima and
+     * percentiles for every mode are derived from it without touching the
+     * pixels again, so batch jobs can compute it once and reuse it.
+     */
+    struct WhiteBalanceStats {
+        int histogram[3][256];  // Per-channel (B, G, R) histograms of the sampled pixels
+        int sampleCount;        // Number of pixels that contributed
+
+        WhiteBalanceStats();
+        bool isValid() const { return sampleCount > 0; }
+        double channelMean(int channel) const;
+        int channelPercentile(int channel, double percentile) const;
+    };
+
+    /**
+     * @brief Gather white balance statistics for all channels in a single parallel pass
+     * @param input Input BGR image (CV_8UC3)
+     * @param stats Output statistics
+     * @param sampleStep Only visit every Nth row and column (1 = every pixel)
+     * @return true if statistics were computed, false for unsupported input
+     */
+    bool computeWhiteBalanceStats(const cv::Mat& input, WhiteBalanceStats& stats,
+                                  int sampleStep = 1);
+
+    /**
+     * @brief Derive per-channel gains from precomputed statistics
+     * @param stats Statistics from computeWhiteBalanceStats
+     * @param mode White balance algorithm
+     * @param percentile Percentile used by PERCENTILE mode (50.0 to 100.0)
+     * @return Gains for the B, G and R channels (1.0 = unchanged)
+     */
+    cv::Vec3d computeWhiteBalanceGains(const WhiteBalanceStats& stats,
+                                       WhiteBalanceMode mode,
+                                       double percentile = 99.0);
+
+    /**
+     * @brief Apply per-channel gains through a single fused LUT pass
+     * @param input Input BGR image (CV_8UC3; other types are copied unchanged)
+     * @param output Output white balanced image
+     * @param gains Gains for the B, G and R channels
+     */
+    void applyWhiteBalanceGains(const cv::Mat& input, cv::Mat& output, const cv::Vec3d& gains);
+
+    /**
+     * @brief Apply white balance correction with the selected algorithm
+     * @param input Input BGR image (CV_8UC3; other types are copied unchanged)
+     * @param output Output white balanced image
+     * @param mode White balance algorithm
+     * @param percentile Percentile used by PERCENTILE mode
+     * @param sampleStep Statistics subsampling step (1 = every pixel)
+     */
+    void whiteBalance(const cv::Mat& input, cv::Mat& output, WhiteBalanceMode mode,
+                      double percentile = 99.0, int sampleStep = 1);
+
+    /**
+     * @brief Apply white balance correction reusing precomputed statistics
+     * @param input Input BGR image the statistics were gathered from
+     *              (copied unchanged if it is not CV_8UC3 or stats are invalid)
+     * @param output Output white balanced image
+     * @param stats Statistics from computeWhiteBalanceStats
+     * @param mode White balance algorithm
+     * @param percentile Percentile used by PERCENTILE mode
+     */
+    void whiteBalance(const cv::Mat& input, cv::Mat& output, const WhiteBalanceStats& stats,
+                      WhiteBalanceMode mode, double percentile = 99.0);
+
     // =============================================================================
     // COLOR GRADING & EFFECTS
     // =============================================================================
@@ -0,0 +1,303 @@
+#include "ConnectedComponents.h"
+#include "Trace.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+// Stripes shorter than this are not worth a separate task
+const int MIN_STRIPE_ROWS = 32;
+
+/**
+ * Running sums for one provisional label (raw moments up to third order).
+ */
+struct Accumulator {
+    int area;
+    int minX, minY, maxX, maxY;
+    double m10, m01, m20, m11, m02, m30, m21, m12, m03;
+
+    Accumulator()
+        : area(0), minX(INT_MAX), minY(INT_MAX), maxX(INT_MIN), maxY(INT_MIN),
+          m10(0), m01(0), m20(0), m11(0), m02(0), m30(0), m21(0), m12(0), m03(0) {}
+
+    void add(int x, int y) {
+        const double dx = x, dy = y;
+        const double xx = dx * dx, yy = dy * dy;
+        ++area;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        m10 += dx;
+        m01 += dy;
+        m20 += xx;
+        m11 += dx * dy;
+        m02 += yy;
+        m30 += xx * dx;
+        m21 += xx * dy;
+        m12 += dx * yy;
+        m03 += yy * dy;
+    }
+
+    void merge(const Accumulator& other) {
+        area += other.area;
+        minX = std::min(minX, other.minX);
+        maxX = std::max(maxX, other.maxX);
+        minY = std::min(minY, other.minY);
+        maxY = std::max(maxY, other.maxY);
+        m10 += other.m10;
+        m01 += other.m01;
+        m20 += other.m20;
+        m11 += other.m11;
+        m02 += other.m02;
+        m30 += other.m30;
+        m21 += other.m21;
+        m12 += other.m12;
+        m03 += other.m03;
+    }
+};
+
+/**
+ * Rows [firstRow, endRow) and the provisional labels they own,
+ * starting at firstLabel.
+ */
+struct Stripe {
+    int firstRow;
+    int endRow;
+    int firstLabel;
+    int labelCount;
+    std::vector<Accumulator> sums;
+};
+
+inline int findRoot(std::vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];  // Path halving
+        i = parent[i];
+    }
+    return i;
+}
+
+// The smaller label always becomes the root, so parent[i] <= i everywhere
+inline int unite(std::vector<int>& parent, int a, int b) {
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a < b) {
+        parent[b] = a;
+        return a;
+    }
+    parent[a] = b;
+    return b;
+}
+
+template <bool WithStats>
+void scanStripe(const cv::Mat& binary, cv::Mat& labels, std::vector<int>& parent,
+                Stripe& stripe, int connectivity) {
+    const int cols = binary.cols;
+    int next = stripe.firstLabel;
+
+    for (int y = stripe.firstRow; y < stripe.endRow; ++y) {
+        const uchar* src = binary.ptr<uchar>(y);
+        const uchar* srcUp = y > stripe.firstRow ? binary.ptr<uchar>(y - 1) : nullptr;
+        int* lab = labels.ptr<int>(y);
+        const int* labUp = srcUp ? labels.ptr<int>(y - 1) : nullptr;
+
+        for (int x = 0; x < cols; ++x) {
+            if (!src[x]) {
+                lab[x] = 0;
+                continue;
+            }
+
+            const bool left = x > 0 && src[x - 1];
+            const bool up = srcUp && srcUp[x];
+            int l = 0;
+
+            if (connectivity == 8) {
+                const bool upLeft = srcUp && x > 0 && srcUp[x - 1];
+                const bool upRight = srcUp && x + 1 < cols && srcUp[x + 1];
+
+                // The upper pixel touches every other scanned neighbor, and the
+                // left pixel was already merged with the upper-left one
+                if (up) {
+                    l = labUp[x];
+                } else if (upRight) {
+                    l = labUp[x + 1];
+                    if (left) {
+                        l = unite(parent, l, lab[x - 1]);
+                    } else if (upLeft) {
+                        l = unite(parent, l, labUp[x - 1]);
+                    }
+                } else if (left) {
+                    l = lab[x - 1];
+                } else if (upLeft) {
+                    l = labUp[x - 1];
+                }
+            } else {
+                if (up && left) {
+                    l = unite(parent, labUp[x], lab[x - 1]);
+                } else if (up) {
+                    l = labUp[x];
+                } else if (left) {
+                    l = lab[x - 1];
+                }
+            }
+
+            if (l == 0) {
+                l = next++;
+                parent[l] = l;
+                if (WithStats) {
+                    stripe.sums.push_back(Accumulator());
+                }
+            }
+
+            lab[x] = l;
+            if (WithStats) {
+                stripe.sums[l - stripe.firstLabel].add(x, y);
+            }
+        }
+    }
+
+    stripe.labelCount = next - stripe.firstLabel;
+}
+
+} // namespace
+
+// =============================================================================
+// LABELING
+// =============================================================================
+
+int ConnectedComponents::label(const cv::Mat& input, cv::Mat& labels, int connectivity) {
+    return labelImpl(input, labels, nullptr, connectivity);
+}
+
+int ConnectedComponents::labelWithStats(const cv::Mat& input, cv::Mat& labels,
+                                        std::vector<ComponentStats>& stats,
+                                        int connectivity) {
+    return labelImpl(input, labels, &stats, connectivity);
+}
+
+// =============================================================================
+// PRIVATE HELPERS
+// =============================================================================
+
+int ConnectedComponents::labelImpl(const cv::Mat& input, cv::Mat& labels,
+                                   std::vector<ComponentStats>* stats, int connectivity) {
+    TRACE_FUNCTION("segmentation");
+    if (stats) {
+        stats->clear();
+    }
+    if (input.empty()) {
+        labels = cv::Mat();
+        return 0;
+    }
+
+    cv::Mat binary = input;
+    if (binary.channels() == 3) {
+        cv::cvtColor(binary, binary, cv::COLOR_BGR2GRAY);
+    }
+    if (binary.type() != CV_8UC1) {
+        binary = binary != 0;
+    }
+    if (connectivity != 4) {
+        connectivity = 8;
+    }
+
+    const int rows = binary.rows;
+    const int cols = binary.cols;
+    labels.create(binary.size(), CV_32S);
+
+    // A row starts at most (cols + 1) / 2 new provisional labels
+    const int labelsPerRow = (cols + 1) / 2;
+    std::vector<int> parent(static_cast<size_t>(rows) * labelsPerRow + 1, 0);
+
+    const int stripeCount = std::max(1, std::min(rows / MIN_STRIPE_ROWS,
+                                                 cv::getNumThreads() * 4));
+    std::vector<Stripe> stripes(stripeCount);
+    for (int s = 0; s < stripeCount; ++s) {
+        stripes[s].firstRow = static_cast<int>(static_cast<long long>(rows) * s / stripeCount);
+        stripes[s].endRow = static_cast<int>(static_cast<long long>(rows) * (s + 1) / stripeCount);
+        stripes[s].firstLabel = 1 + stripes[s].firstRow * labelsPerRow;
+        stripes[s].labelCount = 0;
+    }
+
+    // 1. Label stripes independently (disjoint label ranges, no shared writes)
+    cv::parallel_for_(cv::Range(0, stripeCount), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            if (stats) {
+                scanStripe<true>(binary, labels, parent, stripes[s], connectivity);
+            } else {
+                scanStripe<false>(binary, labels, parent, stripes[s], connectivity);
+            }
+        }
+    });
+
+    // 2. Merge labels across stripe borders
+    for (int s = 1; s < stripeCount; ++s) {
+        const int y = stripes[s].firstRow;
+        const uchar* src = binary.ptr<uchar>(y);
+        const uchar* srcUp = binary.ptr<uchar>(y - 1);
+        const int* lab = labels.ptr<int>(y);
+        const int* labUp = labels.ptr<int>(y - 1);
+
+        for (int x = 0; x < cols; ++x) {
+            if (!src[x]) continue;
+            if (srcUp[x]) {
+                unite(parent, lab[x], labUp[x]);
+            }
+            if (connectivity == 8) {
+                if (x > 0 && srcUp[x - 1]) unite(parent, lab[x], labUp[x - 1]);
+                if (x + 1 < cols && srcUp[x + 1]) unite(parent, lab[x], labUp[x + 1]);
+            }
+        }
+    }
+
+    // 3. Flatten into consecutive final labels. Roots are the smallest label
+    //    of their tree, so every parent is resolved before its children.
+    int labelCount = 1;
+    for (const Stripe& stripe : stripes) {
+        for (int i = stripe.firstLabel; i < stripe.firstLabel + stripe.labelCount; ++i) {
+            parent[i] = parent[i] == i ? labelCount++ : parent[parent[i]];
+        }
+    }
+
+    // 4. Write final labels
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            int* lab = labels.ptr<int>(y);
+            for (int x = 0; x < cols; ++x) {
+                lab[x] = parent[lab[x]];
+            }
+        }
+    });
+
+    if (!stats) {
+        return labelCount;
+    }
+
+    std::vector<Accumulator> totals(labelCount);
+    for (const Stripe& stripe : stripes) {
+        for (int k = 0; k < stripe.labelCount; ++k) {
+            totals[parent[stripe.firstLabel + k]].merge(stripe.sums[k]);
+        }
+    }
+
+    stats->resize(labelCount);
+    int foreground = 0;
+    for (int l = 1; l < labelCount; ++l) {
+        const Accumulator& a = totals[l];
+        ComponentStats& s = (*stats)[l];
+        s.area = a.area;
+        s.boundingBox = cv::Rect(a.minX, a.minY, a.maxX - a.minX + 1, a.maxY - a.minY + 1);
+        s.centroid = cv::Point2d(a.m10 / a.area, a.m01 / a.area);
+        s.moments = cv::Moments(a.area, a.m10, a.m01, a.m20, a.m11, a.m02,
+                                a.m30, a.m21, a.m12, a.m03);
+        foreground += a.area;
+    }
+
+    ComponentStats& background = (*stats)[0];
+    background.area = rows * cols - foreground;
+    background.boundingBox = cv::Rect(0, 0, cols, rows);
+    background.centroid = cv::Point2d(0, 0);
+    background.moments = cv::Moments();
+
+    return labelCount;
+}
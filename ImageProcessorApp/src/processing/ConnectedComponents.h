@@ -0,0 +1,62 @@
+#ifndef CONNECTEDCOMPONENTS_H
+#define CONNECTEDCOMPONENTS_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Parallel connected-component labeling with per-component statistics
+ *
+ * The image is split into horizontal stripes that are labeled concurrently
+ * with a union-find over provisional labels (each stripe owns a disjoint
+ * label range). Stripe borders are then merged, the equivalence table is
+ * flattened into consecutive labels, and the final labels are written in a
+ * second parallel pass. Area, bounding box and raw moments are accumulated
+ * while scanning, so statistics cost no extra sweep over the image.
+ *
+ * Labels follow cv::connectedComponents: 0 is the background and components
+ * are numbered from 1 in raster order of their first pixel.
+ */
+class ConnectedComponents {
+public:
+    /**
+     * @brief Statistics of one connected component
+     */
+    struct ComponentStats {
+        int area;                // Number of pixels
+        cv::Rect boundingBox;
+        cv::Point2d centroid;
+        cv::Moments moments;     // Spatial, central and normalized moments of the pixels
+    };
+
+    // ==========================================================================
+    // LABELING
+    // ==========================================================================
+
+    /**
+     * @brief Label connected components of a binary image
+     * @param input Binary image (non-zero pixels are foreground)
+     * @param labels Output label image (CV_32S)
+     * @param connectivity 4 or 8
+     * @return Number of labels, including the background label 0
+     */
+    static int label(const cv::Mat& input, cv::Mat& labels, int connectivity = 8);
+
+    /**
+     * @brief Label connected components and compute their statistics in the same pass
+     * @param input Binary image (non-zero pixels are foreground)
+     * @param labels Output label image (CV_32S)
+     * @param stats Output statistics indexed by label (stats[0] is the background,
+     *              for which only area is filled)
+     * @param connectivity 4 or 8
+     * @return Number of labels, including the background label 0
+     */
+    static int labelWithStats(const cv::Mat& input, cv::Mat& labels,
+                              std::vector<ComponentStats>& stats, int connectivity = 8);
+
+private:
+    static int labelImpl(const cv::Mat& input, cv::Mat& labels,
+                         std::vector<ComponentStats>* stats, int connectivity);
+};
+
+#endif // CONNECTEDCOMPONENTS_H
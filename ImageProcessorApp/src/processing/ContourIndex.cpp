@@ -0,0 +1,155 @@
+#include "ContourIndex.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int MIN_CELL_SIZE = 8;
+
+// Upper bound on the number of grid cells (memory guard for sparse frames)
+const int MAX_CELLS = 1 << 22;
+
+} // namespace
+
+ContourIndex::ContourIndex()
+    : table(nullptr), cellSize(MIN_CELL_SIZE), gridCols(0), gridRows(0) {
+}
+
+void ContourIndex::build(const ContourTable& source) {
+    TRACE_FUNCTION("segmentation");
+    clear();
+    table = &source;
+
+    const int count = static_cast<int>(source.size());
+    if (count == 0) {
+        return;
+    }
+
+    if (source.columns() & ContourTable::BOUNDING_BOX) {
+        boxes = source.boundingBoxes();
+    } else {
+        boxes.resize(count);
+        cv::parallel_for_(cv::Range(0, count), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                boxes[i] = cv::boundingRect(source.contour(i));
+            }
+        });
+    }
+
+    // Cells sized after the average box keep a few rows per cell
+    double totalArea = 0;
+    bounds = boxes[0];
+    for (const cv::Rect& box : boxes) {
+        totalArea += static_cast<double>(box.width) * box.height;
+        bounds |= box;
+    }
+    cellSize = std::max(MIN_CELL_SIZE, static_cast<int>(std::ceil(std::sqrt(totalArea / count))));
+    while (static_cast<double>((bounds.width + cellSize - 1) / cellSize) *
+           ((bounds.height + cellSize - 1) / cellSize) > MAX_CELLS) {
+        cellSize *= 2;
+    }
+    gridCols = std::max(1, (bounds.width + cellSize - 1) / cellSize);
+    gridRows = std::max(1, (bounds.height + cellSize - 1) / cellSize);
+
+    // Counting pass, prefix sums, then fill (compressed cell -> rows lists)
+    cellStart.assign(static_cast<size_t>(gridCols) * gridRows + 1, 0);
+    for (const cv::Rect& box : boxes) {
+        cv::Rect cells = cellRange(box);
+        for (int cy = cells.y; cy < cells.y + cells.height; ++cy) {
+            for (int cx = cells.x; cx < cells.x + cells.width; ++cx) {
+                ++cellStart[cy * gridCols + cx + 1];
+            }
+        }
+    }
+    for (size_t c = 1; c < cellStart.size(); ++c) {
+        cellStart[c] += cellStart[c - 1];
+    }
+
+    cellItems.resize(cellStart.back());
+    std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    for (int i = 0; i < count; ++i) {
+        cv::Rect cells = cellRange(boxes[i]);
+        for (int cy = cells.y; cy < cells.y + cells.height; ++cy) {
+            for (int cx = cells.x; cx < cells.x + cells.width; ++cx) {
+                cellItems[fill[cy * gridCols + cx]++] = i;
+            }
+        }
+    }
+}
+
+int ContourIndex::query(const cv::Point2f& point) const {
+    if (empty() || !bounds.contains(cv::Point(cvFloor(point.x), cvFloor(point.y)))) {
+        return -1;
+    }
+
+    const int cx = std::min(gridCols - 1, (cvFloor(point.x) - bounds.x) / cellSize);
+    const int cy = std::min(gridRows - 1, (cvFloor(point.y) - bounds.y) / cellSize);
+    const int cell = cy * gridCols + cx;
+
+    // Nested hits resolve to the innermost (smallest) contour
+    int best = -1;
+    double bestArea = 0;
+    for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+        const int row = cellItems[k];
+        const cv::Rect& box = boxes[row];
+        if (point.x < box.x || point.y < box.y ||
+            point.x > box.x + box.width || point.y > box.y + box.height) {
+            continue;
+        }
+
+        const double area = static_cast<double>(box.width) * box.height;
+        if (best >= 0 && area >= bestArea) {
+            continue;
+        }
+
+        if (cv::pointPolygonTest(table->contour(row), point, false) >= 0) {
+            best = row;
+            bestArea = area;
+        }
+    }
+
+    return best;
+}
+
+std::vector<int> ContourIndex::queryRect(const cv::Rect& rect) const {
+    std::vector<int> rows;
+    if (empty() || (rect & bounds).area() <= 0) {
+        return rows;
+    }
+
+    cv::Rect cells = cellRange(rect & bounds);
+    for (int cy = cells.y; cy < cells.y + cells.height; ++cy) {
+        for (int cx = cells.x; cx < cells.x + cells.width; ++cx) {
+            const int cell = cy * gridCols + cx;
+            for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                if ((boxes[cellItems[k]] & rect).area() > 0) {
+                    rows.push_back(cellItems[k]);
+                }
+            }
+        }
+    }
+
+    // Boxes spanning several cells are reported once
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return rows;
+}
+
+void ContourIndex::clear() {
+    table = nullptr;
+    boxes.clear();
+    bounds = cv::Rect();
+    gridCols = 0;
+    gridRows = 0;
+    cellStart.clear();
+    cellItems.clear();
+}
+
+cv::Rect ContourIndex::cellRange(const cv::Rect& rect) const {
+    const int x0 = std::max(0, (rect.x - bounds.x) / cellSize);
+    const int y0 = std::max(0, (rect.y - bounds.y) / cellSize);
+    const int x1 = std::min(gridCols - 1, (rect.x + rect.width - 1 - bounds.x) / cellSize);
+    const int y1 = std::min(gridRows - 1, (rect.y + rect.height - 1 - bounds.y) / cellSize);
+    return cv::Rect(x0, y0, std::max(0, x1 - x0 + 1), std::max(0, y1 - y0 + 1));
+}
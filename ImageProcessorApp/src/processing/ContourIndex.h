@@ -0,0 +1,62 @@
+#ifndef CONTOURINDEX_H
+#define CONTOURINDEX_H
+
+#include "ContourTable.h"
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Uniform-grid spatial index over contour bounding boxes
+ *
+ * Every row of a ContourTable is registered in the grid cells its bounding
+ * box overlaps (cells sized after the average box, stored as a compact
+ * cell -> rows array). A point query only looks at the rows of one cell,
+ * and a point-in-polygon test on the candidates gives the exact answer, so
+ * hit-testing costs O(1) on average regardless of the number of contours.
+ *
+ * The index refers to the table (and through it to the contour storage),
+ * which must outlive it.
+ */
+class ContourIndex {
+public:
+    ContourIndex();
+
+    /**
+     * @brief Build the index for all rows of a table
+     * @param table Contour table (bounding boxes are computed if the column is missing)
+     */
+    void build(const ContourTable& table);
+
+    /**
+     * @brief Find the contour containing a point
+     * @param point Position in image coordinates
+     * @return Table row of the innermost contour containing the point, or -1
+     */
+    int query(const cv::Point2f& point) const;
+
+    /**
+     * @brief Find the contours whose bounding box intersects a rectangle
+     * @param rect Rectangle in image coordinates
+     * @return Table rows, in ascending order
+     */
+    std::vector<int> queryRect(const cv::Rect& rect) const;
+
+    void clear();
+    bool empty() const { return boxes.empty(); }
+    size_t size() const { return boxes.size(); }
+
+private:
+    cv::Rect cellRange(const cv::Rect& rect) const;
+
+    const ContourTable* table;
+    std::vector<cv::Rect> boxes;
+
+    cv::Rect bounds;          // Union of all bounding boxes
+    int cellSize;
+    int gridCols;
+    int gridRows;
+    std::vector<int> cellStart;  // gridCols * gridRows + 1 offsets into cellItems
+    std::vector<int> cellItems;  // Table rows, grouped by cell
+};
+
+#endif // CONTOURINDEX_H
@@ -0,0 +1,133 @@
+#include "ContourTable.h"
+#include "Trace.h"
+#include <algorithm>
+
+namespace {
+
+template <typename T>
+void compact(const std::vector<T>& column, const std::vector<uchar>& mask, std::vector<T>& output) {
+    output.clear();
+    if (column.empty()) {
+        return;
+    }
+    for (size_t i = 0; i < mask.size(); ++i) {
+        if (mask[i]) {
+            output.push_back(column[i]);
+        }
+    }
+}
+
+} // namespace
+
+ContourTable::ContourTable() : source(nullptr), computedColumns(0) {
+}
+
+// =============================================================================
+// CONSTRUCTION
+// =============================================================================
+
+void ContourTable::build(const ContourList& contours, int columns) {
+    TRACE_FUNCTION("segmentation");
+    if (columns & CIRCULARITY) {
+        columns |= AREA | PERIMETER;
+    }
+
+    source = &contours;
+    computedColumns = columns;
+
+    const int count = static_cast<int>(contours.size());
+    indices.resize(count);
+    area.assign((columns & AREA) ? count : 0, 0.0);
+    perimeter.assign((columns & PERIMETER) ? count : 0, 0.0);
+    centroid.assign((columns & CENTROID) ? count : 0, cv::Point2f(0, 0));
+    boundingBox.assign((columns & BOUNDING_BOX) ? count : 0, cv::Rect());
+    circularity.assign((columns & CIRCULARITY) ? count : 0, 0.0);
+
+    cv::parallel_for_(cv::Range(0, count), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            const std::vector<cv::Point>& contour = contours[i];
+            indices[i] = i;
+
+            if (columns & AREA) {
+                area[i] = cv::contourArea(contour);
+            }
+
+            if (columns & PERIMETER) {
+                perimeter[i] = cv::arcLength(contour, true);
+            }
+
+            if (columns & CENTROID) {
+                cv::Moments m = cv::moments(contour);
+                if (m.m00 != 0) {
+                    centroid[i] = cv::Point2f(static_cast<float>(m.m10 / m.m00),
+                                              static_cast<float>(m.m01 / m.m00));
+                }
+            }
+
+            if (columns & BOUNDING_BOX) {
+                boundingBox[i] = cv::boundingRect(contour);
+            }
+
+            // Circularity (4π×area/perimeter²)
+            if ((columns & CIRCULARITY) && perimeter[i] > 0) {
+                circularity[i] = (4 * CV_PI * area[i]) / (perimeter[i] * perimeter[i]);
+            }
+        }
+    });
+}
+
+ContourTable ContourTable::select(const std::vector<uchar>& mask) const {
+    ContourTable result;
+    result.source = source;
+    result.computedColumns = computedColumns;
+
+    if (mask.size() != indices.size()) {
+        return result;
+    }
+
+    compact(indices, mask, result.indices);
+    compact(area, mask, result.area);
+    compact(perimeter, mask, result.perimeter);
+    compact(centroid, mask, result.centroid);
+    compact(boundingBox, mask, result.boundingBox);
+    compact(circularity, mask, result.circularity);
+
+    return result;
+}
+
+// =============================================================================
+// FILTER MASKS
+// =============================================================================
+
+std::vector<uchar> ContourTable::maskByArea(double minArea, double maxArea) const {
+    std::vector<uchar> mask(size(), 0);
+    if (area.empty()) {
+        return mask;
+    }
+
+    for (size_t i = 0; i < mask.size(); ++i) {
+        mask[i] = area[i] >= minArea && (maxArea < 0 || area[i] <= maxArea);
+    }
+    return mask;
+}
+
+std::vector<uchar> ContourTable::maskByCircularity(double minCircularity,
+                                                   double maxCircularity) const {
+    std::vector<uchar> mask(size(), 0);
+    if (circularity.empty()) {
+        return mask;
+    }
+
+    for (size_t i = 0; i < mask.size(); ++i) {
+        mask[i] = circularity[i] >= minCircularity && circularity[i] <= maxCircularity;
+    }
+    return mask;
+}
+
+void ContourTable::combineMasks(std::vector<uchar>& mask, const std::vector<uchar>& other) {
+    const size_t count = std::min(mask.size(), other.size());
+    for (size_t i = 0; i < count; ++i) {
+        mask[i] = mask[i] && other[i];
+    }
+    std::fill(mask.begin() + count, mask.end(), 0);
+}
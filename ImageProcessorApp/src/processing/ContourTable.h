@@ -0,0 +1,119 @@
+#ifndef CONTOURTABLE_H
+#define CONTOURTABLE_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Column-oriented feature table for a set of contours
+ *
+ * Each feature is stored in its own array (one entry per row) and rows refer
+ * back to the original contour storage by index, so no point data is copied.
+ * Columns are filled once, in parallel, and only the requested ones are
+ * computed. Filtering produces byte masks that can be combined and then
+ * applied with select(), which only compacts the feature columns.
+ *
+ * The table does not own the contours: the vector passed to build() must
+ * outlive it and stay unchanged.
+ */
+class ContourTable {
+public:
+    typedef std::vector<std::vector<cv::Point>> ContourList;
+
+    /**
+     * @brief Feature columns that can be requested from build()
+     */
+    enum Column {
+        AREA = 1 << 0,
+        PERIMETER = 1 << 1,
+        CENTROID = 1 << 2,
+        BOUNDING_BOX = 1 << 3,
+        CIRCULARITY = 1 << 4,   // Implies AREA and PERIMETER
+        ALL_COLUMNS = AREA | PERIMETER | CENTROID | BOUNDING_BOX | CIRCULARITY
+    };
+
+    ContourTable();
+
+    // ==========================================================================
+    // CONSTRUCTION
+    // ==========================================================================
+
+    /**
+     * @brief Compute the requested feature columns for every contour
+     * @param contours Contour storage (referenced, not copied)
+     * @param columns Bitwise OR of Column values
+     */
+    void build(const ContourList& contours, int columns = ALL_COLUMNS);
+
+    /**
+     * @brief Keep only the rows whose mask entry is non-zero
+     * @param mask One entry per row
+     * @return New table referring to the same contour storage
+     */
+    ContourTable select(const std::vector<uchar>& mask) const;
+
+    // ==========================================================================
+    // FILTER MASKS
+    // ==========================================================================
+
+    /**
+     * @brief Mask rows by area
+     * @param minArea Minimum area
+     * @param maxArea Maximum area (negative for no limit)
+     * @return One entry per row (1 = keep)
+     */
+    std::vector<uchar> maskByArea(double minArea, double maxArea = -1) const;
+
+    /**
+     * @brief Mask rows by circularity
+     * @param minCircularity Minimum circularity (0-1, circle=1)
+     * @param maxCircularity Maximum circularity
+     * @return One entry per row (1 = keep)
+     */
+    std::vector<uchar> maskByCircularity(double minCircularity, double maxCircularity) const;
+
+    /**
+     * @brief Intersect two masks in place (mask = mask AND other)
+     */
+    static void combineMasks(std::vector<uchar>& mask, const std::vector<uchar>& other);
+
+    // ==========================================================================
+    // ACCESS
+    // ==========================================================================
+
+    size_t size() const { return indices.size(); }
+    bool empty() const { return indices.empty(); }
+    int columns() const { return computedColumns; }
+
+    /**
+     * @brief Contour of a row, read from the original storage
+     */
+    const std::vector<cv::Point>& contour(size_t row) const { return (*source)[indices[row]]; }
+
+    /**
+     * @brief Position of a row in the original contour storage
+     */
+    int index(size_t row) const { return indices[row]; }
+
+    const std::vector<int>& sourceIndices() const { return indices; }
+    const std::vector<double>& areas() const { return area; }
+    const std::vector<double>& perimeters() const { return perimeter; }
+    const std::vector<cv::Point2f>& centroids() const { return centroid; }
+    const std::vector<cv::Rect>& boundingBoxes() const { return boundingBox; }
+    const std::vector<double>& circularities() const { return circularity; }
+
+    const ContourList* contours() const { return source; }
+
+private:
+    const ContourList* source;
+    int computedColumns;
+
+    std::vector<int> indices;
+    std::vector<double> area;
+    std::vector<double> perimeter;
+    std::vector<cv::Point2f> centroid;
+    std::vector<cv::Rect> boundingBox;
+    std::vector<double> circularity;
+};
+
+#endif // CONTOURTABLE_H
@@ -0,0 +1,357 @@
+#include "DerivedImageCache.h"
+#include "IntegralImage.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <map>
+#include <mutex>
+
+const size_t DerivedImageCache::DEFAULT_CACHE_BUDGET;
+const size_t DerivedImageCache::MAX_IMAGES;
+
+namespace {
+
+enum Form {
+    FORM_GRAY,
+    FORM_HSV,
+    FORM_LAB,
+    FORM_FLOAT,
+    FORM_COUNT
+};
+
+struct Entry {
+    uint64_t version;
+    ImageHandle source;  // keeps the pixels of this version alive
+    DerivedImageCache::ContentHash hash;
+    bool hashed;         // hash computed
+    cv::Mat forms[FORM_COUNT];
+    std::shared_ptr<const IntegralImage> integral;
+    std::vector<cv::Mat> pyramid;
+    size_t bytes;        // source and forms
+
+    Entry(const ImageHandle& image, size_t sourceBytes)
+        : version(image.version()), source(image), hash(), hashed(false), bytes(sourceBytes) {}
+};
+
+// Most recently used image first
+struct Cache {
+    std::list<Entry> entries;
+    std::map<uint64_t, std::list<Entry>::iterator> index;
+    size_t bytes = 0;
+    size_t budget = DerivedImageCache::DEFAULT_CACHE_BUDGET;
+};
+
+std::mutex& cacheMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+Cache& cache() {
+    static Cache instance;
+    return instance;
+}
+
+size_t matBytes(const cv::Mat& mat) {
+    return mat.total() * mat.elemSize();
+}
+
+void erase(Cache& c, std::list<Entry>::iterator it) {
+    c.bytes -= it->bytes;
+    c.index.erase(it->version);
+    c.entries.erase(it);
+}
+
+// Drop least recently used images until images and forms fit the budget and
+// the image limit (the most recent image always stays)
+void evict(Cache& c) {
+    while (c.entries.size() > 1 &&
+           (c.bytes > c.budget || c.entries.size() > DerivedImageCache::MAX_IMAGES)) {
+        erase(c, std::prev(c.entries.end()));
+    }
+}
+
+// Entry of an image version, created on first use and moved to the front
+// (lock held)
+Entry& touch(Cache& c, const ImageHandle& image) {
+    auto found = c.index.find(image.version());
+    if (found != c.index.end()) {
+        c.entries.splice(c.entries.begin(), c.entries, found->second);
+        return *found->second;
+    }
+    const size_t sourceBytes = matBytes(image.mat());
+    c.entries.emplace_front(image, sourceBytes);
+    c.index[image.version()] = c.entries.begin();
+    c.bytes += sourceBytes;
+    evict(c);
+    return c.entries.front();
+}
+
+// Entry to store a computed form in, unless it was evicted meanwhile (lock held)
+Entry* entryForStore(Cache& c, const ImageHandle& image) {
+    auto found = c.index.find(image.version());
+    return found == c.index.end() ? nullptr : &*found->second;
+}
+
+// 64-bit finalizer (MurmurHash3 fmix64)
+uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Hash of a run of rows, eight bytes per step, in two independent lanes
+DerivedImageCache::ContentHash hashRows(const cv::Mat& image, int begin, int end) {
+    const size_t rowBytes = image.cols * image.elemSize();
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ static_cast<uint64_t>(begin);
+    uint64_t g = 0xc2b2ae3d27d4eb4fULL + static_cast<uint64_t>(begin);
+    for (int y = begin; y < end; ++y) {
+        const uchar* row = image.ptr<uchar>(y);
+        size_t i = 0;
+        for (; i + 8 <= rowBytes; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, row + i, 8);
+            h = (h ^ (word * 0x87c37b91114253d5ULL)) * 0x4cf5ad432745937fULL;
+            h ^= h >> 29;
+            g = (g + (word ^ 0x165667b19e3779f9ULL)) * 0xff51afd7ed558ccdULL;
+            g = (g << 31) | (g >> 33);
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, row + i, rowBytes - i);
+        h = (h ^ (tail * 0x87c37b91114253d5ULL)) * 0x4cf5ad432745937fULL;
+        h ^= h >> 29;
+        g = (g + (tail ^ 0x165667b19e3779f9ULL)) * 0xff51afd7ed558ccdULL;
+        g = (g << 31) | (g >> 33);
+    }
+    DerivedImageCache::ContentHash hash;
+    hash.high = mix(h);
+    hash.low = mix(g ^ 0x27d4eb2f165667c5ULL);
+    return hash;
+}
+
+// Rows are hashed in parallel blocks, then combined in order
+DerivedImageCache::ContentHash hashImage(const cv::Mat& image) {
+    const int blockRows = std::max(1, (256 * 1024) / std::max<int>(1, static_cast<int>(
+                                      image.cols * image.elemSize())));
+    const int blocks = (image.rows + blockRows - 1) / blockRows;
+    std::vector<DerivedImageCache::ContentHash> blockHashes(blocks);
+    cv::parallel_for_(cv::Range(0, blocks), [&](const cv::Range& range) {
+        for (int b = range.start; b < range.end; ++b) {
+            blockHashes[b] = hashRows(image, b * blockRows,
+                                      std::min(image.rows, (b + 1) * blockRows));
+        }
+    });
+
+    const uint64_t shape = (static_cast<uint64_t>(image.rows) << 32) ^
+                           (static_cast<uint64_t>(image.cols) << 8) ^
+                           static_cast<uint64_t>(image.type());
+    DerivedImageCache::ContentHash hash;
+    hash.high = mix(shape);
+    hash.low = mix(shape ^ 0x94d049bb133111ebULL);
+    for (const DerivedImageCache::ContentHash& blockHash : blockHashes) {
+        hash.high = mix(hash.high ^ blockHash.high) + 0x9e3779b97f4a7c15ULL;
+        hash.low = mix(hash.low + blockHash.low) ^ 0xbf58476d1ce4e5b9ULL;
+    }
+    return hash;
+}
+
+template <typename Compute>
+cv::Mat derived(const ImageHandle& image, Form form, Compute compute) {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        Entry& entry = touch(cache(), image);
+        if (!entry.forms[form].empty()) {
+            return entry.forms[form];
+        }
+    }
+
+    // Computed outside the lock; a concurrent miss on the same form computes twice
+    cv::Mat result;
+    compute(image.mat(), result);
+
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    Cache& c = cache();
+    Entry* entry = entryForStore(c, image);
+    if (entry && entry->forms[form].empty() && !result.empty()) {
+        entry->forms[form] = result;
+        entry->bytes += matBytes(result);
+        c.bytes += matBytes(result);
+        evict(c);
+    }
+    return result;
+}
+
+} // namespace
+
+// =============================================================================
+// DERIVED FORMS
+// =============================================================================
+
+cv::Mat DerivedImageCache::gray(const ImageHandle& image) {
+    if (image.empty() || image->channels() == 1) {
+        return image.mat();
+    }
+    if (image->channels() != 3 && image->channels() != 4) {
+        return cv::Mat();
+    }
+    return derived(image, FORM_GRAY, [](const cv::Mat& source, cv::Mat& result) {
+        TRACE_SCOPE("analysis", "gray");
+        cv::cvtColor(source, result,
+                     source.channels() == 3 ? cv::COLOR_BGR2GRAY : cv::COLOR_BGRA2GRAY);
+    });
+}
+
+cv::Mat DerivedImageCache::hsv(const ImageHandle& image) {
+    if (image.empty() || image->channels() != 3) {
+        return cv::Mat();
+    }
+    return derived(image, FORM_HSV, [](const cv::Mat& source, cv::Mat& result) {
+        TRACE_SCOPE("analysis", "hsv");
+        cv::cvtColor(source, result, cv::COLOR_BGR2HSV);
+    });
+}
+
+cv::Mat DerivedImageCache::lab(const ImageHandle& image) {
+    if (image.empty() || image->channels() != 3) {
+        return cv::Mat();
+    }
+    return derived(image, FORM_LAB, [](const cv::Mat& source, cv::Mat& result) {
+        TRACE_SCOPE("analysis", "lab");
+        cv::cvtColor(source, result, cv::COLOR_BGR2Lab);
+    });
+}
+
+cv::Mat DerivedImageCache::toFloat(const ImageHandle& image) {
+    if (image.empty() || image->depth() == CV_32F) {
+        return image.mat();
+    }
+    return derived(image, FORM_FLOAT, [](const cv::Mat& source, cv::Mat& result) {
+        TRACE_SCOPE("analysis", "float");
+        source.convertTo(result, CV_32F);
+    });
+}
+
+std::shared_ptr<const IntegralImage> DerivedImageCache::integral(const ImageHandle& image) {
+    if (image.empty()) {
+        return std::make_shared<IntegralImage>();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        Entry& entry = touch(cache(), image);
+        if (entry.integral) {
+            return entry.integral;
+        }
+    }
+
+    std::shared_ptr<IntegralImage> tables = std::make_shared<IntegralImage>();
+    tables->build(gray(image));
+
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    Cache& c = cache();
+    Entry* entry = entryForStore(c, image);
+    if (entry && !entry->integral) {
+        const size_t bytes = matBytes(tables->sums()) + matBytes(tables->squaredSums());
+        entry->integral = tables;
+        entry->bytes += bytes;
+        c.bytes += bytes;
+        evict(c);
+    }
+    return tables;
+}
+
+std::vector<cv::Mat> DerivedImageCache::pyramid(const ImageHandle& image, int levels) {
+    levels = std::max(0, levels);
+    if (image.empty() || levels == 0) {
+        return std::vector<cv::Mat>(1, image.mat());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        Entry& entry = touch(cache(), image);
+        if (static_cast<int>(entry.pyramid.size()) > levels) {
+            return std::vector<cv::Mat>(entry.pyramid.begin(),
+                                        entry.pyramid.begin() + levels + 1);
+        }
+    }
+
+    std::vector<cv::Mat> result;
+    {
+        TRACE_SCOPE("analysis", "pyramid");
+        cv::buildPyramid(image.mat(), result, levels);
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    Cache& c = cache();
+    Entry* entry = entryForStore(c, image);
+    if (entry && entry->pyramid.size() < result.size()) {
+        size_t bytes = 0;
+        for (size_t i = 1; i < result.size(); ++i) {
+            bytes += matBytes(result[i]);   // level 0 is the image itself
+        }
+        size_t oldBytes = 0;
+        for (size_t i = 1; i < entry->pyramid.size(); ++i) {
+            oldBytes += matBytes(entry->pyramid[i]);
+        }
+        entry->pyramid = result;
+        entry->bytes += bytes - oldBytes;
+        c.bytes += bytes - oldBytes;
+        evict(c);
+    }
+    return result;
+}
+
+DerivedImageCache::ContentHash DerivedImageCache::contentHash(const ImageHandle& image) {
+    if (image.empty()) {
+        return ContentHash();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        Entry& entry = touch(cache(), image);
+        if (entry.hashed) {
+            return entry.hash;
+        }
+    }
+
+    ContentHash hash;
+    {
+        TRACE_SCOPE("analysis", "content hash");
+        hash = hashImage(image.mat());
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    Entry* entry = entryForStore(cache(), image);
+    if (entry) {
+        entry->hash = hash;
+        entry->hashed = true;
+    }
+    return hash;
+}
+
+// =============================================================================
+// CACHE
+// =============================================================================
+
+void DerivedImageCache::setCacheBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    cache().budget = bytes;
+    evict(cache());
+}
+
+void DerivedImageCache::clearCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    Cache& c = cache();
+    c.entries.clear();
+    c.index.clear();
+    c.bytes = 0;
+}
+
+size_t DerivedImageCache::cacheBytes() {
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    return cache().bytes;
+}
@@ -0,0 +1,128 @@
+#ifndef DERIVEDIMAGECACHE_H
+#define DERIVEDIMAGECACHE_H
+
+#include "ImageHandle.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class IntegralImage;
+
+/**
+ * @brief Opt-in cache of representations derived from an image handle
+ *
+ * Thresholds, edge detectors and color adjustments all start by converting
+ * their input (BGR -> gray, HSV, Lab, CV_32F, integral tables). The
+ * processing libraries always convert for themselves; a caller that keeps
+ * working on one image (the main window, a dialog previewing settings) can
+ * ask this cache for a form instead and pass it on, so switching between
+ * operations on one input skips the conversions.
+ *
+ * Entries are keyed by ImageHandle::version() and hold a copy of the
+ * handle. While it is cached, the content of that version cannot change:
+ * edit() on a shared handle copies the pixels and takes a new version.
+ * Plain cv::Mat buffers are never cached, so code that rewrites a Mat in
+ * place is unaffected.
+ *
+ * Returned Mats are shared and must be treated as read-only (copy before
+ * writing). Cached memory, including the source images the entries keep
+ * alive, is bounded by a budget; least recently used images are dropped
+ * first.
+ */
+class DerivedImageCache {
+public:
+    /**
+     * @brief Default memory budget of cached images and their forms (bytes)
+     */
+    static const size_t DEFAULT_CACHE_BUDGET = 256 * 1024 * 1024;
+
+    /**
+     * @brief Most images tracked at once (each keeps its pixels alive)
+     */
+    static const size_t MAX_IMAGES = 8;
+
+    /**
+     * @brief 128-bit content hash (two independent 64-bit lanes)
+     */
+    struct ContentHash {
+        uint64_t high;
+        uint64_t low;
+
+        ContentHash() : high(0), low(0) {}
+        bool operator==(const ContentHash& other) const {
+            return high == other.high && low == other.low;
+        }
+        bool operator!=(const ContentHash& other) const { return !(*this == other); }
+    };
+
+    // ==========================================================================
+    // DERIVED FORMS
+    // ==========================================================================
+
+    /**
+     * @brief Grayscale form (CV_8U for 8-bit input)
+     * @return The image itself if it is single-channel; empty for
+     *         unsupported channel counts
+     */
+    static cv::Mat gray(const ImageHandle& image);
+
+    /**
+     * @brief HSV form of a 3-channel BGR image (empty otherwise)
+     */
+    static cv::Mat hsv(const ImageHandle& image);
+
+    /**
+     * @brief Lab form of a 3-channel BGR image (empty otherwise)
+     */
+    static cv::Mat lab(const ImageHandle& image);
+
+    /**
+     * @brief CV_32F form with the same channels and unscaled values
+     * @return The image itself if it is already CV_32F
+     */
+    static cv::Mat toFloat(const ImageHandle& image);
+
+    /**
+     * @brief Summed-area tables of the grayscale form
+     */
+    static std::shared_ptr<const IntegralImage> integral(const ImageHandle& image);
+
+    /**
+     * @brief Gaussian pyramid (cv::buildPyramid)
+     * @param levels Levels below the image
+     * @return levels + 1 images, the first being the image itself
+     */
+    static std::vector<cv::Mat> pyramid(const ImageHandle& image, int levels);
+
+    /**
+     * @brief 128-bit hash of an image's pixels, size and type
+     *
+     * Equal content gives equal hashes whatever the buffer, so results can be
+     * matched across copies of an image (e.g. a dialog's private clone and
+     * an undo snapshot). Computed once per version; all zero for an empty
+     * image.
+     */
+    static ContentHash contentHash(const ImageHandle& image);
+
+    // ==========================================================================
+    // CACHE
+    // ==========================================================================
+
+    /**
+     * @brief Limit the memory of cached images and forms (evicts as needed)
+     */
+    static void setCacheBudget(size_t bytes);
+
+    /**
+     * @brief Drop all cached forms and release all images
+     */
+    static void clearCache();
+
+    /**
+     * @brief Memory held by cached images and their forms
+     */
+    static size_t cacheBytes();
+};
+
+#endif // DERIVEDIMAGECACHE_H
@@ -0,0 +1,339 @@
+#include "GrabCutSession.h"
+#include "MorphologyEngine.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Pixel budget of the coarse solve (about 0.5 MP)
+const int DEFAULT_WORKING_PIXELS = 1 << 19;
+const int MIN_WORKING_PIXELS = 1 << 14;
+
+// Boundary band tiles and the context added around each of them
+const int TILE_SIZE = 256;
+const int TILE_MARGIN = 16;
+
+const uchar NO_CONSTRAINT = 255;
+
+#if CV_VERSION_MAJOR >= 4
+const int FROZEN_MODEL_MODE = cv::GC_EVAL_FREEZE_MODEL;
+#else
+const int FROZEN_MODEL_MODE = cv::GC_EVAL;
+#endif
+
+cv::Rect grow(const cv::Rect& rect, int by) {
+    return cv::Rect(rect.x - by, rect.y - by, rect.width + 2 * by, rect.height + 2 * by);
+}
+
+cv::Rect unite(const cv::Rect& a, const cv::Rect& b) {
+    if (a.area() <= 0) return b;
+    if (b.area() <= 0) return a;
+    return a | b;
+}
+
+void drawStroke(cv::Mat& target, const std::vector<cv::Point>& points, int radius,
+                uchar value, double sx, double sy) {
+    const int r = std::max(1, cvRound(radius * std::min(sx, sy)));
+    const cv::Scalar color(value);
+
+    cv::Point prev(cvRound(points[0].x * sx), cvRound(points[0].y * sy));
+    cv::circle(target, prev, r, color, -1);
+    for (size_t i = 1; i < points.size(); ++i) {
+        cv::Point cur(cvRound(points[i].x * sx), cvRound(points[i].y * sy));
+        cv::line(target, prev, cur, color, 2 * r + 1);
+        cv::circle(target, cur, r, color, -1);
+        prev = cur;
+    }
+}
+
+} // namespace
+
+GrabCutSession::GrabCutSession() : scale(1.0), workingPixels(DEFAULT_WORKING_PIXELS) {
+}
+
+// =============================================================================
+// SESSION
+// =============================================================================
+
+bool GrabCutSession::initWithRect(const cv::Mat& input, const cv::Rect& rect, int iterations) {
+    TRACE_FUNCTION("segmentation");
+    reset();
+    if (input.empty() || input.type() != CV_8UC3) {
+        return false;
+    }
+
+    prepare(input);
+
+    const double sx = static_cast<double>(smallImage.cols) / image.cols;
+    const double sy = static_cast<double>(smallImage.rows) / image.rows;
+    cv::Rect smallRect(cvFloor(rect.x * sx), cvFloor(rect.y * sy),
+                       cvCeil(rect.width * sx), cvCeil(rect.height * sy));
+    smallRect &= cv::Rect(0, 0, smallImage.cols, smallImage.rows);
+
+    smallMask = cv::Mat::zeros(smallImage.size(), CV_8U);
+    try {
+        cv::grabCut(smallImage, smallMask, smallRect, bgModel, fgModel,
+                    std::max(1, iterations), cv::GC_INIT_WITH_RECT);
+    } catch (const cv::Exception&) {
+        reset();
+        return false;
+    }
+
+    refineBoundary(cv::Rect(0, 0, image.cols, image.rows));
+    return true;
+}
+
+bool GrabCutSession::initWithMask(const cv::Mat& input, const cv::Mat& mask, int iterations) {
+    TRACE_FUNCTION("segmentation");
+    reset();
+    if (input.empty() || input.type() != CV_8UC3 || mask.size() != input.size() ||
+        mask.type() != CV_8UC1) {
+        return false;
+    }
+
+    prepare(input);
+
+    // Definite labels of the initial mask become hard constraints
+    constraints = cv::Mat(image.size(), CV_8U, cv::Scalar(NO_CONSTRAINT));
+    constraints.setTo(cv::Scalar(cv::GC_BGD), mask == cv::GC_BGD);
+    constraints.setTo(cv::Scalar(cv::GC_FGD), mask == cv::GC_FGD);
+
+    if (scale < 1.0) {
+        cv::resize(mask, smallMask, smallImage.size(), 0, 0, cv::INTER_NEAREST);
+    } else {
+        smallMask = mask.clone();
+    }
+
+    try {
+        cv::grabCut(smallImage, smallMask, cv::Rect(), bgModel, fgModel,
+                    std::max(1, iterations), cv::GC_INIT_WITH_MASK);
+    } catch (const cv::Exception&) {
+        reset();
+        return false;
+    }
+
+    refineBoundary(cv::Rect(0, 0, image.cols, image.rows));
+    return true;
+}
+
+void GrabCutSession::addStroke(const std::vector<cv::Point>& points, int radius, bool foreground) {
+    if (!isActive() || points.empty()) {
+        return;
+    }
+
+    const uchar value = foreground ? cv::GC_FGD : cv::GC_BGD;
+    radius = std::max(1, radius);
+
+    if (constraints.empty()) {
+        constraints = cv::Mat(image.size(), CV_8U, cv::Scalar(NO_CONSTRAINT));
+    }
+    drawStroke(constraints, points, radius, value, 1.0, 1.0);
+    drawStroke(smallMask, points, radius, value,
+               static_cast<double>(smallImage.cols) / image.cols,
+               static_cast<double>(smallImage.rows) / image.rows);
+
+    cv::Rect touched = grow(cv::boundingRect(points), radius + 1) &
+                       cv::Rect(0, 0, image.cols, image.rows);
+    pendingRegion = unite(pendingRegion, touched);
+}
+
+bool GrabCutSession::update(int iterations) {
+    TRACE_FUNCTION("segmentation");
+    if (!isActive()) {
+        return false;
+    }
+
+    cv::Mat before, after;
+    cv::bitwise_and(smallMask, cv::Scalar(1), before);
+    try {
+        // Resume from the kept models instead of re-initializing them
+        cv::grabCut(smallImage, smallMask, cv::Rect(), bgModel, fgModel,
+                    std::max(1, iterations), cv::GC_EVAL);
+    } catch (const cv::Exception&) {
+        return false;
+    }
+
+    // Only the area where the coarse result moved (or strokes landed) is refined
+    cv::bitwise_and(smallMask, cv::Scalar(1), after);
+    cv::Mat changed = after != before;
+    std::vector<cv::Point> changedPoints;
+    cv::findNonZero(changed, changedPoints);
+
+    cv::Rect region = pendingRegion;
+    if (!changedPoints.empty()) {
+        region = unite(region, coarseToImage(cv::boundingRect(changedPoints)));
+    }
+    pendingRegion = cv::Rect();
+
+    if (region.area() > 0) {
+        refineBoundary(grow(region, bandRadius()));
+    }
+    return true;
+}
+
+void GrabCutSession::reset() {
+    image.release();
+    smallImage.release();
+    smallMask.release();
+    bgModel.release();
+    fgModel.release();
+    constraints.release();
+    resultMask.release();
+    pendingRegion = cv::Rect();
+    scale = 1.0;
+}
+
+// =============================================================================
+// RESULTS
+// =============================================================================
+
+void GrabCutSession::foregroundMask(cv::Mat& output) const {
+    if (resultMask.empty()) {
+        output = cv::Mat();
+        return;
+    }
+
+    // GC_FGD and GC_PR_FGD are the odd values
+    cv::bitwise_and(resultMask, cv::Scalar(1), output);
+    output *= 255;
+}
+
+void GrabCutSession::setWorkingPixels(int pixels) {
+    workingPixels = std::max(MIN_WORKING_PIXELS, pixels);
+}
+
+// =============================================================================
+// PRIVATE HELPERS
+// =============================================================================
+
+void GrabCutSession::prepare(const cv::Mat& input) {
+    image = input;
+
+    const double area = static_cast<double>(image.rows) * image.cols;
+    scale = area > workingPixels ? std::sqrt(workingPixels / area) : 1.0;
+
+    if (scale < 1.0) {
+        cv::Size smallSize(std::max(1, cvRound(image.cols * scale)),
+                           std::max(1, cvRound(image.rows * scale)));
+        cv::resize(image, smallImage, smallSize, 0, 0, cv::INTER_AREA);
+    } else {
+        smallImage = image;
+    }
+
+    resultMask = cv::Mat(image.size(), CV_8U, cv::Scalar(cv::GC_BGD));
+}
+
+void GrabCutSession::refineBoundary(const cv::Rect& area) {
+    const cv::Rect imageRect(0, 0, image.cols, image.rows);
+    const cv::Rect region = area & imageRect;
+    if (region.area() <= 0) {
+        return;
+    }
+
+    // Solved at full resolution already: only the hard constraints remain
+    if (scale >= 1.0) {
+        smallMask(region).copyTo(resultMask(region));
+        if (!constraints.empty()) {
+            cv::Mat fixed = constraints(region) != NO_CONSTRAINT;
+            constraints(region).copyTo(resultMask(region), fixed);
+        }
+        return;
+    }
+
+    // Work on the region grown by the band radius so the band is exact inside it
+    const int radius = bandRadius();
+    const cv::Rect outer = grow(region, radius) & imageRect;
+    const double sx = static_cast<double>(smallMask.cols) / image.cols;
+    const double sy = static_cast<double>(smallMask.rows) / image.rows;
+
+    // Coarse foreground at full resolution (nearest neighbour)
+    cv::Mat fg(outer.size(), CV_8U);
+    cv::parallel_for_(cv::Range(0, outer.height), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const int smallY = std::min(static_cast<int>((outer.y + y) * sy), smallMask.rows - 1);
+            const uchar* src = smallMask.ptr<uchar>(smallY);
+            uchar* dst = fg.ptr<uchar>(y);
+            for (int x = 0; x < outer.width; ++x) {
+                const int smallX = std::min(static_cast<int>((outer.x + x) * sx), smallMask.cols - 1);
+                dst[x] = (src[smallX] & 1) ? 255 : 0;
+            }
+        }
+    });
+
+    // Band of uncertain pixels around the coarse boundary
+    cv::Mat band;
+    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT,
+                                               cv::Size(2 * radius + 1, 2 * radius + 1));
+    MorphologyEngine::morphologyEx(fg, band, cv::MORPH_GRADIENT, kernel, 1,
+                                   MorphologyEngine::INPUT_MASK);
+
+    // Definite labels away from the boundary, probable labels inside the band
+    cv::Mat work(outer.size(), CV_8U);
+    cv::parallel_for_(cv::Range(0, outer.height), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const uchar* f = fg.ptr<uchar>(y);
+            const uchar* b = band.ptr<uchar>(y);
+            const uchar* c = constraints.empty() ? nullptr
+                                                 : constraints.ptr<uchar>(outer.y + y) + outer.x;
+            uchar* dst = work.ptr<uchar>(y);
+            for (int x = 0; x < outer.width; ++x) {
+                if (c && c[x] != NO_CONSTRAINT) {
+                    dst[x] = c[x];
+                } else if (f[x]) {
+                    dst[x] = b[x] ? cv::GC_PR_FGD : cv::GC_FGD;
+                } else {
+                    dst[x] = b[x] ? cv::GC_PR_BGD : cv::GC_BGD;
+                }
+            }
+        }
+    });
+
+    const cv::Point origin = outer.tl();
+    work(region - origin).copyTo(resultMask(region));
+
+    // Solve the band tile by tile with the models frozen
+    std::vector<cv::Rect> tiles;
+    for (int y = region.y; y < region.y + region.height; y += TILE_SIZE) {
+        for (int x = region.x; x < region.x + region.width; x += TILE_SIZE) {
+            tiles.push_back(cv::Rect(x, y, TILE_SIZE, TILE_SIZE) & region);
+        }
+    }
+
+    cv::parallel_for_(cv::Range(0, static_cast<int>(tiles.size())), [&](const cv::Range& range) {
+        for (int t = range.start; t < range.end; ++t) {
+            const cv::Rect& tile = tiles[t];
+            if (cv::countNonZero(band(tile - origin)) == 0) {
+                continue;
+            }
+
+            const cv::Rect roi = grow(tile, TILE_MARGIN) & outer;
+            cv::Mat local = work(roi - origin).clone();
+            cv::Mat bg = bgModel.clone();
+            cv::Mat fgm = fgModel.clone();
+
+            try {
+                cv::grabCut(image(roi), local, cv::Rect(), bg, fgm, 1, FROZEN_MODEL_MODE);
+            } catch (const cv::Exception&) {
+                continue;  // Keep the coarse labels for this tile
+            }
+
+            local(tile - roi.tl()).copyTo(resultMask(tile));
+        }
+    });
+}
+
+cv::Rect GrabCutSession::coarseToImage(const cv::Rect& rect) const {
+    const double sx = static_cast<double>(image.cols) / smallImage.cols;
+    const double sy = static_cast<double>(image.rows) / smallImage.rows;
+    const int x0 = cvFloor(rect.x * sx) - 1;
+    const int y0 = cvFloor(rect.y * sy) - 1;
+    const int x1 = cvCeil((rect.x + rect.width) * sx) + 1;
+    const int y1 = cvCeil((rect.y + rect.height) * sy) + 1;
+    return cv::Rect(x0, y0, x1 - x0, y1 - y0) & cv::Rect(0, 0, image.cols, image.rows);
+}
+
+int GrabCutSession::bandRadius() const {
+    // Two coarse pixels on each side of the coarse boundary
+    return scale >= 1.0 ? 0 : cvCeil(2.0 / scale);
+}
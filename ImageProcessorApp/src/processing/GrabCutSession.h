@@ -0,0 +1,108 @@
+#ifndef GRABCUTSESSION_H
+#define GRABCUTSESSION_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Stateful, coarse-to-fine GrabCut for interactive cut-outs
+ *
+ * The color models (GMMs) are fitted once on a downsampled copy of the
+ * image and kept for the whole session; each refinement stroke resumes from
+ * them instead of starting over. Full-resolution work is limited to a band
+ * around the coarse boundary, split into tiles that are solved in parallel
+ * with the models frozen. Only the tiles affected by a stroke are solved
+ * again.
+ *
+ * Images small enough for the working resolution are solved directly at
+ * full resolution, which gives the same result as cv::grabCut.
+ */
+class GrabCutSession {
+public:
+    GrabCutSession();
+
+    // ==========================================================================
+    // SESSION
+    // ==========================================================================
+
+    /**
+     * @brief Start a session from a rectangle around the object
+     * @param image Source color image (CV_8UC3, must stay unchanged during the session)
+     * @param rect Rectangle containing the foreground object
+     * @param iterations Number of GrabCut iterations at the working resolution
+     * @return true on success
+     */
+    bool initWithRect(const cv::Mat& image, const cv::Rect& rect, int iterations = 5);
+
+    /**
+     * @brief Start a session from a GrabCut mask
+     * @param image Source color image (CV_8UC3, must stay unchanged during the session)
+     * @param mask Initial mask (CV_8UC1: GC_BGD, GC_FGD, GC_PR_BGD, GC_PR_FGD);
+     *             definite labels are kept as hard constraints
+     * @param iterations Number of GrabCut iterations at the working resolution
+     * @return true on success
+     */
+    bool initWithMask(const cv::Mat& image, const cv::Mat& mask, int iterations = 5);
+
+    /**
+     * @brief Mark pixels as definite foreground or background
+     * @param points Stroke polyline in image coordinates
+     * @param radius Brush radius in pixels
+     * @param foreground true for foreground, false for background
+     */
+    void addStroke(const std::vector<cv::Point>& points, int radius, bool foreground);
+
+    /**
+     * @brief Re-segment after strokes, reusing the current models
+     * @param iterations Number of GrabCut iterations at the working resolution
+     * @return true on success
+     */
+    bool update(int iterations = 1);
+
+    /**
+     * @brief End the session and release all buffers
+     */
+    void reset();
+
+    bool isActive() const { return !resultMask.empty(); }
+
+    // ==========================================================================
+    // RESULTS
+    // ==========================================================================
+
+    /**
+     * @brief Full-resolution GrabCut mask (GC_BGD, GC_FGD, GC_PR_BGD, GC_PR_FGD)
+     */
+    const cv::Mat& mask() const { return resultMask; }
+
+    /**
+     * @brief Full-resolution foreground mask
+     * @param output Binary mask (CV_8UC1, 255 = foreground)
+     */
+    void foregroundMask(cv::Mat& output) const;
+
+    /**
+     * @brief Set the pixel budget of the coarse solve
+     * @param pixels Maximum number of pixels of the downsampled image
+     */
+    void setWorkingPixels(int pixels);
+
+private:
+    void prepare(const cv::Mat& input);
+    void refineBoundary(const cv::Rect& region);
+    cv::Rect coarseToImage(const cv::Rect& rect) const;
+    int bandRadius() const;
+
+    cv::Mat image;          // Full-resolution source (shared, not copied)
+    cv::Mat smallImage;     // Downsampled source used for the coarse solve
+    cv::Mat smallMask;      // Coarse GrabCut mask
+    cv::Mat bgModel;        // Background GMM, kept between calls
+    cv::Mat fgModel;        // Foreground GMM, kept between calls
+    cv::Mat constraints;    // User strokes at full resolution (NO_CONSTRAINT elsewhere)
+    cv::Mat resultMask;     // Full-resolution result
+    cv::Rect pendingRegion; // Image area touched by strokes since the last update
+    double scale;           // smallImage size / image size
+    int workingPixels;
+};
+
+#endif // GRABCUTSESSION_H
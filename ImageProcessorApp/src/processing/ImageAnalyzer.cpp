@@ -0,0 +1,401 @@
+#include "ImageAnalyzer.h"
+#include "NoiseEstimator.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+// Samples analyzed by defaultSampleStep()
+const double TARGET_SAMPLES = 1 << 20;
+
+// Fixed-point BGR -> gray weights (same as cv::COLOR_BGR2GRAY)
+const int GRAY_SHIFT = 14;
+const int GRAY_B = 1868;
+const int GRAY_G = 9617;
+const int GRAY_R = 4899;
+
+// Noise sigma above which bilateral / Gaussian denoising is applied
+const double NOISE_SIGMA_BILATERAL = 5.0;
+const double NOISE_SIGMA_GAUSSIAN = 2.5;
+
+// Unsharp masking: result = (1 + amount) * image - amount * blurred
+const double SHARPEN_SIGMA = 2.0;
+const double SHARPEN_AMOUNT = 0.8;
+
+int reflect101(int i, int n) {
+    if (n == 1) {
+        return 0;
+    }
+    if (i < 0) {
+        return -i;
+    }
+    if (i >= n) {
+        return 2 * n - 2 - i;
+    }
+    return i;
+}
+
+void convertRowToGray(const uchar* src, uchar* dst, int cols, int cn) {
+    if (cn == 1) {
+        std::memcpy(dst, src, cols);
+        return;
+    }
+    for (int x = 0; x < cols; ++x, src += cn) {
+        dst[x] = static_cast<uchar>((src[0] * GRAY_B + src[1] * GRAY_G + src[2] * GRAY_R +
+                                     (1 << (GRAY_SHIFT - 1))) >> GRAY_SHIFT);
+    }
+}
+
+struct Accumulator {
+    double count;
+    double sum;
+    double sumSq;
+    int minValue;
+    int maxValue;
+    double lapSum;
+    double lapSumSq;
+    double valueCount[256];
+    double chromaSum[256];
+
+    Accumulator() : count(0), sum(0), sumSq(0), minValue(255), maxValue(0),
+                    lapSum(0), lapSumSq(0) {
+        std::fill(valueCount, valueCount + 256, 0.0);
+        std::fill(chromaSum, chromaSum + 256, 0.0);
+    }
+
+    void merge(const Accumulator& other) {
+        count += other.count;
+        sum += other.sum;
+        sumSq += other.sumSq;
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+        lapSum += other.lapSum;
+        lapSumSq += other.lapSumSq;
+        for (int v = 0; v < 256; ++v) {
+            valueCount[v] += other.valueCount[v];
+            chromaSum[v] += other.chromaSum[v];
+        }
+    }
+};
+
+} // namespace
+
+ImageAnalyzer::EnhancementPlan::EnhancementPlan()
+    : tone(TONE_NONE), alpha(1.0), beta(0), denoise(DENOISE_NONE),
+      sharpen(false), saturationGain(1.0), clahe(false) {
+}
+
+bool ImageAnalyzer::EnhancementPlan::isEmpty() const {
+    return tone == TONE_NONE && denoise == DENOISE_NONE && !sharpen &&
+           saturationGain == 1.0 && !clahe;
+}
+
+// =============================================================================
+// ANALYSIS
+// =============================================================================
+
+ImageAnalyzer::Statistics ImageAnalyzer::analyze(const cv::Mat& image, int sampleStep) {
+    TRACE_FUNCTION("analysis");
+    Statistics stats;
+    std::memset(&stats, 0, sizeof(stats));
+    sampleStep = std::max(1, sampleStep);
+    stats.sampleStep = sampleStep;
+    if (image.empty()) {
+        return stats;
+    }
+
+    cv::Mat src = image;
+    if (src.depth() != CV_8U) {
+        image.convertTo(src, CV_8U);
+    }
+
+    const int rows = src.rows;
+    const int cols = src.cols;
+    const int cn = src.channels();
+    const bool isColor = cn >= 3;
+    const int sampledRows = (rows + sampleStep - 1) / sampleStep;
+
+    Accumulator total;
+    std::mutex totalMutex;
+
+    cv::parallel_for_(cv::Range(0, sampledRows), [&](const cv::Range& range) {
+        Accumulator acc;
+
+        // Gray rows y-1, y, y+1 land in distinct slots, so consecutive rows
+        // are converted only once
+        std::vector<uchar> buffer(3 * static_cast<size_t>(cols));
+        int cached[3] = {-1, -1, -1};
+        auto grayRow = [&](int y) -> const uchar* {
+            y = reflect101(y, rows);
+            const int slot = y % 3;
+            uchar* row = &buffer[slot * static_cast<size_t>(cols)];
+            if (cached[slot] != y) {
+                convertRowToGray(src.ptr<uchar>(y), row, cols, cn);
+                cached[slot] = y;
+            }
+            return row;
+        };
+
+        for (int r = range.start; r < range.end; ++r) {
+            const int y = r * sampleStep;
+            const uchar* up = grayRow(y - 1);
+            const uchar* down = grayRow(y + 1);
+            const uchar* gray = grayRow(y);
+            const uchar* pixel = src.ptr<uchar>(y);
+
+            for (int x = 0; x < cols; x += sampleStep) {
+                const int v = gray[x];
+                acc.count += 1;
+                acc.sum += v;
+                acc.sumSq += static_cast<double>(v) * v;
+                acc.minValue = std::min(acc.minValue, v);
+                acc.maxValue = std::max(acc.maxValue, v);
+
+                // 3x3 Laplacian (cv::Laplacian, ksize 1, reflected border)
+                const int lap = up[x] + down[x] + gray[reflect101(x - 1, cols)] +
+                                gray[reflect101(x + 1, cols)] - 4 * v;
+                acc.lapSum += lap;
+                acc.lapSumSq += static_cast<double>(lap) * lap;
+
+                if (isColor) {
+                    const uchar* p = pixel + x * cn;
+                    const int hi = std::max(p[0], std::max(p[1], p[2]));
+                    const int lo = std::min(p[0], std::min(p[1], p[2]));
+                    acc.valueCount[hi] += 1;
+                    acc.chromaSum[hi] += hi - lo;
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(totalMutex);
+        total.merge(acc);
+    });
+
+    const double n = std::max(1.0, total.count);
+    stats.samples = static_cast<int>(total.count);
+    stats.isColor = isColor;
+    stats.minValue = total.minValue;
+    stats.maxValue = total.maxValue;
+    stats.mean = total.sum / n;
+    stats.stddev = std::sqrt(std::max(0.0, total.sumSq / n - stats.mean * stats.mean));
+    const double lapMean = total.lapSum / n;
+    stats.laplacianVariance = std::max(0.0, total.lapSumSq / n - lapMean * lapMean);
+    stats.noiseSigma = NoiseEstimator::estimateSigma(src);
+
+    std::copy(total.valueCount, total.valueCount + 256, stats.valueCount);
+    std::copy(total.chromaSum, total.chromaSum + 256, stats.chromaSum);
+    stats.meanSaturation = isColor ? predictSaturation(stats, 1.0, 0.0) : 0.0;
+
+    return stats;
+}
+
+int ImageAnalyzer::defaultSampleStep(const cv::Size& size) {
+    const double pixels = static_cast<double>(size.width) * size.height;
+    return std::max(1, static_cast<int>(std::sqrt(pixels / TARGET_SAMPLES)));
+}
+
+double ImageAnalyzer::predictSaturation(const Statistics& stats, double alpha, double beta) {
+    if (!stats.isColor || stats.samples <= 0) {
+        return 0.0;
+    }
+
+    // S = 255 * (max - min) / max; a linear change scales (max - min) by
+    // alpha and moves max to alpha * max + beta
+    double total = 0;
+    for (int v = 1; v < 256; ++v) {
+        if (stats.valueCount[v] == 0) {
+            continue;
+        }
+        const double value = std::min(255.0, alpha * v + beta);
+        if (value <= 0) {
+            continue;
+        }
+        const double saturation = 255.0 * alpha * stats.chromaSum[v] / value;
+        total += std::min(255.0 * stats.valueCount[v], saturation);
+    }
+    return total / stats.samples;
+}
+
+// =============================================================================
+// PLANNING & EXECUTION
+// =============================================================================
+
+ImageAnalyzer::EnhancementPlan ImageAnalyzer::planEnhancement(const Statistics& stats) {
+    EnhancementPlan plan;
+    if (stats.samples <= 0) {
+        return plan;
+    }
+
+    const double dynamicRange = stats.maxValue - stats.minValue;
+
+    // Brightness & contrast: too dark (mean < 100) or too bright (mean > 180)
+    if (stats.mean < 100.0) {
+        plan.tone = EnhancementPlan::TONE_BRIGHTNESS;
+        plan.alpha = 1.2;
+        plan.beta = static_cast<int>((120.0 - stats.mean) * 0.8);
+    } else if (stats.mean > 180.0) {
+        plan.tone = EnhancementPlan::TONE_BRIGHTNESS;
+        plan.alpha = 1.1;
+        plan.beta = static_cast<int>((120.0 - stats.mean) * 0.5);
+    } else if (stats.stddev < 50.0) {
+        // Low contrast
+        plan.tone = EnhancementPlan::TONE_EQUALIZE;
+    } else if (dynamicRange < 150) {
+        // Dynamic range too narrow
+        plan.tone = EnhancementPlan::TONE_STRETCH;
+        plan.alpha = 255.0 / dynamicRange;
+        plan.beta = static_cast<int>(-stats.minValue * plan.alpha);
+    }
+
+    // Noise reduction from the estimated noise level
+    if (stats.noiseSigma > NOISE_SIGMA_BILATERAL) {
+        plan.denoise = EnhancementPlan::DENOISE_BILATERAL;
+    } else if (stats.noiseSigma > NOISE_SIGMA_GAUSSIAN) {
+        plan.denoise = EnhancementPlan::DENOISE_GAUSSIAN;
+    }
+
+    // Sharpening for soft images (low Laplacian variance)
+    plan.sharpen = stats.laplacianVariance < 80.0;
+
+    // Saturation boost for dull images, judged after the tone change
+    if (stats.isColor) {
+        double saturation = stats.meanSaturation;
+        if (plan.tone == EnhancementPlan::TONE_BRIGHTNESS || plan.tone == EnhancementPlan::TONE_STRETCH) {
+            saturation = predictSaturation(stats, plan.alpha, plan.beta);
+        }
+        if (saturation < 100.0) {
+            plan.saturationGain = 1.3;
+        }
+    }
+
+    // CLAHE when contrast is still low and no contrast step was taken
+    if (plan.tone == EnhancementPlan::TONE_NONE || plan.tone == EnhancementPlan::TONE_BRIGHTNESS) {
+        plan.clahe = stats.stddev * plan.alpha < 45.0;
+    }
+
+    return plan;
+}
+
+void ImageAnalyzer::executePlan(const cv::Mat& input, cv::Mat& output, const EnhancementPlan& plan) {
+    TRACE_FUNCTION("analysis");
+    if (input.empty() || input.depth() != CV_8U) {
+        output = input.clone();
+        return;
+    }
+
+    const int cn = input.channels();
+    cv::Mat result = input;
+
+    // Tone: one lookup table for the linear corrections
+    if (plan.tone == EnhancementPlan::TONE_BRIGHTNESS || plan.tone == EnhancementPlan::TONE_STRETCH) {
+        cv::Mat lut(1, 256, CV_8U);
+        uchar* table = lut.ptr<uchar>();
+        for (int v = 0; v < 256; ++v) {
+            table[v] = cv::saturate_cast<uchar>(plan.alpha * v + plan.beta);
+        }
+        cv::Mat toned;
+        cv::LUT(result, lut, toned);
+        result = toned;
+    } else if (plan.tone == EnhancementPlan::TONE_EQUALIZE) {
+        cv::Mat toned;
+        if (cn == 3) {
+            cv::Mat ycrcb;
+            cv::cvtColor(result, ycrcb, cv::COLOR_BGR2YCrCb);
+            std::vector<cv::Mat> channels;
+            cv::split(ycrcb, channels);
+            cv::equalizeHist(channels[0], channels[0]);
+            cv::merge(channels, ycrcb);
+            cv::cvtColor(ycrcb, toned, cv::COLOR_YCrCb2BGR);
+            result = toned;
+        } else if (cn == 1) {
+            cv::equalizeHist(result, toned);
+            result = toned;
+        }
+    }
+
+    // Noise reduction
+    if (plan.denoise == EnhancementPlan::DENOISE_BILATERAL) {
+        cv::Mat denoised;
+        cv::bilateralFilter(result, denoised, 9, 75, 75);
+        result = denoised;
+    } else if (plan.denoise == EnhancementPlan::DENOISE_GAUSSIAN) {
+        cv::Mat denoised;
+        cv::GaussianBlur(result, denoised, cv::Size(3, 3), 0);
+        result = denoised;
+    }
+
+    // Sharpening and saturation boost in one per-pixel pass
+    const bool boost = plan.saturationGain != 1.0 && cn >= 3;
+    if (plan.sharpen || boost) {
+        cv::Mat blurred;
+        if (plan.sharpen) {
+            cv::GaussianBlur(result, blurred, cv::Size(0, 0), SHARPEN_SIGMA);
+        }
+
+        cv::Mat fused(result.size(), result.type());
+        const int cols = result.cols;
+        const float gain = static_cast<float>(plan.saturationGain);
+        cv::parallel_for_(cv::Range(0, result.rows), [&](const cv::Range& range) {
+            for (int y = range.start; y < range.end; ++y) {
+                const uchar* src = result.ptr<uchar>(y);
+                uchar* dst = fused.ptr<uchar>(y);
+
+                if (plan.sharpen) {
+                    const uchar* blur = blurred.ptr<uchar>(y);
+                    for (int i = 0; i < cols * cn; ++i) {
+                        dst[i] = cv::saturate_cast<uchar>((1.0f + SHARPEN_AMOUNT) * src[i] -
+                                                          SHARPEN_AMOUNT * blur[i]);
+                    }
+                    src = dst;
+                }
+
+                if (boost) {
+                    // Scaling HSV saturation with hue and value fixed moves every
+                    // channel away from the maximum by the same factor
+                    for (int x = 0; x < cols; ++x) {
+                        const uchar* p = src + x * cn;
+                        uchar* q = dst + x * cn;
+                        const int hi = std::max(p[0], std::max(p[1], p[2]));
+                        const int lo = std::min(p[0], std::min(p[1], p[2]));
+                        float factor = gain;
+                        if (hi > lo) {
+                            factor = std::min(gain, static_cast<float>(hi) / (hi - lo));
+                        }
+                        for (int c = 0; c < 3; ++c) {
+                            q[c] = cv::saturate_cast<uchar>(hi - (hi - p[c]) * factor);
+                        }
+                        for (int c = 3; c < cn; ++c) {
+                            q[c] = p[c];
+                        }
+                    }
+                } else if (!plan.sharpen) {
+                    std::memcpy(dst, src, static_cast<size_t>(cols) * cn);
+                }
+            }
+        });
+        result = fused;
+    }
+
+    // Localized contrast on luminance
+    if (plan.clahe && (cn == 1 || cn == 3)) {
+        cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(2.0, cv::Size(8, 8));
+        cv::Mat enhanced;
+        if (cn == 3) {
+            cv::Mat lab;
+            cv::cvtColor(result, lab, cv::COLOR_BGR2Lab);
+            std::vector<cv::Mat> labChannels;
+            cv::split(lab, labChannels);
+            clahe->apply(labChannels[0], labChannels[0]);
+            cv::merge(labChannels, lab);
+            cv::cvtColor(lab, enhanced, cv::COLOR_Lab2BGR);
+        } else {
+            clahe->apply(result, enhanced);
+        }
+        result = enhanced;
+    }
+
+    output = (result.data == input.data) ? input.clone() : result;
+}
@@ -0,0 +1,122 @@
+#ifndef IMAGEANALYZER_H
+#define IMAGEANALYZER_H
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Single-pass image statistics and automatic enhancement planning
+ *
+ * analyze() reads every sampled pixel once and gathers, in parallel, the
+ * luminance range, mean and standard deviation, the variance of the
+ * Laplacian and the HSV saturation profile, without building any
+ * intermediate image. The noise level comes from a fixed budget of tiles
+ * (NoiseEstimator). planEnhancement() turns those numbers into the
+ * sequence of corrections used by auto enhancement, and executePlan()
+ * applies it with the point operations merged into as few passes as
+ * possible.
+ */
+class ImageAnalyzer {
+public:
+    /**
+     * @brief Statistics gathered by analyze() (all on 8-bit luminance)
+     */
+    struct Statistics {
+        int samples;
+        int sampleStep;
+        bool isColor;
+        double minValue;
+        double maxValue;
+        double mean;
+        double stddev;
+        double laplacianVariance;   // Variance of the 3x3 Laplacian response
+        double noiseSigma;          // Noise level (see NoiseEstimator)
+        double meanSaturation;      // Mean HSV saturation (0-255), 0 for grayscale
+
+        // Saturation profile per HSV value, used to predict the saturation
+        // after a linear tone change
+        double valueCount[256];
+        double chromaSum[256];      // Sum of (max - min) over the pixels with that value
+    };
+
+    /**
+     * @brief Corrections selected for an image, in execution order
+     */
+    struct EnhancementPlan {
+        enum ToneStep {
+            TONE_NONE,
+            TONE_BRIGHTNESS,    // Linear brightness/contrast correction
+            TONE_STRETCH,       // Linear dynamic range stretch
+            TONE_EQUALIZE       // Histogram equalization
+        };
+
+        enum DenoiseStep {
+            DENOISE_NONE,
+            DENOISE_BILATERAL,
+            DENOISE_GAUSSIAN
+        };
+
+        ToneStep tone;
+        double alpha;               // Linear tone: output = alpha * input + beta
+        int beta;
+        DenoiseStep denoise;
+        bool sharpen;               // Unsharp masking (sigma 2.0, amount 0.8)
+        double saturationGain;      // 1.0 for no change
+        bool clahe;                 // CLAHE on luminance
+
+        EnhancementPlan();
+
+        bool isEmpty() const;
+    };
+
+    // ==========================================================================
+    // ANALYSIS
+    // ==========================================================================
+
+    /**
+     * @brief Gather the statistics of an image in one parallel pass
+     * @param image Source image (1, 3 or 4 channels)
+     * @param sampleStep Analyze every sampleStep-th pixel in both directions
+     *                   (neighbors for the Laplacian are always read at full resolution)
+     */
+    static Statistics analyze(const cv::Mat& image, int sampleStep = 1);
+
+    /**
+     * @brief Sample step keeping the analysis near one million pixels
+     */
+    static int defaultSampleStep(const cv::Size& size);
+
+    /**
+     * @brief Estimate the mean saturation after a linear tone change
+     * @param stats Statistics from analyze()
+     * @param alpha Gain
+     * @param beta Offset
+     */
+    static double predictSaturation(const Statistics& stats, double alpha, double beta);
+
+    // ==========================================================================
+    // PLANNING & EXECUTION
+    // ==========================================================================
+
+    /**
+     * @brief Select the auto enhancement corrections for an image
+     *
+     * Decisions that depend on earlier corrections (saturation boost, final
+     * CLAHE) are taken on the statistics predicted after those corrections.
+     */
+    static EnhancementPlan planEnhancement(const Statistics& stats);
+
+    /**
+     * @brief Apply a plan
+     *
+     * The tone change is a single lookup table, and sharpening and the
+     * saturation boost share one per-pixel pass (the boost is done in BGR,
+     * without an HSV round trip).
+     *
+     * @param input Source image (8-bit, 1, 3 or 4 channels)
+     * @param output Enhanced image
+     * @param plan Corrections to apply
+     */
+    static void executePlan(const cv::Mat& input, cv::Mat& output, const EnhancementPlan& plan);
+};
+
+#endif // IMAGEANALYZER_H
@@ -0,0 +1,45 @@
+#include "ImageHandle.h"
+#include "Trace.h"
+#include <atomic>
+
+uint64_t ImageHandle::nextVersion() {
+    static std::atomic<uint64_t> counter(0);
+    return ++counter;
+}
+
+ImageHandle::ImageHandle() : stamp(0) {
+}
+
+ImageHandle::ImageHandle(const cv::Mat& image)
+    : image(image.empty() ? std::shared_ptr<cv::Mat>() : std::make_shared<cv::Mat>(image)),
+      stamp(image.empty() ? 0 : nextVersion()) {
+}
+
+ImageHandle ImageHandle::copyOf(const cv::Mat& image) {
+    return ImageHandle(image.clone());
+}
+
+const cv::Mat& ImageHandle::mat() const {
+    static const cv::Mat emptyImage;
+    return image ? *image : emptyImage;
+}
+
+cv::Mat& ImageHandle::output() {
+    image = std::make_shared<cv::Mat>();
+    stamp = nextVersion();
+    return *image;
+}
+
+cv::Mat& ImageHandle::edit() {
+    if (!image) {
+        image = std::make_shared<cv::Mat>();
+    } else if (image.use_count() > 1 || (image->u && image->u->refcount > 1)) {
+        // Other handles, or cv::Mat headers taken from mat() or passed to the
+        // constructor, still refer to the buffer
+        TRACE_SCOPE("cache", "copy on write");
+        image = std::make_shared<cv::Mat>(image->clone());
+    }
+    // Shared pixels were copied, so only this handle sees the new content
+    stamp = nextVersion();
+    return *image;
+}
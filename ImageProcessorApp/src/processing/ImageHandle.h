@@ -0,0 +1,111 @@
+#ifndef IMAGEHANDLE_H
+#define IMAGEHANDLE_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Shared, immutable image with copy-on-write edits
+ *
+ * Copying a handle shares the pixels instead of copying them, so the main
+ * window, its undo stack, dialogs, previews and caches can all hold the same
+ * image. Pixels behind a handle are never written while another handle
+ * refers to them: output() starts a new buffer for a result, and edit()
+ * copies the pixels first if they are shared.
+ *
+ * mat() is a read-only view. It must not be written or outlive the
+ * handles it came from across an output() call; cv::Mat copies of it share
+ * the buffer, and edit() copies the pixels while any of them is alive.
+ *
+ * Every content gets a version number, unique for the life of the process:
+ * copies of a handle share it, and output() and edit() give the handle a
+ * new one. Caches of derived data (DerivedImageCache) are keyed by it.
+ *
+ * Usage:
+ *   ImageHandle source = processedImage;             // no copy
+ *   ImageFilters::applyMedianFilter(source, processedImage.output(), 5);
+ */
+class ImageHandle {
+public:
+    ImageHandle();
+
+    /**
+     * @brief Take over an image without copying it
+     *
+     * The handle shares the buffer with the given Mat and any other header
+     * of it. edit() copies the pixels while such headers are alive, but
+     * writing through them directly changes the handle's image: pass a
+     * freshly computed result, or use copyOf() for a buffer that keeps
+     * being written.
+     *
+     * @param image Pixels nobody writes to afterwards
+     */
+    explicit ImageHandle(const cv::Mat& image);
+
+    /**
+     * @brief Handle to a private copy (for buffers others keep writing to)
+     */
+    static ImageHandle copyOf(const cv::Mat& image);
+
+    // ==========================================================================
+    // READING
+    // ==========================================================================
+
+    /**
+     * @brief Read-only view of the pixels (an empty Mat for an empty handle)
+     */
+    const cv::Mat& mat() const;
+
+    operator const cv::Mat&() const { return mat(); }
+    const cv::Mat* operator->() const { return &mat(); }
+
+    bool empty() const { return !image || image->empty(); }
+
+    /**
+     * @brief Whether both handles refer to the same pixels
+     */
+    bool sharesWith(const ImageHandle& other) const { return image && image == other.image; }
+
+    /**
+     * @brief Number of handles sharing the pixels (0 for an empty handle)
+     */
+    long useCount() const { return image ? image.use_count() : 0; }
+
+    /**
+     * @brief Version of the pixels (0 for an empty handle)
+     */
+    uint64_t version() const { return image ? stamp : 0; }
+
+    // ==========================================================================
+    // WRITING
+    // ==========================================================================
+
+    /**
+     * @brief Drop the current pixels and return a new, empty Mat to write a
+     *        result into
+     *
+     * Other handles keep the previous pixels. Hold the input in its own
+     * handle when the result is computed from this handle's image.
+     */
+    cv::Mat& output();
+
+    /**
+     * @brief Writable pixels, copied first if another handle or cv::Mat
+     *        header shares them
+     */
+    cv::Mat& edit();
+
+    /**
+     * @brief Release the pixels (the handle becomes empty)
+     */
+    void reset() { image.reset(); }
+
+private:
+    static uint64_t nextVersion();
+
+    std::shared_ptr<cv::Mat> image;
+    uint64_t stamp;
+};
+
+#endif // IMAGEHANDLE_H
@@ -8,6 +8,10 @@ namespace ImageProcessingLib {
 
 /**
  * @brief Automatically enhance image using multiple algorithms
+ *
+ * The image is analyzed in a single pass (see ImageAnalyzer) and the
+ * selected corrections are applied as one pipeline.
+ *
  * @param input Input image
  * @param output Output enhanced image
  * @param operations List of applied operations
@@ -0,0 +1,130 @@
+#include "IntegralImage.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Columns accumulated together in the vertical pass (2 KB of each table row)
+const int COLUMN_BLOCK = 256;
+
+} // namespace
+
+IntegralImage::IntegralImage() {
+}
+
+void IntegralImage::build(const cv::Mat& image) {
+    TRACE_FUNCTION("analysis");
+    sumTable.release();
+    sqsumTable.release();
+    if (image.empty()) {
+        return;
+    }
+
+    cv::Mat gray;
+    if (image.channels() == 3) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    } else if (image.channels() == 4) {
+        cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY);
+    } else {
+        gray = image;
+    }
+    if (gray.depth() != CV_8U) {
+        gray.convertTo(gray, CV_8U);
+    }
+
+    const int rows = gray.rows;
+    const int cols = gray.cols;
+    sumTable.create(rows + 1, cols + 1, CV_64F);
+    sqsumTable.create(rows + 1, cols + 1, CV_64F);
+    sumTable.row(0).setTo(0);
+    sqsumTable.row(0).setTo(0);
+
+    // Pass 1: prefix sums along each row
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const uchar* src = gray.ptr<uchar>(y);
+            double* s = sumTable.ptr<double>(y + 1);
+            double* sq = sqsumTable.ptr<double>(y + 1);
+            double runSum = 0;
+            double runSq = 0;
+            s[0] = 0;
+            sq[0] = 0;
+            for (int x = 0; x < cols; ++x) {
+                const double v = src[x];
+                runSum += v;
+                runSq += v * v;
+                s[x + 1] = runSum;
+                sq[x + 1] = runSq;
+            }
+        }
+    });
+
+    // Pass 2: accumulate down the rows, one block of columns per task
+    const int blocks = (cols + 1 + COLUMN_BLOCK - 1) / COLUMN_BLOCK;
+    cv::parallel_for_(cv::Range(0, blocks), [&](const cv::Range& range) {
+        for (int b = range.start; b < range.end; ++b) {
+            const int x0 = b * COLUMN_BLOCK;
+            const int x1 = std::min(cols + 1, x0 + COLUMN_BLOCK);
+            for (int y = 2; y <= rows; ++y) {
+                const double* sPrev = sumTable.ptr<double>(y - 1);
+                const double* sqPrev = sqsumTable.ptr<double>(y - 1);
+                double* s = sumTable.ptr<double>(y);
+                double* sq = sqsumTable.ptr<double>(y);
+                for (int x = x0; x < x1; ++x) {
+                    s[x] += sPrev[x];
+                    sq[x] += sqPrev[x];
+                }
+            }
+        }
+    });
+}
+
+// =============================================================================
+// REGION QUERIES
+// =============================================================================
+
+double IntegralImage::boxSum(const cv::Mat& table, int x0, int y0, int x1, int y1) {
+    const double* top = table.ptr<double>(y0);
+    const double* bottom = table.ptr<double>(y1);
+    return bottom[x1] - bottom[x0] - top[x1] + top[x0];
+}
+
+double IntegralImage::sum(const cv::Rect& rect) const {
+    cv::Rect r = rect & cv::Rect(0, 0, cols(), rows());
+    if (r.area() <= 0) {
+        return 0;
+    }
+    return boxSum(sumTable, r.x, r.y, r.x + r.width, r.y + r.height);
+}
+
+double IntegralImage::mean(const cv::Rect& rect) const {
+    double m = 0;
+    double s = 0;
+    meanStdDev(rect, m, s);
+    return m;
+}
+
+double IntegralImage::variance(const cv::Rect& rect) const {
+    double m = 0;
+    double s = 0;
+    meanStdDev(rect, m, s);
+    return s * s;
+}
+
+bool IntegralImage::meanStdDev(const cv::Rect& rect, double& mean, double& stddev) const {
+    mean = 0;
+    stddev = 0;
+
+    cv::Rect r = rect & cv::Rect(0, 0, cols(), rows());
+    if (r.area() <= 0) {
+        return false;
+    }
+
+    const int x1 = r.x + r.width;
+    const int y1 = r.y + r.height;
+    const double n = static_cast<double>(r.area());
+    mean = boxSum(sumTable, r.x, r.y, x1, y1) / n;
+    stddev = std::sqrt(std::max(0.0, boxSum(sqsumTable, r.x, r.y, x1, y1) / n - mean * mean));
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef INTEGRALIMAGE_H
+#define INTEGRALIMAGE_H
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Summed-area and squared-sum tables of a grayscale image
+ *
+ * Both tables are (rows + 1) x (cols + 1) CV_64F, with a zero first row and
+ * column, so the sum over any rectangle takes four lookups. They are built
+ * in two parallel passes: prefix sums along each row, then accumulation down
+ * blocks of columns narrow enough to stay in cache.
+ *
+ * Callers that query one image repeatedly can take shared tables from
+ * DerivedImageCache::integral() instead of building them each time.
+ */
+class IntegralImage {
+public:
+    IntegralImage();
+
+    /**
+     * @brief Build the tables
+     * @param image Source image (color images are converted to grayscale)
+     */
+    void build(const cv::Mat& image);
+
+    // ==========================================================================
+    // REGION QUERIES
+    // ==========================================================================
+
+    /**
+     * @brief Sum of the pixels in a rectangle (clipped to the image)
+     */
+    double sum(const cv::Rect& rect) const;
+
+    /**
+     * @brief Mean of the pixels in a rectangle (clipped to the image)
+     */
+    double mean(const cv::Rect& rect) const;
+
+    /**
+     * @brief Variance of the pixels in a rectangle (clipped to the image)
+     */
+    double variance(const cv::Rect& rect) const;
+
+    /**
+     * @brief Mean and standard deviation of the pixels in a rectangle
+     * @param rect Region (clipped to the image)
+     * @param mean Output mean
+     * @param stddev Output standard deviation
+     * @return false if the clipped region is empty
+     */
+    bool meanStdDev(const cv::Rect& rect, double& mean, double& stddev) const;
+
+    // ==========================================================================
+    // ACCESS
+    // ==========================================================================
+
+    bool empty() const { return sumTable.empty(); }
+    int rows() const { return sumTable.empty() ? 0 : sumTable.rows - 1; }
+    int cols() const { return sumTable.empty() ? 0 : sumTable.cols - 1; }
+    cv::Size size() const { return cv::Size(cols(), rows()); }
+
+    /**
+     * @brief Summed-area table ((rows + 1) x (cols + 1), CV_64F)
+     */
+    const cv::Mat& sums() const { return sumTable; }
+
+    /**
+     * @brief Summed-area table of squared values ((rows + 1) x (cols + 1), CV_64F)
+     */
+    const cv::Mat& squaredSums() const { return sqsumTable; }
+
+private:
+    static double boxSum(const cv::Mat& table, int x0, int y0, int x1, int y1);
+
+    cv::Mat sumTable;
+    cv::Mat sqsumTable;
+};
+
+#endif // INTEGRALIMAGE_H
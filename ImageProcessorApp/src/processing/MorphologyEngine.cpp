@@ -0,0 +1,415 @@
+#include "MorphologyEngine.h"
+#include "BinaryImage.h"
+#include "BinaryMorphology.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace {
+
+// Kernels up to 5x5 are left to OpenCV, whose SIMD loops win at that size
+const int MIN_ENGINE_KERNEL_AREA = 25;
+
+// Width (in bytes) of the column strips processed by one vertical pass
+const int VERTICAL_STRIP_BYTES = 128;
+
+struct MinOp {
+    template <typename T>
+    T operator()(T a, T b) const { return b < a ? b : a; }
+};
+
+struct MaxOp {
+    template <typename T>
+    T operator()(T a, T b) const { return a < b ? b : a; }
+};
+
+/**
+ * van Herk/Gil-Werman running extremum over a window [p + lo, p + hi].
+ *
+ * Processes `lanes` independent signals at once: position p of every lane
+ * is stored contiguously at src + p * srcStep. Out-of-range positions read
+ * `pad`, which is the identity of the operation (so they are ignored, like
+ * OpenCV's default morphology border). The padded sequence is cut into
+ * blocks of k; suffix extrema are stored per block and prefix extrema are
+ * kept as a running value, so every output costs three comparisons.
+ */
+template <typename T, typename Op>
+void runningExtremum(const T* src, ptrdiff_t srcStep, T* dst, ptrdiff_t dstStep,
+                     int n, int lanes, int lo, int hi, const T* pad,
+                     std::vector<T>& suffix, std::vector<T>& prefix) {
+    Op op;
+    const int k = hi - lo + 1;
+    const int m = n + k - 1;
+    suffix.resize(static_cast<size_t>(m) * lanes);
+    prefix.resize(lanes);
+
+    auto at = [&](int j) -> const T* {
+        int p = j + lo;
+        return (p >= 0 && p < n) ? src + p * srcStep : pad;
+    };
+
+    // Backward pass: suffix extrema inside each block
+    for (int blockStart = ((m - 1) / k) * k; blockStart >= 0; blockStart -= k) {
+        int blockEnd = std::min(blockStart + k, m);
+
+        const T* g = at(blockEnd - 1);
+        T* r = &suffix[static_cast<size_t>(blockEnd - 1) * lanes];
+        std::copy(g, g + lanes, r);
+
+        for (int j = blockEnd - 2; j >= blockStart; --j) {
+            g = at(j);
+            r = &suffix[static_cast<size_t>(j) * lanes];
+            const T* next = r + lanes;
+            for (int l = 0; l < lanes; ++l) {
+                r[l] = op(g[l], next[l]);
+            }
+        }
+    }
+
+    // Forward pass: running prefix extremum, output lags by k - 1
+    T* running = prefix.data();
+    for (int j = 0; j < m; ++j) {
+        const T* g = at(j);
+        if (j % k == 0) {
+            std::copy(g, g + lanes, running);
+        } else {
+            for (int l = 0; l < lanes; ++l) {
+                running[l] = op(running[l], g[l]);
+            }
+        }
+
+        if (j >= k - 1) {
+            int x = j - k + 1;
+            const T* r = &suffix[static_cast<size_t>(x) * lanes];
+            T* out = dst + x * dstStep;
+            for (int l = 0; l < lanes; ++l) {
+                out[l] = op(r[l], running[l]);
+            }
+        }
+    }
+}
+
+template <typename T, typename Op>
+void horizontalPass(const cv::Mat& src, cv::Mat& dst, int lo, int hi, T padValue) {
+    const int cn = src.channels();
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+        std::vector<T> suffix, prefix;
+        std::vector<T> pad(cn, padValue);
+        for (int y = range.start; y < range.end; ++y) {
+            runningExtremum<T, Op>(src.ptr<T>(y), cn, dst.ptr<T>(y), cn,
+                                   src.cols, cn, lo, hi, pad.data(), suffix, prefix);
+        }
+    });
+}
+
+template <typename T, typename Op>
+void verticalPass(const cv::Mat& src, cv::Mat& dst, int lo, int hi, T padValue) {
+    const int width = src.cols * src.channels();
+    const int stripWidth = std::max(16, VERTICAL_STRIP_BYTES / static_cast<int>(sizeof(T)));
+    const int numStrips = (width + stripWidth - 1) / stripWidth;
+    const ptrdiff_t srcStep = static_cast<ptrdiff_t>(src.step1());
+    const ptrdiff_t dstStep = static_cast<ptrdiff_t>(dst.step1());
+
+    cv::parallel_for_(cv::Range(0, numStrips), [&](const cv::Range& range) {
+        std::vector<T> suffix, prefix;
+        std::vector<T> pad(stripWidth, padValue);
+        for (int s = range.start; s < range.end; ++s) {
+            int c0 = s * stripWidth;
+            int lanes = std::min(stripWidth, width - c0);
+            runningExtremum<T, Op>(src.ptr<T>(0) + c0, srcStep, dst.ptr<T>(0) + c0, dstStep,
+                                   src.rows, lanes, lo, hi, pad.data(), suffix, prefix);
+        }
+    });
+}
+
+template <typename T, typename Op>
+void rectExtremum(const cv::Mat& input, cv::Mat& output, const cv::Rect& r, T padValue) {
+    cv::Mat horizontal = input;
+    if (r.width > 1 || r.x != 0) {
+        horizontal = cv::Mat(input.size(), input.type());
+        horizontalPass<T, Op>(input, horizontal, r.x, r.x + r.width - 1, padValue);
+    }
+
+    if (r.height > 1 || r.y != 0) {
+        output = cv::Mat(input.size(), input.type());
+        verticalPass<T, Op>(horizontal, output, r.y, r.y + r.height - 1, padValue);
+    } else {
+        output = horizontal.data == input.data ? input.clone() : horizontal;
+    }
+}
+
+template <typename T>
+void rectExtremumDispatch(const cv::Mat& input, cv::Mat& output, const cv::Rect& r,
+                          bool isErosion) {
+    if (isErosion) {
+        rectExtremum<T, MinOp>(input, output, r, std::numeric_limits<T>::max());
+    } else {
+        rectExtremum<T, MaxOp>(input, output, r, std::numeric_limits<T>::lowest());
+    }
+}
+
+bool hasCenteredAnchor(const cv::Mat& kernel) {
+    return !kernel.empty() && kernel.rows % 2 == 1 && kernel.cols % 2 == 1;
+}
+
+// Area of the window covered by `iterations` passes of the kernel
+int64_t iteratedKernelArea(const cv::Mat& kernel, int iterations) {
+    const int64_t rows = static_cast<int64_t>(kernel.rows - 1) * iterations + 1;
+    const int64_t cols = static_cast<int64_t>(kernel.cols - 1) * iterations + 1;
+    return rows * cols;
+}
+
+} // namespace
+
+// =============================================================================
+// MORPHOLOGICAL OPERATIONS
+// =============================================================================
+
+void MorphologyEngine::erode(const cv::Mat& input, cv::Mat& output,
+                             const cv::Mat& kernel, int iterations, InputKind kind) {
+    morphologyEx(input, output, cv::MORPH_ERODE, kernel, iterations, kind);
+}
+
+void MorphologyEngine::dilate(const cv::Mat& input, cv::Mat& output,
+                              const cv::Mat& kernel, int iterations, InputKind kind) {
+    morphologyEx(input, output, cv::MORPH_DILATE, kernel, iterations, kind);
+}
+
+void MorphologyEngine::morphologyEx(const cv::Mat& input, cv::Mat& output, int operation,
+                                    const cv::Mat& kernel, int iterations, InputKind kind) {
+    TRACE_FUNCTION("morphology");
+    iterations = std::max(1, iterations);
+    const int requestedIterations = iterations;
+
+    // 0/255 masks (thresholding output) go through the bit-packed path. Small
+    // windows are left to OpenCV before the mask is scanned at all, and
+    // declared masks are not scanned
+    if (hasCenteredAnchor(kernel) &&
+        iteratedKernelArea(kernel, iterations) > MIN_ENGINE_KERNEL_AREA &&
+        (kind == INPUT_MASK ? input.type() == CV_8UC1 : BinaryImage::isBinaryMask(input))) {
+        BinaryMorphology::morphologyEx(input, output, operation, kernel, requestedIterations);
+        return;
+    }
+
+    // Collapse repeated erosions/dilations into one larger structuring element
+    cv::Mat effectiveKernel = kernel;
+    if (iterations > 1 && hasCenteredAnchor(kernel)) {
+        effectiveKernel = iterateStructuringElement(kernel, iterations);
+        iterations = 1;
+    }
+
+    if (input.empty() || iterations != 1 || !isSupported(input, effectiveKernel)) {
+        cv::morphologyEx(input, output, operation, kernel, cv::Point(-1, -1), requestedIterations);
+        return;
+    }
+
+    cv::Mat result, temp;
+    switch (operation) {
+        case cv::MORPH_ERODE:
+            applyExtremum(input, result, effectiveKernel, true);
+            break;
+
+        case cv::MORPH_DILATE:
+            applyExtremum(input, result, effectiveKernel, false);
+            break;
+
+        case cv::MORPH_OPEN:
+            applyExtremum(input, temp, effectiveKernel, true);
+            applyExtremum(temp, result, effectiveKernel, false);
+            break;
+
+        case cv::MORPH_CLOSE:
+            applyExtremum(input, temp, effectiveKernel, false);
+            applyExtremum(temp, result, effectiveKernel, true);
+            break;
+
+        case cv::MORPH_GRADIENT: {
+            cv::Mat eroded;
+            applyExtremum(input, eroded, effectiveKernel, true);
+            applyExtremum(input, temp, effectiveKernel, false);
+            cv::subtract(temp, eroded, result);
+            break;
+        }
+
+        case cv::MORPH_TOPHAT: {
+            cv::Mat opened;
+            applyExtremum(input, temp, effectiveKernel, true);
+            applyExtremum(temp, opened, effectiveKernel, false);
+            cv::subtract(input, opened, result);
+            break;
+        }
+
+        case cv::MORPH_BLACKHAT: {
+            cv::Mat closed;
+            applyExtremum(input, temp, effectiveKernel, false);
+            applyExtremum(temp, closed, effectiveKernel, true);
+            cv::subtract(closed, input, result);
+            break;
+        }
+
+        default:
+            cv::morphologyEx(input, output, operation, kernel, cv::Point(-1, -1), requestedIterations);
+            return;
+    }
+
+    output = result;
+}
+
+// =============================================================================
+// STRUCTURING ELEMENT ALGEBRA
+// =============================================================================
+
+bool MorphologyEngine::decomposeStructuringElement(const cv::Mat& kernel,
+                                                   std::vector<cv::Rect>& rects) {
+    rects.clear();
+    if (!hasCenteredAnchor(kernel) || kernel.type() != CV_8U) {
+        return false;
+    }
+
+    const int anchorX = kernel.cols / 2;
+    const int anchorY = kernel.rows / 2;
+
+    // Each row must be a single run [first, last] (or empty)
+    std::vector<int> first(kernel.rows, -1), last(kernel.rows, -1);
+    for (int y = 0; y < kernel.rows; ++y) {
+        const uchar* row = kernel.ptr<uchar>(y);
+        for (int x = 0; x < kernel.cols; ++x) {
+            if (row[x]) {
+                if (first[y] < 0) first[y] = x;
+                else if (last[y] != x - 1) return false;
+                last[y] = x;
+            }
+        }
+    }
+
+    // For every distinct run, the tallest block of consecutive rows that
+    // contains it is a rectangle inside the SE. The union of these rectangles
+    // covers every row, so it is exactly the SE.
+    for (int y = 0; y < kernel.rows; ++y) {
+        if (first[y] < 0) continue;
+
+        int top = y, bottom = y;
+        while (top > 0 && first[top - 1] >= 0 &&
+               first[top - 1] <= first[y] && last[top - 1] >= last[y]) {
+            --top;
+        }
+        while (bottom < kernel.rows - 1 && first[bottom + 1] >= 0 &&
+               first[bottom + 1] <= first[y] && last[bottom + 1] >= last[y]) {
+            ++bottom;
+        }
+
+        cv::Rect r(first[y] - anchorX, top - anchorY,
+                   last[y] - first[y] + 1, bottom - top + 1);
+        if (std::find(rects.begin(), rects.end(), r) == rects.end()) {
+            rects.push_back(r);
+        }
+    }
+
+    // Drop rectangles contained in another one; they do not change the union
+    std::vector<cv::Rect> pruned;
+    for (size_t i = 0; i < rects.size(); ++i) {
+        bool contained = false;
+        for (size_t j = 0; j < rects.size() && !contained; ++j) {
+            contained = (i != j) && (rects[i] & rects[j]) == rects[i];
+        }
+        if (!contained) {
+            pruned.push_back(rects[i]);
+        }
+    }
+    rects.swap(pruned);
+
+    return !rects.empty();
+}
+
+cv::Mat MorphologyEngine::iterateStructuringElement(const cv::Mat& kernel, int iterations) {
+    if (iterations <= 1 || !hasCenteredAnchor(kernel)) {
+        return kernel.clone();
+    }
+
+    cv::Mat binaryKernel;
+    kernel.convertTo(binaryKernel, CV_8U);
+    binaryKernel = binaryKernel != 0;
+
+    cv::Size bigSize(iterations * (kernel.cols - 1) + 1, iterations * (kernel.rows - 1) + 1);
+
+    // Rectangles stay rectangles under Minkowski sums
+    if (cv::countNonZero(binaryKernel) == kernel.rows * kernel.cols) {
+        return cv::Mat(bigSize, CV_8U, cv::Scalar(1));
+    }
+
+    cv::Mat sum = cv::Mat::zeros(bigSize, CV_8U);
+    cv::Rect center((bigSize.width - kernel.cols) / 2, (bigSize.height - kernel.rows) / 2,
+                    kernel.cols, kernel.rows);
+    binaryKernel.copyTo(sum(center));
+    cv::dilate(sum, sum, binaryKernel, cv::Point(-1, -1), iterations - 1);
+
+    return sum / 255;
+}
+
+bool MorphologyEngine::isSupported(const cv::Mat& input, const cv::Mat& kernel) {
+    if (input.empty() || input.channels() > 4 || !hasCenteredAnchor(kernel) ||
+        kernel.type() != CV_8U) {
+        return false;
+    }
+
+    int depth = input.depth();
+    if (depth != CV_8U && depth != CV_16U && depth != CV_16S && depth != CV_32F) {
+        return false;
+    }
+
+    return kernel.rows * kernel.cols > MIN_ENGINE_KERNEL_AREA;
+}
+
+// =============================================================================
+// PRIVATE HELPERS
+// =============================================================================
+
+void MorphologyEngine::applyExtremum(const cv::Mat& input, cv::Mat& output,
+                                     const cv::Mat& kernel, bool isErosion) {
+    TRACE_FUNCTION("morphology");
+    std::vector<cv::Rect> rects;
+    if (!decomposeStructuringElement(kernel, rects)) {
+        if (isErosion) {
+            cv::erode(input, output, kernel);
+        } else {
+            cv::dilate(input, output, kernel);
+        }
+        return;
+    }
+
+    // Erosion by a union of rectangles is the minimum of the erosions by each
+    cv::Mat result;
+    applyRectExtremum(input, result, rects[0], isErosion);
+    for (size_t i = 1; i < rects.size(); ++i) {
+        cv::Mat partial;
+        applyRectExtremum(input, partial, rects[i], isErosion);
+        if (isErosion) {
+            cv::min(result, partial, result);
+        } else {
+            cv::max(result, partial, result);
+        }
+    }
+
+    output = result;
+}
+
+void MorphologyEngine::applyRectExtremum(const cv::Mat& input, cv::Mat& output,
+                                         const cv::Rect& offsets, bool isErosion) {
+    switch (input.depth()) {
+        case CV_8U:
+            rectExtremumDispatch<uchar>(input, output, offsets, isErosion);
+            break;
+        case CV_16U:
+            rectExtremumDispatch<ushort>(input, output, offsets, isErosion);
+            break;
+        case CV_16S:
+            rectExtremumDispatch<short>(input, output, offsets, isErosion);
+            break;
+        case CV_32F:
+            rectExtremumDispatch<float>(input, output, offsets, isErosion);
+            break;
+        default:
+            CV_Error(cv::Error::StsUnsupportedFormat, "MorphologyEngine: unsupported depth");
+    }
+}
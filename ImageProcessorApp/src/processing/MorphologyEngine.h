@@ -0,0 +1,115 @@
+#ifndef MORPHOLOGYENGINE_H
+#define MORPHOLOGYENGINE_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Linear-time grayscale morphology for large structuring elements
+ *
+ * Erosion and dilation by a rectangle are computed with the van Herk/Gil-Werman
+ * algorithm as a horizontal and a vertical running min/max, costing a constant
+ * number of comparisons per pixel regardless of the kernel size. Ellipses,
+ * crosses and any other structuring element whose rows are single runs are
+ * decomposed into a union of rectangles (each the sum of a horizontal and a
+ * vertical line segment), so their cost grows with the number of distinct
+ * row widths rather than with the kernel area.
+ *
+ * Functions mirror the OpenCV calls they replace (centered anchor, default
+ * border) and fall back to OpenCV for small kernels and unsupported inputs.
+ * Binary masks (CV_8UC1 holding only 0 and 255) under kernels larger than
+ * 5x5 are handed to BinaryMorphology, which works on 64 pixels per word.
+ */
+class MorphologyEngine {
+public:
+    /**
+     * @brief What the caller knows about the input
+     */
+    enum InputKind {
+        INPUT_ANY,   // Checked for a 0/255 mask when the kernel is large
+        INPUT_MASK   // CV_8UC1 holding only 0 and 255 (e.g. threshold output), not checked
+    };
+
+    // ==========================================================================
+    // MORPHOLOGICAL OPERATIONS
+    // ==========================================================================
+
+    /**
+     * @brief Erode image (drop-in for cv::erode with a centered anchor)
+     * @param input Source image (CV_8U, CV_16U, CV_16S or CV_32F, 1-4 channels)
+     * @param output Eroded image
+     * @param kernel Structuring element (non-zero pixels are part of the SE)
+     * @param iterations Number of times erosion is applied
+     * @param kind INPUT_MASK skips the scan for the bit-packed path
+     */
+    static void erode(const cv::Mat& input, cv::Mat& output,
+                      const cv::Mat& kernel, int iterations = 1,
+                      InputKind kind = INPUT_ANY);
+
+    /**
+     * @brief Dilate image (drop-in for cv::dilate with a centered anchor)
+     * @param input Source image
+     * @param output Dilated image
+     * @param kernel Structuring element
+     * @param iterations Number of times dilation is applied
+     * @param kind INPUT_MASK skips the scan for the bit-packed path
+     */
+    static void dilate(const cv::Mat& input, cv::Mat& output,
+                       const cv::Mat& kernel, int iterations = 1,
+                       InputKind kind = INPUT_ANY);
+
+    /**
+     * @brief Compound morphology (drop-in for cv::morphologyEx with a centered anchor)
+     * @param input Source image
+     * @param output Result image
+     * @param operation cv::MORPH_ERODE, DILATE, OPEN, CLOSE, GRADIENT, TOPHAT or BLACKHAT
+     * @param kernel Structuring element
+     * @param iterations Number of erosion/dilation iterations, as in cv::morphologyEx
+     * @param kind INPUT_MASK skips the scan for the bit-packed path
+     */
+    static void morphologyEx(const cv::Mat& input, cv::Mat& output, int operation,
+                             const cv::Mat& kernel, int iterations = 1,
+                             InputKind kind = INPUT_ANY);
+
+    // ==========================================================================
+    // STRUCTURING ELEMENT ALGEBRA
+    // ==========================================================================
+
+    /**
+     * @brief Decompose a structuring element into a union of rectangles
+     * @param kernel Structuring element (CV_8U, odd size, centered anchor)
+     * @param rects Output rectangles as offsets relative to the anchor
+     * @return true if every row of the kernel is a single run of non-zero pixels
+     */
+    static bool decomposeStructuringElement(const cv::Mat& kernel,
+                                            std::vector<cv::Rect>& rects);
+
+    /**
+     * @brief Build the structuring element equivalent to applying a kernel repeatedly
+     *
+     * Eroding (or dilating) n times by B equals one erosion by the n-fold
+     * Minkowski sum B + B + ... + B. The result is exact for rectangles and
+     * matches OpenCV's iterated result away from the image border otherwise.
+     *
+     * @param kernel Structuring element (odd size)
+     * @param iterations Number of repetitions
+     * @return Equivalent structuring element of size n*(k-1)+1
+     */
+    static cv::Mat iterateStructuringElement(const cv::Mat& kernel, int iterations);
+
+    /**
+     * @brief Check whether the linear-time path handles an image/kernel pair
+     * @param input Source image
+     * @param kernel Structuring element
+     * @return true if the engine is used instead of OpenCV
+     */
+    static bool isSupported(const cv::Mat& input, const cv::Mat& kernel);
+
+private:
+    static void applyExtremum(const cv::Mat& input, cv::Mat& output,
+                              const cv::Mat& kernel, bool isErosion);
+    static void applyRectExtremum(const cv::Mat& input, cv::Mat& output,
+                                  const cv::Rect& offsets, bool isErosion);
+};
+
+#endif // MORPHOLOGYENGINE_H
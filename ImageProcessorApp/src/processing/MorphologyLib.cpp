@@ -1,6 +1,10 @@
 #include "MorphologyLib.h"
+#include "MorphologyEngine.h"
+#include "Trace.h"
 #include <algorithm>
 
+const int MorphologyLib::MAX_KERNEL_SIZE;
+
 // =============================================================================
 // BASIC MORPHOLOGICAL OPERATIONS
 // =============================================================================
@@ -8,6 +12,7 @@
 void MorphologyLib::applyErosion(const cv::Mat& input, cv::Mat& output, 
                                  int kernelSize, StructuringElementShape shape,
                                  int iterations) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -15,15 +20,16 @@ void MorphologyLib::applyErosion(const cv::Mat& input, cv::Mat& output,
     
     // Ensure odd kernel size
     if (kernelSize % 2 == 0) kernelSize++;
-    kernelSize = std::max(3, std::min(21, kernelSize));
+    kernelSize = std::max(3, std::min(MAX_KERNEL_SIZE, kernelSize));
     
     cv::Mat kernel = createStructuringElement(shape, cv::Size(kernelSize, kernelSize));
-    cv::erode(input, output, kernel, cv::Point(-1, -1), iterations);
+    MorphologyEngine::erode(input, output, kernel, iterations);
 }
 
 void MorphologyLib::applyDilation(const cv::Mat& input, cv::Mat& output, 
                                   int kernelSize, StructuringElementShape shape,
                                   int iterations) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -31,14 +37,15 @@ void MorphologyLib::applyDilation(const cv::Mat& input, cv::Mat& output,
     
     // Ensure odd kernel size
     if (kernelSize % 2 == 0) kernelSize++;
-    kernelSize = std::max(3, std::min(21, kernelSize));
+    kernelSize = std::max(3, std::min(MAX_KERNEL_SIZE, kernelSize));
     
     cv::Mat kernel = createStructuringElement(shape, cv::Size(kernelSize, kernelSize));
-    cv::dilate(input, output, kernel, cv::Point(-1, -1), iterations);
+    MorphologyEngine::dilate(input, output, kernel, iterations);
 }
 
 void MorphologyLib::applyOpening(const cv::Mat& input, cv::Mat& output, 
                                  int kernelSize, StructuringElementShape shape) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -46,14 +53,15 @@ void MorphologyLib::applyOpening(const cv::Mat& input, cv::Mat& output,
     
     // Ensure odd kernel size
     if (kernelSize % 2 == 0) kernelSize++;
-    kernelSize = std::max(3, std::min(21, kernelSize));
+    kernelSize = std::max(3, std::min(MAX_KERNEL_SIZE, kernelSize));
     
     cv::Mat kernel = createStructuringElement(shape, cv::Size(kernelSize, kernelSize));
-    cv::morphologyEx(input, output, cv::MORPH_OPEN, kernel);
+    MorphologyEngine::morphologyEx(input, output, cv::MORPH_OPEN, kernel);
 }
 
 void MorphologyLib::applyClosing(const cv::Mat& input, cv::Mat& output, 
                                  int kernelSize, StructuringElementShape shape) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -61,14 +69,15 @@ void MorphologyLib::applyClosing(const cv::Mat& input, cv::Mat& output,
     
     // Ensure odd kernel size
     if (kernelSize % 2 == 0) kernelSize++;
-    kernelSize = std::max(3, std::min(21, kernelSize));
+    kernelSize = std::max(3, std::min(MAX_KERNEL_SIZE, kernelSize));
     
     cv::Mat kernel = createStructuringElement(shape, cv::Size(kernelSize, kernelSize));
-    cv::morphologyEx(input, output, cv::MORPH_CLOSE, kernel);
+    MorphologyEngine::morphologyEx(input, output, cv::MORPH_CLOSE, kernel);
 }
 
 void MorphologyLib::applyMorphGradient(const cv::Mat& input, cv::Mat& output, 
                                        int kernelSize) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -76,15 +85,16 @@ void MorphologyLib::applyMorphGradient(const cv::Mat& input, cv::Mat& output,
     
     // Ensure odd kernel size
     if (kernelSize % 2 == 0) kernelSize++;
-    kernelSize = std::max(3, std::min(21, kernelSize));
+    kernelSize = std::max(3, std::min(MAX_KERNEL_SIZE, kernelSize));
     
     cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, 
                                                cv::Size(kernelSize, kernelSize));
-    cv::morphologyEx(input, output, cv::MORPH_GRADIENT, kernel);
+    MorphologyEngine::morphologyEx(input, output, cv::MORPH_GRADIENT, kernel);
 }
 
 void MorphologyLib::applyTopHatTransform(const cv::Mat& input, cv::Mat& output, 
                                          int kernelSize) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -92,15 +102,16 @@ void MorphologyLib::applyTopHatTransform(const cv::Mat& input, cv::Mat& output,
     
     // Ensure odd kernel size
     if (kernelSize % 2 == 0) kernelSize++;
-    kernelSize = std::max(3, std::min(21, kernelSize));
+    kernelSize = std::max(3, std::min(MAX_KERNEL_SIZE, kernelSize));
     
     cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, 
                                                cv::Size(kernelSize, kernelSize));
-    cv::morphologyEx(input, output, cv::MORPH_TOPHAT, kernel);
+    MorphologyEngine::morphologyEx(input, output, cv::MORPH_TOPHAT, kernel);
 }
 
 void MorphologyLib::applyBlackHatTransform(const cv::Mat& input, cv::Mat& output, 
                                            int kernelSize) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -108,11 +119,11 @@ void MorphologyLib::applyBlackHatTransform(const cv::Mat& input, cv::Mat& output
     
     // Ensure odd kernel size
     if (kernelSize % 2 == 0) kernelSize++;
-    kernelSize = std::max(3, std::min(21, kernelSize));
+    kernelSize = std::max(3, std::min(MAX_KERNEL_SIZE, kernelSize));
     
     cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, 
                                                cv::Size(kernelSize, kernelSize));
-    cv::morphologyEx(input, output, cv::MORPH_BLACKHAT, kernel);
+    MorphologyEngine::morphologyEx(input, output, cv::MORPH_BLACKHAT, kernel);
 }
 
 // =============================================================================
@@ -127,6 +138,7 @@ cv::Mat MorphologyLib::createStructuringElement(StructuringElementShape shape,
 void MorphologyLib::applyIterativeMorphology(const cv::Mat& input, cv::Mat& output,
                                              int operation, int kernelSize, 
                                              int iterations) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -134,14 +146,32 @@ void MorphologyLib::applyIterativeMorphology(const cv::Mat& input, cv::Mat& outp
     
     // Ensure odd kernel size
     if (kernelSize % 2 == 0) kernelSize++;
-    kernelSize = std::max(3, std::min(21, kernelSize));
+    kernelSize = std::max(3, std::min(MAX_KERNEL_SIZE, kernelSize));
     
     cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, 
                                                cv::Size(kernelSize, kernelSize));
+    iterations = std::max(1, iterations);
+    
+    switch (operation) {
+        case cv::MORPH_ERODE:
+        case cv::MORPH_DILATE:
+            // Repeated erosion/dilation is one pass with the equivalent larger SE
+            MorphologyEngine::morphologyEx(input, output, operation, kernel, iterations);
+            return;
+        
+        case cv::MORPH_OPEN:
+        case cv::MORPH_CLOSE:
+            // Opening and closing are idempotent: repeating them changes nothing
+            MorphologyEngine::morphologyEx(input, output, operation, kernel);
+            return;
+        
+        default:
+            break;
+    }
     
     cv::Mat temp = input.clone();
     for (int i = 0; i < iterations; ++i) {
-        cv::morphologyEx(temp, temp, operation, kernel);
+        MorphologyEngine::morphologyEx(temp, temp, operation, kernel);
     }
     output = temp;
 }
@@ -151,6 +181,7 @@ void MorphologyLib::applyIterativeMorphology(const cv::Mat& input, cv::Mat& outp
 // =============================================================================
 
 void MorphologyLib::applyPrewittOperator(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -199,6 +230,7 @@ void MorphologyLib::applyPrewittOperator(const cv::Mat& input, cv::Mat& output)
 }
 
 void MorphologyLib::applyRobertsCross(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -246,6 +278,7 @@ void MorphologyLib::applyRobertsCross(const cv::Mat& input, cv::Mat& output) {
 
 void MorphologyLib::applyLoG(const cv::Mat& input, cv::Mat& output, 
                              int kernelSize, double sigma) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -288,6 +321,7 @@ void MorphologyLib::applyLoG(const cv::Mat& input, cv::Mat& output,
 void MorphologyLib::applyDoG(const cv::Mat& input, cv::Mat& output,
                              int kernelSize1, double sigma1,
                              int kernelSize2, double sigma2) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -342,6 +376,7 @@ void MorphologyLib::applyDoG(const cv::Mat& input, cv::Mat& output,
 
 void MorphologyLib::applyZeroCrossing(const cv::Mat& input, cv::Mat& output, 
                                       int kernelSize) {
+    TRACE_FUNCTION("morphology");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -423,6 +458,7 @@ bool MorphologyLib::isValidImage(const cv::Mat& image) {
 }
 
 void MorphologyLib::normalizeEdgeImage(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("morphology");
     // Convert to absolute values if needed
     cv::Mat absImage;
     if (input.depth() == CV_32F || input.depth() == CV_64F) {
@@ -23,6 +23,11 @@ public:
         CROSS = cv::MORPH_CROSS     ///< Cross-shaped structuring element
     };
 
+    /**
+     * @brief Largest accepted structuring element size for morphological operations
+     */
+    static const int MAX_KERNEL_SIZE = 101;
+
     // ==========================================================================
     // BASIC MORPHOLOGICAL OPERATIONS
     // ==========================================================================
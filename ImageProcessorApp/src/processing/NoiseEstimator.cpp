@@ -0,0 +1,118 @@
+#include "NoiseEstimator.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+const int NoiseEstimator::DEFAULT_TILE_BUDGET;
+const int NoiseEstimator::DEFAULT_TILE_SIZE;
+
+namespace {
+
+// Fraction of the tiles (the flattest ones) that give the estimate
+const double FLAT_TILE_FRACTION = 0.25;
+
+// Non-local means strength per unit of noise sigma
+const double NLM_STRENGTH_PER_SIGMA = 1.2;
+const double NLM_MIN_STRENGTH = 1.0;
+
+// Immerkær: sigma = sqrt(pi / 2) / (6 * n) * sum |I * M| over n pixels
+double tileSigma(const cv::Mat& tile, std::vector<short>& rowDiff) {
+    const int rows = tile.rows;
+    const int cols = tile.cols;
+    const int inner = cols - 2;
+    rowDiff.resize(static_cast<size_t>(rows) * inner);
+
+    // Horizontal second difference (range -510..510)
+    for (int y = 0; y < rows; ++y) {
+        const uchar* src = tile.ptr<uchar>(y);
+        short* dst = &rowDiff[static_cast<size_t>(y) * inner];
+        for (int x = 0; x < inner; ++x) {
+            dst[x] = static_cast<short>(src[x] - 2 * src[x + 1] + src[x + 2]);
+        }
+    }
+
+    // Vertical second difference of the rows (range -2040..2040)
+    double total = 0;
+    for (int y = 1; y < rows - 1; ++y) {
+        const short* up = &rowDiff[static_cast<size_t>(y - 1) * inner];
+        const short* mid = &rowDiff[static_cast<size_t>(y) * inner];
+        const short* down = &rowDiff[static_cast<size_t>(y + 1) * inner];
+        int rowSum = 0;
+        for (int x = 0; x < inner; ++x) {
+            rowSum += std::abs(up[x] - 2 * mid[x] + down[x]);
+        }
+        total += rowSum;
+    }
+
+    const double n = static_cast<double>(rows - 2) * inner;
+    return std::sqrt(CV_PI / 2.0) * total / (6.0 * n);
+}
+
+} // namespace
+
+double NoiseEstimator::estimateSigma(const cv::Mat& image, int tileBudget, int tileSize) {
+    TRACE_FUNCTION("analysis");
+    if (image.empty() || image.rows < 3 || image.cols < 3) {
+        return 0.0;
+    }
+
+    tileBudget = std::max(1, tileBudget);
+    tileSize = std::max(3, std::min(tileSize, std::min(image.rows, image.cols)));
+
+    // Spread the tiles on a grid matching the image aspect ratio
+    const double aspect = static_cast<double>(image.cols) / image.rows;
+    int gridCols = std::max(1, static_cast<int>(std::round(std::sqrt(tileBudget * aspect))));
+    int gridRows = std::max(1, tileBudget / gridCols);
+    gridCols = std::min(gridCols, image.cols / tileSize);
+    gridRows = std::min(gridRows, image.rows / tileSize);
+    gridCols = std::max(1, gridCols);
+    gridRows = std::max(1, gridRows);
+
+    const int tileCount = gridCols * gridRows;
+    std::vector<double> sigmas(tileCount, 0.0);
+
+    cv::parallel_for_(cv::Range(0, tileCount), [&](const cv::Range& range) {
+        std::vector<short> rowDiff;
+        cv::Mat gray;
+        for (int t = range.start; t < range.end; ++t) {
+            const int gx = t % gridCols;
+            const int gy = t / gridCols;
+
+            // Tile centered in its grid cell
+            const int x = (2 * gx + 1) * image.cols / (2 * gridCols) - tileSize / 2;
+            const int y = (2 * gy + 1) * image.rows / (2 * gridRows) - tileSize / 2;
+            cv::Rect rect(std::max(0, std::min(x, image.cols - tileSize)),
+                          std::max(0, std::min(y, image.rows - tileSize)),
+                          tileSize, tileSize);
+
+            cv::Mat tile = image(rect);
+            if (tile.channels() == 3) {
+                cv::cvtColor(tile, gray, cv::COLOR_BGR2GRAY);
+            } else if (tile.channels() == 4) {
+                cv::cvtColor(tile, gray, cv::COLOR_BGRA2GRAY);
+            } else {
+                gray = tile;
+            }
+            if (gray.depth() != CV_8U) {
+                gray.convertTo(gray, CV_8U);
+            }
+
+            sigmas[t] = tileSigma(gray, rowDiff);
+        }
+    });
+
+    // Average the flattest tiles
+    const int flatCount = std::max(1, static_cast<int>(tileCount * FLAT_TILE_FRACTION));
+    std::nth_element(sigmas.begin(), sigmas.begin() + (flatCount - 1), sigmas.end());
+    double total = 0;
+    for (int i = 0; i < flatCount; ++i) {
+        total += sigmas[i];
+    }
+    return total / flatCount;
+}
+
+double NoiseEstimator::recommendedNlmStrength(double sigma) {
+    return std::max(NLM_MIN_STRENGTH, NLM_STRENGTH_PER_SIGMA * sigma);
+}
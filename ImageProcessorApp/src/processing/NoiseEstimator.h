@@ -0,0 +1,48 @@
+#ifndef NOISEESTIMATOR_H
+#define NOISEESTIMATOR_H
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Fast estimate of the Gaussian noise level of an image
+ *
+ * Uses Immerkær's operator (the 3x3 mask [1 -2 1; -2 4 -2; 1 -2 1], which
+ * cancels flat regions and linear ramps) evaluated on a fixed budget of
+ * small tiles spread over the image. The mask is computed separably as two
+ * second differences on int16 data. Textured tiles over-estimate the
+ * noise, so the estimate is taken from the flattest tiles.
+ *
+ * The cost depends only on the tile budget, not on the image size.
+ */
+class NoiseEstimator {
+public:
+    /**
+     * @brief Default number of tiles examined
+     */
+    static const int DEFAULT_TILE_BUDGET = 64;
+
+    /**
+     * @brief Default tile side in pixels
+     */
+    static const int DEFAULT_TILE_SIZE = 32;
+
+    /**
+     * @brief Estimate the standard deviation of the noise
+     * @param image Source image (color images are measured on luminance)
+     * @param tileBudget Number of tiles to examine
+     * @param tileSize Tile side in pixels (>= 3)
+     * @return Noise sigma in gray levels (0 for images smaller than 3x3)
+     */
+    static double estimateSigma(const cv::Mat& image,
+                                int tileBudget = DEFAULT_TILE_BUDGET,
+                                int tileSize = DEFAULT_TILE_SIZE);
+
+    /**
+     * @brief Non-local means filter strength (h) for a noise level
+     * @param sigma Noise sigma from estimateSigma()
+     * @return Value for cv::fastNlMeansDenoising's h parameter
+     */
+    static double recommendedNlmStrength(double sigma);
+};
+
+#endif // NOISEESTIMATOR_H
@@ -0,0 +1,340 @@
+#include "Resampler.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// Fixed-point precision of the filter weights (255 times the summed
+// weights, negative lobes included, stays within an int)
+const int WEIGHT_BITS = 22;
+const int WEIGHT_ONE = 1 << WEIGHT_BITS;
+const int WEIGHT_HALF = 1 << (WEIGHT_BITS - 1);
+
+// Coefficient tables kept; the least recently used one goes first
+const size_t MAX_CACHED_TABLES = 64;
+
+// Weights of one axis: output i blends source samples
+// first[i] .. first[i] + taps - 1 with weights[i * taps ..]
+struct Coefficients {
+    int taps;
+    std::vector<int> first;
+    std::vector<int> weights;
+};
+
+typedef std::tuple<int, int, int> CoefficientKey;
+typedef std::pair<CoefficientKey, std::shared_ptr<const Coefficients>> CacheEntry;
+
+// Most recently used table first
+struct TableCache {
+    std::list<CacheEntry> entries;
+    std::map<CoefficientKey, std::list<CacheEntry>::iterator> index;
+};
+
+std::mutex& cacheMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+TableCache& cache() {
+    static TableCache tables;
+    return tables;
+}
+
+double filterSupport(Resampler::Filter filter) {
+    switch (filter) {
+        case Resampler::FILTER_AREA: return 0.5;
+        case Resampler::FILTER_MITCHELL: return 2.0;
+        case Resampler::FILTER_LANCZOS3: return 3.0;
+    }
+    return 0.5;
+}
+
+double sinc(double x) {
+    if (x == 0.0) {
+        return 1.0;
+    }
+    x *= CV_PI;
+    return std::sin(x) / x;
+}
+
+double filterWeight(Resampler::Filter filter, double x) {
+    if (filter == Resampler::FILTER_AREA) {
+        // Half-open so a sample centred on a boundary falls on one side
+        return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+    }
+
+    x = std::abs(x);
+    switch (filter) {
+        case Resampler::FILTER_MITCHELL: {
+            // Mitchell-Netravali with B = C = 1/3
+            const double B = 1.0 / 3.0;
+            const double C = 1.0 / 3.0;
+            if (x < 1.0) {
+                return ((12 - 9 * B - 6 * C) * x * x * x
+                        + (-18 + 12 * B + 6 * C) * x * x
+                        + (6 - 2 * B)) / 6.0;
+            }
+            if (x < 2.0) {
+                return ((-B - 6 * C) * x * x * x + (6 * B + 30 * C) * x * x
+                        + (-12 * B - 48 * C) * x + (8 * B + 24 * C)) / 6.0;
+            }
+            return 0.0;
+        }
+        case Resampler::FILTER_LANCZOS3:
+            return x < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+        default:
+            return 0.0;
+    }
+}
+
+std::shared_ptr<const Coefficients> buildCoefficients(int sourceLength, int targetLength,
+                                                      Resampler::Filter filter) {
+    // Reductions stretch the filter over the source so every sample counts
+    const double scale = static_cast<double>(sourceLength) / targetLength;
+    const double filterScale = std::max(scale, 1.0);
+    const double support = filterSupport(filter) * filterScale;
+
+    std::shared_ptr<Coefficients> table = std::make_shared<Coefficients>();
+    table->taps = std::min(sourceLength, static_cast<int>(std::ceil(support)) * 2 + 1);
+    table->first.resize(targetLength);
+    table->weights.assign(static_cast<size_t>(targetLength) * table->taps, 0);
+
+    std::vector<double> weights(table->taps);
+    for (int i = 0; i < targetLength; ++i) {
+        const double center = (i + 0.5) * scale;
+        const int lo = std::max(0, static_cast<int>(center - support + 0.5));
+        const int hi = std::min(sourceLength, static_cast<int>(center + support + 0.5));
+
+        // Keep a fixed window inside the source; samples outside it weigh 0
+        const int first = std::max(0, std::min(lo, sourceLength - table->taps));
+        double total = 0;
+        for (int t = 0; t < table->taps; ++t) {
+            const int s = first + t;
+            weights[t] = (s >= lo && s < hi)
+                ? filterWeight(filter, (s + 0.5 - center) / filterScale) : 0.0;
+            total += weights[t];
+        }
+        if (total == 0) {
+            // Degenerate window (tiny box at an exact boundary): nearest sample
+            const int nearest = std::min(sourceLength - 1, static_cast<int>(center));
+            weights.assign(table->taps, 0.0);
+            weights[nearest - first] = 1.0;
+            total = 1.0;
+        }
+
+        // Quantize, then put the rounding error on the largest weight so
+        // flat regions stay exactly flat
+        int* w = &table->weights[static_cast<size_t>(i) * table->taps];
+        int sum = 0;
+        int largest = 0;
+        for (int t = 0; t < table->taps; ++t) {
+            w[t] = cvRound(weights[t] / total * WEIGHT_ONE);
+            sum += w[t];
+            if (w[t] > w[largest]) {
+                largest = t;
+            }
+        }
+        w[largest] += WEIGHT_ONE - sum;
+        table->first[i] = first;
+    }
+
+    return table;
+}
+
+std::shared_ptr<const Coefficients> coefficients(int sourceLength, int targetLength,
+                                                 Resampler::Filter filter) {
+    const CoefficientKey key(sourceLength, targetLength, static_cast<int>(filter));
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        TableCache& tables = cache();
+        auto found = tables.index.find(key);
+        if (found != tables.index.end()) {
+            tables.entries.splice(tables.entries.begin(), tables.entries, found->second);
+            return found->second->second;
+        }
+    }
+
+    std::shared_ptr<const Coefficients> table = buildCoefficients(sourceLength, targetLength, filter);
+
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    TableCache& tables = cache();
+    auto found = tables.index.find(key);
+    if (found != tables.index.end()) {
+        // Another thread built the same table meanwhile
+        return found->second->second;
+    }
+    tables.entries.emplace_front(key, table);
+    tables.index[key] = tables.entries.begin();
+    while (tables.entries.size() > MAX_CACHED_TABLES) {
+        tables.index.erase(tables.entries.back().first);
+        tables.entries.pop_back();
+    }
+    return table;
+}
+
+inline uchar roundWeighted(int acc) {
+    return cv::saturate_cast<uchar>((acc + WEIGHT_HALF) >> WEIGHT_BITS);
+}
+
+// Horizontal pass over source rows [rowStart, rowEnd) into dst rows 0..
+template <int CN>
+void resampleRows(const cv::Mat& src, cv::Mat& dst, int rowStart, const Coefficients& table) {
+    const int taps = table.taps;
+    const int cols = dst.cols;
+
+    cv::parallel_for_(cv::Range(0, dst.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const uchar* s = src.ptr<uchar>(rowStart + y);
+            uchar* d = dst.ptr<uchar>(y);
+            for (int x = 0; x < cols; ++x) {
+                const uchar* p = s + table.first[x] * CN;
+                const int* w = &table.weights[static_cast<size_t>(x) * taps];
+                int acc[CN] = {0};
+                for (int t = 0; t < taps; ++t) {
+                    for (int c = 0; c < CN; ++c) {
+                        acc[c] += p[t * CN + c] * w[t];
+                    }
+                }
+                for (int c = 0; c < CN; ++c) {
+                    d[x * CN + c] = roundWeighted(acc[c]);
+                }
+            }
+        }
+    });
+}
+
+// Vertical pass: src row (first[y] - rowStart) .. blended into dst row y
+void resampleColumns(const cv::Mat& src, cv::Mat& dst, int rowStart, const Coefficients& table) {
+    const int taps = table.taps;
+    const int width = dst.cols * dst.channels();
+
+    cv::parallel_for_(cv::Range(0, dst.rows), [&](const cv::Range& range) {
+        std::vector<int> acc(width);
+        for (int y = range.start; y < range.end; ++y) {
+            const int* w = &table.weights[static_cast<size_t>(y) * taps];
+            const int first = table.first[y] - rowStart;
+
+            // Whole rows at a time keep the inner loop contiguous
+            std::fill(acc.begin(), acc.end(), WEIGHT_HALF);
+            for (int t = 0; t < taps; ++t) {
+                const int weight = w[t];
+                if (weight == 0) {
+                    continue;
+                }
+                const uchar* s = src.ptr<uchar>(first + t);
+                for (int x = 0; x < width; ++x) {
+                    acc[x] += s[x] * weight;
+                }
+            }
+
+            uchar* d = dst.ptr<uchar>(y);
+            for (int x = 0; x < width; ++x) {
+                d[x] = cv::saturate_cast<uchar>(acc[x] >> WEIGHT_BITS);
+            }
+        }
+    });
+}
+
+void resampleHorizontal(const cv::Mat& src, cv::Mat& dst, int rowStart, const Coefficients& table) {
+    switch (src.channels()) {
+        case 1: resampleRows<1>(src, dst, rowStart, table); break;
+        case 2: resampleRows<2>(src, dst, rowStart, table); break;
+        case 3: resampleRows<3>(src, dst, rowStart, table); break;
+        default: resampleRows<4>(src, dst, rowStart, table); break;
+    }
+}
+
+int fallbackInterpolation(Resampler::Filter filter) {
+    switch (filter) {
+        case Resampler::FILTER_AREA: return cv::INTER_AREA;
+        case Resampler::FILTER_MITCHELL: return cv::INTER_CUBIC;
+        case Resampler::FILTER_LANCZOS3: return cv::INTER_LANCZOS4;
+    }
+    return cv::INTER_AREA;
+}
+
+} // namespace
+
+void Resampler::resize(const cv::Mat& input, cv::Mat& output,
+                       const cv::Size& size, Filter filter) {
+    TRACE_FUNCTION("resample");
+    if (input.empty() || size.width <= 0 || size.height <= 0) {
+        output = cv::Mat();
+        return;
+    }
+
+    if (input.size() == size) {
+        input.copyTo(output);
+        return;
+    }
+
+    // New buffer when output shares pixels with the input
+    cv::Mat result;
+    if (output.data != input.data && output.size() == size && output.type() == input.type()) {
+        result = output;
+    } else {
+        result.create(size, input.type());
+    }
+
+    if (input.depth() != CV_8U || input.channels() > 4) {
+        cv::resize(input, result, size, 0, 0, fallbackInterpolation(filter));
+        output = result;
+        return;
+    }
+
+    std::shared_ptr<const Coefficients> vertical;
+    int rowStart = 0;
+    int rowEnd = input.rows;
+    if (size.height != input.rows) {
+        vertical = coefficients(input.rows, size.height, filter);
+
+        // Only the source rows the vertical pass reads
+        rowStart = vertical->first.front();
+        rowEnd = vertical->first.back() + vertical->taps;
+    }
+
+    // Horizontal pass (skipped when the width is unchanged)
+    cv::Mat rows;
+    if (size.width != input.cols) {
+        std::shared_ptr<const Coefficients> horizontal = coefficients(input.cols, size.width, filter);
+        if (vertical) {
+            rows.create(rowEnd - rowStart, size.width, input.type());
+        } else {
+            rows = result;
+        }
+        resampleHorizontal(input, rows, rowStart, *horizontal);
+    } else {
+        rows = input.rowRange(rowStart, rowEnd);
+    }
+
+    // Vertical pass (row 0 of rows is source row rowStart)
+    if (vertical) {
+        resampleColumns(rows, result, rowStart, *vertical);
+    }
+
+    output = result;
+}
+
+cv::Size Resampler::fitSize(const cv::Size& size, const cv::Size& bounds) {
+    if (size.width <= 0 || size.height <= 0 || bounds.width <= 0 || bounds.height <= 0) {
+        return cv::Size();
+    }
+
+    const double scale = std::min(static_cast<double>(bounds.width) / size.width,
+                                  static_cast<double>(bounds.height) / size.height);
+    return cv::Size(std::max(1, cvRound(size.width * scale)),
+                    std::max(1, cvRound(size.height * scale)));
+}
+
+void Resampler::clearCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    cache().entries.clear();
+    cache().index.clear();
+}
@@ -0,0 +1,51 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Antialiased separable image resampler
+ *
+ * Resizes with a proper reconstruction filter whose support widens with
+ * the reduction factor, so large reductions average every source pixel
+ * instead of skipping most of them (which is what bilinear does).
+ *
+ * The filter weights only depend on the source length, destination length
+ * and filter, so they are computed once per axis as fixed-point tables and
+ * cached. Images are then resampled horizontally and vertically, each pass
+ * parallel over rows with contiguous inner loops the compiler vectorizes.
+ *
+ * 8-bit images with 1 to 4 channels take the fast path; other types fall
+ * back to cv::resize with the closest OpenCV interpolation.
+ */
+class Resampler {
+public:
+    enum Filter {
+        FILTER_AREA,     // Box: exact area average when reducing
+        FILTER_MITCHELL, // Mitchell-Netravali (B = C = 1/3), soft, no ringing
+        FILTER_LANCZOS3  // Lanczos, 3 lobes, sharpest
+    };
+
+    /**
+     * @brief Resize an image
+     * @param input Input image
+     * @param output Output image (reused when it already has the target size
+     *               and type, so it may be a region of a larger image)
+     * @param size Target size
+     * @param filter Reconstruction filter
+     */
+    static void resize(const cv::Mat& input, cv::Mat& output,
+                       const cv::Size& size, Filter filter = FILTER_LANCZOS3);
+
+    /**
+     * @brief Largest size that fits in bounds with the aspect ratio of size
+     */
+    static cv::Size fitSize(const cv::Size& size, const cv::Size& bounds);
+
+    /**
+     * @brief Drop all cached coefficient tables
+     */
+    static void clearCache();
+};
+
+#endif // RESAMPLER_H
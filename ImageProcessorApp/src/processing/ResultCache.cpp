@@ -0,0 +1,528 @@
+#include "ResultCache.h"
+#include "DerivedImageCache.h"
+#include "Trace.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <vector>
+
+const size_t ResultCache::DEFAULT_CACHE_BUDGET;
+const size_t ResultCache::DEFAULT_SPILL_BUDGET;
+
+namespace {
+
+const char SPILL_MAGIC[8] = {'D', 'I', 'P', 'R', 'C', '0', '0', '1'};
+const char SPILL_EXTENSION[] = ".imgcache";
+
+struct MemoryEntry {
+    std::string key;
+    ImageHandle input;   // checked on every hit
+    ImageHandle result;
+    size_t bytes;
+};
+
+struct DiskEntry {
+    std::string key;
+    int rows;
+    int cols;
+    int type;
+    size_t bytes;
+    uint64_t lastUse;
+};
+
+// Most recently used result first
+struct Cache {
+    std::list<MemoryEntry> entries;
+    std::map<std::string, std::list<MemoryEntry>::iterator> index;
+    std::map<uint64_t, size_t> inputs;           // input version -> entries using it
+    size_t bytes = 0;                            // results and distinct inputs
+    size_t budget = ResultCache::DEFAULT_CACHE_BUDGET;
+
+    std::string spillDirectory;                  // empty: no spilling
+    std::map<std::string, DiskEntry> disk;       // file name -> entry
+    size_t diskBytes = 0;
+    size_t diskBudget = ResultCache::DEFAULT_SPILL_BUDGET;
+    uint64_t diskClock = 0;
+
+    ResultCache::Stats stats;
+};
+
+std::mutex& cacheMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+Cache& cache() {
+    static Cache instance;
+    return instance;
+}
+
+size_t matBytes(const cv::Mat& mat) {
+    return mat.total() * mat.elemSize();
+}
+
+std::string formatDouble(double value) {
+    if (value == 0.0) {
+        return "0";   // also folds -0
+    }
+    if (std::isnan(value)) {
+        return "nan";
+    }
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.17g", value);
+    return text;
+}
+
+// Stable file name of a key (FNV-1a, identical across runs)
+std::string spillFileName(const std::string& key) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (char c : key) {
+        h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(h));
+    return std::string(name) + SPILL_EXTENSION;
+}
+
+std::string spillPath(const Cache& c, const std::string& fileName) {
+    return c.spillDirectory + "/" + fileName;
+}
+
+// =============================================================================
+// SPILL FILES
+// =============================================================================
+// Layout: magic, rows, cols, type (int32), key length (uint32), key text,
+// then the pixel rows without padding.
+
+// Header of a spill file; false unless it describes a plausible image and
+// the file holds exactly its pixels
+bool readHeader(std::ifstream& file, std::string& key, int& rows, int& cols, int& type) {
+    char magic[sizeof(SPILL_MAGIC)];
+    int32_t header[3];
+    uint32_t keyLength = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    file.read(reinterpret_cast<char*>(&keyLength), sizeof(keyLength));
+    if (!file || std::memcmp(magic, SPILL_MAGIC, sizeof(magic)) != 0 ||
+        header[0] <= 0 || header[1] <= 0 || keyLength > (1u << 20) ||
+        header[2] < 0 || CV_MAT_DEPTH(header[2]) > CV_64F || CV_MAT_CN(header[2]) > 4) {
+        return false;
+    }
+    key.resize(keyLength);
+    file.read(&key[0], keyLength);
+    rows = header[0];
+    cols = header[1];
+    type = header[2];
+    if (!file) {
+        return false;
+    }
+
+    const std::streamoff pixels = file.tellg();
+    file.seekg(0, std::ios::end);
+    const std::streamoff size = file.tellg();
+    file.seekg(pixels);
+    const double expected = static_cast<double>(rows) * cols * CV_ELEM_SIZE(type);
+    return static_cast<bool>(file) && static_cast<double>(size - pixels) == expected;
+}
+
+bool writeSpill(const std::string& path, const std::string& key, const cv::Mat& result) {
+    TRACE_SCOPE("cache", "spill write");
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary.c_str(), std::ios::binary | std::ios::trunc);
+        const int32_t header[3] = {result.rows, result.cols, result.type()};
+        const uint32_t keyLength = static_cast<uint32_t>(key.size());
+        file.write(SPILL_MAGIC, sizeof(SPILL_MAGIC));
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&keyLength), sizeof(keyLength));
+        file.write(key.data(), key.size());
+        const size_t rowBytes = result.cols * result.elemSize();
+        for (int y = 0; y < result.rows && file; ++y) {
+            file.write(result.ptr<char>(y), rowBytes);
+        }
+        if (!file) {
+            file.close();
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    // Readers never see a partly written file
+    std::remove(path.c_str());
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+// Read a result back; anything but the file that was indexed is rejected
+bool readSpill(const std::string& path, const DiskEntry& expected, ImageHandle& result) {
+    TRACE_SCOPE("cache", "spill read");
+    std::ifstream file(path.c_str(), std::ios::binary);
+    std::string storedKey;
+    int rows, cols, type;
+    if (!file || !readHeader(file, storedKey, rows, cols, type) || storedKey != expected.key ||
+        rows != expected.rows || cols != expected.cols || type != expected.type) {
+        return false;
+    }
+    cv::Mat loaded(rows, cols, type);
+    file.read(loaded.ptr<char>(), matBytes(loaded));
+    if (!file) {
+        return false;
+    }
+    result = ImageHandle(loaded);
+    return true;
+}
+
+// Whether a stored input has the content a key was made for: the same
+// pixels, or an exact copy of them
+bool sameInput(const ImageHandle& stored, const ImageHandle& input) {
+    if (stored.sharesWith(input) || stored.version() == input.version()) {
+        return true;
+    }
+    const cv::Mat& a = stored.mat();
+    const cv::Mat& b = input.mat();
+    if (a.rows != b.rows || a.cols != b.cols || a.type() != b.type()) {
+        return false;
+    }
+    TRACE_SCOPE("cache", "verify input");
+    const size_t rowBytes = a.cols * a.elemSize();
+    for (int y = 0; y < a.rows; ++y) {
+        if (std::memcmp(a.ptr<uchar>(y), b.ptr<uchar>(y), rowBytes) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Inputs are counted once however many results refer to them (lock held)
+void retainInput(Cache& c, const ImageHandle& input) {
+    if (c.inputs[input.version()]++ == 0) {
+        c.bytes += matBytes(input);
+    }
+}
+
+void releaseInput(Cache& c, const ImageHandle& input) {
+    auto found = c.inputs.find(input.version());
+    if (found != c.inputs.end() && --found->second == 0) {
+        c.bytes -= matBytes(input);
+        c.inputs.erase(found);
+    }
+}
+
+// Remove the least recently used files until the directory fits (lock held)
+void evictDisk(Cache& c) {
+    while (c.diskBytes > c.diskBudget && !c.disk.empty()) {
+        auto oldest = c.disk.begin();
+        for (auto it = c.disk.begin(); it != c.disk.end(); ++it) {
+            if (it->second.lastUse < oldest->second.lastUse) {
+                oldest = it;
+            }
+        }
+        std::remove(spillPath(c, oldest->first).c_str());
+        c.diskBytes -= oldest->second.bytes;
+        c.disk.erase(oldest);
+    }
+}
+
+// Drop least recently used results until memory fits the budget (the most
+// recent result always stays); evicted results are handed back for spilling
+void evict(Cache& c, std::vector<MemoryEntry>& evicted) {
+    while (c.entries.size() > 1 && c.bytes > c.budget) {
+        auto last = std::prev(c.entries.end());
+        c.bytes -= last->bytes;
+        releaseInput(c, last->input);
+        c.index.erase(last->key);
+        evicted.push_back(*last);
+        c.entries.erase(last);
+    }
+}
+
+// Insert or replace a memory entry (lock held)
+void insert(Cache& c, const std::string& key, const ImageHandle& input,
+            const ImageHandle& result, std::vector<MemoryEntry>& evicted) {
+    auto found = c.index.find(key);
+    if (found != c.index.end()) {
+        c.bytes -= found->second->bytes;
+        releaseInput(c, found->second->input);
+        c.entries.erase(found->second);
+        c.index.erase(found);
+    }
+    MemoryEntry entry;
+    entry.key = key;
+    entry.input = input;
+    entry.result = result;
+    entry.bytes = matBytes(result);
+    c.entries.push_front(entry);
+    c.index[key] = c.entries.begin();
+    c.bytes += entry.bytes;
+    retainInput(c, input);
+    evict(c, evicted);
+}
+
+// Write evicted results to the spill directory (called without the lock)
+void spill(const std::vector<MemoryEntry>& evicted) {
+    for (const MemoryEntry& entry : evicted) {
+        const std::string fileName = spillFileName(entry.key);
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex());
+            Cache& c = cache();
+            if (c.spillDirectory.empty()) {
+                return;
+            }
+            auto found = c.disk.find(fileName);
+            if (found != c.disk.end() && found->second.key == entry.key) {
+                continue;   // already on disk
+            }
+            path = spillPath(c, fileName);
+        }
+
+        if (!writeSpill(path, entry.key, entry.result)) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        Cache& c = cache();
+        auto found = c.disk.find(fileName);
+        if (found != c.disk.end()) {
+            c.diskBytes -= found->second.bytes;   // same name, different key: replaced
+        }
+        DiskEntry diskEntry;
+        diskEntry.key = entry.key;
+        diskEntry.rows = entry.result->rows;
+        diskEntry.cols = entry.result->cols;
+        diskEntry.type = entry.result->type();
+        diskEntry.bytes = entry.bytes;
+        diskEntry.lastUse = c.diskClock++;
+        c.disk[fileName] = diskEntry;
+        c.diskBytes += diskEntry.bytes;
+        evictDisk(c);
+    }
+}
+
+} // namespace
+
+// =============================================================================
+// KEY
+// =============================================================================
+
+ResultCache::Key::Key(const std::string& operation, const ImageHandle& input)
+    : operation(operation), image(input) {
+    if (input.empty()) {
+        return;
+    }
+    const DerivedImageCache::ContentHash hash = DerivedImageCache::contentHash(input);
+    char text[96];
+    std::snprintf(text, sizeof(text), "%016llx%016llx:%dx%d:%d",
+                  static_cast<unsigned long long>(hash.high),
+                  static_cast<unsigned long long>(hash.low),
+                  input->rows, input->cols, input->type());
+    this->inputText = text;
+}
+
+ResultCache::Key& ResultCache::Key::add(const std::string& name, int value) {
+    parameters[name] = std::to_string(value);
+    return *this;
+}
+
+ResultCache::Key& ResultCache::Key::add(const std::string& name, double value) {
+    parameters[name] = formatDouble(value);
+    return *this;
+}
+
+ResultCache::Key& ResultCache::Key::add(const std::string& name, const cv::Matx33d& value) {
+    std::string text;
+    for (int i = 0; i < 9; ++i) {
+        text += (i ? "," : "") + formatDouble(value.val[i]);
+    }
+    parameters[name] = text;
+    return *this;
+}
+
+std::string ResultCache::Key::text() const {
+    if (inputText.empty()) {
+        return std::string();
+    }
+    std::string text = operation + "|" + inputText;
+    for (const auto& parameter : parameters) {
+        text += "|" + parameter.first + "=" + parameter.second;
+    }
+    return text;
+}
+
+// =============================================================================
+// RESULTS
+// =============================================================================
+
+bool ResultCache::lookup(const Key& key, ImageHandle& result) {
+    const std::string text = key.text();
+    if (text.empty()) {
+        return false;
+    }
+
+    DiskEntry diskEntry;
+    std::string path;
+    {
+        std::unique_lock<std::mutex> lock(cacheMutex());
+        Cache& c = cache();
+        auto found = c.index.find(text);
+        if (found != c.index.end()) {
+            c.entries.splice(c.entries.begin(), c.entries, found->second);
+            const MemoryEntry entry = *found->second;
+            lock.unlock();
+
+            // Equal keys with other input content (a hash collision) miss
+            const bool valid = sameInput(entry.input, key.input());
+            lock.lock();
+            if (!valid) {
+                c.stats.misses++;
+                return false;
+            }
+            c.stats.hits++;
+            result = entry.result;
+            return true;
+        }
+
+        auto onDisk = c.spillDirectory.empty() ? c.disk.end()
+                                               : c.disk.find(spillFileName(text));
+        if (onDisk == c.disk.end() || onDisk->second.key != text) {
+            c.stats.misses++;
+            return false;
+        }
+        onDisk->second.lastUse = c.diskClock++;
+        diskEntry = onDisk->second;
+        path = spillPath(c, onDisk->first);
+    }
+
+    // Spilled results carry no input; they are matched by the 128-bit key
+    ImageHandle loaded;
+    const bool read = readSpill(path, diskEntry, loaded);
+
+    std::vector<MemoryEntry> evicted;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        Cache& c = cache();
+        if (!read) {
+            // Unreadable, damaged or replaced file: forget it
+            auto onDisk = c.disk.find(spillFileName(text));
+            if (onDisk != c.disk.end() && onDisk->second.key == text) {
+                std::remove(spillPath(c, onDisk->first).c_str());
+                c.diskBytes -= onDisk->second.bytes;
+                c.disk.erase(onDisk);
+            }
+            c.stats.misses++;
+            return false;
+        }
+        c.stats.diskHits++;
+        insert(c, text, key.input(), loaded, evicted);
+    }
+    spill(evicted);
+
+    result = loaded;
+    return true;
+}
+
+void ResultCache::store(const Key& key, const ImageHandle& result) {
+    const std::string text = key.text();
+    if (text.empty() || result.empty()) {
+        return;
+    }
+
+    std::vector<MemoryEntry> evicted;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        insert(cache(), text, key.input(), result, evicted);
+    }
+    spill(evicted);
+}
+
+// =============================================================================
+// CACHE
+// =============================================================================
+
+void ResultCache::setCacheBudget(size_t bytes) {
+    std::vector<MemoryEntry> evicted;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        cache().budget = bytes;
+        evict(cache(), evicted);
+    }
+    spill(evicted);
+}
+
+void ResultCache::setSpillDirectory(const std::string& directory, size_t budget) {
+    // Index the files already there (headers only)
+    std::map<std::string, DiskEntry> disk;
+    size_t diskBytes = 0;
+    if (!directory.empty()) {
+        std::vector<cv::String> files;
+        try {
+            cv::glob(directory + "/*" + SPILL_EXTENSION, files, false);
+        } catch (const cv::Exception&) {
+            files.clear();
+        }
+        uint64_t order = 0;
+        for (const cv::String& path : files) {
+            std::ifstream file(path.c_str(), std::ios::binary);
+            std::string key;
+            int rows, cols, type;
+            if (!file || !readHeader(file, key, rows, cols, type)) {
+                file.close();
+                std::remove(path.c_str());   // damaged or truncated
+                continue;
+            }
+            const std::string fileName = path.substr(path.find_last_of("/\\") + 1);
+            DiskEntry entry;
+            entry.key = key;
+            entry.rows = rows;
+            entry.cols = cols;
+            entry.type = type;
+            entry.bytes = static_cast<size_t>(rows) * cols * CV_ELEM_SIZE(type);
+            entry.lastUse = order++;
+            disk[fileName] = entry;
+            diskBytes += entry.bytes;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    Cache& c = cache();
+    c.spillDirectory = directory;
+    c.disk.swap(disk);
+    c.diskBytes = diskBytes;
+    c.diskBudget = budget;
+    c.diskClock = c.disk.size();
+    evictDisk(c);
+}
+
+void ResultCache::clearSpill() {
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    Cache& c = cache();
+    for (const auto& file : c.disk) {
+        std::remove(spillPath(c, file.first).c_str());
+    }
+    c.disk.clear();
+    c.diskBytes = 0;
+}
+
+void ResultCache::clearCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    Cache& c = cache();
+    c.entries.clear();
+    c.index.clear();
+    c.inputs.clear();
+    c.bytes = 0;
+    c.stats = Stats();
+}
+
+ResultCache::Stats ResultCache::stats() {
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    const Cache& c = cache();
+    Stats stats = c.stats;
+    stats.memoryBytes = c.bytes;
+    stats.memoryEntries = c.entries.size();
+    stats.diskBytes = c.diskBytes;
+    stats.diskEntries = c.disk.size();
+    return stats;
+}
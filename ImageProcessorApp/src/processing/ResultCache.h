@@ -0,0 +1,146 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include "ImageHandle.h"
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <map>
+#include <string>
+
+/**
+ * @brief Memoized results of (input image, operation, parameters)
+ *
+ * Dialogs recompute their preview every time a control changes, and users
+ * often go back and forth between a few settings or undo a step and apply
+ * it again. Results are stored under a key made of the input's 128-bit
+ * content hash (DerivedImageCache::contentHash, so any copy of the same
+ * pixels matches), an operation name and the parameters in canonical form;
+ * revisiting a setting returns the stored result instead of running the
+ * operation.
+ *
+ * Results are shared as ImageHandles, so storing and hitting copy nothing.
+ * Each result in memory keeps its input, and a hit is only returned if the
+ * key's input has the same pixels, so a hash collision costs a recompute
+ * instead of a wrong image. Memory, including those inputs, is bounded by a
+ * budget, least recently used results first.
+ *
+ * Spilling is off unless a directory is set: results evicted from memory
+ * are then written there and read back on a later miss, matched by key and
+ * checked against the file header. The directory has its own budget;
+ * clearSpill() removes the files.
+ */
+class ResultCache {
+public:
+    /**
+     * @brief Default memory budget of cached results (bytes)
+     */
+    static const size_t DEFAULT_CACHE_BUDGET = 256 * 1024 * 1024;
+
+    /**
+     * @brief Default disk budget of the spill directory (bytes)
+     */
+    static const size_t DEFAULT_SPILL_BUDGET = 1024 * 1024 * 1024;
+
+    /**
+     * @brief Cache key: input content, operation and canonical parameters
+     *
+     * Parameters are ordered by name and doubles are printed exactly, so the
+     * same setting always gives the same key regardless of the order in
+     * which add() is called.
+     */
+    class Key {
+    public:
+        /**
+         * @param operation Stable operation name (e.g. "ImageFilters::median")
+         * @param input Image the operation reads
+         */
+        Key(const std::string& operation, const ImageHandle& input);
+
+        Key& add(const std::string& name, int value);
+        Key& add(const std::string& name, double value);
+        Key& add(const std::string& name, const cv::Matx33d& value);
+
+        /**
+         * @brief Canonical text of the key (empty for an empty input)
+         */
+        std::string text() const;
+
+        bool empty() const { return inputText.empty(); }
+
+        /**
+         * @brief The image the key was made for
+         */
+        const ImageHandle& input() const { return image; }
+
+    private:
+        std::string operation;
+        ImageHandle image;
+        std::string inputText;
+        std::map<std::string, std::string> parameters;
+    };
+
+    /**
+     * @brief Counters since the last clearCache()
+     */
+    struct Stats {
+        size_t hits;            // served from memory
+        size_t diskHits;        // read back from the spill directory
+        size_t misses;
+        size_t memoryBytes;
+        size_t memoryEntries;
+        size_t diskBytes;
+        size_t diskEntries;
+
+        Stats() : hits(0), diskHits(0), misses(0), memoryBytes(0), memoryEntries(0),
+                  diskBytes(0), diskEntries(0) {}
+    };
+
+    // ==========================================================================
+    // RESULTS
+    // ==========================================================================
+
+    /**
+     * @brief Look up a stored result
+     * @param result Receives the shared result on a hit
+     * @return true on a hit
+     */
+    static bool lookup(const Key& key, ImageHandle& result);
+
+    /**
+     * @brief Store a result (shared, not copied)
+     */
+    static void store(const Key& key, const ImageHandle& result);
+
+    // ==========================================================================
+    // CACHE
+    // ==========================================================================
+
+    /**
+     * @brief Limit the memory of cached results (evicts as needed)
+     */
+    static void setCacheBudget(size_t bytes);
+
+    /**
+     * @brief Spill evicted results to a directory (empty path disables)
+     *
+     * Off by default. The directory must exist. Valid result files already
+     * in it are indexed and can be hit; files beyond the disk budget are
+     * removed, oldest first.
+     */
+    static void setSpillDirectory(const std::string& directory,
+                                  size_t budget = DEFAULT_SPILL_BUDGET);
+
+    /**
+     * @brief Remove every indexed file from the spill directory
+     */
+    static void clearSpill();
+
+    /**
+     * @brief Drop all results in memory (spilled files are kept) and reset stats
+     */
+    static void clearCache();
+
+    static Stats stats();
+};
+
+#endif // RESULTCACHE_H
@@ -1,8 +1,83 @@
 #include "SegmentationLib.h"
+#include "ConnectedComponents.h"
+#include "GrabCutSession.h"
+#include "IntegralImage.h"
+#include "MorphologyEngine.h"
+#include "Trace.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <random>
 
+const int SegmentationLib::MAX_THRESHOLD_LEVELS;
+
+namespace {
+
+// Dynamic range of the standard deviation for 8-bit images (Sauvola's R)
+const double SAUVOLA_DYNAMIC_RANGE = 128.0;
+
+// Colors precomputed for the first labels; the palette grows on demand
+const int INITIAL_PALETTE_SIZE = 4096;
+
+// Largest shared palette (192 KB); higher labels get a hashed color
+const int MAX_PALETTE_SIZE = 65536;
+
+typedef std::shared_ptr<const std::vector<cv::Vec3b>> PaletteSnapshot;
+
+std::mutex& paletteMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+/**
+ * Persistent label palette: background is black, label i > 0 gets the i-th
+ * color of a fixed-seed generator, so colors are stable across calls.
+ * Growing replaces the vector, so snapshots handed out stay valid.
+ */
+PaletteSnapshot& labelPalette() {
+    static PaletteSnapshot palette =
+        std::make_shared<const std::vector<cv::Vec3b>>(1, cv::Vec3b(0, 0, 0));
+    return palette;
+}
+
+void growLabelPalette(std::vector<cv::Vec3b>& palette, int size) {
+    static std::mt19937 rng(42); // Fixed seed for reproducibility
+    static std::uniform_int_distribution<int> dist(0, 255);
+    
+    while (static_cast<int>(palette.size()) < size) {
+        int b = dist(rng);
+        int g = dist(rng);
+        int r = dist(rng);
+        palette.push_back(cv::Vec3b(b, g, r));
+    }
+}
+
+// Palette covering labels below `size` (capped), grown under the lock
+PaletteSnapshot acquireLabelPalette(int size) {
+    size = std::min(std::max(size, INITIAL_PALETTE_SIZE), MAX_PALETTE_SIZE);
+    
+    std::lock_guard<std::mutex> lock(paletteMutex());
+    PaletteSnapshot& palette = labelPalette();
+    if (static_cast<int>(palette->size()) < size) {
+        std::shared_ptr<std::vector<cv::Vec3b>> grown =
+            std::make_shared<std::vector<cv::Vec3b>>(*palette);
+        growLabelPalette(*grown, size);
+        palette = grown;
+    }
+    return palette;
+}
+
+// Stable color of a label beyond the shared palette
+inline cv::Vec3b hashedLabelColor(int label) {
+    const uint32_t h = static_cast<uint32_t>(label) * 2654435761u;
+    return cv::Vec3b(static_cast<uchar>(h >> 8), static_cast<uchar>(h >> 16),
+                     static_cast<uchar>(h >> 24));
+}
+
+} // namespace
+
 // =============================================================================
 // THRESHOLDING VARIANTS
 // =============================================================================
@@ -10,6 +85,7 @@
 void SegmentationLib::applyAdaptiveThreshold(const cv::Mat& input, cv::Mat& output,
                                              double maxValue, int method,
                                              int blockSize, double C) {
+    TRACE_FUNCTION("segmentation");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -39,6 +115,7 @@ void SegmentationLib::applyAdaptiveThreshold(const cv::Mat& input, cv::Mat& outp
 
 void SegmentationLib::applyMultiLevelThreshold(const cv::Mat& input, cv::Mat& output,
                                                int levels) {
+    TRACE_FUNCTION("segmentation");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -49,8 +126,45 @@ void SegmentationLib::applyMultiLevelThreshold(const cv::Mat& input, cv::Mat& ou
     // Convert to grayscale if needed
     cv::Mat gray;
     convertToGrayscale(input, gray);
+    if (gray.depth() != CV_8U) {
+        gray.convertTo(gray, CV_8U);
+    }
+    
+    levels = std::max(2, std::min(MAX_THRESHOLD_LEVELS, levels));
     
-    levels = std::max(2, std::min(5, levels));
+    // Optimal thresholds from the histogram
+    std::vector<int> thresholds = computeMultiOtsuThresholds(gray, levels);
+    
+    // Map every gray value to its level once, then apply in one LUT pass
+    cv::Mat lut(1, 256, CV_8U);
+    uchar* table = lut.ptr<uchar>();
+    size_t t = 0;
+    for (int v = 0; v < 256; ++v) {
+        while (t < thresholds.size() && v >= thresholds[t]) {
+            ++t;
+        }
+        table[v] = cv::saturate_cast<uchar>((255 / levels) * static_cast<int>(t));
+    }
+    
+    cv::Mat result;
+    cv::LUT(gray, lut, result);
+    
+    // Convert back to color if input was color
+    if (wasColor) {
+        cv::cvtColor(result, output, cv::COLOR_GRAY2BGR);
+    } else {
+        output = result;
+    }
+}
+
+std::vector<int> SegmentationLib::computeMultiOtsuThresholds(const cv::Mat& gray, int levels) {
+    TRACE_FUNCTION("segmentation");
+    std::vector<int> thresholds;
+    if (gray.empty() || gray.type() != CV_8UC1) {
+        return thresholds;
+    }
+    
+    levels = std::max(2, std::min(MAX_THRESHOLD_LEVELS, levels));
     
     // Calculate histogram
     int histSize = 256;
@@ -59,42 +173,151 @@ void SegmentationLib::applyMultiLevelThreshold(const cv::Mat& input, cv::Mat& ou
     cv::Mat hist;
     cv::calcHist(&gray, 1, 0, cv::Mat(), hist, 1, &histSize, &histRange);
     
-    // Find threshold values by dividing histogram into equal parts
-    std::vector<int> thresholds;
-    float totalPixels = gray.rows * gray.cols;
-    float pixelsPerLevel = totalPixels / levels;
+    // Prefix sums of counts and of value*count: any class [a, b) of gray
+    // values contributes sum^2 / count to the between-class variance
+    std::vector<double> count(257, 0.0), sum(257, 0.0);
+    for (int i = 0; i < 256; ++i) {
+        double h = hist.at<float>(i);
+        count[i + 1] = count[i] + h;
+        sum[i + 1] = sum[i] + h * i;
+    }
+    auto classScore = [&](int a, int b) {
+        double w = count[b] - count[a];
+        double s = sum[b] - sum[a];
+        return w > 0 ? s * s / w : 0.0;
+    };
+    
+    // best[k][j]: best score splitting values [0, j) into k + 1 classes,
+    // start[k][j]: where the last of those classes begins
+    std::vector<std::vector<double>> best(levels, std::vector<double>(257, -1.0));
+    std::vector<std::vector<int>> start(levels, std::vector<int>(257, 0));
+    for (int j = 1; j <= 256; ++j) {
+        best[0][j] = classScore(0, j);
+    }
+    for (int k = 1; k < levels; ++k) {
+        for (int j = k + 1; j <= 256; ++j) {
+            for (int i = k; i < j; ++i) {
+                double score = best[k - 1][i] + classScore(i, j);
+                if (score > best[k][j]) {
+                    best[k][j] = score;
+                    start[k][j] = i;
+                }
+            }
+        }
+    }
     
-    float cumSum = 0;
-    int currentLevel = 1;
+    // Walk back from the full range to recover the class boundaries
+    thresholds.resize(levels - 1);
+    int end = 256;
+    for (int k = levels - 1; k >= 1; --k) {
+        end = start[k][end];
+        thresholds[k - 1] = end;
+    }
     
-    for (int i = 0; i < 256 && currentLevel < levels; ++i) {
-        cumSum += hist.at<float>(i);
-        if (cumSum >= pixelsPerLevel * currentLevel) {
-            thresholds.push_back(i);
-            currentLevel++;
-        }
+    return thresholds;
+}
+
+void SegmentationLib::applyLocalThreshold(const cv::Mat& input, cv::Mat& output,
+                                          int method, int windowSize, double k,
+                                          double maxValue) {
+    IntegralImage integral;
+    if (isValidImage(input)) {
+        integral.build(input);
+    }
+    applyLocalThreshold(input, integral, output, method, windowSize, k, maxValue);
+}
+
+void SegmentationLib::applyLocalThreshold(const cv::Mat& input, const IntegralImage& tables,
+                                          cv::Mat& output, int method, int windowSize,
+                                          double k, double maxValue) {
+    TRACE_FUNCTION("segmentation");
+    if (!isValidImage(input)) {
+        output = input.clone();
+        return;
     }
     
-    // Apply multi-level thresholding
-    cv::Mat result = cv::Mat::zeros(gray.size(), CV_8U);
-    for (int i = 0; i < gray.rows; ++i) {
-        for (int j = 0; j < gray.cols; ++j) {
-            uchar pixel = gray.at<uchar>(i, j);
-            uchar level = 0;
-            for (size_t t = 0; t < thresholds.size(); ++t) {
-                if (pixel >= thresholds[t]) {
-                    level = (255 / levels) * (t + 1);
+    bool wasColor = (input.channels() == 3);
+    
+    // Tables of another image (or none) are rebuilt
+    const IntegralImage* integral = &tables;
+    IntegralImage ownTables;
+    if (tables.size() != input.size()) {
+        ownTables.build(input);
+        integral = &ownTables;
+    }
+    
+    // Convert to grayscale if needed
+    cv::Mat gray;
+    convertToGrayscale(input, gray);
+    if (gray.depth() != CV_8U) {
+        gray.convertTo(gray, CV_8U);
+    }
+    
+    const int rows = gray.rows;
+    const int cols = gray.cols;
+    
+    // Ensure odd window size; anything beyond the image covers it entirely
+    if (windowSize % 2 == 0) windowSize++;
+    windowSize = std::max(3, std::min(2 * std::max(rows, cols) + 1, windowSize));
+    const int radius = windowSize / 2;
+    const bool needsDeviation = (method == LOCAL_THRESH_NIBLACK ||
+                                 method == LOCAL_THRESH_SAUVOLA);
+    const uchar highValue = cv::saturate_cast<uchar>(maxValue);
+    
+    const cv::Mat& sums = integral->sums();
+    const cv::Mat& sqsums = integral->squaredSums();
+    
+    cv::Mat binary(rows, cols, CV_8U);
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const int y0 = std::max(0, y - radius);
+            const int y1 = std::min(rows, y + radius + 1);
+            const double* sTop = sums.ptr<double>(y0);
+            const double* sBottom = sums.ptr<double>(y1);
+            const double* sqTop = sqsums.ptr<double>(y0);
+            const double* sqBottom = sqsums.ptr<double>(y1);
+            const uchar* src = gray.ptr<uchar>(y);
+            uchar* dst = binary.ptr<uchar>(y);
+            
+            for (int x = 0; x < cols; ++x) {
+                const int x0 = std::max(0, x - radius);
+                const int x1 = std::min(cols, x + radius + 1);
+                const double n = static_cast<double>((x1 - x0) * (y1 - y0));
+                const double mean = (sBottom[x1] - sBottom[x0] - sTop[x1] + sTop[x0]) / n;
+                
+                double stddev = 0;
+                if (needsDeviation) {
+                    double sq = (sqBottom[x1] - sqBottom[x0] - sqTop[x1] + sqTop[x0]) / n;
+                    stddev = std::sqrt(std::max(0.0, sq - mean * mean));
+                }
+                
+                double threshold;
+                switch (method) {
+                    case LOCAL_THRESH_NIBLACK:
+                        threshold = mean + k * stddev;
+                        break;
+                    case LOCAL_THRESH_SAUVOLA:
+                        threshold = mean * (1.0 + k * (stddev / SAUVOLA_DYNAMIC_RANGE - 1.0));
+                        break;
+                    case LOCAL_THRESH_BRADLEY:
+                        threshold = mean * (1.0 - k);
+                        break;
+                    case LOCAL_THRESH_BOX_MEAN:
+                    default:
+                        threshold = mean - k;
+                        break;
                 }
+                
+                dst[x] = (src[x] > threshold) ? highValue : 0;
             }
-            result.at<uchar>(i, j) = level;
         }
-    }
+    });
     
     // Convert back to color if input was color
     if (wasColor) {
-        cv::cvtColor(result, output, cv::COLOR_GRAY2BGR);
+        cv::cvtColor(binary, output, cv::COLOR_GRAY2BGR);
     } else {
-        output = result;
+        output = binary;
     }
 }
 
@@ -102,8 +325,9 @@ void SegmentationLib::applyMultiLevelThreshold(const cv::Mat& input, cv::Mat& ou
 // WATERSHED SEGMENTATION
 // =============================================================================
 
-void SegmentationLib::createWatershedMarkers(const cv::Mat& input, cv::Mat& markers,
+int SegmentationLib::createWatershedMarkers(const cv::Mat& input, cv::Mat& markers,
                                              double distThreshold) {
+    TRACE_FUNCTION("segmentation");
     // Convert to grayscale
     cv::Mat gray;
     convertToGrayscale(input, gray);
@@ -112,13 +336,15 @@ void SegmentationLib::createWatershedMarkers(const cv::Mat& input, cv::Mat& mark
     cv::Mat binary;
     cv::threshold(gray, binary, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
     
-    // Noise removal with morphology
+    // Noise removal with morphology (the engine picks OpenCV or the
+    // bit-packed path from the window size)
     cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3));
-    cv::morphologyEx(binary, binary, cv::MORPH_OPEN, kernel, cv::Point(-1, -1), 2);
+    MorphologyEngine::morphologyEx(binary, binary, cv::MORPH_OPEN, kernel, 2,
+                                   MorphologyEngine::INPUT_MASK);
     
     // Sure background area
     cv::Mat sureBg;
-    cv::dilate(binary, sureBg, kernel, cv::Point(-1, -1), 3);
+    MorphologyEngine::dilate(binary, sureBg, kernel, 3, MorphologyEngine::INPUT_MASK);
     
     // Distance transform
     cv::Mat distTransform;
@@ -131,29 +357,30 @@ void SegmentationLib::createWatershedMarkers(const cv::Mat& input, cv::Mat& mark
     cv::threshold(distTransform, sureFg, distThreshold * maxDist, 255, cv::THRESH_BINARY);
     sureFg.convertTo(sureFg, CV_8U);
     
-    // Unknown region
-    cv::Mat unknown;
-    cv::subtract(sureBg, sureFg, unknown);
-    
     // Label markers
-    markers = cv::Mat::zeros(sureFg.size(), CV_32S);
-    cv::connectedComponents(sureFg, markers);
-    
-    // Add one to all labels so background is not 0, but 1
-    markers = markers + 1;
-    
-    // Mark unknown region as 0
-    for (int i = 0; i < markers.rows; ++i) {
-        for (int j = 0; j < markers.cols; ++j) {
-            if (unknown.at<uchar>(i, j) == 255) {
-                markers.at<int>(i, j) = 0;
+    cv::Mat labels;
+    const int numLabels = ConnectedComponents::label(sureFg, labels);
+    
+    // Shift labels so background is 1 instead of 0, and mark the unknown
+    // region (sure background but not sure foreground) as 0, in one pass
+    markers.create(labels.size(), CV_32S);
+    cv::parallel_for_(cv::Range(0, labels.rows), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            const int* lab = labels.ptr<int>(i);
+            const uchar* bg = sureBg.ptr<uchar>(i);
+            const uchar* fg = sureFg.ptr<uchar>(i);
+            int* dst = markers.ptr<int>(i);
+            for (int j = 0; j < labels.cols; ++j) {
+                dst[j] = (bg[j] == 255 && fg[j] == 0) ? 0 : lab[j] + 1;
             }
         }
-    }
+    });
+    return numLabels + 1;
 }
 
 void SegmentationLib::applyWatershedAuto(const cv::Mat& input, cv::Mat& output,
                                          double distThreshold) {
+    TRACE_FUNCTION("segmentation");
     if (!isValidImage(input)) {
         output = input.clone();
         return;
@@ -169,26 +396,18 @@ void SegmentationLib::applyWatershedAuto(const cv::Mat& input, cv::Mat& output,
     
     // Create automatic markers
     cv::Mat markers;
-    createWatershedMarkers(colorInput, markers, distThreshold);
+    const int numMarkers = createWatershedMarkers(colorInput, markers, distThreshold);
     
-    // Apply watershed
+    // Apply watershed (regions keep their marker values)
     cv::watershed(colorInput, markers);
     
-    // Colorize result
-    colorizeLabels(markers, output);
-    
-    // Draw boundaries
-    for (int i = 0; i < markers.rows; ++i) {
-        for (int j = 0; j < markers.cols; ++j) {
-            if (markers.at<int>(i, j) == -1) {
-                output.at<cv::Vec3b>(i, j) = cv::Vec3b(0, 0, 255); // Red boundaries
-            }
-        }
-    }
+    // Colorize result with red boundaries
+    colorizeLabels(markers, output, cv::Vec3b(0, 0, 255), numMarkers);
 }
 
 void SegmentationLib::applyWatershedManual(const cv::Mat& input, cv::Mat& markers,
                                            cv::Mat& output) {
+    TRACE_FUNCTION("segmentation");
     if (!isValidImage(input) || markers.empty()) {
         output = input.clone();
         return;
@@ -205,17 +424,8 @@ void SegmentationLib::applyWatershedManual(const cv::Mat& input, cv::Mat& marker
     // Apply watershed
     cv::watershed(colorInput, markers);
     
-    // Colorize result
-    colorizeLabels(markers, output);
-    
-    // Draw boundaries
-    for (int i = 0; i < markers.rows; ++i) {
-        for (int j = 0; j < markers.cols; ++j) {
-            if (markers.at<int>(i, j) == -1) {
-                output.at<cv::Vec3b>(i, j) = cv::Vec3b(0, 0, 255);
-            }
-        }
-    }
+    // Colorize result with red boundaries
+    colorizeLabels(markers, output, cv::Vec3b(0, 0, 255));
 }
 
 // =============================================================================
@@ -224,50 +434,78 @@ void SegmentationLib::applyWatershedManual(const cv::Mat& input, cv::Mat& marker
 
 void SegmentationLib::applyGrabCut(const cv::Mat& input, cv::Mat& output,
                                    const cv::Rect& rect, int iterations) {
+    TRACE_FUNCTION("segmentation");
     if (!isValidImage(input) || input.channels() != 3) {
         output = input.clone();
         return;
     }
     
-    cv::Mat mask = cv::Mat::zeros(input.size(), CV_8U);
-    cv::Mat bgModel, fgModel;
-    
-    try {
-        cv::grabCut(input, mask, rect, bgModel, fgModel, iterations, cv::GC_INIT_WITH_RECT);
-        
-        // Create binary mask (0 or 255) - always as color to match input
-        output = cv::Mat::zeros(input.size(), CV_8UC3);
-        
-        for (int i = 0; i < mask.rows; ++i) {
-            for (int j = 0; j < mask.cols; ++j) {
-                if (mask.at<uchar>(i, j) == cv::GC_FGD || 
-                    mask.at<uchar>(i, j) == cv::GC_PR_FGD) {
-                    // Set all channels to 255 (white foreground)
-                    output.at<cv::Vec3b>(i, j) = cv::Vec3b(255, 255, 255);
-                }
-            }
-        }
-    } catch (const cv::Exception& e) {
+    // Coarse solve plus full-resolution boundary refinement
+    GrabCutSession session;
+    if (!session.initWithRect(input, rect, iterations)) {
         output = cv::Mat::zeros(input.size(), CV_8UC3);
+        return;
     }
+    
+    // Binary mask (0 or 255) - always as color to match input
+    cv::Mat foreground;
+    session.foregroundMask(foreground);
+    cv::cvtColor(foreground, output, cv::COLOR_GRAY2BGR);
 }
 
 void SegmentationLib::applyGrabCutWithMask(const cv::Mat& input, cv::Mat& mask,
-                                           int iterations) {
+                                           int iterations, cv::Mat* bgModel,
+                                           cv::Mat* fgModel) {
+    TRACE_FUNCTION("segmentation");
     if (!isValidImage(input) || input.channels() != 3 || mask.empty()) {
         return;
     }
     
-    cv::Mat bgModel, fgModel;
+    cv::Mat localBg, localFg;
+    cv::Mat& bg = bgModel ? *bgModel : localBg;
+    cv::Mat& fg = fgModel ? *fgModel : localFg;
+    
+    // Models from a previous call are resumed instead of refitted
+    const int mode = (!bg.empty() && !fg.empty()) ? cv::GC_EVAL : cv::GC_INIT_WITH_MASK;
     
     try {
-        cv::grabCut(input, mask, cv::Rect(), bgModel, fgModel, 
-                   iterations, cv::GC_INIT_WITH_MASK);
+        cv::grabCut(input, mask, cv::Rect(), bg, fg, iterations, mode);
     } catch (const cv::Exception& e) {
         // Handle error silently
     }
 }
 
+// =============================================================================
+// CONNECTED COMPONENTS
+// =============================================================================
+
+int SegmentationLib::labelConnectedComponents(const cv::Mat& input, cv::Mat& labels,
+                                              std::vector<ConnectedComponents::ComponentStats>& stats,
+                                              int connectivity) {
+    TRACE_FUNCTION("segmentation");
+    if (input.empty() || (!isValidImage(input) && input.channels() != 4)) {
+        labels = cv::Mat();
+        stats.clear();
+        return 0;
+    }
+    
+    // Foreground is every pixel brighter than 127, whatever the input type
+    cv::Mat gray;
+    if (input.channels() == 4) {
+        cv::cvtColor(input, gray, cv::COLOR_BGRA2GRAY);
+    } else {
+        convertToGrayscale(input, gray);
+    }
+    if (gray.depth() != CV_8U) {
+        gray.convertTo(gray, CV_8U);
+    }
+    
+    cv::Mat binary;
+    cv::threshold(gray, binary, 127, 255, cv::THRESH_BINARY);
+    
+    return ConnectedComponents::labelWithStats(binary, labels, stats, connectivity);
+}
+
 // =============================================================================
 // CONTOUR DETECTION & ANALYSIS
 // =============================================================================
@@ -276,6 +514,7 @@ void SegmentationLib::findAllContours(const cv::Mat& input,
                                       std::vector<std::vector<cv::Point>>& contours,
                                       std::vector<cv::Vec4i>& hierarchy,
                                       int mode, int method) {
+    TRACE_FUNCTION("segmentation");
     if (!isValidImage(input)) {
         contours.clear();
         hierarchy.clear();
@@ -296,6 +535,7 @@ void SegmentationLib::findAllContours(const cv::Mat& input,
 
 SegmentationLib::ContourProperties SegmentationLib::calculateContourProperties(
     const std::vector<cv::Point>& contour) {
+    TRACE_FUNCTION("segmentation");
     
     ContourProperties props;
     props.contour = contour;
@@ -331,12 +571,20 @@ SegmentationLib::ContourProperties SegmentationLib::calculateContourProperties(
 std::vector<SegmentationLib::ContourProperties> 
 SegmentationLib::calculateAllContourProperties(
     const std::vector<std::vector<cv::Point>>& contours) {
-    
-    std::vector<ContourProperties> allProps;
-    allProps.reserve(contours.size());
-    
-    for (const auto& contour : contours) {
-        allProps.push_back(calculateContourProperties(contour));
+    TRACE_FUNCTION("segmentation");
+    
+    ContourTable table;
+    table.build(contours);
+    
+    std::vector<ContourProperties> allProps(table.size());
+    for (size_t i = 0; i < table.size(); ++i) {
+        ContourProperties& props = allProps[i];
+        props.area = table.areas()[i];
+        props.perimeter = table.perimeters()[i];
+        props.centroid = table.centroids()[i];
+        props.boundingBox = table.boundingBoxes()[i];
+        props.circularity = table.circularities()[i];
+        props.contour = contours[i];
     }
     
     return allProps;
@@ -348,26 +596,48 @@ void SegmentationLib::drawContoursWithInfo(cv::Mat& image,
                                            int thickness,
                                            bool drawBoundingBoxes,
                                            bool drawCentroids) {
+    TRACE_FUNCTION("segmentation");
     if (image.empty() || contours.empty()) {
         return;
     }
     
-    // Draw all contours
-    cv::drawContours(image, contours, -1, color, thickness);
+    // Only the columns needed for the overlays
+    int columns = 0;
+    if (drawBoundingBoxes) columns |= ContourTable::BOUNDING_BOX;
+    if (drawCentroids) columns |= ContourTable::CENTROID;
     
-    if (drawBoundingBoxes || drawCentroids) {
-        for (size_t i = 0; i < contours.size(); ++i) {
-            ContourProperties props = calculateContourProperties(contours[i]);
-            
-            // Draw bounding box
-            if (drawBoundingBoxes) {
-                cv::rectangle(image, props.boundingBox, cv::Scalar(255, 0, 0), 2);
-            }
-            
-            // Draw centroid
-            if (drawCentroids) {
-                cv::circle(image, props.centroid, 5, cv::Scalar(0, 255, 255), -1);
-            }
+    ContourTable table;
+    table.build(contours, columns);
+    drawContoursWithInfo(image, table, color, thickness, drawBoundingBoxes, drawCentroids);
+}
+
+void SegmentationLib::drawContoursWithInfo(cv::Mat& image,
+                                           const ContourTable& table,
+                                           const cv::Scalar& color,
+                                           int thickness,
+                                           bool drawBoundingBoxes,
+                                           bool drawCentroids) {
+    TRACE_FUNCTION("segmentation");
+    if (image.empty() || table.empty()) {
+        return;
+    }
+    
+    // Draw the selected contours straight from the original storage
+    for (size_t i = 0; i < table.size(); ++i) {
+        cv::drawContours(image, *table.contours(), table.index(i), color, thickness);
+    }
+    
+    // Draw bounding boxes
+    if (drawBoundingBoxes && (table.columns() & ContourTable::BOUNDING_BOX)) {
+        for (const cv::Rect& box : table.boundingBoxes()) {
+            cv::rectangle(image, box, cv::Scalar(255, 0, 0), 2);
+        }
+    }
+    
+    // Draw centroids
+    if (drawCentroids && (table.columns() & ContourTable::CENTROID)) {
+        for (const cv::Point2f& center : table.centroids()) {
+            cv::circle(image, center, 5, cv::Scalar(0, 255, 255), -1);
         }
     }
 }
@@ -376,13 +646,17 @@ void SegmentationLib::filterContoursByArea(
     const std::vector<std::vector<cv::Point>>& contours,
     std::vector<std::vector<cv::Point>>& filtered,
     double minArea, double maxArea) {
+    TRACE_FUNCTION("segmentation");
     
     filtered.clear();
     
-    for (const auto& contour : contours) {
-        double area = cv::contourArea(contour);
-        if (area >= minArea && (maxArea < 0 || area <= maxArea)) {
-            filtered.push_back(contour);
+    ContourTable table;
+    table.build(contours, ContourTable::AREA);
+    std::vector<uchar> mask = table.maskByArea(minArea, maxArea);
+    
+    for (size_t i = 0; i < mask.size(); ++i) {
+        if (mask[i]) {
+            filtered.push_back(contours[i]);
         }
     }
 }
@@ -391,13 +665,18 @@ void SegmentationLib::filterContoursByCircularity(
     const std::vector<std::vector<cv::Point>>& contours,
     std::vector<std::vector<cv::Point>>& filtered,
     double minCircularity, double maxCircularity) {
+    TRACE_FUNCTION("segmentation");
     
     filtered.clear();
     
-    for (const auto& contour : contours) {
-        ContourProperties props = calculateContourProperties(contour);
-        if (props.circularity >= minCircularity && props.circularity <= maxCircularity) {
-            filtered.push_back(contour);
+    // Moments and bounding boxes are not needed here
+    ContourTable table;
+    table.build(contours, ContourTable::CIRCULARITY);
+    std::vector<uchar> mask = table.maskByCircularity(minCircularity, maxCircularity);
+    
+    for (size_t i = 0; i < mask.size(); ++i) {
+        if (mask[i]) {
+            filtered.push_back(contours[i]);
         }
     }
 }
@@ -407,6 +686,7 @@ void SegmentationLib::filterContoursByCircularity(
 // =============================================================================
 
 void SegmentationLib::convertToGrayscale(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("segmentation");
     if (input.channels() == 3) {
         cv::cvtColor(input, output, cv::COLOR_BGR2GRAY);
     } else {
@@ -418,34 +698,55 @@ bool SegmentationLib::isValidImage(const cv::Mat& image) {
     return !image.empty() && (image.channels() == 1 || image.channels() == 3);
 }
 
-void SegmentationLib::colorizeLabels(const cv::Mat& labels, cv::Mat& output) {
-    if (labels.empty()) {
+void SegmentationLib::colorizeLabels(const cv::Mat& labels, cv::Mat& output,
+                                     const cv::Vec3b& boundaryColor, int labelCount) {
+    TRACE_FUNCTION("segmentation");
+    if (labels.empty() || labels.type() != CV_32S) {
         output = cv::Mat();
         return;
     }
     
-    // Find number of unique labels
-    double minVal, maxVal;
-    cv::minMaxLoc(labels, &minVal, &maxVal);
-    int numLabels = static_cast<int>(maxVal) + 1;
+    // The lock only covers taking the snapshot, not the pass over the pixels
+    PaletteSnapshot palette = acquireLabelPalette(labelCount);
     
-    // Generate random colors for each label
-    std::vector<cv::Vec3b> colors(numLabels);
-    std::mt19937 rng(42); // Fixed seed for reproducibility
-    std::uniform_int_distribution<int> dist(0, 255);
-    
-    colors[0] = cv::Vec3b(0, 0, 0); // Background is black
-    for (int i = 1; i < numLabels; ++i) {
-        colors[i] = cv::Vec3b(dist(rng), dist(rng), dist(rng));
-    }
+    output.create(labels.size(), CV_8UC3);
     
-    // Create output image
-    output = cv::Mat::zeros(labels.size(), CV_8UC3);
-    for (int i = 0; i < labels.rows; ++i) {
-        for (int j = 0; j < labels.cols; ++j) {
-            int label = labels.at<int>(i, j);
-            if (label >= 0 && label < numLabels) {
-                output.at<cv::Vec3b>(i, j) = colors[label];
+    // Rows holding labels beyond the snapshot are redone after it grows
+    std::vector<int> rowOverflow(labels.rows, 0);
+    auto colorizeRows = [&](const cv::Range& range) {
+        const cv::Vec3b* colors = palette->data();
+        const int numColors = static_cast<int>(palette->size());
+        const cv::Vec3b black(0, 0, 0);
+        
+        for (int i = range.start; i < range.end; ++i) {
+            const int* src = labels.ptr<int>(i);
+            cv::Vec3b* dst = output.ptr<cv::Vec3b>(i);
+            int overflow = 0;
+            for (int j = 0; j < labels.cols; ++j) {
+                const int label = src[j];
+                if (static_cast<unsigned>(label) < static_cast<unsigned>(numColors)) {
+                    dst[j] = colors[label];
+                } else if (label == -1) {
+                    dst[j] = boundaryColor;
+                } else if (label >= MAX_PALETTE_SIZE) {
+                    dst[j] = hashedLabelColor(label);
+                } else if (label > 0) {
+                    overflow = std::max(overflow, label);
+                } else {
+                    dst[j] = black;
+                }
+            }
+            rowOverflow[i] = overflow;
+        }
+    };
+    cv::parallel_for_(cv::Range(0, labels.rows), colorizeRows);
+    
+    const int maxLabel = *std::max_element(rowOverflow.begin(), rowOverflow.end());
+    if (maxLabel > 0) {
+        palette = acquireLabelPalette(maxLabel + 1);
+        for (int i = 0; i < labels.rows; ++i) {
+            if (rowOverflow[i] > 0) {
+                colorizeRows(cv::Range(i, i + 1));
             }
         }
     }
@@ -1,6 +1,9 @@
 #ifndef SEGMENTATIONLIB_H
 #define SEGMENTATIONLIB_H
 
+#include "ConnectedComponents.h"
+#include "ContourTable.h"
+#include "IntegralImage.h"
 #include <opencv2/opencv.hpp>
 #include <vector>
 
@@ -12,6 +15,21 @@
  */
 class SegmentationLib {
 public:
+    /**
+     * @brief Largest number of classes accepted by multi-level thresholding
+     */
+    static const int MAX_THRESHOLD_LEVELS = 64;
+
+    /**
+     * @brief Local threshold rules evaluated from integral images
+     */
+    enum LocalThresholdMethod {
+        LOCAL_THRESH_BOX_MEAN,   // T = mean - k
+        LOCAL_THRESH_NIBLACK,    // T = mean + k * stddev
+        LOCAL_THRESH_SAUVOLA,    // T = mean * (1 + k * (stddev / 128 - 1))
+        LOCAL_THRESH_BRADLEY     // T = mean * (1 - k)
+    };
+
     /**
      * @brief Contour properties structure
      */
@@ -47,11 +65,59 @@ public:
      * @brief Apply multi-level thresholding (Otsu with multiple levels)
      * @param input Source grayscale image
      * @param output Segmented image with multiple levels
-     * @param levels Number of threshold levels (2-5)
+     * @param levels Number of threshold levels (2-MAX_THRESHOLD_LEVELS)
      */
     static void applyMultiLevelThreshold(const cv::Mat& input, cv::Mat& output,
                                         int levels = 3);
 
+    /**
+     * @brief Find multi-level Otsu thresholds (maximum between-class variance)
+     *
+     * Solved exactly on the 256-bin histogram by dynamic programming over
+     * prefix sums, so the cost does not depend on the image size.
+     *
+     * @param gray Source grayscale image (CV_8UC1)
+     * @param levels Number of classes (2-MAX_THRESHOLD_LEVELS)
+     * @return levels - 1 ascending thresholds; pixels >= thresholds[k] belong to class k + 1 or above
+     */
+    static std::vector<int> computeMultiOtsuThresholds(const cv::Mat& gray, int levels);
+
+    /**
+     * @brief Apply a local (windowed) threshold in constant time per pixel
+     *
+     * Window mean and standard deviation come from integral images built
+     * for the call, so the cost does not depend on the window size. Windows
+     * are clipped at the image border.
+     *
+     * @param input Source image
+     * @param output Binary output image (pixel > T gives maxValue)
+     * @param method LocalThresholdMethod
+     * @param windowSize Size of the square window (odd, >= 3)
+     * @param k Method parameter (typical: box mean 2, Niblack -0.2, Sauvola 0.2, Bradley 0.15)
+     * @param maxValue Value assigned to pixels above the threshold
+     */
+    static void applyLocalThreshold(const cv::Mat& input, cv::Mat& output,
+                                   int method = LOCAL_THRESH_SAUVOLA,
+                                   int windowSize = 25,
+                                   double k = 0.2,
+                                   double maxValue = 255);
+
+    /**
+     * @brief applyLocalThreshold() with integral images built beforehand
+     *
+     * For callers that threshold the same image repeatedly (e.g. while a
+     * window size is tuned). Tables whose size does not match the input are
+     * rebuilt.
+     *
+     * @param tables Integral images of input (IntegralImage::build)
+     */
+    static void applyLocalThreshold(const cv::Mat& input, const IntegralImage& tables,
+                                   cv::Mat& output,
+                                   int method = LOCAL_THRESH_SAUVOLA,
+                                   int windowSize = 25,
+                                   double k = 0.2,
+                                   double maxValue = 255);
+
     // ==========================================================================
     // WATERSHED SEGMENTATION
     // ==========================================================================
@@ -79,8 +145,9 @@ public:
      * @param input Source image
      * @param markers Output marker image (CV_32S)
      * @param distThreshold Distance threshold (0.0-1.0)
+     * @return Number of marker values (markers lie in 0 .. count - 1)
      */
-    static void createWatershedMarkers(const cv::Mat& input, cv::Mat& markers,
+    static int createWatershedMarkers(const cv::Mat& input, cv::Mat& markers,
                                       double distThreshold = 0.5);
 
     // ==========================================================================
@@ -89,6 +156,9 @@ public:
 
     /**
      * @brief Apply GrabCut segmentation with rectangle initialization
+     *
+     * Large images are solved coarse-to-fine (see GrabCutSession).
+     *
      * @param input Source color image
      * @param output Binary mask (foreground/background)
      * @param rect Rectangle containing foreground object
@@ -99,12 +169,37 @@ public:
 
     /**
      * @brief Apply GrabCut with mask initialization
+     *
+     * For interactive refinement prefer GrabCutSession, which also avoids
+     * full-resolution solves on large images.
+     *
      * @param input Source color image
      * @param mask Input/output mask (CV_8UC1: GC_BGD, GC_FGD, GC_PR_BGD, GC_PR_FGD)
      * @param iterations Number of iterations
+     * @param bgModel Optional background model kept between calls (resumed when non-empty)
+     * @param fgModel Optional foreground model kept between calls (resumed when non-empty)
      */
     static void applyGrabCutWithMask(const cv::Mat& input, cv::Mat& mask,
-                                    int iterations = 5);
+                                    int iterations = 5,
+                                    cv::Mat* bgModel = nullptr,
+                                    cv::Mat* fgModel = nullptr);
+
+    // ==========================================================================
+    // CONNECTED COMPONENTS
+    // ==========================================================================
+
+    /**
+     * @brief Label connected regions and compute area, bounding box, centroid and moments
+     * @param input Source image with 1, 3 or 4 channels (converted to gray
+     *              and thresholded: pixels above 127 are foreground)
+     * @param labels Output label image (CV_32S, 0 = background)
+     * @param stats Output statistics indexed by label
+     * @param connectivity 4 or 8
+     * @return Number of labels, including the background
+     */
+    static int labelConnectedComponents(const cv::Mat& input, cv::Mat& labels,
+                                        std::vector<ConnectedComponents::ComponentStats>& stats,
+                                        int connectivity = 8);
 
     // ==========================================================================
     // CONTOUR DETECTION & ANALYSIS
@@ -156,6 +251,22 @@ public:
                                     bool drawBoundingBoxes = true,
                                     bool drawCentroids = true);
 
+    /**
+     * @brief Draw the contours of a feature table on image
+     * @param image Image to draw on
+     * @param table Contour table (needs BOUNDING_BOX/CENTROID columns for the overlays)
+     * @param color Line color
+     * @param thickness Line thickness (-1 for filled)
+     * @param drawBoundingBoxes Whether to draw bounding boxes
+     * @param drawCentroids Whether to draw centroids
+     */
+    static void drawContoursWithInfo(cv::Mat& image,
+                                    const ContourTable& table,
+                                    const cv::Scalar& color = cv::Scalar(0, 255, 0),
+                                    int thickness = 2,
+                                    bool drawBoundingBoxes = true,
+                                    bool drawCentroids = true);
+
     /**
      * @brief Filter contours by area
      * @param contours Input contours
@@ -200,10 +311,25 @@ public:
 
     /**
      * @brief Colorize segmented image
+     *
+     * Labels are mapped through a persistent palette (the same label always
+     * gets the same color) in a single row-parallel pass. The palette stops
+     * growing at 65536 colors; higher labels get a color hashed from the
+     * label. Watershed boundary pixels (-1) are painted with boundaryColor
+     * in the same pass.
+     *
+     * Pass the label count when it is known (connected components, watershed
+     * markers) so the palette is sized up front. Otherwise rows holding
+     * labels beyond the current palette are redone once it has grown.
+     *
      * @param labels Label image (CV_32S)
      * @param output Colorized output image
+     * @param boundaryColor Color for boundary pixels (label -1)
+     * @param labelCount Labels are below this value (0 = unknown)
      */
-    static void colorizeLabels(const cv::Mat& labels, cv::Mat& output);
+    static void colorizeLabels(const cv::Mat& labels, cv::Mat& output,
+                               const cv::Vec3b& boundaryColor = cv::Vec3b(0, 0, 0),
+                               int labelCount = 0);
 };
 
 #endif // SEGMENTATIONLIB_H
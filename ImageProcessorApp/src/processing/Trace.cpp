@@ -0,0 +1,513 @@
+#include "Trace.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+const size_t Trace::EVENTS_PER_THREAD;
+
+namespace {
+
+// Threads kept after they exit, so short-lived workers still show up in a dump
+const size_t MAX_RETAINED_THREADS = 64;
+
+enum EventType {
+    EVENT_COMPLETE,
+    EVENT_COUNTER,
+    EVENT_INSTANT
+};
+
+struct Event {
+    const char* category;
+    const char* name;
+    int64_t startNs;
+    int64_t durationNs;
+    double value;
+    EventType type;
+};
+
+/**
+ * One thread's ring of events. Only the owning thread writes; the mutex is
+ * uncontended except while another thread exports or clears.
+ */
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<Event> events;
+    size_t next;
+    size_t count;
+    int threadId;
+    std::string threadName;
+
+    explicit ThreadBuffer(int id)
+        : events(Trace::EVENTS_PER_THREAD), next(0), count(0), threadId(id) {}
+
+    void push(const Event& event) {
+        std::lock_guard<std::mutex> lock(mutex);
+        events[next] = event;
+        next = (next + 1) % events.size();
+        count = std::min(count + 1, events.size());
+    }
+};
+
+std::atomic<bool>& enabledFlag() {
+    static std::atomic<bool> enabled(true);
+    return enabled;
+}
+
+std::chrono::steady_clock::time_point origin() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    int nextThreadId = 1;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+ThreadBuffer& localBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+
+        // Forget threads that have exited once too many accumulate
+        if (reg.buffers.size() >= MAX_RETAINED_THREADS) {
+            reg.buffers.erase(std::remove_if(reg.buffers.begin(), reg.buffers.end(),
+                                             [](const std::shared_ptr<ThreadBuffer>& b) {
+                                                 return b.use_count() == 1;
+                                             }),
+                              reg.buffers.end());
+        }
+
+        buffer = std::make_shared<ThreadBuffer>(reg.nextThreadId++);
+        reg.buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void record(const char* category, const char* name, int64_t startNs, int64_t durationNs,
+            double value, EventType type) {
+    Event event;
+    event.category = category;
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = durationNs;
+    event.value = value;
+    event.type = type;
+    localBuffer().push(event);
+}
+
+// Complete events of the calling thread that started at or after startNs
+std::vector<Event> localSpansSince(int64_t startNs) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+
+    std::vector<Event> spans;
+    const size_t capacity = buffer.events.size();
+    // Walk back from the newest event; older events started earlier
+    for (size_t i = 0; i < buffer.count; ++i) {
+        const Event& event = buffer.events[(buffer.next + capacity - 1 - i) % capacity];
+        if (event.type != EVENT_COMPLETE) {
+            continue;
+        }
+        // Events are stored when they end, so a long child may sit behind
+        // shorter spans that started before the operation; stop only at
+        // events that also ended before it
+        if (event.startNs + event.durationNs < startNs) {
+            break;
+        }
+        if (event.startNs >= startNs) {
+            spans.push_back(event);
+        }
+    }
+    return spans;
+}
+
+// Sum the spans that are not nested in another span, per category and name
+std::vector<Trace::StageTiming> summarizeStages(std::vector<Event> spans) {
+    std::sort(spans.begin(), spans.end(), [](const Event& a, const Event& b) {
+        return a.startNs != b.startNs ? a.startNs < b.startNs : a.durationNs > b.durationNs;
+    });
+
+    std::map<std::pair<std::string, std::string>, Trace::StageTiming> byName;
+    int64_t coveredUntil = -1;
+    for (const Event& event : spans) {
+        if (event.startNs < coveredUntil) {
+            continue;   // inside an earlier stage
+        }
+        coveredUntil = event.startNs + event.durationNs;
+
+        const std::string category = event.category ? event.category : "";
+        const std::string name = event.name ? event.name : "";
+        Trace::StageTiming& stage = byName[std::make_pair(category, name)];
+        stage.category = category;
+        stage.name = name;
+        stage.milliseconds += event.durationNs / 1e6;
+        stage.calls++;
+    }
+
+    std::vector<Trace::StageTiming> stages;
+    for (const auto& entry : byName) {
+        stages.push_back(entry.second);
+    }
+    std::sort(stages.begin(), stages.end(),
+              [](const Trace::StageTiming& a, const Trace::StageTiming& b) {
+                  return a.milliseconds > b.milliseconds;
+              });
+    return stages;
+}
+
+std::function<void(const Trace::OperationSummary&)>& operationListener() {
+    static std::function<void(const Trace::OperationSummary&)> listener;
+    return listener;
+}
+
+std::mutex& operationListenerMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// Nesting depth of Trace::Operation on this thread, and its outermost one
+thread_local int operationDepth = 0;
+thread_local Trace::Operation* currentOperation = nullptr;
+
+// Bytes of cv::Mat buffers made by CountingAllocator that are still alive,
+// and the highest value since the last outermost operation started
+std::atomic<size_t> liveBytes(0);
+std::atomic<size_t> peakBytes(0);
+
+void raisePeak(size_t bytes) {
+    size_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (bytes > peak &&
+           !peakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * Default cv::Mat allocator that counts the bytes of live buffers and
+ * leaves the actual allocation to the default allocator it replaced.
+ */
+class CountingAllocator : public cv::MatAllocator {
+public:
+    CountingAllocator() : base(cv::Mat::getDefaultAllocator()) {}
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        cv::UMatData* u = base->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        if (u) {
+            u->currAllocator = this;
+            if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+                raisePeak(liveBytes.fetch_add(u->size, std::memory_order_relaxed) + u->size);
+            }
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags,
+                  cv::UMatUsageFlags usageFlags) const override {
+        return base->allocate(data, accessFlags, usageFlags);
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (u && !(u->flags & cv::UMatData::USER_ALLOCATED)) {
+            liveBytes.fetch_sub(u->size, std::memory_order_relaxed);
+        }
+        base->deallocate(u);
+    }
+
+private:
+    const cv::MatAllocator* base;
+};
+
+void writeEscaped(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text ? text : ""; *c; ++c) {
+        switch (*c) {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(*c) < 0x20) {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", *c);
+                    out << code;
+                } else {
+                    out << *c;
+                }
+        }
+    }
+    out << '"';
+}
+
+void writeMicroseconds(std::ostream& out, int64_t ns) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%lld.%03lld",
+                  static_cast<long long>(ns / 1000), static_cast<long long>(ns % 1000));
+    out << text;
+}
+
+} // namespace
+
+// =============================================================================
+// RECORDING
+// =============================================================================
+
+Trace::Span::Span(const char* category, const char* name)
+    : category(category), name(name), startNs(isEnabled() ? now() : -1) {}
+
+Trace::Span::~Span() {
+    if (startNs >= 0) {
+        record(category, name, startNs, now() - startNs, 0.0, EVENT_COMPLETE);
+    }
+}
+
+Trace::Operation::Operation(const char* category, const char* name)
+    : span(category, name), name(name), startNs(now()), baseBytes(0),
+      outermost(operationDepth++ == 0 && isEnabled()), finished(false) {
+    if (outermost) {
+        baseBytes = liveBytes.load(std::memory_order_relaxed);
+        peakBytes.store(baseBytes, std::memory_order_relaxed);
+        currentOperation = this;
+    }
+}
+
+Trace::Operation::~Operation() {
+    --operationDepth;
+    // Never finished: the operation returned early (error box, cancelled
+    // input dialog) and showed no result
+    cancel();
+}
+
+void Trace::Operation::finish() {
+    if (!outermost || finished) {
+        return;
+    }
+    finished = true;
+    currentOperation = nullptr;
+
+    const int64_t endNs = now();
+    const std::vector<Event> spans = localSpansSince(startNs);
+    if (spans.empty()) {
+        // Nothing ran (error box, cancelled input dialog): nothing to report
+        return;
+    }
+    int64_t firstNs = endNs;
+    for (const Event& event : spans) {
+        firstNs = std::min(firstNs, event.startNs);
+    }
+
+    OperationSummary summary;
+    summary.name = name ? name : "";
+    summary.wallMs = (endNs - firstNs) / 1e6;
+    summary.stages = summarizeStages(spans);
+    const size_t peak = peakBytes.load(std::memory_order_relaxed);
+    summary.peakTemporaryBytes = peak > baseBytes ? peak - baseBytes : 0;
+    summary.threads = std::max(1, cv::getNumThreads());
+
+    std::function<void(const OperationSummary&)> listener;
+    {
+        std::lock_guard<std::mutex> lock(operationListenerMutex());
+        listener = operationListener();
+    }
+    if (listener) {
+        listener(summary);
+    }
+}
+
+void Trace::Operation::restart() {
+    if (!outermost || finished) {
+        return;
+    }
+    startNs = now();
+    baseBytes = liveBytes.load(std::memory_order_relaxed);
+    peakBytes.store(baseBytes, std::memory_order_relaxed);
+}
+
+void Trace::Operation::cancel() {
+    if (!outermost || finished) {
+        return;
+    }
+    finished = true;
+    currentOperation = nullptr;
+}
+
+void Trace::finishOperation() {
+    if (currentOperation) {
+        currentOperation->finish();
+    }
+}
+
+void Trace::restartOperation() {
+    if (currentOperation) {
+        currentOperation->restart();
+    }
+}
+
+void Trace::cancelOperation() {
+    if (currentOperation) {
+        currentOperation->cancel();
+    }
+}
+
+void Trace::setOperationListener(const std::function<void(const OperationSummary&)>& listener) {
+    std::lock_guard<std::mutex> lock(operationListenerMutex());
+    operationListener() = listener;
+}
+
+// =============================================================================
+// MEMORY
+// =============================================================================
+
+void Trace::installAllocationTracking() {
+    // Never destroyed: buffers may outlive static destruction
+    static CountingAllocator* allocator = new CountingAllocator();
+    cv::Mat::setDefaultAllocator(allocator);
+}
+
+size_t Trace::liveAllocationBytes() {
+    return liveBytes.load(std::memory_order_relaxed);
+}
+
+void Trace::counter(const char* category, const char* name, double value) {
+    if (isEnabled()) {
+        record(category, name, now(), 0, value, EVENT_COUNTER);
+    }
+}
+
+void Trace::instant(const char* category, const char* name) {
+    if (isEnabled()) {
+        record(category, name, now(), 0, 0.0, EVENT_INSTANT);
+    }
+}
+
+void Trace::setThreadName(const std::string& threadName) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = threadName;
+}
+
+void Trace::setEnabled(bool enabled) {
+    enabledFlag().store(enabled && isCompiledIn(), std::memory_order_relaxed);
+}
+
+bool Trace::isEnabled() {
+    return IMGPROC_TRACING && enabledFlag().load(std::memory_order_relaxed);
+}
+
+bool Trace::isCompiledIn() {
+    return IMGPROC_TRACING != 0;
+}
+
+int64_t Trace::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - origin()).count();
+}
+
+// =============================================================================
+// EXPORT
+// =============================================================================
+
+void Trace::clear() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const std::shared_ptr<ThreadBuffer>& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->next = 0;
+        buffer->count = 0;
+    }
+}
+
+size_t Trace::eventCount() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    size_t total = 0;
+    for (const std::shared_ptr<ThreadBuffer>& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        total += buffer->count;
+    }
+    return total;
+}
+
+bool Trace::writeChromeTrace(const std::string& path) {
+    // Snapshot every buffer first so recording threads are blocked only briefly
+    struct Snapshot {
+        int threadId;
+        std::string threadName;
+        std::vector<Event> events;
+    };
+    std::vector<Snapshot> snapshots;
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const std::shared_ptr<ThreadBuffer>& buffer : reg.buffers) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            Snapshot snapshot;
+            snapshot.threadId = buffer->threadId;
+            snapshot.threadName = buffer->threadName;
+            snapshot.events.reserve(buffer->count);
+            const size_t capacity = buffer->events.size();
+            const size_t first = (buffer->next + capacity - buffer->count) % capacity;
+            for (size_t i = 0; i < buffer->count; ++i) {
+                snapshot.events.push_back(buffer->events[(first + i) % capacity]);
+            }
+            snapshots.push_back(std::move(snapshot));
+        }
+    }
+
+    std::ofstream out(path.c_str(), std::ios::out | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+           "\"args\":{\"name\":\"ImageProcessorApp\"}}";
+
+    for (const Snapshot& snapshot : snapshots) {
+        if (!snapshot.threadName.empty()) {
+            out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                << snapshot.threadId << ",\"args\":{\"name\":";
+            writeEscaped(out, snapshot.threadName.c_str());
+            out << "}}";
+        }
+
+        for (const Event& event : snapshot.events) {
+            out << ",\n{\"name\":";
+            writeEscaped(out, event.name);
+            out << ",\"cat\":";
+            writeEscaped(out, event.category);
+            out << ",\"pid\":1,\"tid\":" << snapshot.threadId << ",\"ts\":";
+            writeMicroseconds(out, event.startNs);
+
+            switch (event.type) {
+                case EVENT_COMPLETE:
+                    out << ",\"ph\":\"X\",\"dur\":";
+                    writeMicroseconds(out, event.durationNs);
+                    break;
+                case EVENT_COUNTER:
+                    out << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}";
+                    break;
+                case EVENT_INSTANT:
+                    out << ",\"ph\":\"i\",\"s\":\"t\"";
+                    break;
+            }
+            out << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
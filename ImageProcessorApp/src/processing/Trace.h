@@ -0,0 +1,269 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Compile-time switch for the span tracer
+ *
+ * Build with -DIMGPROC_TRACING=0 (CMake: -DENABLE_TRACING=OFF) to compile
+ * every TRACE_* macro to nothing. The Trace API stays available and simply
+ * records nothing.
+ */
+#ifndef IMGPROC_TRACING
+#define IMGPROC_TRACING 1
+#endif
+
+/**
+ * @brief Low-overhead recorder of timed spans for profiling sessions
+ *
+ * Every thread that records gets its own fixed-size ring buffer, so the
+ * recorder keeps the most recent EVENTS_PER_THREAD events of each thread
+ * and never allocates while tracing. A span costs two steady-clock reads
+ * and one uncontended buffer write. Recording is on by default, which
+ * makes the tracer a flight recorder: writeChromeTrace() can be called at
+ * any time and shows what led up to that moment.
+ *
+ * The output is Chrome trace event JSON, readable by chrome://tracing and
+ * https://ui.perfetto.dev.
+ *
+ * Usage:
+ *   void ImageFilters::applyBilateralFilter(...) {
+ *       TRACE_FUNCTION("filters");
+ *       ...
+ *   }
+ *
+ * Span names and categories must be string literals (or otherwise outlive
+ * the recorder), because only the pointers are stored.
+ */
+class Trace {
+public:
+    /**
+     * @brief Ring buffer capacity of each thread
+     */
+    static const size_t EVENTS_PER_THREAD = 16384;
+
+    /**
+     * @brief Records the lifetime of a scope as one complete event
+     */
+    class Span {
+    public:
+        Span(const char* category, const char* name);
+        ~Span();
+
+    private:
+        Span(const Span&);
+        Span& operator=(const Span&);
+
+        const char* category;
+        const char* name;
+        int64_t startNs;   // < 0 when tracing was off at construction
+    };
+
+    // ==========================================================================
+    // OPERATION SUMMARIES
+    // ==========================================================================
+
+    /**
+     * @brief Total time of the spans with one name directly inside an operation
+     */
+    struct StageTiming {
+        std::string category;
+        std::string name;
+        double milliseconds;
+        int calls;
+
+        StageTiming() : milliseconds(0.0), calls(0) {}
+    };
+
+    /**
+     * @brief What one user-level operation cost
+     */
+    struct OperationSummary {
+        std::string name;
+        double wallMs;                     // first stage start to finish
+        std::vector<StageTiming> stages;   // direct child spans, slowest first
+        size_t peakTemporaryBytes;         // cv::Mat memory above the level at start
+        int threads;                       // OpenCV worker threads available
+
+        OperationSummary() : wallMs(0.0), peakTemporaryBytes(0), threads(0) {}
+    };
+
+    /**
+     * @brief Span that also summarizes its direct child spans when finished
+     *
+     * Only the outermost operation of a thread is summarized; nested ones
+     * are recorded as plain spans. The summary goes to the operation
+     * listener on the thread that ran the operation when finishOperation()
+     * is called, i.e. once its result is on screen. An operation whose
+     * scope ends unfinished (it returned after an error box or a cancelled
+     * input dialog) publishes nothing, and neither does one that recorded
+     * no stage.
+     *
+     * Wall time runs from the start of the first stage, so a parameter
+     * dialog shown before any work is not counted.
+     */
+    class Operation {
+    public:
+        Operation(const char* category, const char* name);
+        ~Operation();
+
+        /**
+         * @brief Publish the summary now (later work is not counted)
+         */
+        void finish();
+
+        /**
+         * @brief Count only work from now on (spans and memory so far are dropped)
+         */
+        void restart();
+
+        /**
+         * @brief End the operation without publishing a summary
+         */
+        void cancel();
+
+    private:
+        Operation(const Operation&);
+        Operation& operator=(const Operation&);
+
+        Span span;
+        const char* name;
+        int64_t startNs;
+        size_t baseBytes;
+        bool outermost;
+        bool finished;
+    };
+
+    /**
+     * @brief Finish the outermost operation of the calling thread, if any
+     *
+     * Called once the result is on screen, so that confirmation dialogs
+     * shown afterwards do not count towards the operation.
+     */
+    static void finishOperation();
+
+    /**
+     * @brief Restart the outermost operation of the calling thread, if any
+     *
+     * Called when a modal dialog is accepted, so that previews rendered
+     * while it was open do not count towards the applied result.
+     */
+    static void restartOperation();
+
+    /**
+     * @brief Drop the outermost operation of the calling thread, if any
+     *
+     * Called when a dialog is cancelled; nothing was applied, so nothing
+     * is reported.
+     */
+    static void cancelOperation();
+
+    /**
+     * @brief Receive the summary of every finished outermost operation
+     */
+    static void setOperationListener(const std::function<void(const OperationSummary&)>& listener);
+
+    // ==========================================================================
+    // MEMORY
+    // ==========================================================================
+
+    /**
+     * @brief Count cv::Mat allocations from now on (installs a counting
+     *        default allocator on top of the current one; call once at
+     *        startup, after BufferPool::install() and before images load)
+     */
+    static void installAllocationTracking();
+
+    /**
+     * @brief Bytes of tracked cv::Mat buffers currently alive
+     */
+    static size_t liveAllocationBytes();
+
+    /**
+     * @brief Record a counter value (e.g. undo stack depth)
+     */
+    static void counter(const char* category, const char* name, double value);
+
+    /**
+     * @brief Record a zero-duration marker
+     */
+    static void instant(const char* category, const char* name);
+
+    /**
+     * @brief Name the calling thread in exported traces
+     */
+    static void setThreadName(const std::string& threadName);
+
+    /**
+     * @brief Start or stop recording (spans already open still finish)
+     */
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /**
+     * @brief Whether tracing was compiled in (IMGPROC_TRACING)
+     */
+    static bool isCompiledIn();
+
+    /**
+     * @brief Drop all recorded events
+     */
+    static void clear();
+
+    /**
+     * @brief Number of events currently held by all threads
+     */
+    static size_t eventCount();
+
+    /**
+     * @brief Write all recorded events as Chrome trace JSON
+     * @param path Output file (.json)
+     * @return false if the file cannot be written
+     */
+    static bool writeChromeTrace(const std::string& path);
+
+    /**
+     * @brief Nanoseconds since the recorder's time origin
+     */
+    static int64_t now();
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if IMGPROC_TRACING
+/**
+ * @brief Time the rest of the enclosing scope
+ * @param category Group shown in the trace viewer ("filters", "ui", ...)
+ * @param name Span name (string literal)
+ */
+#define TRACE_SCOPE(category, name) \
+    Trace::Span TRACE_CONCAT(traceSpan, __LINE__)(category, name)
+
+/**
+ * @brief Time the enclosing function, named after it
+ */
+#define TRACE_FUNCTION(category) TRACE_SCOPE(category, __func__)
+
+/**
+ * @brief Time the enclosing function as a user-level operation (summarized
+ *        for the performance display)
+ */
+#define TRACE_OPERATION(category) \
+    Trace::Operation TRACE_CONCAT(traceOperation, __LINE__)(category, __func__)
+
+#define TRACE_COUNTER(category, name, value) Trace::counter(category, name, value)
+#define TRACE_INSTANT(category, name) Trace::instant(category, name)
+#else
+#define TRACE_SCOPE(category, name) ((void)0)
+#define TRACE_FUNCTION(category) ((void)0)
+#define TRACE_OPERATION(category) ((void)0)
+#define TRACE_COUNTER(category, name, value) ((void)0)
+#define TRACE_INSTANT(category, name) ((void)0)
+#endif
+
+#endif // TRACE_H
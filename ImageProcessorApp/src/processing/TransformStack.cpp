@@ -0,0 +1,85 @@
+#include "TransformStack.h"
+#include "TransformationsLib.h"
+#include "Trace.h"
+
+TransformStack::TransformStack() : transform(cv::Matx33d::eye()), pendingCount(0) {
+}
+
+void TransformStack::setSource(const ImageHandle& image) {
+    sourceImage = image;
+    transform = cv::Matx33d::eye();
+    pendingCount = 0;
+}
+
+void TransformStack::clear() {
+    setSource(ImageHandle());
+}
+
+// =============================================================================
+// TRANSFORMS
+// =============================================================================
+
+void TransformStack::translate(double tx, double ty) {
+    append(TransformationsLib::translationMatrix(tx, ty));
+}
+
+void TransformStack::rotate(double angle) {
+    append(TransformationsLib::rotationMatrix(size(), angle));
+}
+
+void TransformStack::skew(double shearX) {
+    append(TransformationsLib::skewMatrix(size(), shearX));
+}
+
+void TransformStack::zoom(double zoomFactor) {
+    append(TransformationsLib::zoomMatrix(size(), zoomFactor));
+}
+
+void TransformStack::flip(int flipCode) {
+    append(TransformationsLib::flipMatrix(size(), flipCode));
+}
+
+void TransformStack::append(const cv::Matx33d& next) {
+    // A quarter turn of a non-square frame changes the canvas: resample what
+    // is pending, turn the pixels exactly and continue from the result.
+    // Turns combined with a translation keep the frame and stay pending.
+    const int turns = TransformationsLib::quarterTurns(next, size());
+    if ((turns == 1 || turns == 3) && !sourceImage.empty() && sourceImage->rows != sourceImage->cols) {
+        cv::Mat base;
+        if (pendingCount > 0) {
+            render(base);
+        } else {
+            base = sourceImage.mat();
+        }
+        cv::Mat turned;
+        TransformationsLib::rotateRightAngle(base, turned, turns);
+        setSource(ImageHandle(turned));
+        return;
+    }
+    
+    // Later transforms act on the result of the earlier ones
+    transform = next * transform;
+    ++pendingCount;
+}
+
+// =============================================================================
+// RESULT
+// =============================================================================
+
+void TransformStack::render(cv::Mat& output, int interpolation) const {
+    TRACE_FUNCTION("transform");
+    if (pendingCount == 0) {
+        output = sourceImage->clone();
+        return;
+    }
+    
+    // Whole-pixel chains (flips, half turns) are copied exactly
+    TransformationsLib::applyTransformMatrix(sourceImage, output, transform, interpolation);
+}
+
+cv::Mat TransformStack::commit(int interpolation) {
+    cv::Mat result;
+    render(result, interpolation);
+    setSource(ImageHandle(result));
+    return result;
+}
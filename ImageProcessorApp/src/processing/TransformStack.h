@@ -0,0 +1,80 @@
+#ifndef TRANSFORMSTACK_H
+#define TRANSFORMSTACK_H
+
+#include "ImageHandle.h"
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Lazy chain of geometric transforms over one source image
+ *
+ * Translations, rotations, skews, zooms and flips are accumulated as a
+ * single 3x3 matrix instead of being applied one after the other, so a
+ * chain such as rotate -> skew -> zoom is resampled once, from the
+ * original pixels, when the result is rendered. Nothing is resampled
+ * until render() or commit() is called.
+ *
+ * All transforms keep the frame size of the source, except quarter turns
+ * of a non-square frame: those are applied right away, exactly, on a
+ * resized canvas, and the chain continues from the turned image.
+ */
+class TransformStack {
+public:
+    TransformStack();
+
+    /**
+     * @brief Start a new chain on an image (drops pending transforms)
+     * @param image Source image (shared, not copied)
+     */
+    void setSource(const ImageHandle& image);
+
+    /**
+     * @brief Drop the source and all pending transforms
+     */
+    void clear();
+
+    // ==========================================================================
+    // TRANSFORMS
+    // ==========================================================================
+
+    void translate(double tx, double ty);
+    void rotate(double angle);
+    void skew(double shearX);
+    void zoom(double zoomFactor);
+    void flip(int flipCode);
+
+    /**
+     * @brief Append an arbitrary source -> destination matrix
+     */
+    void append(const cv::Matx33d& transform);
+
+    // ==========================================================================
+    // RESULT
+    // ==========================================================================
+
+    /**
+     * @brief Resample the source through the accumulated matrix
+     * @param output Result (a copy of the source when nothing is pending)
+     * @param interpolation OpenCV interpolation flag
+     */
+    void render(cv::Mat& output, int interpolation = cv::INTER_LINEAR) const;
+
+    /**
+     * @brief Render, then make the result the new source with no pending transforms
+     * @return The rendered image
+     */
+    cv::Mat commit(int interpolation = cv::INTER_LINEAR);
+
+    bool empty() const { return sourceImage.empty(); }
+    bool hasPending() const { return pendingCount > 0; }
+    int pending() const { return pendingCount; }
+    const ImageHandle& source() const { return sourceImage; }
+    const cv::Matx33d& matrix() const { return transform; }
+    cv::Size size() const { return sourceImage->size(); }
+
+private:
+    ImageHandle sourceImage;
+    cv::Matx33d transform;
+    int pendingCount;
+};
+
+#endif // TRANSFORMSTACK_H
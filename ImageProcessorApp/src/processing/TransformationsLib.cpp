@@ -1,72 +1,399 @@
 #include "TransformationsLib.h"
+#include "Resampler.h"
+#include "WarpPlan.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+// Side of the square tiles used by the right-angle rotation kernel; a tile of
+// source rows stays in cache while its columns are written out
+const int ROTATE_TILE = 32;
+
+// Pixel of N bytes, copied as a single trivially-copyable value
+template <int N>
+struct PixelBytes {
+    uchar bytes[N];
+};
+
+// dst is src turned by 90 degrees (counter-clockwise or clockwise)
+template <typename T>
+void rotateQuarterBlocked(const cv::Mat& src, cv::Mat& dst, bool counterClockwise) {
+    const int srcRows = src.rows;
+    const int srcCols = src.cols;
+    const int dstRows = dst.rows;
+    const int dstCols = dst.cols;
+    const int tileRows = (dstRows + ROTATE_TILE - 1) / ROTATE_TILE;
+    
+    cv::parallel_for_(cv::Range(0, tileRows), [&](const cv::Range& range) {
+        for (int tr = range.start; tr < range.end; ++tr) {
+            const int r0 = tr * ROTATE_TILE;
+            const int r1 = std::min(dstRows, r0 + ROTATE_TILE);
+            for (int c0 = 0; c0 < dstCols; c0 += ROTATE_TILE) {
+                const int c1 = std::min(dstCols, c0 + ROTATE_TILE);
+                for (int r = r0; r < r1; ++r) {
+                    T* d = dst.ptr<T>(r);
+                    if (counterClockwise) {
+                        // dst(r, c) = src(c, srcCols - 1 - r)
+                        const int sx = srcCols - 1 - r;
+                        for (int c = c0; c < c1; ++c) {
+                            d[c] = src.ptr<T>(c)[sx];
+                        }
+                    } else {
+                        // dst(r, c) = src(srcRows - 1 - c, r)
+                        for (int c = c0; c < c1; ++c) {
+                            d[c] = src.ptr<T>(srcRows - 1 - c)[r];
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+bool rotateQuarter(const cv::Mat& src, cv::Mat& dst, bool counterClockwise) {
+    switch (src.elemSize()) {
+        case 1: rotateQuarterBlocked<uchar>(src, dst, counterClockwise); return true;
+        case 2: rotateQuarterBlocked<ushort>(src, dst, counterClockwise); return true;
+        case 3: rotateQuarterBlocked<PixelBytes<3>>(src, dst, counterClockwise); return true;
+        case 4: rotateQuarterBlocked<unsigned int>(src, dst, counterClockwise); return true;
+        case 6: rotateQuarterBlocked<PixelBytes<6>>(src, dst, counterClockwise); return true;
+        case 8: rotateQuarterBlocked<PixelBytes<8>>(src, dst, counterClockwise); return true;
+        case 12: rotateQuarterBlocked<PixelBytes<12>>(src, dst, counterClockwise); return true;
+        case 16: rotateQuarterBlocked<PixelBytes<16>>(src, dst, counterClockwise); return true;
+        default: return false;
+    }
+}
+
+// Number of counter-clockwise quarter turns for an angle, or -1
+int rightAngleTurns(double angle) {
+    const double turns = angle / 90.0;
+    const double rounded = std::round(turns);
+    if (std::abs(turns - rounded) > 1e-9) {
+        return -1;
+    }
+    return ((static_cast<int>(rounded) % 4) + 4) % 4;
+}
+
+bool isUnit(double v) {
+    return v == 1.0 || v == -1.0;
+}
+
+// Exact resampling for matrices that only move whole pixels within the
+// frame (identity, flips, half turn, and quarter turns of square frames)
+bool applyExactTransform(const cv::Mat& input, cv::Mat& output, const cv::Matx33d& m) {
+    if (m(2, 0) != 0 || m(2, 1) != 0 || m(2, 2) != 1) {
+        return false;
+    }
+    
+    const double right = input.cols - 1;
+    const double bottom = input.rows - 1;
+    
+    if (m(0, 1) == 0 && m(1, 0) == 0 && isUnit(m(0, 0)) && isUnit(m(1, 1))) {
+        const bool mirrorX = m(0, 0) < 0;
+        const bool mirrorY = m(1, 1) < 0;
+        if (m(0, 2) != (mirrorX ? right : 0) || m(1, 2) != (mirrorY ? bottom : 0)) {
+            return false;
+        }
+        if (!mirrorX && !mirrorY) {
+            output = input.clone();
+        } else {
+            cv::flip(input, output, mirrorX && mirrorY ? -1 : (mirrorX ? 1 : 0));
+        }
+        return true;
+    }
+    
+    if (input.rows == input.cols && m(0, 0) == 0 && m(1, 1) == 0) {
+        if (m(0, 1) == 1 && m(1, 0) == -1 && m(0, 2) == 0 && m(1, 2) == right) {
+            TransformationsLib::rotateRightAngle(input, output, 1);
+            return true;
+        }
+        if (m(0, 1) == -1 && m(1, 0) == 1 && m(0, 2) == bottom && m(1, 2) == 0) {
+            TransformationsLib::rotateRightAngle(input, output, 3);
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+// Axis-aligned shrink that keeps the whole image inside the frame: the
+// covered rectangle is filtered straight from the source, so zooming out
+// does not alias and needs no full-size intermediate
+bool applyShrinkTransform(const cv::Mat& input, cv::Mat& output, const cv::Matx33d& m) {
+    if (m(0, 1) != 0 || m(1, 0) != 0 || m(2, 0) != 0 || m(2, 1) != 0 || m(2, 2) != 1) {
+        return false;
+    }
+    
+    const double sx = m(0, 0);
+    const double sy = m(1, 1);
+    if (sx <= 0 || sy <= 0 || sx > 1 || sy > 1 || (sx == 1 && sy == 1)) {
+        return false;
+    }
+    
+    // Left/top pixel edge of the source (-0.5) in destination pixel edges
+    const cv::Rect covered(cvRound(m(0, 2) - 0.5 * sx + 0.5),
+                           cvRound(m(1, 2) - 0.5 * sy + 0.5),
+                           std::max(1, cvRound(input.cols * sx)),
+                           std::max(1, cvRound(input.rows * sy)));
+    const cv::Rect frame(0, 0, input.cols, input.rows);
+    if ((covered & frame) != covered) {
+        return false;
+    }
+    
+    // New buffer: output may be the input itself
+    cv::Mat result = cv::Mat::zeros(input.size(), input.type());
+    cv::Mat target = result(covered);
+    Resampler::resize(input, target, covered.size(), Resampler::FILTER_LANCZOS3);
+    output = result;
+    return true;
+}
+
+// Source pixels outside the image that still weigh in at the edges
+// (widest OpenCV kernel, Lanczos-4)
+const int INTERPOLATION_REACH = 4;
+
+// Destination pixels an affine matrix can reach, clipped to the frame
+cv::Rect affineCoverage(const cv::Size& size, const cv::Matx23d& affine) {
+    const double xs[2] = {-INTERPOLATION_REACH, size.width - 1.0 + INTERPOLATION_REACH};
+    const double ys[2] = {-INTERPOLATION_REACH, size.height - 1.0 + INTERPOLATION_REACH};
+    double minX = DBL_MAX, minY = DBL_MAX, maxX = -DBL_MAX, maxY = -DBL_MAX;
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            const double x = affine(0, 0) * xs[i] + affine(0, 1) * ys[j] + affine(0, 2);
+            const double y = affine(1, 0) * xs[i] + affine(1, 1) * ys[j] + affine(1, 2);
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+    }
+    
+    // One pixel of slack for rounding
+    const cv::Rect reach(cvFloor(minX) - 1, cvFloor(minY) - 1,
+                         cvCeil(maxX) - cvFloor(minX) + 3,
+                         cvCeil(maxY) - cvFloor(minY) + 3);
+    return reach & cv::Rect(0, 0, size.width, size.height);
+}
+
+} // namespace
 
 namespace TransformationsLib {
 
 void applyTranslation(const cv::Mat& input, cv::Mat& output, int tx, int ty) {
-    cv::Mat M = (cv::Mat_<float>(2, 3) << 1, 0, tx, 0, 1, ty);
-    cv::warpAffine(input, output, M, input.size());
+    TRACE_FUNCTION("transform");
+    applyTransformMatrix(input, output, translationMatrix(tx, ty));
 }
 
 void applyRotation(const cv::Mat& input, cv::Mat& output, double angle) {
-    cv::Point2f center(input.cols / 2.0f, input.rows / 2.0f);
-    cv::Mat M = cv::getRotationMatrix2D(center, angle, 1.0);
-    cv::warpAffine(input, output, M, input.size());
+    TRACE_FUNCTION("transform");
+    // Right angles are exact pixel moves (the canvas follows the image)
+    const int turns = rightAngleTurns(angle);
+    if (turns >= 0) {
+        rotateRightAngle(input, output, turns);
+        return;
+    }
+    
+    applyTransformMatrix(input, output, rotationMatrix(input.size(), angle));
 }
 
-void applyZoom(const cv::Mat& input, cv::Mat& output, double zoomFactor) {
-    cv::Mat resized;
-    cv::resize(input, resized, cv::Size(), zoomFactor, zoomFactor);
-    
-    // If zoomed out, pad with black
-    if (zoomFactor < 1.0) {
-        output = cv::Mat::zeros(input.size(), input.type());
-        int x_offset = (input.cols - resized.cols) / 2;
-        int y_offset = (input.rows - resized.rows) / 2;
-        
-        cv::Rect roi(x_offset, y_offset, resized.cols, resized.rows);
-        resized.copyTo(output(roi));
+void rotateRightAngle(const cv::Mat& input, cv::Mat& output, int quarterTurns) {
+    TRACE_FUNCTION("transform");
+    quarterTurns = ((quarterTurns % 4) + 4) % 4;
+    
+    if (input.empty() || quarterTurns == 0) {
+        if (output.data != input.data) {
+            output = input.clone();
+        }
+        return;
     }
-    // If zoomed in, crop to original size
-    else if (zoomFactor > 1.0) {
-        int x_offset = (resized.cols - input.cols) / 2;
-        int y_offset = (resized.rows - input.rows) / 2;
-        
-        cv::Rect roi(x_offset, y_offset, input.cols, input.rows);
-        output = resized(roi).clone();
-    } else {
+    
+    if (quarterTurns == 2) {
+        cv::flip(input, output, -1);   // Works in place
+        return;
+    }
+    
+    // A separate buffer is needed even when output aliases input
+    cv::Mat rotated(input.cols, input.rows, input.type());
+    if (!rotateQuarter(input, rotated, quarterTurns == 1)) {
+        cv::rotate(input, rotated, quarterTurns == 1 ? cv::ROTATE_90_COUNTERCLOCKWISE
+                                                     : cv::ROTATE_90_CLOCKWISE);
+    }
+    output = rotated;
+}
+
+void applyZoom(const cv::Mat& input, cv::Mat& output, double zoomFactor) {
+    TRACE_FUNCTION("transform");
+    if (zoomFactor == 1.0) {
         output = input.clone();
+        return;
     }
+    
+    // Zoom about the center. Only destination pixels are computed: zooming
+    // in samples the visible source crop, zooming out filters the covered
+    // rectangle with an antialiasing kernel and leaves a black border
+    applyTransformMatrix(input, output, zoomMatrix(input.size(), zoomFactor));
 }
 
+// cv::flip swaps mirrored pairs, so output may be the input itself
 void applyFlipX(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("transform");
     cv::flip(input, output, 0); // Flip around x-axis
 }
 
 void applyFlipY(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("transform");
     cv::flip(input, output, 1); // Flip around y-axis
 }
 
 void applyFlipXY(const cv::Mat& input, cv::Mat& output) {
+    TRACE_FUNCTION("transform");
     cv::flip(input, output, -1); // Flip both axes
 }
 
 void applySkew(const cv::Mat& input, cv::Mat& output, float shearX) {
-    int rows = input.rows;
-    int cols = input.cols;
+    TRACE_FUNCTION("transform");
+    applyTransformMatrix(input, output, skewMatrix(input.size(), shearX));
+}
+
+// =============================================================================
+// TRANSFORM MATRICES
+// =============================================================================
+
+cv::Matx33d translationMatrix(double tx, double ty) {
+    return cv::Matx33d(1, 0, tx,
+                       0, 1, ty,
+                       0, 0, 1);
+}
+
+cv::Matx33d rotationMatrix(const cv::Size& size, double angle) {
+    // Rotate about the center pixel; right angles get exact coefficients
+    const double cx = (size.width - 1) / 2.0;
+    const double cy = (size.height - 1) / 2.0;
+    double c = std::cos(angle * CV_PI / 180.0);
+    double s = std::sin(angle * CV_PI / 180.0);
+    const int turns = rightAngleTurns(angle);
+    if (turns >= 0) {
+        const double cosines[4] = {1, 0, -1, 0};
+        const double sines[4] = {0, 1, 0, -1};
+        c = cosines[turns];
+        s = sines[turns];
+    }
+    return cv::Matx33d(c, s, (1 - c) * cx - s * cy,
+                       -s, c, s * cx + (1 - c) * cy,
+                       0, 0, 1);
+}
+
+cv::Matx33d zoomMatrix(const cv::Size& size, double zoomFactor) {
+    // Pixel centers scale about the middle of the frame (as resize + center crop/pad)
+    const double cx = (size.width - 1) / 2.0;
+    const double cy = (size.height - 1) / 2.0;
+    return cv::Matx33d(zoomFactor, 0, cx * (1 - zoomFactor),
+                       0, zoomFactor, cy * (1 - zoomFactor),
+                       0, 0, 1);
+}
+
+cv::Matx33d skewMatrix(const cv::Size& size, double shearX) {
+    const double rows = std::max(1, size.height - 1);
+    return cv::Matx33d(1, shearX / rows, 0,
+                       0, 1, 0,
+                       0, 0, 1);
+}
+
+cv::Matx33d flipMatrix(const cv::Size& size, int flipCode) {
+    const bool aroundY = flipCode != 0;   // Mirror columns
+    const bool aroundX = flipCode <= 0;   // Mirror rows
+    return cv::Matx33d(aroundY ? -1 : 1, 0, aroundY ? size.width - 1 : 0,
+                       0, aroundX ? -1 : 1, aroundX ? size.height - 1 : 0,
+                       0, 0, 1);
+}
+
+int quarterTurns(const cv::Matx33d& transform, const cv::Size& size) {
+    if (transform(2, 0) != 0 || transform(2, 1) != 0 || transform(2, 2) != 1 ||
+        transform(0, 0) != transform(1, 1) || transform(0, 1) != -transform(1, 0)) {
+        return -1;
+    }
     
-    cv::Point2f srcTri[3];
-    cv::Point2f dstTri[3];
+    const double c = transform(0, 0);
+    const double s = transform(0, 1);
+    int turns = -1;
+    if (c == 1 && s == 0) turns = 0;
+    else if (c == 0 && s == 1) turns = 1;
+    else if (c == -1 && s == 0) turns = 2;
+    else if (c == 0 && s == -1) turns = 3;
+    if (turns < 0) {
+        return -1;
+    }
     
-    srcTri[0] = cv::Point2f(0, 0);
-    srcTri[1] = cv::Point2f(cols - 1, 0);
-    srcTri[2] = cv::Point2f(0, rows - 1);
+    // Any other translation moves the turned pixels elsewhere in the frame
+    const cv::Matx33d centered = rotationMatrix(size, turns * 90.0);
+    if (transform(0, 2) != centered(0, 2) || transform(1, 2) != centered(1, 2)) {
+        return -1;
+    }
+    return turns;
+}
+
+void applyTransformMatrix(const cv::Mat& input, cv::Mat& output,
+                          const cv::Matx33d& transform, int interpolation) {
+    TRACE_FUNCTION("transform");
+    if (input.empty()) {
+        output = cv::Mat();
+        return;
+    }
     
-    dstTri[0] = cv::Point2f(0, 0);
-    dstTri[1] = cv::Point2f(cols - 1, 0);
-    dstTri[2] = cv::Point2f(shearX, rows - 1);
+    if (applyExactTransform(input, output, transform)) {
+        return;
+    }
+    
+    if (interpolation != cv::INTER_NEAREST && applyShrinkTransform(input, output, transform)) {
+        return;
+    }
+    
+    if (transform(2, 0) == 0 && transform(2, 1) == 0 && transform(2, 2) == 1) {
+        cv::Matx23d affine(transform(0, 0), transform(0, 1), transform(0, 2),
+                           transform(1, 0), transform(1, 1), transform(1, 2));
+        
+        // Only resample the part of the frame the image lands on
+        const cv::Rect reach = affineCoverage(input.size(), affine);
+        if (reach.area() == input.size().area()) {
+            cv::warpAffine(input, output, affine, input.size(), interpolation);
+            return;
+        }
+        
+        cv::Mat result = cv::Mat::zeros(input.size(), input.type());
+        if (reach.area() > 0) {
+            affine(0, 2) -= reach.x;
+            affine(1, 2) -= reach.y;
+            cv::Mat target = result(reach);
+            cv::warpAffine(input, target, affine, reach.size(), interpolation);
+        }
+        output = result;
+    } else {
+        cv::warpPerspective(input, output, transform, input.size(), interpolation);
+    }
+}
+
+void applyCachedTransform(const cv::Mat& input, cv::Mat& output,
+                          const cv::Matx33d& transform, int interpolation) {
+    TRACE_FUNCTION("transform");
+    if (input.empty()) {
+        output = cv::Mat();
+        return;
+    }
+    
+    if (applyExactTransform(input, output, transform)) {
+        return;
+    }
+    
+    // Fixed-point tables cannot address frames this large
+    if (!WarpPlan::supports(input.size())) {
+        applyTransformMatrix(input, output, transform, interpolation);
+        return;
+    }
     
-    cv::Mat warpMat = cv::getAffineTransform(srcTri, dstTri);
-    cv::warpAffine(input, output, warpMat, input.size());
+    WarpPlan::acquireTransform(input.size(), transform, interpolation)->apply(input, output);
 }
 
 } // namespace TransformationsLib
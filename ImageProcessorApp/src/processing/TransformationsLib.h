@@ -16,14 +16,35 @@ void applyTranslation(const cv::Mat& input, cv::Mat& output, int tx, int ty);
 
 /**
  * @brief Apply rotation transformation
+ *
+ * Multiples of 90 degrees are exact (see rotateRightAngle) and resize the
+ * canvas; other angles keep the frame size (see applyTransformMatrix).
+ * To rotate many frames by the same angle, use applyCachedTransform.
+ *
  * @param input Input image
  * @param output Output transformed image
- * @param angle Rotation angle in degrees
+ * @param angle Rotation angle in degrees (positive = counter-clockwise)
  */
 void applyRotation(const cv::Mat& input, cv::Mat& output, double angle);
 
 /**
- * @brief Apply zoom/scaling transformation
+ * @brief Rotate by a multiple of 90 degrees without resampling
+ *
+ * Quarter turns use a cache-blocked, parallel transpose kernel; the half
+ * turn is a flip of both axes. The canvas is resized for quarter turns.
+ *
+ * @param input Input image
+ * @param output Output rotated image (may be the input)
+ * @param quarterTurns Number of counter-clockwise quarter turns (any integer)
+ */
+void rotateRightAngle(const cv::Mat& input, cv::Mat& output, int quarterTurns);
+
+/**
+ * @brief Apply zoom/scaling transformation about the image center
+ *
+ * Computes the destination frame directly from source coordinates, so deep
+ * zoom levels never build an enlarged intermediate image.
+ *
  * @param input Input image
  * @param output Output transformed image
  * @param zoomFactor Zoom factor (1.0 = no change, >1.0 = zoom in, <1.0 = zoom out)
@@ -59,6 +80,96 @@ void applyFlipXY(const cv::Mat& input, cv::Mat& output);
  */
 void applySkew(const cv::Mat& input, cv::Mat& output, float shearX = 100.0f);
 
+// =============================================================================
+// TRANSFORM MATRICES
+// =============================================================================
+// 3x3 matrices mapping source pixel coordinates to destination pixel
+// coordinates for a frame of the given size. They compose by multiplication
+// (later operations on the left) and are applied with applyTransformMatrix().
+
+/**
+ * @brief Translation matrix
+ * @param tx Translation in X direction (pixels)
+ * @param ty Translation in Y direction (pixels)
+ */
+cv::Matx33d translationMatrix(double tx, double ty);
+
+/**
+ * @brief Rotation matrix about the frame center
+ * @param size Frame size
+ * @param angle Rotation angle in degrees (positive = counter-clockwise)
+ */
+cv::Matx33d rotationMatrix(const cv::Size& size, double angle);
+
+/**
+ * @brief Zoom matrix about the frame center
+ * @param size Frame size
+ * @param zoomFactor Zoom factor (1.0 = no change, >1.0 = zoom in, <1.0 = zoom out)
+ */
+cv::Matx33d zoomMatrix(const cv::Size& size, double zoomFactor);
+
+/**
+ * @brief Horizontal shear matrix (top row fixed, bottom row moved by shearX)
+ * @param size Frame size
+ * @param shearX Horizontal shear amount at the bottom row (pixels)
+ */
+cv::Matx33d skewMatrix(const cv::Size& size, double shearX);
+
+/**
+ * @brief Flip matrix
+ * @param size Frame size
+ * @param flipCode Same as cv::flip (0 = around x-axis, 1 = around y-axis, -1 = both)
+ */
+cv::Matx33d flipMatrix(const cv::Size& size, int flipCode);
+
+/**
+ * @brief Counter-clockwise quarter turns performed by a transform matrix
+ * @param transform Transform to classify
+ * @param size Frame size the transform applies to
+ * @return 0-3 if the transform is an exact right-angle rotation about the
+ *         frame center (as rotationMatrix builds it), -1 otherwise
+ */
+int quarterTurns(const cv::Matx33d& transform, const cv::Size& size);
+
+/**
+ * @brief Resample an image through a transform matrix
+ *
+ * Matrices that only move whole pixels (identity, flips, half turn,
+ * quarter turns of square frames) are applied exactly without
+ * interpolation. Axis-aligned shrinks that stay inside the frame go
+ * through the antialiased Resampler (Lanczos-3), and affine maps only
+ * resample the part of the frame the image lands on.
+ *
+ * @param input Input image
+ * @param output Output image (same size as input, uncovered pixels are black)
+ * @param transform Source -> destination matrix (affine or perspective)
+ * @param interpolation OpenCV interpolation flag
+ */
+void applyTransformMatrix(const cv::Mat& input, cv::Mat& output,
+                          const cv::Matx33d& transform,
+                          int interpolation = cv::INTER_LINEAR);
+
+/**
+ * @brief Resample an image through a cached warp plan
+ *
+ * For the same transform applied to many frames of one size: the remap
+ * tables are computed on the first call and shared through the WarpPlan
+ * cache, so later frames only pay for the gather. Whole-pixel matrices
+ * are still applied exactly.
+ *
+ * A plan holds 6 bytes per pixel, which only pays off when it is reused;
+ * single images should go through applyTransformMatrix. Frames the tables
+ * cannot address (see WarpPlan::supports) fall back to it as well.
+ *
+ * @param input Input image
+ * @param output Output image (same size as input, uncovered pixels are black)
+ * @param transform Source -> destination matrix (affine or perspective)
+ * @param interpolation OpenCV interpolation flag (not INTER_AREA)
+ */
+void applyCachedTransform(const cv::Mat& input, cv::Mat& output,
+                          const cv::Matx33d& transform,
+                          int interpolation = cv::INTER_LINEAR);
+
 } // namespace TransformationsLib
 
 #endif // TRANSFORMATIONSLIB_H
@@ -0,0 +1,228 @@
+#include "WarpPlan.h"
+#include "Trace.h"
+#include <climits>
+#include <list>
+#include <map>
+#include <mutex>
+#include <utility>
+
+const size_t WarpPlan::DEFAULT_CACHE_BUDGET;
+
+namespace {
+
+enum PlanKind {
+    PLAN_TRANSFORM,
+    PLAN_UNDISTORT
+};
+
+// Everything that determines the tables of a plan
+struct PlanKey {
+    int kind;
+    int width;
+    int height;
+    int interpolation;
+    std::vector<double> parameters;
+
+    bool operator<(const PlanKey& other) const {
+        if (kind != other.kind) return kind < other.kind;
+        if (width != other.width) return width < other.width;
+        if (height != other.height) return height < other.height;
+        if (interpolation != other.interpolation) return interpolation < other.interpolation;
+        return parameters < other.parameters;
+    }
+};
+
+typedef std::pair<PlanKey, std::shared_ptr<const WarpPlan>> CacheEntry;
+
+// Most recently used plan first
+struct PlanCache {
+    std::list<CacheEntry> entries;
+    std::map<PlanKey, std::list<CacheEntry>::iterator> index;
+    size_t bytes = 0;
+    size_t budget = WarpPlan::DEFAULT_CACHE_BUDGET;
+};
+
+std::mutex& cacheMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+PlanCache& cache() {
+    static PlanCache plans;
+    return plans;
+}
+
+// Drop least recently used plans until the tables fit the budget
+// (the most recent plan always stays)
+void evict(PlanCache& plans) {
+    while (plans.bytes > plans.budget && plans.entries.size() > 1) {
+        const CacheEntry& oldest = plans.entries.back();
+        plans.bytes -= oldest.second->bytes();
+        plans.index.erase(oldest.first);
+        plans.entries.pop_back();
+    }
+}
+
+template <typename Build>
+std::shared_ptr<const WarpPlan> acquire(const PlanKey& key, Build build) {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        PlanCache& plans = cache();
+        auto found = plans.index.find(key);
+        if (found != plans.index.end()) {
+            plans.entries.splice(plans.entries.begin(), plans.entries, found->second);
+            return found->second->second;
+        }
+    }
+
+    // Built outside the lock; a concurrent miss on the same key builds twice
+    std::shared_ptr<WarpPlan> plan = std::make_shared<WarpPlan>();
+    build(*plan);
+
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    PlanCache& plans = cache();
+    auto found = plans.index.find(key);
+    if (found != plans.index.end()) {
+        plans.entries.splice(plans.entries.begin(), plans.entries, found->second);
+        return found->second->second;
+    }
+
+    plans.entries.push_front(CacheEntry(key, plan));
+    plans.index[key] = plans.entries.begin();
+    plans.bytes += plan->bytes();
+    evict(plans);
+    return plan;
+}
+
+std::vector<double> matrixParameters(const cv::Matx33d& m) {
+    return std::vector<double>(m.val, m.val + 9);
+}
+
+} // namespace
+
+WarpPlan::WarpPlan() : interpolation(cv::INTER_LINEAR) {
+}
+
+void WarpPlan::buildTransform(const cv::Size& size, const cv::Matx33d& transform,
+                              int interpolationFlag) {
+    TRACE_FUNCTION("resample");
+    frameSize = size;
+    interpolation = interpolationFlag;
+    positions.release();
+    fractions.release();
+    if (size.width <= 0 || size.height <= 0 || !supports(size)) {
+        return;
+    }
+
+    // Destination -> source, evaluated for every destination pixel once
+    const cv::Matx33d inverse = transform.inv();
+    const bool affine = transform(2, 0) == 0 && transform(2, 1) == 0 && transform(2, 2) == 1;
+    cv::Mat coordinates(size, CV_32FC2);
+
+    cv::parallel_for_(cv::Range(0, size.height), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            cv::Vec2f* row = coordinates.ptr<cv::Vec2f>(y);
+            double sx = inverse(0, 1) * y + inverse(0, 2);
+            double sy = inverse(1, 1) * y + inverse(1, 2);
+            double sw = inverse(2, 1) * y + inverse(2, 2);
+            for (int x = 0; x < size.width; ++x) {
+                if (affine) {
+                    row[x] = cv::Vec2f(static_cast<float>(sx), static_cast<float>(sy));
+                } else if (sw != 0) {
+                    row[x] = cv::Vec2f(static_cast<float>(sx / sw), static_cast<float>(sy / sw));
+                } else {
+                    // Maps to infinity: outside the source
+                    row[x] = cv::Vec2f(-1.0f, -1.0f);
+                }
+                sx += inverse(0, 0);
+                sy += inverse(1, 0);
+                sw += inverse(2, 0);
+            }
+        }
+    });
+
+    cv::convertMaps(coordinates, cv::noArray(), positions, fractions, CV_16SC2,
+                    interpolation == cv::INTER_NEAREST);
+}
+
+void WarpPlan::buildUndistort(const cv::Size& size, const cv::Matx33d& cameraMatrix,
+                              const std::vector<double>& distCoeffs, int interpolationFlag) {
+    TRACE_FUNCTION("resample");
+    frameSize = size;
+    interpolation = interpolationFlag;
+    positions.release();
+    fractions.release();
+    if (size.width <= 0 || size.height <= 0 || !supports(size)) {
+        return;
+    }
+
+    cv::initUndistortRectifyMap(cameraMatrix, distCoeffs, cv::noArray(), cameraMatrix,
+                                size, CV_16SC2, positions, fractions);
+    if (interpolation == cv::INTER_NEAREST) {
+        fractions.release();
+    }
+}
+
+bool WarpPlan::apply(const cv::Mat& input, cv::Mat& output) const {
+    TRACE_FUNCTION("resample");
+    if (input.empty() || positions.empty() || input.size() != frameSize) {
+        output = input.clone();
+        return false;
+    }
+
+    // remap cannot work in place
+    cv::Mat result;
+    cv::remap(input, result, positions, fractions, interpolation,
+              cv::BORDER_CONSTANT, cv::Scalar::all(0));
+    output = result;
+    return true;
+}
+
+bool WarpPlan::supports(const cv::Size& size) {
+    return size.width < SHRT_MAX && size.height < SHRT_MAX;
+}
+
+size_t WarpPlan::bytes() const {
+    return positions.total() * positions.elemSize() + fractions.total() * fractions.elemSize();
+}
+
+// =============================================================================
+// SHARED PLANS
+// =============================================================================
+
+std::shared_ptr<const WarpPlan> WarpPlan::acquireTransform(const cv::Size& size,
+                                                           const cv::Matx33d& transform,
+                                                           int interpolation) {
+    const PlanKey key = {PLAN_TRANSFORM, size.width, size.height, interpolation,
+                         matrixParameters(transform)};
+    return acquire(key, [&](WarpPlan& plan) {
+        plan.buildTransform(size, transform, interpolation);
+    });
+}
+
+std::shared_ptr<const WarpPlan> WarpPlan::acquireUndistort(const cv::Size& size,
+                                                           const cv::Matx33d& cameraMatrix,
+                                                           const std::vector<double>& distCoeffs,
+                                                           int interpolation) {
+    std::vector<double> parameters = matrixParameters(cameraMatrix);
+    parameters.insert(parameters.end(), distCoeffs.begin(), distCoeffs.end());
+
+    const PlanKey key = {PLAN_UNDISTORT, size.width, size.height, interpolation, parameters};
+    return acquire(key, [&](WarpPlan& plan) {
+        plan.buildUndistort(size, cameraMatrix, distCoeffs, interpolation);
+    });
+}
+
+void WarpPlan::setCacheBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    cache().budget = bytes;
+    evict(cache());
+}
+
+void WarpPlan::clearCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    PlanCache& plans = cache();
+    plans.entries.clear();
+    plans.index.clear();
+    plans.bytes = 0;
+}
@@ -0,0 +1,111 @@
+#ifndef WARPPLAN_H
+#define WARPPLAN_H
+
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Precomputed remap tables for one geometric warp of one frame size
+ *
+ * warpAffine and warpPerspective work out the source coordinate of every
+ * destination pixel on each call. A plan does that once and stores the
+ * result as fixed-point tables (cv::convertMaps format: CV_16SC2 integer
+ * positions plus CV_16UC1 interpolation-table indices), so applying it to
+ * another frame of the same size only costs the gather.
+ *
+ * The acquire functions share plans through a least-recently-used cache
+ * bounded by table memory, so a batch of frames from one camera pays for
+ * the tables once whether it is rotated, sheared, perspective-corrected or
+ * lens-corrected.
+ */
+class WarpPlan {
+public:
+    /**
+     * @brief Default memory budget of the shared cache (bytes)
+     */
+    static const size_t DEFAULT_CACHE_BUDGET = 256 * 1024 * 1024;
+
+    WarpPlan();
+
+    /**
+     * @brief Build the tables for a transform matrix
+     * @param size Frame size (input and output)
+     * @param transform Source -> destination matrix (affine or perspective)
+     * @param interpolation OpenCV interpolation flag (not INTER_AREA)
+     */
+    void buildTransform(const cv::Size& size, const cv::Matx33d& transform,
+                        int interpolation = cv::INTER_LINEAR);
+
+    /**
+     * @brief Build the tables that remove lens distortion
+     * @param size Frame size (input and output)
+     * @param cameraMatrix Camera intrinsics (kept for the corrected frame)
+     * @param distCoeffs Distortion coefficients (k1, k2, p1, p2[, k3, ...])
+     * @param interpolation OpenCV interpolation flag (not INTER_AREA)
+     */
+    void buildUndistort(const cv::Size& size, const cv::Matx33d& cameraMatrix,
+                        const std::vector<double>& distCoeffs,
+                        int interpolation = cv::INTER_LINEAR);
+
+    /**
+     * @brief Warp a frame
+     * @param input Frame of the plan's size
+     * @param output Warped frame (may be the input; uncovered pixels are black)
+     * @return false (and a copy of the input) if the frame size does not match
+     */
+    bool apply(const cv::Mat& input, cv::Mat& output) const;
+
+    /**
+     * @brief Whether the fixed-point tables can address a frame of this size
+     *
+     * cv::remap needs both sides below 32767 pixels; larger frames get an
+     * empty plan.
+     */
+    static bool supports(const cv::Size& size);
+
+    // ==========================================================================
+    // SHARED PLANS
+    // ==========================================================================
+
+    /**
+     * @brief Plan for a transform matrix, reusing a cached one when possible
+     */
+    static std::shared_ptr<const WarpPlan> acquireTransform(const cv::Size& size,
+                                                            const cv::Matx33d& transform,
+                                                            int interpolation = cv::INTER_LINEAR);
+
+    /**
+     * @brief Plan for lens correction, reusing a cached one when possible
+     */
+    static std::shared_ptr<const WarpPlan> acquireUndistort(const cv::Size& size,
+                                                            const cv::Matx33d& cameraMatrix,
+                                                            const std::vector<double>& distCoeffs,
+                                                            int interpolation = cv::INTER_LINEAR);
+
+    /**
+     * @brief Limit the memory of the cached tables (evicts as needed)
+     */
+    static void setCacheBudget(size_t bytes);
+
+    /**
+     * @brief Drop all cached plans
+     */
+    static void clearCache();
+
+    // ==========================================================================
+    // ACCESS
+    // ==========================================================================
+
+    bool empty() const { return positions.empty(); }
+    cv::Size size() const { return frameSize; }
+    size_t bytes() const;
+
+private:
+    cv::Mat positions; // CV_16SC2 integer source positions
+    cv::Mat fractions; // CV_16UC1 sub-pixel table indices (empty for nearest)
+    cv::Size frameSize;
+    int interpolation;
+};
+
+#endif // WARPPLAN_H
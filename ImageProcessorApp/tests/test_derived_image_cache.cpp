@@ -0,0 +1,88 @@
+#include "DerivedImageCache.h"
+#include "ImageProcessingLib.h"
+#include <QtTest>
+
+/**
+ * @brief DerivedImageCache keys by handle version; the libraries stay pure
+ */
+class TestDerivedImageCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init() {
+        DerivedImageCache::setCacheBudget(DerivedImageCache::DEFAULT_CACHE_BUDGET);
+        DerivedImageCache::clearCache();
+    }
+
+    void formIsSharedBetweenCopiesOfAHandle() {
+        ImageHandle a(colorImage(1));
+        ImageHandle b = a;
+        cv::Mat first = DerivedImageCache::gray(a);
+        cv::Mat second = DerivedImageCache::gray(b);
+        QVERIFY(first.data == second.data);
+
+        cv::Mat expected;
+        cv::cvtColor(a.mat(), expected, cv::COLOR_BGR2GRAY);
+        QCOMPARE(cv::norm(first, expected, cv::NORM_INF), 0.0);
+    }
+
+    void editedHandleGetsFreshForms() {
+        ImageHandle image(colorImage(1));
+        cv::Mat before = DerivedImageCache::gray(image).clone();
+
+        // The cache holds the handle, so the edit copies and re-versions
+        image.edit().setTo(cv::Scalar::all(200));
+        cv::Mat after = DerivedImageCache::gray(image);
+
+        QVERIFY(cv::norm(before, after, cv::NORM_INF) > 0.0);
+        QCOMPARE(after.at<uchar>(0, 0), uchar(200));
+    }
+
+    void libraryResultFollowsInPlaceRewrites() {
+        cv::Mat frame = colorImage(1);
+        cv::Mat first, second, expected;
+        ImageProcessingLib::applyBinaryThreshold(frame, first, 128);
+
+        frame.setTo(cv::Scalar::all(255));     // same buffer, new content
+        ImageProcessingLib::applyBinaryThreshold(frame, second, 128);
+
+        expected = cv::Mat(frame.size(), CV_8UC1, cv::Scalar(255));
+        QCOMPARE(cv::norm(second, expected, cv::NORM_INF), 0.0);
+    }
+
+    void budgetCountsSourceImages() {
+        ImageHandle a(colorImage(1));
+        DerivedImageCache::contentHash(a);
+        const size_t sourceBytes = a->total() * a->elemSize();
+        QVERIFY(DerivedImageCache::cacheBytes() == sourceBytes);
+
+        DerivedImageCache::gray(a);
+        QVERIFY(DerivedImageCache::cacheBytes() == sourceBytes + a->total());
+
+        // Over budget: only the most recent image stays
+        DerivedImageCache::setCacheBudget(sourceBytes);
+        ImageHandle b(colorImage(2));
+        DerivedImageCache::contentHash(b);
+        QVERIFY(DerivedImageCache::cacheBytes() == sourceBytes);
+        QCOMPARE(a.useCount(), 1L);
+    }
+
+    void contentHashMatchesAcrossCopies() {
+        ImageHandle a(colorImage(1));
+        ImageHandle copy = ImageHandle::copyOf(a.mat());
+        ImageHandle other(colorImage(2));
+        QVERIFY(DerivedImageCache::contentHash(a) == DerivedImageCache::contentHash(copy));
+        QVERIFY(DerivedImageCache::contentHash(a) != DerivedImageCache::contentHash(other));
+    }
+
+private:
+    static cv::Mat colorImage(int seed) {
+        cv::Mat image(48, 64, CV_8UC3);
+        cv::RNG rng(seed);
+        rng.fill(image, cv::RNG::UNIFORM, 0, 256);
+        return image;
+    }
+};
+
+QTEST_APPLESS_MAIN(TestDerivedImageCache)
+#include "test_derived_image_cache.moc"
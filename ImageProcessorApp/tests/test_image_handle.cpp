@@ -0,0 +1,140 @@
+#include "ImageHandle.h"
+#include <QtTest>
+
+/**
+ * @brief ImageHandle sharing, output() and copy-on-write edit()
+ */
+class TestImageHandle : public QObject {
+    Q_OBJECT
+
+private slots:
+    void emptyHandle() {
+        ImageHandle handle;
+        QVERIFY(handle.empty());
+        QVERIFY(handle.mat().empty());
+        QCOMPARE(handle.useCount(), 0L);
+        QVERIFY(!handle.sharesWith(ImageHandle()));
+    }
+
+    void copiesSharePixels() {
+        ImageHandle a(cv::Mat(4, 4, CV_8UC1, cv::Scalar(7)));
+        ImageHandle b = a;
+        QVERIFY(a.sharesWith(b));
+        QCOMPARE(a.useCount(), 2L);
+        QVERIFY(a->data == b->data);
+    }
+
+    void copyOfDoesNotShareTheSource() {
+        cv::Mat buffer(4, 4, CV_8UC1, cv::Scalar(7));
+        ImageHandle handle = ImageHandle::copyOf(buffer);
+        buffer.setTo(1);
+        QCOMPARE(handle->at<uchar>(0, 0), uchar(7));
+    }
+
+    void outputLeavesOtherHandlesAlone() {
+        ImageHandle source(cv::Mat(4, 4, CV_8UC1, cv::Scalar(7)));
+        ImageHandle result = source;
+
+        cv::Mat& out = result.output();
+        QVERIFY(out.empty());
+        QVERIFY(!result.sharesWith(source));
+        cv::add(source.mat(), cv::Scalar(1), out);
+
+        QCOMPARE(source->at<uchar>(0, 0), uchar(7));
+        QCOMPARE(result->at<uchar>(0, 0), uchar(8));
+        QCOMPARE(source.useCount(), 1L);
+    }
+
+    void outputOfSoleHolderKeepsReadViewsOfHeldCopies() {
+        // The slots' pattern: hold the input, then write a new result
+        ImageHandle processed(cv::Mat(4, 4, CV_8UC1, cv::Scalar(7)));
+        ImageHandle input = processed;
+        cv::bitwise_not(input.mat(), processed.output());
+
+        QCOMPARE(input->at<uchar>(0, 0), uchar(7));
+        QCOMPARE(processed->at<uchar>(0, 0), uchar(248));
+    }
+
+    void readingDoesNotChangeTheImage() {
+        ImageHandle handle(cv::Mat(4, 4, CV_8UC1, cv::Scalar(7)));
+        const uchar* data = handle->data;
+        const cv::Mat& view = handle;
+        QVERIFY(view.data == data);
+        QVERIFY(handle.mat().data == data);
+        QVERIFY(!handle.empty());
+        QCOMPARE(handle->at<uchar>(3, 3), uchar(7));
+    }
+
+    void editCopiesSharedPixels() {
+        ImageHandle a(cv::Mat(4, 4, CV_8UC1, cv::Scalar(7)));
+        ImageHandle b = a;
+
+        b.edit().setTo(3);
+
+        QVERIFY(!a.sharesWith(b));
+        QCOMPARE(a->at<uchar>(0, 0), uchar(7));
+        QCOMPARE(b->at<uchar>(0, 0), uchar(3));
+        QCOMPARE(a.useCount(), 1L);
+    }
+
+    void editCopiesPixelsSharedWithMatHeaders() {
+        cv::Mat buffer(4, 4, CV_8UC1, cv::Scalar(7));
+        ImageHandle handle(buffer);
+        const cv::Mat view = handle.mat();
+
+        handle.edit().setTo(3);
+
+        QVERIFY(handle->data != buffer.data);
+        QCOMPARE(buffer.at<uchar>(0, 0), uchar(7));
+        QCOMPARE(view.at<uchar>(0, 0), uchar(7));
+        QCOMPARE(handle->at<uchar>(0, 0), uchar(3));
+    }
+
+    void editWritesUnsharedPixelsInPlace() {
+        ImageHandle handle(cv::Mat(4, 4, CV_8UC1, cv::Scalar(7)));
+        const uchar* data = handle->data;
+
+        handle.edit().setTo(3);
+
+        QVERIFY(handle->data == data);
+        QCOMPARE(handle->at<uchar>(0, 0), uchar(3));
+    }
+
+    void editOfEmptyHandle() {
+        ImageHandle handle;
+        cv::Mat& out = handle.edit();
+        QVERIFY(out.empty());
+        out.create(2, 2, CV_8UC1);
+        QVERIFY(!handle.empty());
+    }
+
+    void versionsFollowTheContent() {
+        ImageHandle a(cv::Mat(4, 4, CV_8UC1, cv::Scalar(7)));
+        ImageHandle b = a;
+        QVERIFY(a.version() != 0);
+        QCOMPARE(b.version(), a.version());
+
+        b.edit().setTo(3);
+        QVERIFY(b.version() != a.version());
+
+        const uint64_t edited = b.version();
+        b.edit().setTo(4);          // sole holder: in place, still a new version
+        QVERIFY(b.version() != edited);
+
+        b.output();
+        QVERIFY(b.version() != edited && b.version() != a.version());
+        QVERIFY(ImageHandle().version() == 0);
+    }
+
+    void resetReleasesOnlyThisHandle() {
+        ImageHandle a(cv::Mat(4, 4, CV_8UC1, cv::Scalar(7)));
+        ImageHandle b = a;
+        b.reset();
+        QVERIFY(b.empty());
+        QCOMPARE(a.useCount(), 1L);
+        QCOMPARE(a->at<uchar>(0, 0), uchar(7));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestImageHandle)
+#include "test_image_handle.moc"
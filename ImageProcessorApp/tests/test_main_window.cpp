@@ -0,0 +1,60 @@
+#include "MainWindow.h"
+#include "processing/ImageProcessingLib.h"
+#include <QtTest>
+#include <QTemporaryDir>
+
+/**
+ * @brief End-to-end: load, apply operations, display, save
+ */
+class TestMainWindow : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        QStandardPaths::setTestModeEnabled(true);
+    }
+
+    void appliedResultIsDisplayedAndSaved() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        cv::Mat input(64, 96, CV_8UC3);
+        cv::randu(input, cv::Scalar::all(0), cv::Scalar::all(255));
+        const QString inputPath = dir.filePath("input.png");
+        QVERIFY(cv::imwrite(inputPath.toStdString(), input));
+
+        MainWindow window;
+        QVERIFY(window.openImage(inputPath));
+
+        // Applied twice: the second run must read the first result (each
+        // apply also refreshes the display, which must not disturb it)
+        QVERIFY(QMetaObject::invokeMethod(&window, "applyGaussianBlur", Qt::DirectConnection));
+        QVERIFY(QMetaObject::invokeMethod(&window, "applyGaussianBlur", Qt::DirectConnection));
+
+        const QString outputPath = dir.filePath("output.png");
+        QVERIFY(window.saveProcessedImage(outputPath));
+
+        cv::Mat once, twice;
+        ImageProcessingLib::applyGaussianBlur(input, once, 5);
+        ImageProcessingLib::applyGaussianBlur(once, twice, 5);
+
+        cv::Mat saved = cv::imread(outputPath.toStdString(), cv::IMREAD_UNCHANGED);
+        QCOMPARE(saved.rows, input.rows);
+        QCOMPARE(saved.cols, input.cols);
+        QCOMPARE(saved.type(), twice.type());
+        QCOMPARE(cv::norm(saved, twice, cv::NORM_INF), 0.0);
+    }
+
+    void nothingToSaveBeforeProcessing() {
+        QTemporaryDir dir;
+        const QString inputPath = dir.filePath("input.png");
+        QVERIFY(cv::imwrite(inputPath.toStdString(), cv::Mat(8, 8, CV_8UC3, cv::Scalar::all(9))));
+
+        MainWindow window;
+        QVERIFY(window.openImage(inputPath));
+        QVERIFY(!window.saveProcessedImage(dir.filePath("output.png")));
+    }
+};
+
+QTEST_MAIN(TestMainWindow)
+#include "test_main_window.moc"
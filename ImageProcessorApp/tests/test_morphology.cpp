@@ -0,0 +1,76 @@
+#include "MorphologyEngine.h"
+#include <QtTest>
+
+/**
+ * @brief MorphologyEngine on 0/255 masks matches cv::morphologyEx
+ *
+ * Large kernels take the bit-packed BinaryMorphology path, small ones go
+ * straight to OpenCV; both must give OpenCV's result.
+ */
+class TestMorphology : public QObject {
+    Q_OBJECT
+
+private slots:
+    void maskMatchesOpenCV_data() {
+        QTest::addColumn<int>("operation");
+        QTest::addColumn<int>("shape");
+        QTest::addColumn<int>("size");
+        QTest::addColumn<int>("iterations");
+
+        const int operations[] = {cv::MORPH_ERODE, cv::MORPH_DILATE, cv::MORPH_OPEN,
+                                  cv::MORPH_CLOSE, cv::MORPH_GRADIENT, cv::MORPH_TOPHAT,
+                                  cv::MORPH_BLACKHAT};
+        const int shapes[] = {cv::MORPH_RECT, cv::MORPH_ELLIPSE, cv::MORPH_CROSS};
+        for (int operation : operations) {
+            for (int shape : shapes) {
+                QTest::newRow(qPrintable(QString("op%1 shape%2 3x3").arg(operation).arg(shape)))
+                    << operation << shape << 3 << 1;
+                QTest::newRow(qPrintable(QString("op%1 shape%2 9x9").arg(operation).arg(shape)))
+                    << operation << shape << 9 << 1;
+                QTest::newRow(qPrintable(QString("op%1 shape%2 5x5 x3").arg(operation).arg(shape)))
+                    << operation << shape << 5 << 3;
+            }
+        }
+    }
+
+    void maskMatchesOpenCV() {
+        QFETCH(int, operation);
+        QFETCH(int, shape);
+        QFETCH(int, size);
+        QFETCH(int, iterations);
+
+        const cv::Mat mask = randomMask();
+        const cv::Mat kernel = cv::getStructuringElement(shape, cv::Size(size, size));
+
+        cv::Mat expected, actual;
+        cv::morphologyEx(mask, expected, operation, kernel, cv::Point(-1, -1), iterations);
+        MorphologyEngine::morphologyEx(mask, actual, operation, kernel, iterations);
+
+        QCOMPARE(actual.type(), expected.type());
+        QCOMPARE(actual.size(), expected.size());
+        QCOMPARE(cv::norm(actual, expected, cv::NORM_INF), 0.0);
+
+        // Declaring the mask skips the scan, not the result
+        cv::Mat declared;
+        MorphologyEngine::morphologyEx(mask, declared, operation, kernel, iterations,
+                                       MorphologyEngine::INPUT_MASK);
+        QCOMPARE(cv::norm(declared, expected, cv::NORM_INF), 0.0);
+    }
+
+private:
+    // Blobs and isolated pixels; the width is not a multiple of 64
+    static cv::Mat randomMask() {
+        cv::Mat noise(97, 131, CV_8UC1);
+        cv::RNG rng(7);
+        rng.fill(noise, cv::RNG::UNIFORM, 0, 256);
+
+        cv::Mat blurred, mask;
+        cv::GaussianBlur(noise, blurred, cv::Size(7, 7), 0);
+        cv::threshold(blurred, mask, 128, 255, cv::THRESH_BINARY);
+        mask.setTo(255, noise > 250);
+        return mask;
+    }
+};
+
+QTEST_APPLESS_MAIN(TestMorphology)
+#include "test_morphology.moc"
@@ -0,0 +1,97 @@
+#include "ResultCache.h"
+#include <QtTest>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+/**
+ * @brief ResultCache hits, input checks and spill files
+ */
+class TestResultCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init() {
+        ResultCache::setSpillDirectory(std::string());
+        ResultCache::setCacheBudget(ResultCache::DEFAULT_CACHE_BUDGET);
+        ResultCache::clearCache();
+    }
+
+    void copyOfTheInputHits() {
+        ImageHandle input(image(1));
+        ImageHandle result(image(2));
+        ResultCache::store(ResultCache::Key("op", input).add("k", 3), result);
+
+        ImageHandle copy = ImageHandle::copyOf(input.mat());
+        ImageHandle hit;
+        QVERIFY(ResultCache::lookup(ResultCache::Key("op", copy).add("k", 3), hit));
+        QVERIFY(hit.sharesWith(result));
+
+        QVERIFY(!ResultCache::lookup(ResultCache::Key("op", copy).add("k", 4), hit));
+        QVERIFY(!ResultCache::lookup(ResultCache::Key("op", ImageHandle(image(3))).add("k", 3), hit));
+    }
+
+    void spilledResultIsReadBack() {
+        QTemporaryDir dir;
+        ResultCache::setSpillDirectory(dir.path().toStdString());
+        ResultCache::setCacheBudget(1);     // only the latest result stays in memory
+
+        ImageHandle input(image(1));
+        cv::Mat first = image(5);
+        ResultCache::store(ResultCache::Key("op", input).add("i", 0), ImageHandle(first));
+        ResultCache::store(ResultCache::Key("op", input).add("i", 1), ImageHandle(image(6)));
+        QCOMPARE(int(ResultCache::stats().diskEntries), 1);
+
+        ImageHandle hit;
+        QVERIFY(ResultCache::lookup(ResultCache::Key("op", input).add("i", 0), hit));
+        QCOMPARE(cv::norm(hit.mat(), first, cv::NORM_INF), 0.0);
+        QCOMPARE(int(ResultCache::stats().diskHits), 1);
+    }
+
+    void damagedSpillFileIsRejected() {
+        QTemporaryDir dir;
+        ResultCache::setSpillDirectory(dir.path().toStdString());
+        ResultCache::setCacheBudget(1);
+
+        ImageHandle input(image(1));
+        ResultCache::store(ResultCache::Key("op", input).add("i", 0), ImageHandle(image(5)));
+        ResultCache::store(ResultCache::Key("op", input).add("i", 1), ImageHandle(image(6)));
+
+        const QStringList files = QDir(dir.path()).entryList(QStringList("*.imgcache"));
+        QCOMPARE(files.size(), 1);
+        QFile file(dir.filePath(files.first()));
+        QVERIFY(file.resize(file.size() - 1));
+
+        ImageHandle hit;
+        QVERIFY(!ResultCache::lookup(ResultCache::Key("op", input).add("i", 0), hit));
+        QVERIFY(!QFile::exists(file.fileName()));
+        QCOMPARE(int(ResultCache::stats().diskEntries), 0);
+    }
+
+    void clearSpillRemovesFiles() {
+        QTemporaryDir dir;
+        ResultCache::setSpillDirectory(dir.path().toStdString());
+        ResultCache::setCacheBudget(1);
+
+        ImageHandle input(image(1));
+        for (int i = 0; i < 3; ++i) {
+            ResultCache::store(ResultCache::Key("op", input).add("i", i), ImageHandle(image(10 + i)));
+        }
+        QCOMPARE(QDir(dir.path()).entryList(QStringList("*.imgcache")).size(), 2);
+
+        ResultCache::clearSpill();
+        QCOMPARE(QDir(dir.path()).entryList(QStringList("*.imgcache")).size(), 0);
+        QCOMPARE(int(ResultCache::stats().diskEntries), 0);
+    }
+
+private:
+    static cv::Mat image(int seed) {
+        cv::Mat result(32, 40, CV_8UC3);
+        cv::RNG rng(seed);
+        rng.fill(result, cv::RNG::UNIFORM, 0, 256);
+        return result;
+    }
+};
+
+QTEST_APPLESS_MAIN(TestResultCache)
+#include "test_result_cache.moc"
@@ -0,0 +1,60 @@
+#include "SegmentationLib.h"
+#include <QtTest>
+
+/**
+ * @brief SegmentationLib::labelConnectedComponents thresholds every input type
+ */
+class TestSegmentation : public QObject {
+    Q_OBJECT
+
+private slots:
+    void grayInputIsThresholdedAt127() {
+        // The dark square is not foreground even though it is non-zero
+        cv::Mat gray(40, 60, CV_8UC1, cv::Scalar(0));
+        gray(cv::Rect(5, 5, 10, 10)).setTo(100);
+        gray(cv::Rect(30, 20, 12, 8)).setTo(200);
+
+        cv::Mat labels;
+        std::vector<ConnectedComponents::ComponentStats> stats;
+        QCOMPARE(SegmentationLib::labelConnectedComponents(gray, labels, stats), 2);
+        QCOMPARE(stats[1].area, 12 * 8);
+        QCOMPARE(stats[1].boundingBox, cv::Rect(30, 20, 12, 8));
+        QCOMPARE(labels.at<int>(10, 10), 0);
+    }
+
+    void colorInputsMatchGray() {
+        const cv::Mat gray = twoSquares();
+        cv::Mat bgr, bgra;
+        cv::cvtColor(gray, bgr, cv::COLOR_GRAY2BGR);
+        cv::cvtColor(gray, bgra, cv::COLOR_GRAY2BGRA);
+
+        cv::Mat grayLabels, bgrLabels, bgraLabels;
+        std::vector<ConnectedComponents::ComponentStats> stats;
+        const int expected = SegmentationLib::labelConnectedComponents(gray, grayLabels, stats);
+        QCOMPARE(expected, 3);
+        QCOMPARE(SegmentationLib::labelConnectedComponents(bgr, bgrLabels, stats), expected);
+        QCOMPARE(SegmentationLib::labelConnectedComponents(bgra, bgraLabels, stats), expected);
+        QCOMPARE(cv::norm(grayLabels, bgrLabels, cv::NORM_INF), 0.0);
+        QCOMPARE(cv::norm(grayLabels, bgraLabels, cv::NORM_INF), 0.0);
+        QCOMPARE(stats[2].area, 10 * 10);
+    }
+
+    void unsupportedInputIsRejected() {
+        cv::Mat labels(4, 4, CV_32S, cv::Scalar(1));
+        std::vector<ConnectedComponents::ComponentStats> stats(3);
+        QCOMPARE(SegmentationLib::labelConnectedComponents(cv::Mat(), labels, stats), 0);
+        QVERIFY(labels.empty());
+        QVERIFY(stats.empty());
+    }
+
+private:
+    static cv::Mat twoSquares() {
+        cv::Mat gray(40, 60, CV_8UC1, cv::Scalar(0));
+        gray(cv::Rect(5, 5, 8, 8)).setTo(255);
+        gray(cv::Rect(30, 20, 10, 10)).setTo(180);
+        return gray;
+    }
+};
+
+QTEST_APPLESS_MAIN(TestSegmentation)
+#include "test_segmentation.moc"